@@ -0,0 +1,134 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Hal.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Counts heap allocations made through operator new.
+ *
+ * Linking Benchmark.cpp replaces the global operator new and delete with versions that
+ * count calls and bytes, so benchmarks can report allocations per operation. Counting is a
+ * pair of relaxed atomic adds per allocation.
+ */
+namespace AllocationCounter {
+
+/**
+ * @brief Returns the number of allocations since program start.
+ */
+uint64_t getCount();
+
+/**
+ * @brief Returns the number of bytes requested since program start.
+ */
+uint64_t getBytes();
+
+} // namespace AllocationCounter
+
+/**
+ * @brief Minimal micro-benchmark harness for the per-wake critical path.
+ *
+ * A case runs its operation in batches: each sample times `batch` back-to-back calls with
+ * Hal::micros() and records the time per call in nanoseconds, so operations shorter than the
+ * clock resolution still measure. Results carry p50, p99, max and mean per call and the
+ * allocations per call.
+ *
+ * report() prints one machine-readable line per case, `BENCH {json}`, through Hal::println(),
+ * so the same output can be grepped from a host run or a device's serial log and diffed
+ * against a stored baseline.
+ *
+ * Example:
+ * @code
+ * Benchmark::Result result = Benchmark::run("logger.dispatch", {200, 50, 10}, [] {
+ *     LOG_INFO("Reading {} took {} ms", 3, 12);
+ * });
+ * Benchmark::report(result);
+ * @endcode
+ */
+class Benchmark {
+public:
+    /**
+     * @brief How many samples to take and how many calls each sample times.
+     */
+    struct Config {
+        uint32_t samples; /**< Timed samples. */
+        uint32_t batch;   /**< Calls per sample. */
+        uint32_t warmup;  /**< Untimed calls before the first sample. */
+    };
+
+    /**
+     * @brief Timing and allocation figures of one case, per call.
+     */
+    struct Result {
+        const char* name;      /**< Case name, e.g. "filesystem.write". */
+        uint32_t samples;      /**< Timed samples. */
+        uint32_t batch;        /**< Calls per sample. */
+        uint32_t p50Ns;        /**< Median time per call. */
+        uint32_t p99Ns;        /**< 99th percentile time per call. */
+        uint32_t maxNs;        /**< Slowest sample, per call. */
+        uint32_t meanNs;       /**< Mean time per call. */
+        float allocsPerCall;   /**< Heap allocations per call. */
+        float bytesPerCall;    /**< Heap bytes requested per call. */
+    };
+
+    /**
+     * @brief Times an operation.
+     *
+     * @param name Case name; must outlive the result.
+     * @param config Samples, batch size and warm-up calls.
+     * @param operation The callable to time.
+     * @return The per-call figures.
+     */
+    template <typename Operation>
+    static Result run(const char* name, Config config, Operation operation);
+
+    /**
+     * @brief Computes the figures of a case from per-call sample times.
+     *
+     * Sorts the samples in place.
+     */
+    static Result summarize(const char* name, std::vector<uint32_t>& sampleNs, uint32_t batch,
+                            uint64_t allocations, uint64_t bytes);
+
+    /**
+     * @brief Writes a result as a single-line JSON object.
+     * @return The number of characters written, excluding the terminator.
+     */
+    static size_t formatJson(const Result& result, char* out, size_t capacity);
+
+    /**
+     * @brief Prints `BENCH {json}` for a result to the debug console.
+     */
+    static void report(const Result& result);
+};
+
+template <typename Operation>
+Benchmark::Result Benchmark::run(const char* name, Config config, Operation operation) {
+    uint32_t samples = config.samples > 0 ? config.samples : 1;
+    uint32_t batch = config.batch > 0 ? config.batch : 1;
+    std::vector<uint32_t> sampleNs;
+    sampleNs.reserve(samples); // Before the counters are read, so it is not charged to the case
+
+    for (uint32_t i = 0; i < config.warmup; ++i) {
+        operation();
+    }
+
+    uint64_t allocationsBefore = AllocationCounter::getCount();
+    uint64_t bytesBefore = AllocationCounter::getBytes();
+    for (uint32_t sample = 0; sample < samples; ++sample) {
+        uint32_t start = Hal::micros();
+        for (uint32_t call = 0; call < batch; ++call) {
+            operation();
+        }
+        uint64_t elapsedNs = static_cast<uint64_t>(Hal::micros() - start) * 1000;
+        sampleNs.push_back(static_cast<uint32_t>(std::min<uint64_t>(elapsedNs / batch, UINT32_MAX)));
+    }
+
+    return summarize(name, sampleNs, batch, AllocationCounter::getCount() - allocationsBefore,
+                     AllocationCounter::getBytes() - bytesBefore);
+}
+
+#endif // BENCHMARK_H
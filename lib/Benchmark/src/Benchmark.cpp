@@ -0,0 +1,116 @@
+#include "Benchmark.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocationBytes{0};
+
+void* countedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+// Nearest-rank percentile of sorted samples
+uint32_t percentile(const std::vector<uint32_t>& sorted, uint32_t percent) {
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+} // namespace
+
+// Replacements of the global allocation functions; all other forms forward to these
+void* operator new(std::size_t size) {
+    void* memory = countedAllocate(size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace AllocationCounter {
+
+uint64_t getCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t getBytes() {
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+} // namespace AllocationCounter
+
+Benchmark::Result Benchmark::summarize(const char* name, std::vector<uint32_t>& sampleNs, uint32_t batch,
+                                       uint64_t allocations, uint64_t bytes) {
+    Result result{name, static_cast<uint32_t>(sampleNs.size()), batch, 0, 0, 0, 0, 0.0f, 0.0f};
+    if (sampleNs.empty()) {
+        return result;
+    }
+
+    std::sort(sampleNs.begin(), sampleNs.end());
+    uint64_t total = 0;
+    for (uint32_t ns : sampleNs) {
+        total += ns;
+    }
+    uint64_t calls = static_cast<uint64_t>(sampleNs.size()) * batch;
+
+    result.p50Ns = percentile(sampleNs, 50);
+    result.p99Ns = percentile(sampleNs, 99);
+    result.maxNs = sampleNs.back();
+    result.meanNs = static_cast<uint32_t>(total / sampleNs.size());
+    result.allocsPerCall = static_cast<float>(allocations) / calls;
+    result.bytesPerCall = static_cast<float>(bytes) / calls;
+    return result;
+}
+
+size_t Benchmark::formatJson(const Result& result, char* out, size_t capacity) {
+    int length = snprintf(out, capacity,
+                          "{\"name\":\"%s\",\"samples\":%u,\"batch\":%u,\"p50_ns\":%u,\"p99_ns\":%u,"
+                          "\"max_ns\":%u,\"mean_ns\":%u,\"allocs_per_call\":%.3f,\"bytes_per_call\":%.1f}",
+                          result.name, static_cast<unsigned>(result.samples), static_cast<unsigned>(result.batch),
+                          static_cast<unsigned>(result.p50Ns), static_cast<unsigned>(result.p99Ns),
+                          static_cast<unsigned>(result.maxNs), static_cast<unsigned>(result.meanNs),
+                          static_cast<double>(result.allocsPerCall), static_cast<double>(result.bytesPerCall));
+    if (length < 0) {
+        return 0;
+    }
+    return static_cast<size_t>(length) < capacity ? static_cast<size_t>(length) : capacity - 1;
+}
+
+void Benchmark::report(const Result& result) {
+    char line[256] = "BENCH ";
+    formatJson(result, line + 6, sizeof(line) - 6);
+    Hal::println(line);
+}
@@ -1,6 +1,7 @@
 #ifndef BASECONNECTION_H
 #define BASECONNECTION_H
 
+#include <cstdint>
 #include <string>
 #include <ConnType.h>
 
@@ -21,6 +22,8 @@ public:
     virtual void start() = 0;             // Activate the connection
     virtual void stop() = 0;              // Deactivate the connection
     virtual bool isConnected() const = 0; // Check connection status
+    virtual void loop() {}                // Service an established connection (keep-alives, incoming data)
+    virtual uint32_t getAttemptTimeoutMs() const { return 0; } // Limit of the attempt in progress, 0 for the caller's default
     virtual void reset() {
         stop();
         begin();
@@ -0,0 +1,195 @@
+#ifndef BATCHPUBLISHER_H
+#define BATCHPUBLISHER_H
+
+#include "OfflineQueue.h"
+#include <Metrics.h>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef BATCH_PUBLISHER_MAX_READINGS
+#define BATCH_PUBLISHER_MAX_READINGS 32 /**< Readings held per wake cycle, across all topics. */
+#endif
+
+#ifndef BATCH_PUBLISHER_MAX_TOPICS
+#define BATCH_PUBLISHER_MAX_TOPICS 4 /**< Topic groups per wake cycle. */
+#endif
+
+#ifndef BATCH_PUBLISHER_PAYLOAD_SIZE
+#define BATCH_PUBLISHER_PAYLOAD_SIZE 512 /**< Encoding buffer for one topic's payload. */
+#endif
+
+/**
+ * @brief Collects the readings of a wake cycle and publishes one payload per topic.
+ *
+ * Instead of one publish per value, readings are added as they are taken and publish()
+ * sends a single payload per topic group over the already open connection. Payloads are
+ * encoded as compact JSON or CBOR with the same structure:
+ *
+ * `{"d": device, "t": epoch ms of the first reading, "r": [[sensor, field, value, ms after t], ...]}`
+ *
+ * Topic, sensor and field strings are stored as pointers, so they must outlive the batch
+ * (string literals or BaseSensor::getName()). Adding a reading never allocates. PubSubClient's
+ * default 256 byte packet buffer must be raised with setBufferSize() for large batches. When
+ * an offline queue is given, payloads are capped at OfflineQueue::maxPayloadSize() so any
+ * of them can be queued.
+ *
+ * Example:
+ * @code
+ * BatchPublisher batch("esp32-temperature", BatchPublisher::Format::Cbor);
+ * batch.add("greenhouse/readings", "dht", "temp", 21.5f, epochMs);
+ * batch.add("greenhouse/readings", "dht", "hum", 48.0f, epochMs);
+ * batch.publish(client, &offlineQueue);
+ * @endcode
+ */
+class BatchPublisher {
+public:
+    /**
+     * @brief Payload encodings.
+     */
+    enum class Format {
+        Json,
+        Cbor
+    };
+
+    /**
+     * @brief What publish() did with each topic group.
+     */
+    struct Result {
+        size_t published;                               /**< Payloads published. */
+        size_t queued;                                  /**< Payloads put in the offline queue instead. */
+        size_t lost;                                    /**< Payloads neither published nor queued. */
+        size_t topicCount;                              /**< Topic groups the batch had. */
+        const char* topics[BATCH_PUBLISHER_MAX_TOPICS]; /**< The groups, as passed to add(). */
+        bool delivered[BATCH_PUBLISHER_MAX_TOPICS];     /**< True if no payload of the group was lost. */
+
+        /**
+         * @brief Checks whether the batch had readings under a topic and every payload of
+         * them was published or queued.
+         */
+        bool isDelivered(const char* topic) const;
+    };
+
+    /**
+     * @brief Constructs an empty batch.
+     * @param device Device identifier put in every payload.
+     * @param format Payload encoding.
+     */
+    BatchPublisher(const char* device, Format format = Format::Json);
+
+    /**
+     * @brief Adds one reading.
+     * @param topic Topic group the reading is published under.
+     * @param sensor Name of the sensor.
+     * @param field What was measured, e.g. "temp".
+     * @param value The reading.
+     * @param timestampMs Epoch time of the reading in milliseconds.
+     * @return False if the batch is full or the value is not a number.
+     */
+    bool add(const char* topic, const char* sensor, const char* field, float value, uint64_t timestampMs);
+
+    /**
+     * @brief Encodes readings of one topic group into a payload.
+     *
+     * Encodes as many of the group's readings as fit, starting at position, so a group too
+     * large for one buffer is sent as several payloads.
+     *
+     * @param topicIndex Index of the group, below getTopicCount().
+     * @param out Destination buffer.
+     * @param capacity Size of the destination buffer.
+     * @param position Index of the first reading to consider; advanced past the encoded readings.
+     * @return The payload size, or 0 if no reading is left or none fits.
+     */
+    size_t encode(size_t topicIndex, uint8_t* out, size_t capacity, size_t& position) const;
+
+    /**
+     * @brief Publishes one payload per topic group and clears the batch.
+     *
+     * Payloads that fail to publish go to the offline queue when one is given. A payload
+     * that is neither published nor queued is lost; it is counted in the PublishesLost
+     * metric and its topic is marked in the result.
+     *
+     * @tparam Client Type with `bool publish(const char* topic, const uint8_t* payload, unsigned int length)`,
+     *         such as PubSubClient.
+     * @param client The connected client. The connection is left open.
+     * @param fallback Queue for payloads that could not be published, or nullptr.
+     * @param result Receives what happened to each topic group, or nullptr.
+     * @return The number of payloads published.
+     */
+    template <typename Client>
+    size_t publish(Client& client, OfflineQueue* fallback = nullptr, Result* result = nullptr);
+
+    /**
+     * @brief Drops all readings.
+     */
+    void clear();
+
+    size_t getReadingCount() const { return readingCount; }
+    size_t getTopicCount() const { return topicCount; }
+    const char* getTopic(size_t topicIndex) const { return topics[topicIndex]; }
+    Format getFormat() const { return format; }
+    void setFormat(Format newFormat) { format = newFormat; }
+
+private:
+    struct Reading {
+        uint8_t topic;        // Index into topics
+        const char* sensor;   // Sensor name
+        const char* field;    // Measured quantity
+        float value;          // The reading
+        uint64_t timestampMs; // Epoch time of the reading
+    };
+
+    const char* device;                                 // Device identifier
+    Format format;                                      // Payload encoding
+    const char* topics[BATCH_PUBLISHER_MAX_TOPICS];     // Topic groups in order of first use
+    size_t topicCount;                                  // Topic groups in use
+    Reading readings[BATCH_PUBLISHER_MAX_READINGS];     // Readings in order of addition
+    size_t readingCount;                                // Readings in use
+};
+
+template <typename Client>
+size_t BatchPublisher::publish(Client& client, OfflineQueue* fallback, Result* result) {
+    uint8_t payload[BATCH_PUBLISHER_PAYLOAD_SIZE];
+    Result outcome = {};
+    outcome.topicCount = topicCount;
+
+    for (size_t topic = 0; topic < topicCount; ++topic) {
+        outcome.topics[topic] = topics[topic];
+        outcome.delivered[topic] = true;
+
+        // A payload the queue could not take would be lost whenever the publish fails
+        size_t capacity = sizeof(payload);
+        if (fallback != nullptr && OfflineQueue::maxPayloadSize(topics[topic]) < capacity) {
+            capacity = OfflineQueue::maxPayloadSize(topics[topic]);
+        }
+        size_t position = 0;
+        size_t length;
+        while ((length = encode(topic, payload, capacity, position)) > 0) {
+            bool sent;
+            {
+                METRICS_TIME(Publish);
+                sent = client.publish(topics[topic], payload, static_cast<unsigned int>(length));
+            }
+            if (sent) {
+                METRICS_COUNT(Published);
+                METRICS_ADD(PublishedBytes, static_cast<uint32_t>(length));
+                outcome.published++;
+                continue;
+            }
+            METRICS_COUNT(PublishFailures);
+            if (fallback != nullptr && fallback->enqueue(topics[topic], payload, length)) {
+                outcome.queued++;
+                continue;
+            }
+            METRICS_COUNT(PublishesLost);
+            outcome.lost++;
+            outcome.delivered[topic] = false;
+        }
+    }
+    clear();
+    if (result != nullptr) {
+        *result = outcome;
+    }
+    return outcome.published;
+}
+
+#endif // BATCHPUBLISHER_H
@@ -1,17 +1,133 @@
 #ifndef CONNECTIONMANAGER_H
 #define CONNECTIONMANAGER_H
 
+#include <cstdint>
 #include <string>
 #include <ConnType.h>
+#include "BaseConnection.h"
 
-
+/**
+ * @brief Non-blocking state machine that brings up a network link and then a broker session.
+ *
+ * update() never waits: it checks the current state, starts the next step when it is due and
+ * returns, so the caller can sample sensors while WiFi associates. Each stage has a timeout,
+ * and failed attempts are retried after an exponential backoff (initialBackoffMs doubling up
+ * to maxBackoffMs). A link or session that drops while connected is re-established the same way.
+ *
+ * Example:
+ * @code
+ * WiFiCommunication wifi(ssid, password);
+ * MqttConnection mqtt(client, "ESP32Client");
+ * ConnectionManager connection(wifi, mqtt);
+ * connection.begin();
+ * while (!connection.isConnected() && millis() < deadline) {
+ *     connection.update();
+ *     // ... sample sensors ...
+ * }
+ * @endcode
+ */
 class ConnectionManager {
 public:
+    /**
+     * @brief Connection states.
+     */
+    enum class State {
+        Idle,           /**< Not started, or stopped. */
+        LinkConnecting, /**< Waiting for the network link (WiFi association). */
+        LinkBackoff,    /**< Waiting before the next link attempt. */
+        BrokerConnecting, /**< Link is up, attempting the broker session. */
+        BrokerBackoff,  /**< Waiting before the next broker attempt. */
+        Connected       /**< Link and broker session are up. */
+    };
 
+    /**
+     * @brief Timeouts and backoff limits.
+     */
+    struct Config {
+        uint32_t linkTimeoutMs;    /**< Time allowed for one link attempt, unless the link sets its own. */
+        uint32_t initialBackoffMs; /**< Wait after the first failed attempt. */
+        uint32_t maxBackoffMs;     /**< Upper bound of the doubling backoff. */
+        uint32_t (*clock)();       /**< Millisecond clock, defaults to Hal::millis(). */
+    };
 
-};
+    /**
+     * @brief Returns the default config: 10 s link timeout, backoff from 500 ms up to 30 s.
+     */
+    static Config defaultConfig();
+
+    /**
+     * @brief Constructs a manager over a link and a session that runs on top of it.
+     * @param link The network link, e.g. WiFiCommunication. begin() must not block.
+     * @param broker The broker session, e.g. MqttConnection. begin() makes one attempt.
+     * @param config Timeouts and backoff limits.
+     */
+    ConnectionManager(BaseConnection& link, BaseConnection& broker, Config config = defaultConfig());
+
+    /**
+     * @brief Starts connecting. Does nothing if already started.
+     */
+    void begin();
+
+    /**
+     * @brief Advances the state machine. Call often; never blocks on the link.
+     * @return The state after the update.
+     */
+    State update();
+
+    /**
+     * @brief Closes the broker session and the link and returns to Idle.
+     */
+    void stop();
 
+    bool isConnected() const { return state == State::Connected; }
+    State getState() const { return state; }
 
+    /**
+     * @brief Returns the number of link and broker attempts since begin().
+     */
+    uint32_t getAttempts() const { return attempts; }
+
+    /**
+     * @brief Returns the time from begin() to the last transition to Connected, in ms.
+     */
+    uint32_t getConnectTimeMs() const { return connectTimeMs; }
+
+    /**
+     * @brief Returns the wait that will follow the next failed attempt, in ms.
+     */
+    uint32_t getBackoffMs() const { return backoffMs; }
+
+private:
+    void enter(State next);            // Switch state and note the time
+    void startLink();                  // Begin a link attempt
+    void scheduleRetry(State backoff); // Wait before the next attempt and grow the backoff
+    uint32_t linkTimeoutMs() const;    // The link's own limit for this attempt, or the config's
+
+    BaseConnection& link;    // Network link
+    BaseConnection& broker;  // Session over the link
+    Config config;           // Timeouts and backoff limits
+    State state;             // Current state
+    uint32_t stateSinceMs;   // Clock value when the current state was entered
+    uint32_t startedMs;      // Clock value when begin() was called
+    uint32_t retryDelayMs;   // Wait of the current backoff state
+    uint32_t backoffMs;      // Wait after the next failure
+    uint32_t attempts;       // Attempts since begin()
+    uint32_t connectTimeMs;  // Time from begin() to Connected
+};
 
+/**
+ * @brief Converts a connection state to its string representation.
+ */
+inline const char* connectionStateToString(ConnectionManager::State state) {
+    switch (state) {
+        case ConnectionManager::State::Idle: return "Idle";
+        case ConnectionManager::State::LinkConnecting: return "LinkConnecting";
+        case ConnectionManager::State::LinkBackoff: return "LinkBackoff";
+        case ConnectionManager::State::BrokerConnecting: return "BrokerConnecting";
+        case ConnectionManager::State::BrokerBackoff: return "BrokerBackoff";
+        case ConnectionManager::State::Connected: return "Connected";
+        default: return "UNKNOWN";
+    }
+}
 
-#endif // CONNECTIONMANAGER_H
\ No newline at end of file
+#endif // CONNECTIONMANAGER_H
@@ -0,0 +1,119 @@
+#ifndef FASTRESUME_H
+#define FASTRESUME_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Connection parameters carried across deep sleep so a wake can skip the slow steps of
+ * connecting.
+ *
+ * A full connect scans for the access point, waits for a DHCP lease, looks the broker up in
+ * DNS. After one full connect the cache holds the AP's BSSID and channel, the lease and the
+ * broker's address, so the next wakes associate directly, configure the address statically and
+ * connect to the broker by IP. The wall clock is carried separately, by TimeService.
+ *
+ * The state is owned by the caller so it can be declared RTC_DATA_ATTR. It carries a magic
+ * number and a checksum; anything else (a power-on reset, a firmware with another layout)
+ * reads as an empty cache. Each part is dropped on its own when using it fails, e.g.
+ * forgetLink() when the cached association times out, and the next attempt connects the
+ * full way and caches the result again.
+ *
+ * Example:
+ * @code
+ * RTC_DATA_ATTR FastResume::State resumeState;
+ * FastResume resume(resumeState);
+ * wifi.setFastResume(&resume);
+ * mqtt.setFastResume(&resume, mqtt_broker, mqtt_port);
+ * // ... connect ...
+ * wifi.rememberLink();
+ * mqtt.rememberBroker();
+ * @endcode
+ */
+class FastResume {
+public:
+    /**
+     * @brief The association and address lease of the last full connect.
+     */
+    struct Link {
+        uint8_t bssid[6];  /**< MAC address of the access point. */
+        uint8_t channel;   /**< WiFi channel of the access point. */
+        uint8_t reserved;  /**< Keeps the layout free of padding. */
+        uint32_t localIp;  /**< Leased address, as IPAddress converts to uint32_t. */
+        uint32_t gateway;  /**< Gateway of the lease. */
+        uint32_t subnet;   /**< Subnet mask of the lease. */
+        uint32_t dns;      /**< DNS server of the lease. */
+    };
+
+    /**
+     * @brief Cached parameters. Zero-initialized memory reads as an empty cache.
+     *
+     * The fields are ordered so the struct has no padding and the checksum covers only data.
+     */
+    struct State {
+        uint32_t magic;      /**< stateMagic once the cache has been written. */
+        uint32_t brokerIp;   /**< Valid with the broker flag. */
+        Link link;           /**< Valid with the link flag. */
+        uint8_t flags;       /**< Which parts are cached. */
+        uint8_t reserved[3]; /**< Keeps the layout free of padding. */
+        uint32_t checksum;   /**< Over every field above. */
+    };
+
+    /**
+     * @brief Constructs a cache over a state.
+     * @param state The cached parameters, typically declared RTC_DATA_ATTR.
+     */
+    explicit FastResume(State& state);
+
+    /**
+     * @brief Checks the magic number and checksum.
+     * @return False for a cache that was never written or has been corrupted.
+     */
+    bool isValid() const;
+
+    bool hasLink() const { return has(linkFlag); }
+    bool hasBroker() const { return has(brokerFlag); }
+
+    /**
+     * @brief Returns the cached link. Only meaningful when hasLink() is true.
+     */
+    const Link& getLink() const { return state.link; }
+
+    /**
+     * @brief Returns the cached broker address. Only meaningful when hasBroker() is true.
+     */
+    uint32_t getBrokerIp() const { return state.brokerIp; }
+
+    void saveLink(const Link& link);
+    void saveBroker(uint32_t ip);
+
+    void forgetLink();
+    void forgetBroker();
+
+    /**
+     * @brief Drops the link and the broker. For a wake that never connected.
+     */
+    void forgetNetwork();
+
+    /**
+     * @brief Drops everything.
+     */
+    void clear();
+
+    static const uint32_t stateMagic = 0x46524553; // "FRES"
+
+private:
+    static const uint8_t linkFlag = 0x01;
+    static const uint8_t brokerFlag = 0x02;
+
+    bool has(uint8_t flag) const { return isValid() && (state.flags & flag) != 0; }
+    void prepare();            // Start over from an empty cache unless the state is valid
+    void set(uint8_t flag);    // Set a flag and reseal
+    void unset(uint8_t flag);  // Clear a flag and reseal
+    void seal();               // Recompute the checksum
+    static uint32_t checksumOf(const State& state);
+
+    State& state; // Cached parameters, usually in RTC memory
+};
+
+#endif // FASTRESUME_H
@@ -0,0 +1,44 @@
+#ifndef MQTTCONNECTION_H
+#define MQTTCONNECTION_H
+
+#include <PubSubClient.h>
+#include "BaseConnection.h"
+#include "FastResume.h"
+
+class MqttConnection : public BaseConnection {
+public:
+    // Constructor - the client must already have its server set
+    MqttConnection(PubSubClient& client, const std::string& clientId,
+                   const std::string& username = "", const std::string& password = "")
+        : BaseConnection("MQTT Connection", ConnType::WiFi, "", password), client(client), clientId(clientId),
+          username(username) {}
+
+    // Override methods from BaseConnection
+    // One connection attempt - PubSubClient blocks for at most its socket timeout here
+    bool begin() override;
+    void start() override { if (!isConnected()) begin(); }
+    void stop() override { client.disconnect(); }
+    bool isConnected() const override { return client.connected(); }
+    void loop() override { client.loop(); }
+
+    // Lets begin() connect to the cached broker address instead of looking the host up, see FastResume
+    void setFastResume(FastResume* cache, const char* host, uint16_t port) {
+        resume = cache;
+        brokerHost = host;
+        brokerPort = port;
+    }
+
+    // Caches the broker's address for the next wake; call once connected
+    void rememberBroker();
+
+private:
+    PubSubClient& client;   // Client used for publishing
+    std::string clientId;   // MQTT client identifier
+    std::string username;   // Broker username, empty for anonymous
+    FastResume* resume = nullptr;      // Cached broker address, or nullptr to use the client's server as set
+    const char* brokerHost = nullptr;  // Host name to fall back to
+    uint16_t brokerPort = 0;           // Broker port
+    bool cachedAttempt = false;        // The last attempt used the cached address
+};
+
+#endif // MQTTCONNECTION_H
@@ -0,0 +1,256 @@
+#ifndef OFFLINEQUEUE_H
+#define OFFLINEQUEUE_H
+
+#include <AppendJournal.h>
+#include <BaseAppendFile.h>
+#include <Metrics.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+#ifndef OFFLINE_QUEUE_SEGMENT_SIZE
+#define OFFLINE_QUEUE_SEGMENT_SIZE 4096 /**< Bytes per segment file, one LittleFS block. */
+#endif
+
+#ifndef OFFLINE_QUEUE_MAX_SEGMENTS
+#define OFFLINE_QUEUE_MAX_SEGMENTS 16 /**< Segments kept before the oldest is dropped. */
+#endif
+
+#ifndef OFFLINE_QUEUE_ENTRY_SIZE
+#define OFFLINE_QUEUE_ENTRY_SIZE 640 /**< Largest entry: topic, terminator and payload; fits a full BatchPublisher payload. */
+#endif
+
+#ifndef OFFLINE_QUEUE_DRAIN_BATCH
+#define OFFLINE_QUEUE_DRAIN_BATCH 8 /**< Entries published between head pointer saves. */
+#endif
+
+/**
+ * @brief Persistent FIFO of MQTT publishes that could not be sent.
+ *
+ * Entries are appended as AppendJournal frames (topic, NUL, payload) to numbered segment
+ * files `<prefix>.<n>`. An entry too large for one frame, up to OFFLINE_QUEUE_ENTRY_SIZE, is
+ * split over consecutive frames of one segment, each starting with a part marker byte
+ * (partFirst, partMiddle, partLast); drain() puts the parts back together and only publishes
+ * an entry whose last part is there, so an entry cut short by a reset is skipped. Files are only ever appended to or deleted: the head position
+ * (segment and offset of the oldest unsent entry) is appended as a small numbered record to
+ * `<prefix>.head0` or `<prefix>.head1`, and a segment is deleted once the head moves past
+ * it. When one head file fills up the other one is started over, so the newest record
+ * survives a reset at any point. The tail is found again on begin() by probing for the
+ * highest segment number.
+ *
+ * drain() publishes oldest first and saves the head after every OFFLINE_QUEUE_DRAIN_BATCH
+ * entries, so a reset during a drain re-sends at most one batch and never loses an entry.
+ * When OFFLINE_QUEUE_MAX_SEGMENTS segments are full, the oldest segment is dropped.
+ *
+ * Example:
+ * @code
+ * OfflineQueue queue("/mqtt_queue", [](const std::string& path) {
+ *     return std::unique_ptr<BaseAppendFile>(new LittleFSAppendFile(path));
+ * });
+ * queue.begin();
+ * if (!client.publish(topic, message)) {
+ *     queue.enqueue(topic, message);
+ * }
+ * // Once connected again:
+ * queue.drain(client);
+ * @endcode
+ */
+class OfflineQueue {
+public:
+    /**
+     * @brief Creates the file object for a path; lets the host tests swap LittleFS out.
+     */
+    using FileFactory = std::function<std::unique_ptr<BaseAppendFile>(const std::string& path)>;
+
+    /**
+     * @brief Queue activity counters.
+     */
+    struct Stats {
+        uint32_t enqueued;         /**< Entries added. */
+        uint32_t published;        /**< Entries published by drain(). */
+        uint32_t rejected;         /**< Entries larger than OFFLINE_QUEUE_ENTRY_SIZE, or not written. */
+        uint32_t droppedSegments;  /**< Segments dropped because the queue was full. */
+        uint32_t headSaves;        /**< Head pointer records written. */
+    };
+
+    static constexpr uint8_t partFirst = 0x01;  /**< Marks the first frame of a split entry. */
+    static constexpr uint8_t partMiddle = 0x02; /**< Marks a frame between the first and the last. */
+    static constexpr uint8_t partLast = 0x03;   /**< Marks the frame that completes a split entry. */
+
+    /**
+     * @brief Returns the largest payload enqueue() accepts under a topic.
+     */
+    static size_t maxPayloadSize(const char* topic);
+
+    /**
+     * @brief Constructs a queue.
+     * @param pathPrefix Prefix of the queue's files, e.g. "/mqtt_queue".
+     * @param factory Creates the file objects for the segments and the head pointer.
+     */
+    OfflineQueue(const std::string& pathPrefix, FileFactory factory);
+
+    /**
+     * @brief Restores the head and tail from the files left by a previous boot.
+     * @return True if the queue is ready for use.
+     */
+    bool begin();
+
+    /**
+     * @brief Appends an entry and commits it to flash.
+     *
+     * The topic, its terminator and the payload together must fit in OFFLINE_QUEUE_ENTRY_SIZE;
+     * entries larger than one journal frame take several.
+     * @return True if the entry was stored.
+     */
+    bool enqueue(const char* topic, const uint8_t* payload, size_t size);
+    bool enqueue(const char* topic, const char* message);
+
+    /**
+     * @brief Publishes queued entries, oldest first, until the queue is empty, a publish
+     * fails, or maxEntries have been sent.
+     *
+     * @tparam Client Type with `bool publish(const char* topic, const uint8_t* payload, unsigned int length)`,
+     *         such as PubSubClient.
+     * @param client The connected client.
+     * @param maxEntries Upper bound on the entries published by this call.
+     * @return The number of entries published.
+     */
+    template <typename Client>
+    size_t drain(Client& client, size_t maxEntries = SIZE_MAX);
+
+    /**
+     * @brief Checks whether all entries have been published.
+     */
+    bool isEmpty();
+
+    /**
+     * @brief Returns the number of segment files in use.
+     */
+    uint32_t getSegmentCount() const { return tailSegment - headSegment + 1; }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct HeadRecord {
+        uint32_t sequence;  // Orders records across both head files
+        uint32_t segment;
+        uint32_t offset;
+    };
+
+    std::string segmentPath(uint32_t segment) const;
+    bool appendParts(const char* topic, size_t topicLength, const uint8_t* payload, size_t size);
+    bool openTail(uint32_t segment);
+    bool saveHead();
+    void dropHeadSegment();
+
+    std::string pathPrefix;                        // Prefix of all queue files
+    FileFactory factory;                           // Creates file objects
+    Stats stats;                                   // Activity counters
+    std::unique_ptr<BaseAppendFile> headFiles[2];  // Head pointer files, used in turn
+    std::unique_ptr<AppendJournal> headJournals[2]; // Head pointer records
+    uint8_t activeHead;                            // Head file new records go to
+    uint32_t headSequence;                         // Sequence number of the last head record
+    std::unique_ptr<BaseAppendFile> tailFile;      // Segment being appended to
+    std::unique_ptr<AppendJournal> tailJournal;    // Frames of the tail segment
+    uint32_t headSegment;                          // Segment of the oldest unsent entry
+    uint32_t headOffset;                           // Offset of the oldest unsent entry
+    uint32_t tailSegment;                          // Segment new entries go to
+    uint8_t entry[OFFLINE_QUEUE_ENTRY_SIZE];       // A split entry being put back together by drain()
+};
+
+template <typename Client>
+size_t OfflineQueue::drain(Client& client, size_t maxEntries) {
+    size_t published = 0;
+    bool failed = false;
+
+    while (!failed && published < maxEntries && !isEmpty()) {
+        // Older segments get a reader of their own; the tail is read through its open journal
+        std::unique_ptr<BaseAppendFile> file;
+        std::unique_ptr<AppendJournal> journal;
+        BaseAppendFile* segment = tailFile.get();
+        AppendJournal* reader = tailJournal.get();
+        if (headSegment != tailSegment) {
+            file = factory(segmentPath(headSegment));
+            journal.reset(new AppendJournal(*file));
+            segment = file.get();
+            reader = journal.get();
+        }
+        size_t unsaved = 0;
+        bool limited = false;
+        bool assembling = false; // Parts of a split entry are in the entry buffer
+        size_t assembled = 0;
+
+        reader->readFrames(headOffset, [&](const uint8_t* frame, size_t frameSize, size_t nextOffset) {
+            const uint8_t* data = frame;
+            size_t size = frameSize;
+            if (size > 0 && frame[0] >= partFirst && frame[0] <= partLast) {
+                // headOffset stays on the first part until the whole entry is published
+                if (frame[0] == partFirst) {
+                    assembling = true; // Also drops an earlier entry whose last part never came
+                    assembled = 0;
+                }
+                if (!assembling || assembled + size - 1 > sizeof(entry)) {
+                    assembling = false;
+                    headOffset = static_cast<uint32_t>(nextOffset); // Part of an entry cut short
+                    return true;
+                }
+                std::memcpy(entry + assembled, frame + 1, size - 1);
+                assembled += size - 1;
+                if (frame[0] != partLast) {
+                    return true;
+                }
+                assembling = false;
+                data = entry;
+                size = assembled;
+            } else {
+                assembling = false;
+            }
+
+            const char* topic = reinterpret_cast<const char*>(data);
+            size_t topicLength = strnlen(topic, size);
+            if (topicLength < size) {
+                const uint8_t* payload = data + topicLength + 1;
+                size_t length = size - topicLength - 1;
+                bool sent;
+                {
+                    METRICS_TIME(Publish);
+                    sent = client.publish(topic, payload, static_cast<unsigned int>(length));
+                }
+                if (!sent) {
+                    METRICS_COUNT(PublishFailures);
+                    failed = true;
+                    return false; // Keep the entry for the next connection
+                }
+                METRICS_COUNT(Published);
+                METRICS_ADD(PublishedBytes, static_cast<uint32_t>(length));
+                published++;
+                stats.published++;
+            }
+            headOffset = static_cast<uint32_t>(nextOffset);
+            if (++unsaved >= OFFLINE_QUEUE_DRAIN_BATCH) {
+                saveHead();
+                unsaved = 0;
+            }
+            limited = published >= maxEntries;
+            return !limited;
+        });
+
+        bool exhausted = !failed && !limited;
+        if (exhausted && headSegment != tailSegment) {
+            dropHeadSegment(); // Everything in this segment is sent
+            continue;
+        }
+        if (exhausted) {
+            headOffset = static_cast<uint32_t>(segment->size()); // Skip any torn bytes at the end
+        }
+        if (unsaved > 0 || exhausted) {
+            saveHead();
+        }
+    }
+    return published;
+}
+
+#endif // OFFLINEQUEUE_H
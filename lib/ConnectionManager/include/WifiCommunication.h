@@ -0,0 +1,135 @@
+#ifndef WIFICOMMUNICATION_H
+#define WIFICOMMUNICATION_H
+
+#include <WiFi.h>
+#include <cstring>
+#include "BaseConnection.h"
+#include "FastResume.h"
+#include <Metrics.h>
+
+#ifndef WIFI_FAST_RESUME_TIMEOUT_MS
+#define WIFI_FAST_RESUME_TIMEOUT_MS 3000 /**< Time a cached association gets before falling back to a full connect. */
+#endif
+
+class WiFiCommunication : public BaseConnection {
+public:
+    // Constructor
+    WiFiCommunication(const std::string& ssid, const std::string& password)
+        : BaseConnection("WiFi Communication", ConnType::WiFi, ssid, password) {}
+
+    // Override methods from BaseConnection
+    // Starts associating and returns immediately - poll isConnected() or let ConnectionManager drive it
+    bool begin() override {
+        METRICS_TIME(WifiBegin);
+        METRICS_COUNT(WifiAttempts);
+        Serial.println("Initializing WiFi...");
+        wl_status_t status;
+        fastAttempt = resume != nullptr && resume->hasLink();
+        if (fastAttempt) {
+            // Skips the scan and DHCP: straight to the known AP with the last lease
+            const FastResume::Link& link = resume->getLink();
+            WiFi.config(IPAddress(link.localIp), IPAddress(link.gateway), IPAddress(link.subnet), IPAddress(link.dns));
+            status = WiFi.begin(networkName.c_str(), password.c_str(), link.channel, link.bssid);
+        } else {
+            WiFi.config(IPAddress(), IPAddress(), IPAddress()); // Back to DHCP
+            status = WiFi.begin(networkName.c_str(), password.c_str());
+        }
+        if (status == WL_CONNECT_FAILED) {
+            if (fastAttempt) {
+                resume->forgetLink();
+            }
+            setErrorMessage("Failed to start WiFi.");
+            return false;
+        }
+        return true;
+    }
+
+    void start() override {
+        if (isConnected()) {
+            Serial.println("WiFi is already connected.");
+        } else {
+            begin();
+        }
+    }
+
+    void stop() override {
+        if (isConnected()) {
+            Serial.println("Disconnecting WiFi...");
+        } else if (fastAttempt) {
+            resume->forgetLink(); // The cached AP or lease did not work; the next begin() connects the full way
+        }
+        fastAttempt = false;
+        WiFi.disconnect(); // Also cancels an association in progress
+    }
+
+    bool isConnected() const override {
+        return WiFi.status() == WL_CONNECTED;
+    }
+
+    uint32_t getAttemptTimeoutMs() const override {
+        return fastAttempt ? WIFI_FAST_RESUME_TIMEOUT_MS : 0;
+    }
+
+    // Lets begin() reuse the association and lease of the last full connect, see FastResume
+    void setFastResume(FastResume* cache) { resume = cache; }
+
+    // Caches the current association and lease for the next wake; call once connected
+    void rememberLink() {
+        if (resume == nullptr || fastAttempt || !isConnected()) {
+            return; // Nothing to cache, or the cache already holds this link
+        }
+        FastResume::Link link = {};
+        std::memcpy(link.bssid, WiFi.BSSID(), sizeof(link.bssid));
+        link.channel = static_cast<uint8_t>(WiFi.channel());
+        link.localIp = WiFi.localIP();
+        link.gateway = WiFi.gatewayIP();
+        link.subnet = WiFi.subnetMask();
+        link.dns = WiFi.dnsIP();
+        resume->saveLink(link);
+    }
+
+    // Additional communication-specific methods
+    bool sendData(const String& server, uint16_t port, const String& data) {
+        if (!isConnected()) {
+            setErrorMessage("WiFi not connected.");
+            return false;
+        }
+
+        WiFiClient client;
+        if (!client.connect(server.c_str(), port)) {
+            setErrorMessage("Failed to connect to server.");
+            return false;
+        }
+
+        client.print(data);
+        client.stop();
+        return true;
+    }
+
+    String receiveData(const String& server, uint16_t port) {
+        if (!isConnected()) {
+            setErrorMessage("WiFi not connected.");
+            return "";
+        }
+
+        WiFiClient client;
+        if (!client.connect(server.c_str(), port)) {
+            setErrorMessage("Failed to connect to server.");
+            return "";
+        }
+
+        String response = "";
+        while (client.available()) {
+            response += client.readString();
+        }
+
+        client.stop();
+        return response;
+    }
+
+private:
+    FastResume* resume = nullptr; // Cached link parameters, or nullptr to always connect the full way
+    bool fastAttempt = false;     // The attempt in progress uses the cached link
+};
+
+#endif // WIFICOMMUNICATION_H
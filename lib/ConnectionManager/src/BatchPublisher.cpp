@@ -0,0 +1,237 @@
+#include "BatchPublisher.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Bounded output cursor; a write that does not fit marks the writer as failed
+struct PayloadWriter {
+    uint8_t* out;
+    size_t capacity;
+    size_t pos;
+    bool ok;
+
+    void put(uint8_t byte) {
+        if (pos >= capacity) {
+            ok = false;
+            return;
+        }
+        out[pos++] = byte;
+    }
+
+    void put(const void* data, size_t size) {
+        if (capacity - pos < size) {
+            ok = false;
+            return;
+        }
+        std::memcpy(out + pos, data, size);
+        pos += size;
+    }
+
+    void text(const char* value) {
+        put(value, std::strlen(value));
+    }
+};
+
+void jsonString(PayloadWriter& writer, const char* value) {
+    writer.put('"');
+    for (const char* c = value; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            writer.put('\\');
+        }
+        writer.put(static_cast<uint8_t>(*c));
+    }
+    writer.put('"');
+}
+
+// Puts snprintf output; an encoding error or a cut number fails the writer instead of reading
+// past the end of the text
+void putFormatted(PayloadWriter& writer, const char* text, int length, size_t size) {
+    if (length < 0 || static_cast<size_t>(length) >= size) {
+        writer.ok = false;
+        return;
+    }
+    writer.put(text, static_cast<size_t>(length));
+}
+
+void jsonNumber(PayloadWriter& writer, const char* format, double value) {
+    char number[48]; // -FLT_MAX with two decimals is 43 characters
+    int length = snprintf(number, sizeof(number), format, value);
+    putFormatted(writer, number, length, sizeof(number));
+}
+
+void jsonInteger(PayloadWriter& writer, long long value) {
+    char number[24];
+    int length = snprintf(number, sizeof(number), "%lld", value);
+    putFormatted(writer, number, length, sizeof(number));
+}
+
+// CBOR head: major type in the top 3 bits, argument in the shortest form
+void cborHead(PayloadWriter& writer, uint8_t major, uint64_t value) {
+    major <<= 5;
+    if (value < 24) {
+        writer.put(static_cast<uint8_t>(major | value));
+        return;
+    }
+    int bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+    writer.put(static_cast<uint8_t>(major | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27)));
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        writer.put(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void cborInteger(PayloadWriter& writer, int64_t value) {
+    if (value >= 0) {
+        cborHead(writer, 0, static_cast<uint64_t>(value));
+    } else {
+        cborHead(writer, 1, static_cast<uint64_t>(-(value + 1)));
+    }
+}
+
+void cborString(PayloadWriter& writer, const char* value) {
+    size_t length = std::strlen(value);
+    cborHead(writer, 3, length);
+    writer.put(value, length);
+}
+
+void cborFloat(PayloadWriter& writer, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writer.put(0xFA); // Single precision float
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        writer.put(static_cast<uint8_t>(bits >> shift));
+    }
+}
+
+const uint8_t cborBreak = 0xFF;
+const uint8_t cborIndefiniteArray = 0x9F;
+
+} // namespace
+
+bool BatchPublisher::Result::isDelivered(const char* topic) const {
+    for (size_t i = 0; i < topicCount; ++i) {
+        if (std::strcmp(topics[i], topic) == 0) {
+            return delivered[i];
+        }
+    }
+    return false;
+}
+
+BatchPublisher::BatchPublisher(const char* device, Format format)
+    : device(device), format(format), topics{}, topicCount(0), readings{}, readingCount(0) {}
+
+bool BatchPublisher::add(const char* topic, const char* sensor, const char* field, float value, uint64_t timestampMs) {
+    if (readingCount >= BATCH_PUBLISHER_MAX_READINGS || std::isnan(value) || std::isinf(value)) {
+        return false;
+    }
+
+    size_t index = 0;
+    while (index < topicCount && std::strcmp(topics[index], topic) != 0) {
+        ++index;
+    }
+    if (index == topicCount) {
+        if (topicCount >= BATCH_PUBLISHER_MAX_TOPICS) {
+            return false;
+        }
+        topics[topicCount++] = topic;
+    }
+
+    readings[readingCount++] = {static_cast<uint8_t>(index), sensor, field, value, timestampMs};
+    return true;
+}
+
+size_t BatchPublisher::encode(size_t topicIndex, uint8_t* out, size_t capacity, size_t& position) const {
+    while (position < readingCount && readings[position].topic != topicIndex) {
+        ++position;
+    }
+    if (position >= readingCount) {
+        return 0;
+    }
+
+    bool json = format == Format::Json;
+    size_t footerSize = json ? 2 : 1; // "]}" or the CBOR break
+    if (capacity <= footerSize) {
+        position = readingCount;
+        return 0;
+    }
+
+    uint64_t base = readings[position].timestampMs;
+    PayloadWriter writer{out, capacity - footerSize, 0, true};
+    if (json) {
+        writer.text("{\"d\":");
+        jsonString(writer, device);
+        writer.text(",\"t\":");
+        jsonInteger(writer, static_cast<long long>(base));
+        writer.text(",\"r\":[");
+    } else {
+        cborHead(writer, 5, 3); // Map of three pairs
+        cborString(writer, "d");
+        cborString(writer, device);
+        cborString(writer, "t");
+        cborHead(writer, 0, base);
+        cborString(writer, "r");
+        writer.put(cborIndefiniteArray);
+    }
+    if (!writer.ok) {
+        position = readingCount; // Even the header does not fit
+        return 0;
+    }
+
+    size_t encoded = 0;
+    for (; position < readingCount; ++position) {
+        const Reading& reading = readings[position];
+        if (reading.topic != topicIndex) {
+            continue;
+        }
+
+        size_t mark = writer.pos;
+        int64_t offsetMs = static_cast<int64_t>(reading.timestampMs - base);
+        if (json) {
+            if (encoded > 0) {
+                writer.put(',');
+            }
+            writer.put('[');
+            jsonString(writer, reading.sensor);
+            writer.put(',');
+            jsonString(writer, reading.field);
+            writer.put(',');
+            jsonNumber(writer, "%.2f", reading.value);
+            writer.put(',');
+            jsonInteger(writer, static_cast<long long>(offsetMs));
+            writer.put(']');
+        } else {
+            cborHead(writer, 4, 4); // Array of four items
+            cborString(writer, reading.sensor);
+            cborString(writer, reading.field);
+            cborFloat(writer, reading.value);
+            cborInteger(writer, offsetMs);
+        }
+
+        if (!writer.ok) {
+            writer.pos = mark;
+            writer.ok = true;
+            if (encoded == 0) {
+                continue; // This reading alone does not fit; skip it rather than stall
+            }
+            break; // The rest goes in the next payload
+        }
+        encoded++;
+    }
+
+    if (encoded == 0) {
+        return 0;
+    }
+    writer.capacity += footerSize;
+    if (json) {
+        writer.text("]}");
+    } else {
+        writer.put(cborBreak);
+    }
+    return writer.pos;
+}
+
+void BatchPublisher::clear() {
+    topicCount = 0;
+    readingCount = 0;
+}
@@ -0,0 +1,125 @@
+#include "ConnectionManager.h"
+#include <Hal.h>
+
+ConnectionManager::Config ConnectionManager::defaultConfig() {
+    return Config{10000, 500, 30000, Hal::millis};
+}
+
+ConnectionManager::ConnectionManager(BaseConnection& link, BaseConnection& broker, Config config)
+    : link(link), broker(broker), config(config), state(State::Idle), stateSinceMs(0), startedMs(0),
+      retryDelayMs(0), backoffMs(config.initialBackoffMs), attempts(0), connectTimeMs(0) {
+    if (this->config.clock == nullptr) {
+        this->config.clock = Hal::millis;
+    }
+}
+
+void ConnectionManager::begin() {
+    if (state != State::Idle) {
+        return;
+    }
+    startedMs = config.clock();
+    attempts = 0;
+    backoffMs = config.initialBackoffMs;
+    if (link.isConnected()) {
+        enter(State::BrokerConnecting); // Link survived, e.g. a light sleep
+    } else {
+        startLink();
+    }
+}
+
+ConnectionManager::State ConnectionManager::update() {
+    uint32_t elapsed = config.clock() - stateSinceMs;
+
+    switch (state) {
+        case State::Idle:
+            break;
+
+        case State::LinkConnecting:
+            if (link.isConnected()) {
+                enter(State::BrokerConnecting);
+                break; // The broker attempt happens on the next update, keeping each call short
+            }
+            if (elapsed >= linkTimeoutMs()) {
+                link.stop();
+                scheduleRetry(State::LinkBackoff);
+            }
+            break;
+
+        case State::LinkBackoff:
+            if (elapsed >= retryDelayMs) {
+                startLink();
+            }
+            break;
+
+        case State::BrokerConnecting:
+            if (!link.isConnected()) {
+                startLink();
+                break;
+            }
+            attempts++;
+            if (broker.begin()) {
+                backoffMs = config.initialBackoffMs;
+                connectTimeMs = config.clock() - startedMs;
+                enter(State::Connected);
+            } else {
+                scheduleRetry(State::BrokerBackoff);
+            }
+            break;
+
+        case State::BrokerBackoff:
+            if (!link.isConnected()) {
+                startLink();
+            } else if (elapsed >= retryDelayMs) {
+                enter(State::BrokerConnecting);
+            }
+            break;
+
+        case State::Connected:
+            if (!link.isConnected()) {
+                broker.stop();
+                startedMs = config.clock();
+                startLink();
+            } else if (!broker.isConnected()) {
+                startedMs = config.clock();
+                enter(State::BrokerConnecting);
+            } else {
+                broker.loop();
+            }
+            break;
+    }
+    return state;
+}
+
+void ConnectionManager::stop() {
+    if (state == State::Idle) {
+        return;
+    }
+    broker.stop();
+    link.stop();
+    enter(State::Idle);
+}
+
+void ConnectionManager::enter(State next) {
+    state = next;
+    stateSinceMs = config.clock();
+}
+
+void ConnectionManager::startLink() {
+    attempts++;
+    if (link.begin()) {
+        enter(State::LinkConnecting);
+    } else {
+        scheduleRetry(State::LinkBackoff);
+    }
+}
+
+uint32_t ConnectionManager::linkTimeoutMs() const {
+    uint32_t timeout = link.getAttemptTimeoutMs();
+    return timeout > 0 ? timeout : config.linkTimeoutMs;
+}
+
+void ConnectionManager::scheduleRetry(State backoff) {
+    retryDelayMs = backoffMs;
+    backoffMs = backoffMs >= config.maxBackoffMs / 2 ? config.maxBackoffMs : backoffMs * 2;
+    enter(backoff);
+}
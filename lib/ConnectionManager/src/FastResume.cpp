@@ -0,0 +1,71 @@
+#include "FastResume.h"
+#include <cstring>
+
+static_assert(sizeof(FastResume::State) == 40, "FastResume::State must not contain padding");
+
+FastResume::FastResume(State& state) : state(state) {}
+
+bool FastResume::isValid() const {
+    return state.magic == stateMagic && state.checksum == checksumOf(state);
+}
+
+void FastResume::saveLink(const Link& link) {
+    prepare();
+    state.link = link;
+    set(linkFlag);
+}
+
+void FastResume::saveBroker(uint32_t ip) {
+    prepare();
+    state.brokerIp = ip;
+    set(brokerFlag);
+}
+
+void FastResume::forgetLink() {
+    unset(linkFlag);
+}
+
+void FastResume::forgetBroker() {
+    unset(brokerFlag);
+}
+
+void FastResume::forgetNetwork() {
+    unset(linkFlag | brokerFlag);
+}
+
+void FastResume::clear() {
+    std::memset(&state, 0, sizeof(state));
+}
+
+void FastResume::prepare() {
+    if (!isValid()) {
+        clear(); // Start over from an empty cache
+        state.magic = stateMagic;
+    }
+}
+
+void FastResume::set(uint8_t flag) {
+    state.flags |= flag;
+    seal();
+}
+
+void FastResume::unset(uint8_t flag) {
+    if (isValid()) {
+        state.flags &= ~flag;
+        seal();
+    }
+}
+
+void FastResume::seal() {
+    state.checksum = checksumOf(state);
+}
+
+// FNV-1a over the fields before the checksum
+uint32_t FastResume::checksumOf(const State& state) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(State, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
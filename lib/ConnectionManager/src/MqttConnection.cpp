@@ -0,0 +1,43 @@
+// Needs PubSubClient, so it is only built for the device
+#ifdef ARDUINO
+
+#include "MqttConnection.h"
+#include <Metrics.h>
+#include <WiFi.h>
+
+// Makes one connection attempt to the broker
+bool MqttConnection::begin() {
+    METRICS_TIME(MqttConnect);
+    METRICS_COUNT(MqttAttempts);
+    if (resume != nullptr) {
+        cachedAttempt = resume->hasBroker();
+        if (cachedAttempt) {
+            client.setServer(IPAddress(resume->getBrokerIp()), brokerPort); // No DNS lookup
+        } else {
+            client.setServer(brokerHost, brokerPort);
+        }
+    }
+    bool connected = username.empty()
+        ? client.connect(clientId.c_str())
+        : client.connect(clientId.c_str(), username.c_str(), password.c_str());
+    if (!connected) {
+        METRICS_COUNT(MqttFailures);
+        if (cachedAttempt) {
+            resume->forgetBroker(); // The broker may have moved; the next attempt looks it up again
+        }
+        setErrorMessage("Failed to connect to MQTT, state " + std::to_string(client.state()));
+    }
+    return connected;
+}
+
+void MqttConnection::rememberBroker() {
+    if (resume == nullptr || cachedAttempt || !isConnected()) {
+        return;
+    }
+    IPAddress ip;
+    if (WiFi.hostByName(brokerHost, ip) == 1) { // Answered from lwIP's cache of the lookup connect() made
+        resume->saveBroker(ip);
+    }
+}
+
+#endif // ARDUINO
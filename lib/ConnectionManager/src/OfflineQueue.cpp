@@ -0,0 +1,168 @@
+#include "OfflineQueue.h"
+
+namespace {
+
+const size_t headRecordsPerFile = 64; // Records before switching to the other head file
+
+} // namespace
+
+OfflineQueue::OfflineQueue(const std::string& pathPrefix, FileFactory factory)
+    : pathPrefix(pathPrefix), factory(factory), stats{}, activeHead(0), headSequence(0), headSegment(0), headOffset(0), tailSegment(0) {}
+
+bool OfflineQueue::begin() {
+    // The newest committed record in either head file is the current head
+    HeadRecord head{0, 0, 0};
+    bool restored = false;
+    for (uint8_t index = 0; index < 2; ++index) {
+        headFiles[index] = factory(pathPrefix + ".head" + std::to_string(index));
+        headJournals[index].reset(new AppendJournal(*headFiles[index]));
+        headJournals[index]->replay([&](const uint8_t* payload, size_t size) {
+            HeadRecord record;
+            if (size != sizeof(record)) {
+                return;
+            }
+            std::memcpy(&record, payload, sizeof(record));
+            if (!restored || record.sequence > head.sequence) {
+                head = record;
+                activeHead = index;
+                restored = true;
+            }
+        });
+    }
+    headSequence = head.sequence;
+    headSegment = head.segment;
+    headOffset = head.offset;
+    if (!headJournals[activeHead]->begin()) {
+        return false;
+    }
+
+    if (!restored) {
+        // No head yet: the queue starts at the first segment on flash, if any
+        for (uint32_t segment = 0; segment < OFFLINE_QUEUE_MAX_SEGMENTS; ++segment) {
+            if (factory(segmentPath(segment))->exists()) {
+                headSegment = segment;
+                break;
+            }
+        }
+    }
+
+    tailSegment = headSegment;
+    while (factory(segmentPath(tailSegment + 1))->exists()) {
+        ++tailSegment;
+    }
+    return openTail(tailSegment);
+}
+
+size_t OfflineQueue::maxPayloadSize(const char* topic) {
+    size_t topicLength = std::strlen(topic);
+    return topicLength + 1 < OFFLINE_QUEUE_ENTRY_SIZE ? OFFLINE_QUEUE_ENTRY_SIZE - topicLength - 1 : 0;
+}
+
+bool OfflineQueue::enqueue(const char* topic, const uint8_t* payload, size_t size) {
+    size_t topicLength = std::strlen(topic);
+    size_t entrySize = topicLength + 1 + size;
+    if (!tailJournal || entrySize > OFFLINE_QUEUE_ENTRY_SIZE || !tailJournal->flush()) {
+        stats.rejected++;
+        return false;
+    }
+
+    // A split entry takes one marker byte per frame and stays within one segment
+    bool split = entrySize > AppendJournal::maxPayload;
+    size_t partSize = AppendJournal::maxPayload - 1;
+    size_t frames = split ? (entrySize + partSize - 1) / partSize : 1;
+    size_t storedSize = entrySize + frames * AppendJournal::frameOverhead + (split ? frames : 0);
+    if (tailFile->size() + storedSize > OFFLINE_QUEUE_SEGMENT_SIZE) {
+        if (!openTail(tailSegment + 1)) {
+            stats.rejected++;
+            return false;
+        }
+        if (getSegmentCount() > OFFLINE_QUEUE_MAX_SEGMENTS) {
+            stats.droppedSegments++;
+            dropHeadSegment(); // Full: the oldest entries make room
+        }
+    }
+
+    bool stored;
+    if (split) {
+        stored = appendParts(topic, topicLength, payload, size);
+    } else {
+        uint8_t entry[AppendJournal::maxPayload];
+        std::memcpy(entry, topic, topicLength + 1);
+        std::memcpy(entry + topicLength + 1, payload, size);
+        stored = tailJournal->append(entry, entrySize) && tailJournal->flush();
+    }
+    if (!stored) {
+        // A rejected entry must not reach the segment with the next flush; parts of a split
+        // entry already written have no last part, so drain() skips them
+        tailJournal->discard();
+        stats.rejected++;
+        return false;
+    }
+    stats.enqueued++;
+    return true;
+}
+
+// Writes an entry as one frame per part, each a marker byte followed by the next slice of
+// the topic, its terminator and the payload
+bool OfflineQueue::appendParts(const char* topic, size_t topicLength, const uint8_t* payload, size_t size) {
+    size_t entrySize = topicLength + 1 + size;
+    uint8_t part[AppendJournal::maxPayload];
+    for (size_t position = 0; position < entrySize;) {
+        size_t length = entrySize - position < sizeof(part) - 1 ? entrySize - position : sizeof(part) - 1;
+        part[0] = position == 0 ? partFirst : position + length == entrySize ? partLast : partMiddle;
+        for (size_t i = 0; i < length; ++i, ++position) {
+            part[1 + i] = position <= topicLength ? static_cast<uint8_t>(topic[position]) : payload[position - topicLength - 1];
+        }
+        if (!tailJournal->append(part, length + 1) || !tailJournal->flush()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OfflineQueue::enqueue(const char* topic, const char* message) {
+    return enqueue(topic, reinterpret_cast<const uint8_t*>(message), std::strlen(message));
+}
+
+bool OfflineQueue::isEmpty() {
+    return headSegment == tailSegment && (!tailFile || headOffset >= tailFile->size());
+}
+
+std::string OfflineQueue::segmentPath(uint32_t segment) const {
+    return pathPrefix + "." + std::to_string(segment);
+}
+
+bool OfflineQueue::openTail(uint32_t segment) {
+    tailJournal.reset(); // Flushes and closes the previous tail before its file goes away
+    tailFile = factory(segmentPath(segment));
+    tailJournal.reset(new AppendJournal(*tailFile));
+    tailSegment = segment;
+    return tailJournal->begin();
+}
+
+bool OfflineQueue::saveHead() {
+    const size_t recordSize = sizeof(HeadRecord) + AppendJournal::frameOverhead;
+    if (headFiles[activeHead]->size() >= headRecordsPerFile * recordSize) {
+        // Start the other file over; the full one keeps the newest record until the switch is committed
+        uint8_t next = activeHead ^ 1;
+        headJournals[next]->close();
+        headFiles[next]->remove();
+        if (!headJournals[next]->begin()) {
+            return false;
+        }
+        headJournals[activeHead]->close();
+        activeHead = next;
+    }
+
+    HeadRecord head{++headSequence, headSegment, headOffset};
+    stats.headSaves++;
+    AppendJournal& journal = *headJournals[activeHead];
+    return journal.append(reinterpret_cast<const uint8_t*>(&head), sizeof(head)) && journal.flush();
+}
+
+void OfflineQueue::dropHeadSegment() {
+    factory(segmentPath(headSegment))->remove();
+    headSegment++;
+    headOffset = 0;
+    saveHead();
+}
@@ -0,0 +1,254 @@
+#ifndef APPENDJOURNAL_H
+#define APPENDJOURNAL_H
+
+#include "BaseAppendFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef JOURNAL_BUFFER_SIZE
+#define JOURNAL_BUFFER_SIZE 256 /**< RAM buffer per journal, one flash program page. */
+#endif
+
+/**
+ * @brief Write-coalescing append journal on top of an open BaseAppendFile.
+ * 
+ * Appends are collected in a page-sized RAM buffer and written as one frame when the buffer
+ * fills, when the oldest buffered byte is older than the configured delay, or on flush()
+ * (call it before deep sleep). The file handle stays open, so a flush costs one append and
+ * one sync instead of an open/metadata update/close per write.
+ * 
+ * Each frame is laid out as:
+ * `0xA5 | payload length (u16 LE) | payload | CRC-32 of payload (u32 LE) | 0x5A commit marker`.
+ * A frame only counts once its commit marker and CRC check out, so a frame torn by a reset
+ * is skipped on replay and appends made after the reset are still found.
+ */
+class AppendJournal {
+public:
+    static constexpr uint8_t frameMagic = 0xA5;
+    static constexpr uint8_t commitMarker = 0x5A;
+    static constexpr size_t frameOverhead = 8;
+    static constexpr size_t maxPayload = JOURNAL_BUFFER_SIZE - frameOverhead;
+
+    class Reader;
+
+    /**
+     * @brief Flush thresholds.
+     */
+    struct Config {
+        size_t flushThreshold;    /**< Buffered payload bytes that trigger a flush. At most maxPayload. */
+        uint32_t maxDelayMs;      /**< Oldest buffered byte age that triggers a flush; 0 disables. */
+        uint32_t (*clock)();      /**< Millisecond clock, defaults to Hal::millis(). */
+    };
+
+    /**
+     * @brief Journal activity counters.
+     */
+    struct Stats {
+        uint32_t appends;      /**< append() calls. */
+        uint32_t frames;       /**< Frames written. */
+        uint32_t sizeFlushes;  /**< Flushes caused by the size threshold. */
+        uint32_t timeFlushes;  /**< Flushes caused by the delay threshold. */
+        uint32_t tornFrames;   /**< Invalid frames skipped while reading, counted on every walk that meets them. */
+        uint32_t syncFailures; /**< Syncs that failed after their frame was written. */
+    };
+
+    /**
+     * @brief Returns the default thresholds: flush a full page or after 5 seconds.
+     */
+    static Config defaultConfig();
+
+    /**
+     * @brief Constructs a journal over a file.
+     * @param file The file to append frames to. Must outlive the journal.
+     * @param config Flush thresholds.
+     */
+    explicit AppendJournal(BaseAppendFile& file, Config config = defaultConfig());
+    ~AppendJournal();
+
+    /**
+     * @brief Opens the file handle.
+     * @return True if the file is open for appending.
+     */
+    bool begin();
+
+    /**
+     * @brief Buffers data, flushing first if it would overflow the buffer.
+     * 
+     * Data larger than one frame is split across several frames.
+     * @return False if a required flush failed. The part of the data not yet in a written
+     *         frame is then dropped from the buffer again and the append is not counted, so
+     *         data that fits one frame was not stored at all and may be appended again.
+     */
+    bool append(const uint8_t* data, size_t size);
+    bool append(const std::string& data);
+
+    /**
+     * @brief Flushes if the buffered data is older than the delay threshold.
+     * 
+     * Call this from the main loop or a timer.
+     * @return False if a required flush failed.
+     */
+    bool poll();
+
+    /**
+     * @brief Writes the buffered data as one committed frame and syncs the file.
+     * 
+     * A frame that was written but whose sync failed is not written again, since that would
+     * store it twice; isSyncPending() reports it and the next flush() retries the sync.
+     * @return True if the buffer was empty or its frame was written.
+     */
+    bool flush();
+
+    /**
+     * @brief Drops the buffered data that has not been flushed yet.
+     * 
+     * For a caller that reports its data as not stored after a failed append() or flush()
+     * and must keep a later flush from writing it after all.
+     */
+    void discard() { used = 0; }
+
+    /**
+     * @brief Flushes and closes the file handle.
+     */
+    void close();
+
+    /**
+     * @brief Calls a function with the payload of each committed frame, oldest first.
+     * 
+     * Buffered data that has not been flushed is not included.
+     * 
+     * @param callback Called as callback(const uint8_t* payload, size_t size).
+     * @return The number of committed frames.
+     */
+    template <typename Callback>
+    size_t replay(Callback callback);
+
+    /**
+     * @brief Walks the committed frames starting at a file offset.
+     * 
+     * @param offset File offset to start at, e.g. a nextOffset from an earlier call.
+     * @param callback Called as bool callback(const uint8_t* payload, size_t size, size_t nextOffset),
+     *        where nextOffset is the offset just past the frame. Return false to stop.
+     * @return The number of committed frames passed to the callback.
+     */
+    template <typename Callback>
+    size_t readFrames(size_t offset, Callback callback);
+
+    /**
+     * @brief Checks whether a written frame still waits for a successful sync.
+     */
+    bool isSyncPending() const { return syncPending; }
+
+    /**
+     * @brief Returns the payload bytes waiting in the RAM buffer.
+     */
+    size_t getBufferedBytes() const { return used; }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    friend class Reader;
+
+    bool writeFrame(size_t size);
+    static uint32_t crc32(const uint8_t* data, size_t size);
+
+    BaseAppendFile& file;                   // Destination file
+    Config config;                          // Flush thresholds
+    Stats stats;                            // Activity counters
+    uint8_t buffer[JOURNAL_BUFFER_SIZE];    // Frame under construction; payload starts at offset 3
+    size_t used;                            // Buffered payload bytes
+    uint32_t oldestAppendMs;                // Clock value of the first byte in the buffer
+    bool syncPending;                       // A frame was written but its sync failed
+};
+
+/**
+ * @brief Reads a journal's data as one byte stream: the payloads of the committed frames,
+ * oldest first, then the bytes still in the RAM buffer.
+ * 
+ * Frames are read one at a time into a frame-sized buffer, so the file is never loaded
+ * whole. It has the `size_t read(uint8_t* buffer, size_t size)` method ChunkedReader and
+ * LineReader expect. Do not append to the journal while a reader is in use.
+ * 
+ * Example:
+ * @code
+ * AppendJournal::Reader source(journal);
+ * LineReader<AppendJournal::Reader> lines(source);
+ * @endcode
+ */
+class AppendJournal::Reader {
+public:
+    explicit Reader(AppendJournal& journal);
+
+    /**
+     * @brief Copies up to size bytes, fewer only at the end of the data.
+     * @return The number of bytes copied, 0 at the end.
+     */
+    size_t read(uint8_t* out, size_t size);
+
+    /**
+     * @brief Moves past up to size bytes without copying them.
+     * @return The number of bytes skipped.
+     */
+    size_t skip(size_t size);
+
+private:
+    bool nextChunk(); // Moves on to the next frame, or to the RAM buffer after the last one
+
+    AppendJournal& journal;
+    uint8_t payload[maxPayload]; // Payload of the current frame
+    const uint8_t* chunk;        // Unread bytes of the current frame or of the RAM buffer
+    size_t remaining;            // Bytes left at chunk
+    size_t nextOffset;           // File offset of the next frame
+    bool inFrames;               // Still reading frames from the file
+    bool done;                   // The RAM buffer has been handed out as well
+};
+
+template <typename Callback>
+size_t AppendJournal::replay(Callback callback) {
+    return readFrames(0, [&callback](const uint8_t* payload, size_t size, size_t) {
+        callback(payload, size);
+        return true;
+    });
+}
+
+template <typename Callback>
+size_t AppendJournal::readFrames(size_t offset, Callback callback) {
+    uint8_t frame[JOURNAL_BUFFER_SIZE];
+    size_t fileSize = file.size();
+    size_t committed = 0;
+
+    while (offset + frameOverhead <= fileSize) {
+        // The header first, then only the payload and trailer it announces
+        bool valid = file.read(offset, frame, 3) == 3 && frame[0] == frameMagic;
+        size_t payloadSize = valid ? (frame[1] | (frame[2] << 8)) : 0;
+        valid = valid && payloadSize <= maxPayload && offset + payloadSize + frameOverhead <= fileSize;
+        valid = valid && file.read(offset + 3, frame + 3, payloadSize + frameOverhead - 3) == payloadSize + frameOverhead - 3;
+        if (valid) {
+            const uint8_t* trailer = frame + 3 + payloadSize;
+            uint32_t storedCrc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<uint32_t>(trailer[3]) << 24);
+            valid = trailer[4] == commitMarker && storedCrc == crc32(frame + 3, payloadSize);
+        }
+
+        if (!valid) {
+            // Torn or corrupt frame: resynchronise on the next magic byte
+            stats.tornFrames++;
+            size_t length = file.read(offset + 1, frame, sizeof(frame));
+            size_t skip = 0;
+            while (skip < length && frame[skip] != frameMagic) {
+                ++skip;
+            }
+            offset += 1 + skip;
+            continue;
+        }
+
+        offset += payloadSize + frameOverhead;
+        committed++;
+        if (!callback(static_cast<const uint8_t*>(frame + 3), payloadSize, offset)) {
+            break;
+        }
+    }
+    return committed;
+}
+
+#endif // APPENDJOURNAL_H
@@ -0,0 +1,49 @@
+#ifndef BASEAPPENDFILE_H
+#define BASEAPPENDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief An append-only file that stays open between writes.
+ * 
+ * Implementations wrap a LittleFS file on the device or a regular file on the host, so the
+ * code built on top (e.g. AppendJournal) can be measured without hardware.
+ */
+class BaseAppendFile {
+public:
+    /**
+     * @brief Flash activity counters, used to compare write strategies.
+     */
+    struct Stats {
+        uint32_t opens;        /**< Times the file was opened for appending. */
+        uint32_t readOpens;    /**< Times a read handle was opened. */
+        uint32_t syncs;        /**< Times written data was committed to storage. */
+        uint32_t bytesWritten; /**< Bytes appended. */
+        uint32_t pageWrites;   /**< Flash pages programmed, as estimated by the implementation. */
+    };
+
+    explicit BaseAppendFile(const std::string& path) : path(path), stats{} {}
+    virtual ~BaseAppendFile() = default;
+
+    virtual bool open() = 0;                                   // Open for appending, creating the file if needed
+    virtual bool isOpen() const = 0;                           // Check if the handle is open
+    virtual size_t append(const uint8_t* data, size_t size) = 0; // Append bytes to the end of the file
+    virtual bool sync() = 0;                                   // Commit appended bytes to storage
+    virtual void close() = 0;                                  // Sync and release the handle
+    virtual size_t size() = 0;                                 // Current file size in bytes
+    virtual size_t read(size_t offset, uint8_t* out, size_t size) = 0; // Read committed bytes at an offset; the read handle stays open until the next append or close
+    virtual bool exists() = 0;                                 // Check if the file exists
+    virtual bool remove() = 0;                                 // Close and delete the file
+
+    const std::string& getPath() const { return path; }
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats{}; }
+
+protected:
+    std::string path; // File path
+    Stats stats;      // Flash activity counters
+};
+
+#endif // BASEAPPENDFILE_H
@@ -0,0 +1,81 @@
+#ifndef BINARYLOGFILE_H
+#define BINARYLOGFILE_H
+
+#include "BinaryLogFormat.h"
+#include "LogRecord.h"
+#include <string>
+
+#ifndef BINARY_LOG_BUFFER_SIZE
+#define BINARY_LOG_BUFFER_SIZE 256 /**< Encoded bytes buffered in RAM before a flush. */
+#endif
+
+/**
+ * @brief Appends binary log and sensor records to a LittleFS file.
+ * 
+ * Records are encoded into a RAM buffer and written with a single open/append/close when
+ * the buffer fills up or flush() is called. The encoder state is owned by the caller so it
+ * can be kept in RTC memory across deep sleep.
+ * 
+ * The caller's state only advances when a flush succeeds, so it always describes the records
+ * on flash. If the buffer is lost (a failed flush followed by a reset, a watchdog or brownout
+ * reset, a deep sleep without flush()), the next record is still a delta against a baseline
+ * the file has.
+ */
+class BinaryLogFile {
+public:
+    /**
+     * @brief Constructs a binary log file writer.
+     * @param path The file path to append to.
+     * @param state The encoder state, typically declared RTC_DATA_ATTR.
+     */
+    BinaryLogFile(const std::string& path, BinaryLogEncoder::State& state);
+
+    /**
+     * @brief Writes the file header if the file is missing or empty.
+     * 
+     * A new file resets the encoder state so the first record starts with a sync record.
+     * @return True if the file is ready for appending.
+     */
+    bool begin();
+
+    /**
+     * @brief Buffers a log message.
+     * @return False if the record could not be encoded or the buffer could not be flushed.
+     */
+    bool appendLog(uint64_t timestampMs, LogLevel level, uint32_t sourceId, const char* message, size_t length);
+
+    /**
+     * @brief Buffers a structured log record, rendering its text once.
+     */
+    bool appendRecord(uint64_t timestampMs, const LogRecord& record, uint32_t sourceId = 0);
+
+    /**
+     * @brief Buffers a sensor reading.
+     * @return False if the record could not be encoded or the buffer could not be flushed.
+     */
+    bool appendReading(uint64_t timestampMs, uint8_t sensorId, const float* values, uint8_t count);
+
+    /**
+     * @brief Writes the buffered records to the file and commits the encoder state.
+     * 
+     * On failure the records stay buffered for the next flush, and the caller's state keeps
+     * the baselines of the records already in the file.
+     * @return True if the buffer was empty or was written successfully.
+     */
+    bool flush();
+
+    /**
+     * @brief Returns the number of encoded bytes waiting to be written.
+     */
+    size_t getBufferedBytes() const { return used; }
+
+private:
+    std::string path;                       /**< The file path to append to. */
+    BinaryLogEncoder::State& committed;     /**< The caller's state: baselines of the records in the file. */
+    BinaryLogEncoder::State pending;        /**< Baselines including the buffered records. */
+    BinaryLogEncoder encoder;               /**< Encoder bound to pending. */
+    uint8_t buffer[BINARY_LOG_BUFFER_SIZE]; /**< Encoded records not yet written. */
+    size_t used;                            /**< Bytes of buffer in use. */
+};
+
+#endif // BINARYLOGFILE_H
@@ -0,0 +1,205 @@
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+#include "LogLevel.h"
+#include <cstddef>
+#include <cstdint>
+
+#ifndef BINARY_LOG_MAX_SENSORS
+#define BINARY_LOG_MAX_SENSORS 8 /**< Sensor ids that get delta-encoded readings. */
+#endif
+
+#ifndef BINARY_LOG_MAX_CHANNELS
+#define BINARY_LOG_MAX_CHANNELS 4 /**< Values per reading record (e.g. temperature, humidity). */
+#endif
+
+#ifndef BINARY_LOG_SYNC_INTERVAL
+#define BINARY_LOG_SYNC_INTERVAL 64 /**< Records between sync records, bounding the damage of a lost record. */
+#endif
+
+/**
+ * @brief Compact binary record format for the on-flash log and sensor data files.
+ *
+ * A file starts with a 5 byte header ("ESPB" and a version byte) followed by records. Every
+ * record starts with one tag byte:
+ * - `0x01` Sync: varint absolute timestamp (ms). Resets all delta baselines.
+ * - `0x1L` Log, level L: varint timestamp delta, varint source id, varint length, message bytes.
+ * - `0x2C` Reading with C values: varint sensor id, varint timestamp delta, then C zigzag varints,
+ *   each the change of the value (in hundredths) since the previous reading of that sensor.
+ *
+ * Timestamp deltas are relative to the previous record of any kind. A typical temperature and
+ * humidity sample takes 5-7 bytes, compared to ~40 bytes for the text line it replaces.
+ */
+class BinaryLogFormat {
+public:
+    static constexpr uint8_t headerSize = 5;
+    static constexpr uint8_t version = 1;
+
+    static constexpr uint8_t tagSync = 0x01;
+    static constexpr uint8_t tagLog = 0x10;
+    static constexpr uint8_t tagReading = 0x20;
+
+    /**
+     * @brief Writes the file header.
+     * @param out Destination buffer of at least headerSize bytes.
+     * @return The number of bytes written.
+     */
+    static size_t writeHeader(uint8_t* out);
+
+    /**
+     * @brief Checks that a buffer starts with a valid file header.
+     */
+    static bool checkHeader(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Encodes an unsigned LEB128 varint.
+     * @return The number of bytes written, or 0 if the buffer is too small.
+     */
+    static size_t writeVarint(uint8_t* out, size_t capacity, uint64_t value);
+
+    /**
+     * @brief Decodes an unsigned LEB128 varint.
+     * @return The number of bytes consumed, or 0 if the input is truncated or malformed.
+     */
+    static size_t readVarint(const uint8_t* data, size_t size, uint64_t& value);
+
+    static uint64_t zigzagEncode(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t zigzagDecode(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+};
+
+/**
+ * @brief Encodes records into the binary format.
+ *
+ * The delta baselines live in a caller-owned State, so they can be kept in RTC memory and
+ * carried across deep sleep. A State that is not synced makes the next record start with a
+ * sync record, which is always the case after a cold boot.
+ */
+class BinaryLogEncoder {
+public:
+    /**
+     * @brief Delta baselines shared by consecutive records of one file.
+     */
+    struct State {
+        uint64_t lastTimestamp;                                                /**< Timestamp of the previous record (ms). */
+        int32_t lastValues[BINARY_LOG_MAX_SENSORS][BINARY_LOG_MAX_CHANNELS];  /**< Previous reading per sensor, in hundredths. */
+        uint16_t recordsSinceSync;                                             /**< Records written since the last sync record. */
+        bool synced;                                                           /**< False until a sync record has been written. */
+    };
+
+    /**
+     * @brief Constructs an encoder over an existing state.
+     * @param state The delta baselines to use and update.
+     */
+    explicit BinaryLogEncoder(State& state) : state(state) {}
+
+    /**
+     * @brief Marks the state as unsynced so the next record starts with a sync record.
+     */
+    void reset();
+
+    /**
+     * @brief Encodes a log message.
+     *
+     * @param out Destination buffer.
+     * @param capacity Size of the destination buffer.
+     * @param timestampMs Timestamp of the message in milliseconds.
+     * @param level The severity level of the message.
+     * @param sourceId Caller-defined id of the component that logged the message.
+     * @param message The message text.
+     * @param length The length of the message text.
+     * @return The number of bytes written, or 0 if the buffer is too small.
+     */
+    size_t encodeLog(uint8_t* out, size_t capacity, uint64_t timestampMs, LogLevel level,
+                     uint32_t sourceId, const char* message, size_t length);
+
+    /**
+     * @brief Encodes one sensor reading.
+     *
+     * Values are stored with two decimals, the same precision as the text format.
+     *
+     * @param out Destination buffer.
+     * @param capacity Size of the destination buffer.
+     * @param timestampMs Timestamp of the reading in milliseconds.
+     * @param sensorId Id of the sensor, below BINARY_LOG_MAX_SENSORS.
+     * @param values The reading's values (e.g. temperature and humidity).
+     * @param count Number of values, 1 to BINARY_LOG_MAX_CHANNELS.
+     * @return The number of bytes written, or 0 if the buffer is too small or the input is invalid.
+     */
+    size_t encodeReading(uint8_t* out, size_t capacity, uint64_t timestampMs, uint8_t sensorId,
+                         const float* values, uint8_t count);
+
+private:
+    size_t beginRecord(uint8_t* out, size_t capacity, uint64_t timestampMs, uint64_t& delta);
+
+    State& state;
+};
+
+/**
+ * @brief A decoded record.
+ */
+struct BinaryLogEntry {
+    enum class Type {
+        Log,
+        Reading
+    };
+
+    Type type;
+    uint64_t timestampMs;                    /**< Absolute timestamp in milliseconds. */
+    LogLevel level;                          /**< Log records only. */
+    uint32_t sourceId;                       /**< Log records only. */
+    const char* message;                     /**< Log records only; points into the decoded buffer, not NUL-terminated. */
+    size_t messageLength;                    /**< Log records only. */
+    uint8_t sensorId;                        /**< Reading records only. */
+    uint8_t valueCount;                      /**< Reading records only. */
+    float values[BINARY_LOG_MAX_CHANNELS];   /**< Reading records only. */
+};
+
+/**
+ * @brief Walks the records of a binary log buffer.
+ */
+class BinaryLogDecoder {
+public:
+    /**
+     * @brief Constructs a decoder over a buffer that starts with the file header.
+     */
+    BinaryLogDecoder(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Checks whether the buffer started with a valid header.
+     */
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief Decodes the next record.
+     * @param entry Receives the record.
+     * @return False at the end of the buffer or on a malformed record.
+     */
+    bool next(BinaryLogEntry& entry);
+
+    /**
+     * @brief Checks whether decoding stopped on a malformed or truncated record.
+     */
+    bool hasError() const { return error; }
+
+    /**
+     * @brief Returns the offset of the next byte to decode.
+     */
+    size_t getOffset() const { return offset; }
+
+private:
+    bool readVarint(uint64_t& value);
+
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+    bool valid;
+    bool error;
+    BinaryLogEncoder::State state;
+};
+
+#endif // BINARYLOGFORMAT_H
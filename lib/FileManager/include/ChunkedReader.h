@@ -0,0 +1,169 @@
+#ifndef CHUNKEDREADER_H
+#define CHUNKEDREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#ifndef FILE_READ_CHUNK_SIZE
+#define FILE_READ_CHUNK_SIZE 512 /**< Bytes requested per read call; two LittleFS cache pages. */
+#endif
+
+/**
+ * @brief Bulk read helpers for anything with a `size_t read(uint8_t* buffer, size_t size)`
+ * method, such as an Arduino File.
+ *
+ * Reading a chunk at a time replaces the `file.read()` per byte loops, which cost one call
+ * into the filesystem and one possible string reallocation per character.
+ */
+namespace ChunkedReader {
+
+/**
+ * @brief Reads a source to its end and appends the bytes to a string.
+ *
+ * @param source The source to read from.
+ * @param out The string to append to.
+ * @param sizeHint Expected number of bytes (e.g. File::size()), reserved up front.
+ * @return The number of bytes appended.
+ */
+template <typename Source>
+size_t readAll(Source& source, std::string& out, size_t sizeHint = 0) {
+    size_t start = out.size();
+    if (sizeHint > 0) {
+        out.reserve(start + sizeHint);
+    }
+
+    uint8_t chunk[FILE_READ_CHUNK_SIZE];
+    size_t length;
+    while ((length = source.read(chunk, sizeof(chunk))) > 0) {
+        out.append(reinterpret_cast<const char*>(chunk), length);
+    }
+    return out.size() - start;
+}
+
+/**
+ * @brief A source over bytes already in memory.
+ */
+class BufferSource {
+public:
+    BufferSource(const void* data, size_t size)
+        : data(static_cast<const uint8_t*>(data)), remaining(size) {}
+
+    size_t read(uint8_t* buffer, size_t size) {
+        size_t length = size < remaining ? size : remaining;
+        std::memcpy(buffer, data, length);
+        data += length;
+        remaining -= length;
+        return length;
+    }
+
+private:
+    const uint8_t* data;
+    size_t remaining;
+};
+
+} // namespace ChunkedReader
+
+/**
+ * @brief Streams the lines of a source through a fixed buffer.
+ *
+ * Lines are returned as views into the internal buffer without the trailing "\n" (or
+ * "\r\n"), so walking a file never copies a line or touches the heap. A view is valid until
+ * the next call to next(). A line longer than the buffer is returned in buffer-sized pieces
+ * and counted by getSplitLines().
+ *
+ * Example:
+ * @code
+ * File file = LittleFS.open("/logs/info.txt", "r");
+ * LineReader<File> lines(file);
+ * std::string_view line;
+ * while (lines.next(line)) {
+ *     // ...
+ * }
+ * @endcode
+ *
+ * @tparam Source Type with a `size_t read(uint8_t* buffer, size_t size)` method.
+ * @tparam BufferSize Size of the line buffer, and the longest line returned whole.
+ */
+template <typename Source, size_t BufferSize = FILE_READ_CHUNK_SIZE>
+class LineReader {
+public:
+    explicit LineReader(Source& source)
+        : source(source), start(0), end(0), splitLines(0), finished(false) {}
+
+    /**
+     * @brief Reads the next line.
+     * @param line Receives a view of the line.
+     * @return False once the source is exhausted.
+     */
+    bool next(std::string_view& line) {
+        while (true) {
+            const char* begin = buffer + start;
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - start));
+            if (newline != nullptr) {
+                size_t length = static_cast<size_t>(newline - begin);
+                start += length + 1;
+                line = trim(begin, length);
+                return true;
+            }
+
+            if (finished) {
+                if (start == end) {
+                    return false;
+                }
+                line = trim(begin, end - start); // Last line without a newline
+                start = end;
+                return true;
+            }
+
+            if (start == 0 && end == BufferSize) {
+                // No newline in a full buffer: hand out what we have as one piece
+                splitLines++;
+                start = end;
+                line = std::string_view(buffer, BufferSize);
+                return true;
+            }
+
+            refill();
+        }
+    }
+
+    /**
+     * @brief Returns the number of lines that were too long for the buffer.
+     */
+    uint32_t getSplitLines() const { return splitLines; }
+
+private:
+    void refill() {
+        // Move the partial line to the front, then top the buffer up behind it
+        size_t pending = end - start;
+        if (start > 0) {
+            std::memmove(buffer, buffer + start, pending);
+            start = 0;
+            end = pending;
+        }
+        size_t length = source.read(reinterpret_cast<uint8_t*>(buffer + end), BufferSize - end);
+        if (length == 0) {
+            finished = true;
+        }
+        end += length;
+    }
+
+    static std::string_view trim(const char* text, size_t length) {
+        if (length > 0 && text[length - 1] == '\r') {
+            --length;
+        }
+        return std::string_view(text, length);
+    }
+
+    Source& source;            // Where lines are read from
+    char buffer[BufferSize];   // Lines being returned; start..end is unread
+    size_t start;              // First unread byte
+    size_t end;                // One past the last buffered byte
+    uint32_t splitLines;       // Lines longer than the buffer
+    bool finished;             // The source returned no more data
+};
+
+#endif // CHUNKEDREADER_H
@@ -1,8 +1,13 @@
 #ifndef FILESYSTEM_H
 #define FILESYSTEM_H
 
-#include <LittleFS.h>
+#include <HalFS.h>
+#include <map>
+#include <memory>
 #include <string>
+#include "AppendJournal.h"
+#include "ChunkedReader.h"
+#include "LittleFSAppendFile.h"
 
 class FileSystem {
 public:
@@ -16,21 +21,78 @@ public:
     // Read data from a file
     std::string read(const std::string& path);
 
+    // Read up to size bytes starting at offset into a caller-provided buffer, returns the bytes read.
+    // For a journaled path the offset counts data bytes, unflushed appends included
+    size_t read(const std::string& path, uint8_t* buffer, size_t size, size_t offset = 0);
+
+    // Call callback(std::string_view line) for each line of a file without copying the lines,
+    // returns the number of lines
+    template <typename Callback>
+    size_t readLines(const std::string& path, Callback callback);
+
     // Delete a file 
     bool remove(const std::string& path);
 
     // Check if a file exists
     bool exists(const std::string& path);
 
+    // Route appends to a path through a write-coalescing journal that keeps the file open.
+    // The file then holds journal frames; read() and readLines() return the payloads, including
+    // appends still in the journal's buffer.
+    bool openJournal(const std::string& path, AppendJournal::Config config = AppendJournal::defaultConfig());
+
+    // Flush every open journal - call before deep sleep so buffered writes are not lost
+    bool flushJournals();
+
+    // Flush and close every open journal
+    void closeJournals();
+
 private:
     void logError(const std::string& operation, const std::string& path); // Log errors
     void createInitialFiles(); // Create initial files on first boot
     void parseFirstBootFile(const std::string& content); // Parse the first boot file
     bool isFirstBoot() const; // Check if a file is the first boot file
 
+    // An open journal and the file handle it writes to
+    struct Journal {
+        std::unique_ptr<LittleFSAppendFile> file;
+        std::unique_ptr<AppendJournal> journal;
+    };
+
+    AppendJournal* findJournal(const std::string& path); // Journal for a path, or nullptr
+
     int bootFailCount; // Number of failed boot operations
     bool firstBoot;    // Flag to indicate first boot
+    std::map<std::string, Journal> journals; // Journals by path
 
 };
 
+template <typename Callback>
+size_t FileSystem::readLines(const std::string& path, Callback callback) {
+    size_t count = 0;
+    std::string_view line;
+
+    AppendJournal* journal = findJournal(path);
+    if (journal) {
+        // Journal files hold frames, so lines are streamed from their payloads a frame at a time
+        AppendJournal::Reader source(*journal);
+        LineReader<AppendJournal::Reader> lines(source);
+        for (; lines.next(line); ++count) {
+            callback(line);
+        }
+        return count;
+    }
+
+    File file = LittleFS.open(path.c_str(), "r");
+    if (!file) {
+        return 0;
+    }
+    LineReader<File> lines(file);
+    for (; lines.next(line); ++count) {
+        callback(line);
+    }
+    file.close();
+    return count;
+}
+
 #endif // FILESYSTEM_H
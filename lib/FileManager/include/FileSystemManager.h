@@ -3,6 +3,7 @@
 
 #include "FileSystem.h"
 #include "LogLevel.h"
+#include "LogRecord.h"
 #include <functional>
 #include <string>
 #include <vector>
@@ -11,16 +12,22 @@
  * @brief Manages file system operations and logging.
  * 
  * Provides high-level abstractions for interacting with the LittleFS file system.
- * Logging is handled via an injectable logging function for flexibility.
+ * Logging is handled via an injectable logging function for flexibility. Messages are passed
+ * as structured LogRecords, so no message text is built unless a handler renders it.
  */
 class FileSystemManager {
 public:
+    /**
+     * @brief A callable that receives the manager's log records, e.g. a wrapper around Logger::log.
+     */
+    using LogMethod = std::function<void(const LogRecord&)>;
+
     /**
      * @brief Constructor accepting a logging method.
      * 
      * @param registerLogMethod A function to register logging methods.
      */
-    FileSystemManager(std::function<void(LogLevel, const std::string&)> registerLogMethod);
+    FileSystemManager(LogMethod registerLogMethod);
 
     /**
      * @brief Initializes the file system.
@@ -29,7 +36,11 @@ public:
     bool begin();
 
     /**
-     * @brief Flushes a buffer of logs to a specified file.
+     * @brief Flushes a buffer of logs to a specified file in the binary log format.
+     * 
+     * Each message becomes an INFO log record stamped with Hal::rtcMicros() in ms, the time
+     * since the first boot. Every flush starts with a sync record, so a file written by
+     * several managers or across resets stays decodable; tools/binlog_decode prints it.
      * @param buffer The buffer of log messages to write.
      * @param path The file path to write the buffer to.
      */
@@ -72,7 +83,21 @@ public:
     bool createFileIfNotExists(const std::string& path);
 
 private:
-    std::function<void(LogLevel, const std::string&)> logMethod; /**< Logging provided by the Logging class on creation */
+    /**
+     * @brief Packs a log record and hands it to the logging method, if one is set.
+     * 
+     * Levels below LOGGER_MIN_LEVEL compile to nothing.
+     */
+    template <LogLevel Level, typename... Args>
+    void log(const char* format, const Args&... args) {
+        if constexpr (isLogLevelCompiledIn(Level)) {
+            if (logMethod) {
+                logMethod(LogRecord::make(Level, format, args...));
+            }
+        }
+    }
+
+    LogMethod logMethod; /**< Logging provided by the Logging class on creation */
 };
 
 #endif // FILESYSTEM_MANAGER_H
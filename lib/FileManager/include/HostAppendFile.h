@@ -0,0 +1,38 @@
+#ifndef HOSTAPPENDFILE_H
+#define HOSTAPPENDFILE_H
+
+#include "BaseAppendFile.h"
+#include <cstdio>
+
+/**
+ * @brief BaseAppendFile backed by a regular file, for host tests and benchmarks.
+ * 
+ * Counts flash page programs the way a NOR flash would see them: each sync programs every
+ * page touched since the previous sync (a partly filled page is programmed again when it
+ * grows) plus one metadata page. Read handles are kept and counted as LittleFSAppendFile does.
+ */
+class HostAppendFile : public BaseAppendFile {
+public:
+    static constexpr size_t pageSize = 256; // ESP32 NOR flash program page
+
+    explicit HostAppendFile(const std::string& path) : BaseAppendFile(path) {}
+    ~HostAppendFile() override { close(); }
+
+    bool open() override;
+    bool isOpen() const override { return file != nullptr; }
+    size_t append(const uint8_t* data, size_t size) override;
+    bool sync() override;
+    void close() override;
+    size_t size() override;
+    size_t read(size_t offset, uint8_t* out, size_t size) override;
+    bool exists() override;
+    bool remove() override;
+
+private:
+    FILE* file = nullptr;   // Open append handle
+    FILE* reader = nullptr; // Read handle, kept between reads like LittleFSAppendFile's
+    size_t syncedSize = 0; // File size at the last sync
+    size_t currentSize = 0; // File size including unsynced bytes
+};
+
+#endif // HOSTAPPENDFILE_H
@@ -0,0 +1,37 @@
+#ifndef LITTLEFSAPPENDFILE_H
+#define LITTLEFSAPPENDFILE_H
+
+#include "BaseAppendFile.h"
+#include <HalFS.h>
+
+/**
+ * @brief BaseAppendFile backed by a LittleFS file handle that is kept open.
+ * 
+ * sync() maps to File::flush(), which commits the data and metadata to flash. Page writes
+ * are estimated the same way as HostAppendFile so device and host numbers compare. read()
+ * keeps its own handle open until the next append() or close(), so the file is not opened
+ * again for every frame an AppendJournal walk reads.
+ */
+class LittleFSAppendFile : public BaseAppendFile {
+public:
+    explicit LittleFSAppendFile(const std::string& path) : BaseAppendFile(path) {}
+    ~LittleFSAppendFile() override { close(); }
+
+    bool open() override;
+    bool isOpen() const override { return static_cast<bool>(file); }
+    size_t append(const uint8_t* data, size_t size) override;
+    bool sync() override;
+    void close() override;
+    size_t size() override;
+    size_t read(size_t offset, uint8_t* out, size_t size) override;
+    bool exists() override;
+    bool remove() override;
+
+private:
+    File file;              // Open append handle
+    File reader;            // Read handle, kept between reads so a frame by frame walk opens the file once
+    size_t syncedSize = 0;  // File size at the last sync
+    size_t currentSize = 0; // File size including unsynced bytes
+};
+
+#endif // LITTLEFSAPPENDFILE_H
@@ -0,0 +1,276 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#ifndef TIME_SERIES_MAX_CHANNELS
+#define TIME_SERIES_MAX_CHANNELS 8 /**< Sensor channels a store rolls up; each takes 72 bytes of State. */
+#endif
+
+#ifndef TIME_SERIES_SEGMENT_SIZE
+#define TIME_SERIES_SEGMENT_SIZE 4096 /**< Bytes of a segment file, one LittleFS block. */
+#endif
+
+#ifndef TIME_SERIES_BUFFER_SIZE
+#define TIME_SERIES_BUFFER_SIZE 240 /**< Bytes of records each tier keeps in the State before writing them; a multiple of 24. */
+#endif
+
+#ifndef TIME_SERIES_MAX_STEP
+#define TIME_SERIES_MAX_STEP (10UL * 365 * 86400) /**< Seconds a sample may lie ahead of the last one; later ones come from an unset clock. */
+#endif
+
+/**
+ * @brief Sensor history on LittleFS: raw samples for a short window, and min, max, mean and
+ * count per minute, hour and day for much longer.
+ *
+ * Each tier is a ring of fixed-size segment files (`<directory>/r0`, `m0`, `h0`, `d0`, ...).
+ * When a tier's newest segment is full, the next one is started over its oldest, so the
+ * history takes at most the configured number of segments per tier, and a tier's window is
+ * as long as its segments hold. With the default configuration, 96 KB in all, that is about
+ * 1360 raw samples and 680 minute, 1360 hour and 1360 day rollups.
+ *
+ * Every sample also updates the open rollup of its channel in each tier. When a sample falls
+ * in a later period, the tier's open rollups are closed and stored, so summaries are read
+ * from the rollup tiers instead of by scanning raw data. Records reach flash a buffer at a
+ * time: each tier collects them in the State, which is meant for RTC memory, and writes them
+ * once TIME_SERIES_BUFFER_SIZE bytes are waiting, so a wake that appends a few samples
+ * usually writes nothing. Call flush() before a power-off; deep sleep keeps the buffers.
+ *
+ * If the State is lost (power loss, or a reset in the middle of an append), begin() finds
+ * the newest segment of each tier on flash and rebuilds the open rollups from the raw
+ * samples still in the window. What was buffered is gone.
+ *
+ * Times are epoch seconds and must not go backwards; a sample older than the last is stored
+ * with the last time, so a small clock correction does not break the order of the tiers.
+ * Periods are aligned to UTC. Not thread-safe.
+ *
+ * Example:
+ * @code
+ * RTC_DATA_ATTR TimeSeriesStore::State seriesState;
+ * TimeSeriesStore series(seriesState);
+ * series.begin(); // After LittleFS.begin()
+ * series.append(epochSeconds, 0, 0, temperature);
+ * series.query(TimeSeriesStore::Tier::Hour, 0, 0, dayStart, dayEnd, [](const TimeSeriesStore::Rollup& hour) {
+ *     // hour.min, hour.max, hour.mean, hour.count
+ * });
+ * @endcode
+ */
+class TimeSeriesStore {
+public:
+    /**
+     * @brief Resolutions the store keeps, finest first.
+     */
+    enum class Tier : uint8_t {
+        Raw,
+        Minute,
+        Hour,
+        Day,
+    };
+
+    static const size_t tierCount = 4;
+    static const size_t rollupTierCount = tierCount - 1;
+
+    /**
+     * @brief One raw sample, as stored in the raw tier.
+     */
+    struct Sample {
+        uint32_t time;     /**< Epoch seconds. */
+        uint8_t sensorId;
+        uint8_t channel;
+        uint16_t reserved; /**< Keeps the layout free of padding. */
+        float value;
+    };
+
+    /**
+     * @brief Summary of one channel over one period, as stored in the rollup tiers.
+     */
+    struct Rollup {
+        uint32_t periodStart; /**< Epoch seconds the period starts at. */
+        uint8_t sensorId;
+        uint8_t channel;
+        uint16_t reserved;    /**< Keeps the layout free of padding. */
+        uint32_t count;       /**< Samples in the period. */
+        float min;
+        float max;
+        float mean;
+    };
+
+    /**
+     * @brief Where the segments go and how many each tier keeps.
+     */
+    struct Config {
+        const char* directory;        /**< Directory of the segment files; begin() creates it. */
+        uint8_t segments[tierCount];  /**< Segments per tier, indexed by Tier; 0 turns a rollup tier off. */
+    };
+
+    /**
+     * @brief The segment a tier writes to.
+     */
+    struct Segment {
+        uint32_t sequence; /**< Counts up from 1 with every new segment; 0 before the first. */
+        uint16_t slot;     /**< File the segment is in. */
+        uint16_t records;  /**< Records written to it. */
+    };
+
+    /**
+     * @brief Everything the store needs between wakes; keep it in RTC memory.
+     */
+    struct State {
+        uint32_t magic;                                              /**< stateMagic once begin() has run. */
+        uint32_t lastTime;                                           /**< Time of the last sample. */
+        Segment segments[tierCount];                                 /**< Per tier. */
+        uint16_t buffered[tierCount];                                /**< Bytes waiting in each buffer. */
+        uint8_t buffers[tierCount][TIME_SERIES_BUFFER_SIZE];         /**< Records not yet written. */
+        Rollup open[rollupTierCount][TIME_SERIES_MAX_CHANNELS];     /**< Open rollups; count 0 marks a free one. */
+        uint32_t checksum;                                           /**< Over every field above. */
+    };
+
+    /**
+     * @brief Store activity since construction or resetStats().
+     */
+    struct Stats {
+        uint32_t samples;          /**< append() calls that stored a sample. */
+        uint32_t rollups;          /**< Rollups closed. */
+        uint32_t droppedRollups;   /**< Samples not rolled up because every channel slot was taken. */
+        uint32_t fileWrites;       /**< Opens that wrote to a segment. */
+        uint32_t bytesWritten;     /**< Headers and records written. */
+        uint32_t pageWrites;       /**< Flash pages programmed, estimated as LittleFSAppendFile does. */
+        uint32_t segmentsReused;   /**< Segments started over an old one, dropping its records. */
+        uint32_t rejectedTimes;    /**< Samples dropped for lying more than TIME_SERIES_MAX_STEP ahead. */
+    };
+
+    static const uint32_t stateMagic = 0x54535331;  // "TSS1"
+    static const uint32_t segmentMagic = 0x54535347; // "TSSG"
+    static const size_t headerSize = 12;
+
+    /**
+     * @brief Returns the default layout: "/series", 4 raw and minute segments, 8 hour and day segments.
+     */
+    static Config defaultConfig();
+
+    /**
+     * @brief Constructs a store over a state.
+     * @param state The buffers and open rollups, typically declared RTC_DATA_ATTR.
+     */
+    explicit TimeSeriesStore(State& state, Config config = defaultConfig());
+
+    /**
+     * @brief Creates the directory and, if the State is not valid, rebuilds it from flash.
+     * Mount LittleFS first.
+     * @return False if the directory could not be created or the config has no raw segments.
+     */
+    bool begin();
+
+    /**
+     * @brief Stores a sample and updates the open rollups of its channel.
+     *
+     * A time behind the last sample's is stored as that time, so every tier stays in order
+     * across a clock step back. A time more than TIME_SERIES_MAX_STEP ahead of it is dropped
+     * rather than let an unset clock hold the store decades ahead.
+     * @return False for a NaN value or a dropped time, or if a buffer could not be written to flash.
+     */
+    bool append(uint32_t time, uint8_t sensorId, uint8_t channel, float value);
+
+    /**
+     * @brief Writes every buffer to flash; open rollups stay in the State.
+     */
+    bool flush();
+
+    /**
+     * @brief Calls callback(const Sample&) for the channel's raw samples from from to to
+     * (inclusive), oldest first, including buffered ones.
+     * @return The number of samples passed to the callback.
+     */
+    template <typename Callback>
+    size_t queryRaw(uint8_t sensorId, uint8_t channel, uint32_t from, uint32_t to, Callback callback);
+
+    /**
+     * @brief Calls callback(const Rollup&) for the channel's closed periods of a rollup tier
+     * starting from from to to (inclusive), oldest first. See getOpen() for the current one.
+     * @return The number of rollups passed to the callback.
+     */
+    template <typename Callback>
+    size_t query(Tier tier, uint8_t sensorId, uint8_t channel, uint32_t from, uint32_t to, Callback callback);
+
+    /**
+     * @brief The rollup of the channel's current period in a rollup tier.
+     * @return False if the channel has no sample in the period.
+     */
+    bool getOpen(Tier tier, uint8_t sensorId, uint8_t channel, Rollup& out) const;
+
+    /**
+     * @brief Records a tier keeps at most: its segments times the records of a segment.
+     */
+    size_t getCapacity(Tier tier) const;
+
+    /**
+     * @brief True if the last begin() had to rebuild the State from flash.
+     */
+    bool wasRebuilt() const { return rebuilt; }
+
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats{}; }
+
+    /**
+     * @brief Start of the tier's period that contains time; time itself for the raw tier.
+     */
+    static uint32_t periodStart(Tier tier, uint32_t time);
+
+    /**
+     * @brief Bytes of one record of a tier.
+     */
+    static size_t recordSize(Tier tier) { return tier == Tier::Raw ? sizeof(Sample) : sizeof(Rollup); }
+
+private:
+    using Visitor = std::function<bool(const uint8_t* record)>; // True if the record was taken
+
+    size_t walk(Tier tier, uint32_t from, uint32_t to, const Visitor& visit); // Records of a tier in time order
+    bool aggregate(const Sample& sample, const uint32_t* closedUntil); // Adds a sample to the open rollups
+    bool close(size_t rollupTier);                   // Stores and frees the open rollups of a tier
+    bool buffer(Tier tier, const void* record);      // Queues a record, writing the buffer when full
+    bool writeBuffer(Tier tier);                     // Writes a tier's buffer to its segments
+    void rebuild();                                  // Recreates the State from the segments on flash
+    std::string pathOf(Tier tier, size_t slot) const;
+    void seal();                                     // Updates the checksum after a change
+    static uint32_t checksumOf(const State& state);
+
+    State& state;
+    Config config;
+    Stats stats = {};
+    bool rebuilt = false;
+};
+
+template <typename Callback>
+size_t TimeSeriesStore::queryRaw(uint8_t sensorId, uint8_t channel, uint32_t from, uint32_t to, Callback callback) {
+    return walk(Tier::Raw, from, to, [&](const uint8_t* record) {
+        Sample sample;
+        std::memcpy(&sample, record, sizeof(sample));
+        if (sample.sensorId != sensorId || sample.channel != channel) {
+            return false;
+        }
+        callback(static_cast<const Sample&>(sample));
+        return true;
+    });
+}
+
+template <typename Callback>
+size_t TimeSeriesStore::query(Tier tier, uint8_t sensorId, uint8_t channel, uint32_t from, uint32_t to, Callback callback) {
+    if (tier == Tier::Raw) {
+        return 0;
+    }
+    return walk(tier, from, to, [&](const uint8_t* record) {
+        Rollup rollup;
+        std::memcpy(&rollup, record, sizeof(rollup));
+        if (rollup.sensorId != sensorId || rollup.channel != channel) {
+            return false;
+        }
+        callback(static_cast<const Rollup&>(rollup));
+        return true;
+    });
+}
+
+#endif // TIMESERIESSTORE_H
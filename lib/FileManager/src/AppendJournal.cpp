@@ -0,0 +1,192 @@
+#include "AppendJournal.h"
+#include <Hal.h>
+#include <cstring>
+
+namespace {
+
+const size_t payloadOffset = 3; // Magic byte and 16-bit length
+
+} // namespace
+
+AppendJournal::Config AppendJournal::defaultConfig() {
+    return Config{maxPayload, 5000, Hal::millis};
+}
+
+AppendJournal::AppendJournal(BaseAppendFile& file, Config config)
+    : file(file), config(config), stats{}, used(0), oldestAppendMs(0), syncPending(false) {
+    if (this->config.flushThreshold == 0 || this->config.flushThreshold > maxPayload) {
+        this->config.flushThreshold = maxPayload;
+    }
+    if (this->config.clock == nullptr) {
+        this->config.clock = Hal::millis;
+    }
+}
+
+AppendJournal::~AppendJournal() {
+    close();
+}
+
+bool AppendJournal::begin() {
+    return file.open();
+}
+
+bool AppendJournal::append(const uint8_t* data, size_t size) {
+    size_t kept = used; // Buffered before this append; dropping the rest undoes it
+    while (size > 0) {
+        if (used == 0) {
+            oldestAppendMs = config.clock();
+        }
+        size_t room = config.flushThreshold - used;
+        size_t chunk = size < room ? size : room;
+        std::memcpy(buffer + payloadOffset + used, data, chunk);
+        used += chunk;
+        data += chunk;
+        size -= chunk;
+
+        if (used >= config.flushThreshold) {
+            stats.sizeFlushes++;
+            if (!flush()) {
+                used = kept; // Otherwise the next flush writes data reported as not stored
+                return false;
+            }
+            kept = 0;
+        }
+    }
+    if (!poll()) {
+        used = kept;
+        return false;
+    }
+    stats.appends++;
+    return true;
+}
+
+bool AppendJournal::append(const std::string& data) {
+    return append(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+bool AppendJournal::poll() {
+    if (used == 0 || config.maxDelayMs == 0) {
+        return true;
+    }
+    if (config.clock() - oldestAppendMs < config.maxDelayMs) {
+        return true;
+    }
+    stats.timeFlushes++;
+    return flush();
+}
+
+bool AppendJournal::flush() {
+    if (used == 0) {
+        if (syncPending && file.isOpen() && file.sync()) {
+            syncPending = false;
+        }
+        return true;
+    }
+    if (!file.isOpen() && !file.open()) {
+        return false;
+    }
+    if (!writeFrame(used)) {
+        return false;
+    }
+    used = 0;
+    return true;
+}
+
+void AppendJournal::close() {
+    flush();
+    file.close();
+}
+
+bool AppendJournal::writeFrame(size_t size) {
+    // The payload already sits in the buffer, so the header and trailer are filled in around it
+    uint8_t* frame = buffer;
+    const uint8_t* payload = buffer + payloadOffset;
+    frame[0] = frameMagic;
+    frame[1] = static_cast<uint8_t>(size & 0xFF);
+    frame[2] = static_cast<uint8_t>(size >> 8);
+
+    uint32_t crc = crc32(payload, size);
+    uint8_t* trailer = frame + payloadOffset + size;
+    trailer[0] = static_cast<uint8_t>(crc);
+    trailer[1] = static_cast<uint8_t>(crc >> 8);
+    trailer[2] = static_cast<uint8_t>(crc >> 16);
+    trailer[3] = static_cast<uint8_t>(crc >> 24);
+    trailer[4] = commitMarker;
+
+    size_t frameSize = size + frameOverhead;
+    if (file.append(frame, frameSize) != frameSize) {
+        return false; // A partly written frame fails its check on replay, so it can be written again
+    }
+    stats.frames++;
+
+    // The frame is in the file now; a failed sync is reported, not answered with a second copy
+    syncPending = !file.sync();
+    if (syncPending) {
+        stats.syncFailures++;
+    }
+    return true;
+}
+
+AppendJournal::Reader::Reader(AppendJournal& journal)
+    : journal(journal), chunk(nullptr), remaining(0), nextOffset(0), inFrames(true), done(false) {}
+
+size_t AppendJournal::Reader::read(uint8_t* out, size_t size) {
+    size_t total = 0;
+    while (total < size && (remaining > 0 || nextChunk())) {
+        size_t length = size - total < remaining ? size - total : remaining;
+        std::memcpy(out + total, chunk, length);
+        chunk += length;
+        remaining -= length;
+        total += length;
+    }
+    return total;
+}
+
+size_t AppendJournal::Reader::skip(size_t size) {
+    size_t total = 0;
+    while (total < size && (remaining > 0 || nextChunk())) {
+        size_t length = size - total < remaining ? size - total : remaining;
+        chunk += length;
+        remaining -= length;
+        total += length;
+    }
+    return total;
+}
+
+bool AppendJournal::Reader::nextChunk() {
+    if (inFrames) {
+        size_t frames = journal.readFrames(nextOffset, [this](const uint8_t* frame, size_t size, size_t next) {
+            std::memcpy(payload, frame, size);
+            chunk = payload;
+            remaining = size;
+            nextOffset = next;
+            return false; // One frame at a time
+        });
+        if (frames > 0) {
+            return true;
+        }
+        inFrames = false;
+    }
+    if (done) {
+        return false;
+    }
+    // Bytes appended since the last flush come after every committed frame
+    done = true;
+    chunk = journal.buffer + payloadOffset;
+    remaining = journal.used;
+    return remaining > 0;
+}
+
+uint32_t AppendJournal::crc32(const uint8_t* data, size_t size) {
+    // Nibble-table CRC-32 (IEEE), small enough to keep in flash
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0x0F];
+        crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0x0F];
+    }
+    return ~crc;
+}
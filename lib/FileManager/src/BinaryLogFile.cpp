@@ -0,0 +1,83 @@
+#include "BinaryLogFile.h"
+#include <HalFS.h>
+
+BinaryLogFile::BinaryLogFile(const std::string& path, BinaryLogEncoder::State& state)
+    : path(path), committed(state), pending(state), encoder(pending), used(0) {}
+
+bool BinaryLogFile::begin() {
+    if (LittleFS.exists(path.c_str())) {
+        File existing = LittleFS.open(path.c_str(), "r");
+        size_t size = existing ? existing.size() : 0;
+        existing.close();
+        if (size > 0) {
+            return true;
+        }
+    }
+
+    File file = LittleFS.open(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    uint8_t header[BinaryLogFormat::headerSize];
+    size_t length = BinaryLogFormat::writeHeader(header);
+    bool written = file.write(header, length) == length;
+    file.close();
+
+    encoder.reset(); // Baselines from an earlier file do not apply to a new one
+    committed = pending;
+    used = 0;
+    return written;
+}
+
+bool BinaryLogFile::appendLog(uint64_t timestampMs, LogLevel level, uint32_t sourceId, const char* message, size_t length) {
+    if (used == 0) {
+        pending = committed; // Nothing buffered: continue from what the file has
+    }
+    size_t written = encoder.encodeLog(buffer + used, sizeof(buffer) - used, timestampMs, level, sourceId, message, length);
+    if (written == 0) {
+        if (used == 0 || !flush()) {
+            return false; // Record is larger than the whole buffer
+        }
+        written = encoder.encodeLog(buffer, sizeof(buffer), timestampMs, level, sourceId, message, length);
+    }
+    used += written;
+    return written > 0;
+}
+
+bool BinaryLogFile::appendRecord(uint64_t timestampMs, const LogRecord& record, uint32_t sourceId) {
+    char text[LOGGER_RENDER_BUFFER_SIZE];
+    size_t length = record.render(text, sizeof(text));
+    return appendLog(timestampMs, record.getLevel(), sourceId, text, length);
+}
+
+bool BinaryLogFile::appendReading(uint64_t timestampMs, uint8_t sensorId, const float* values, uint8_t count) {
+    if (used == 0) {
+        pending = committed; // Nothing buffered: continue from what the file has
+    }
+    size_t written = encoder.encodeReading(buffer + used, sizeof(buffer) - used, timestampMs, sensorId, values, count);
+    if (written == 0) {
+        if (used == 0 || !flush()) {
+            return false; // Invalid reading
+        }
+        written = encoder.encodeReading(buffer, sizeof(buffer), timestampMs, sensorId, values, count);
+    }
+    used += written;
+    return written > 0;
+}
+
+bool BinaryLogFile::flush() {
+    if (used == 0) {
+        return true;
+    }
+    File file = LittleFS.open(path.c_str(), "a");
+    if (!file) {
+        return false;
+    }
+    bool written = file.write(buffer, used) == used;
+    file.close();
+    if (written) {
+        committed = pending;
+        used = 0;
+    }
+    return written;
+}
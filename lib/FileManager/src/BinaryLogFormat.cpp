@@ -0,0 +1,251 @@
+#include "BinaryLogFormat.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const uint8_t headerMagic[4] = {'E', 'S', 'P', 'B'};
+
+int32_t toHundredths(float value) {
+    return static_cast<int32_t>(std::lround(static_cast<double>(value) * 100.0));
+}
+
+} // namespace
+
+size_t BinaryLogFormat::writeHeader(uint8_t* out) {
+    std::memcpy(out, headerMagic, sizeof(headerMagic));
+    out[4] = version;
+    return headerSize;
+}
+
+bool BinaryLogFormat::checkHeader(const uint8_t* data, size_t size) {
+    return size >= headerSize && std::memcmp(data, headerMagic, sizeof(headerMagic)) == 0 && data[4] == version;
+}
+
+size_t BinaryLogFormat::writeVarint(uint8_t* out, size_t capacity, uint64_t value) {
+    size_t written = 0;
+    do {
+        if (written >= capacity) {
+            return 0;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[written++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    return written;
+}
+
+size_t BinaryLogFormat::readVarint(const uint8_t* data, size_t size, uint64_t& value) {
+    value = 0;
+    for (size_t i = 0; i < size && i < 10; ++i) {
+        value |= static_cast<uint64_t>(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void BinaryLogEncoder::reset() {
+    state.synced = false;
+}
+
+size_t BinaryLogEncoder::beginRecord(uint8_t* out, size_t capacity, uint64_t timestampMs, uint64_t& delta) {
+    bool needsSync = !state.synced || timestampMs < state.lastTimestamp ||
+                     state.recordsSinceSync >= BINARY_LOG_SYNC_INTERVAL;
+    if (!needsSync) {
+        delta = timestampMs - state.lastTimestamp;
+        return 0;
+    }
+
+    if (capacity < 1) {
+        return SIZE_MAX;
+    }
+    out[0] = BinaryLogFormat::tagSync;
+    size_t written = BinaryLogFormat::writeVarint(out + 1, capacity - 1, timestampMs);
+    if (written == 0) {
+        return SIZE_MAX;
+    }
+
+    std::memset(state.lastValues, 0, sizeof(state.lastValues));
+    state.lastTimestamp = timestampMs;
+    state.recordsSinceSync = 0;
+    state.synced = true;
+    delta = 0;
+    return written + 1;
+}
+
+size_t BinaryLogEncoder::encodeLog(uint8_t* out, size_t capacity, uint64_t timestampMs, LogLevel level,
+                                   uint32_t sourceId, const char* message, size_t length) {
+    State saved = state;
+    uint64_t delta = 0;
+    size_t pos = beginRecord(out, capacity, timestampMs, delta);
+    if (pos == SIZE_MAX) {
+        return 0;
+    }
+
+    size_t written = 0;
+    bool fits = pos < capacity;
+    if (fits) {
+        out[pos++] = BinaryLogFormat::tagLog | static_cast<uint8_t>(level);
+    }
+    fits = fits && (written = BinaryLogFormat::writeVarint(out + pos, capacity - pos, delta)) != 0;
+    pos += written;
+    fits = fits && (written = BinaryLogFormat::writeVarint(out + pos, capacity - pos, sourceId)) != 0;
+    pos += written;
+    fits = fits && (written = BinaryLogFormat::writeVarint(out + pos, capacity - pos, length)) != 0;
+    pos += written;
+    fits = fits && capacity - pos >= length;
+
+    if (!fits) {
+        state = saved; // Leave the baselines untouched so the caller can retry with more room
+        return 0;
+    }
+
+    std::memcpy(out + pos, message, length);
+    pos += length;
+    state.lastTimestamp = timestampMs;
+    state.recordsSinceSync++;
+    return pos;
+}
+
+size_t BinaryLogEncoder::encodeReading(uint8_t* out, size_t capacity, uint64_t timestampMs, uint8_t sensorId,
+                                       const float* values, uint8_t count) {
+    if (sensorId >= BINARY_LOG_MAX_SENSORS || count == 0 || count > BINARY_LOG_MAX_CHANNELS) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        if (!std::isfinite(values[i])) {
+            return 0;
+        }
+    }
+
+    State saved = state;
+    uint64_t delta = 0;
+    size_t pos = beginRecord(out, capacity, timestampMs, delta);
+    if (pos == SIZE_MAX) {
+        return 0;
+    }
+
+    size_t written = 0;
+    bool fits = pos < capacity;
+    if (fits) {
+        out[pos++] = BinaryLogFormat::tagReading | count;
+    }
+    fits = fits && (written = BinaryLogFormat::writeVarint(out + pos, capacity - pos, sensorId)) != 0;
+    pos += written;
+    fits = fits && (written = BinaryLogFormat::writeVarint(out + pos, capacity - pos, delta)) != 0;
+    pos += written;
+
+    for (uint8_t i = 0; fits && i < count; ++i) {
+        int32_t value = toHundredths(values[i]);
+        int64_t change = static_cast<int64_t>(value) - state.lastValues[sensorId][i];
+        fits = (written = BinaryLogFormat::writeVarint(out + pos, capacity - pos,
+                                                       BinaryLogFormat::zigzagEncode(change))) != 0;
+        pos += written;
+        state.lastValues[sensorId][i] = value;
+    }
+
+    if (!fits) {
+        state = saved;
+        return 0;
+    }
+
+    state.lastTimestamp = timestampMs;
+    state.recordsSinceSync++;
+    return pos;
+}
+
+BinaryLogDecoder::BinaryLogDecoder(const uint8_t* data, size_t size)
+    : data(data), size(size), offset(0), valid(false), error(false) {
+    std::memset(&state, 0, sizeof(state));
+    if (BinaryLogFormat::checkHeader(data, size)) {
+        valid = true;
+        offset = BinaryLogFormat::headerSize;
+    }
+}
+
+bool BinaryLogDecoder::readVarint(uint64_t& value) {
+    size_t consumed = BinaryLogFormat::readVarint(data + offset, size - offset, value);
+    if (consumed == 0) {
+        error = true;
+        return false;
+    }
+    offset += consumed;
+    return true;
+}
+
+bool BinaryLogDecoder::next(BinaryLogEntry& entry) {
+    if (!valid || error) {
+        return false;
+    }
+
+    while (offset < size) {
+        size_t recordStart = offset;
+        uint8_t tag = data[offset++];
+        uint8_t kind = tag & 0xF0;
+        uint8_t low = tag & 0x0F;
+        uint64_t value = 0;
+
+        if (tag == BinaryLogFormat::tagSync) {
+            if (!readVarint(value)) {
+                offset = recordStart;
+                return false;
+            }
+            std::memset(state.lastValues, 0, sizeof(state.lastValues));
+            state.lastTimestamp = value;
+            state.synced = true;
+            continue;
+        }
+
+        if (kind == BinaryLogFormat::tagLog && low < logLevelCount) {
+            uint64_t delta = 0;
+            uint64_t sourceId = 0;
+            uint64_t length = 0;
+            if (!readVarint(delta) || !readVarint(sourceId) || !readVarint(length) || size - offset < length) {
+                error = true;
+                offset = recordStart;
+                return false;
+            }
+            state.lastTimestamp += delta;
+            entry.type = BinaryLogEntry::Type::Log;
+            entry.timestampMs = state.lastTimestamp;
+            entry.level = static_cast<LogLevel>(low);
+            entry.sourceId = static_cast<uint32_t>(sourceId);
+            entry.message = reinterpret_cast<const char*>(data + offset);
+            entry.messageLength = static_cast<size_t>(length);
+            offset += static_cast<size_t>(length);
+            return true;
+        }
+
+        if (kind == BinaryLogFormat::tagReading && low >= 1 && low <= BINARY_LOG_MAX_CHANNELS) {
+            uint64_t sensorId = 0;
+            uint64_t delta = 0;
+            if (!readVarint(sensorId) || !readVarint(delta) || sensorId >= BINARY_LOG_MAX_SENSORS) {
+                error = true;
+                offset = recordStart;
+                return false;
+            }
+            entry.type = BinaryLogEntry::Type::Reading;
+            entry.sensorId = static_cast<uint8_t>(sensorId);
+            entry.valueCount = low;
+            for (uint8_t i = 0; i < low; ++i) {
+                if (!readVarint(value)) {
+                    offset = recordStart;
+                    return false;
+                }
+                int32_t& last = state.lastValues[sensorId][i];
+                last = static_cast<int32_t>(last + BinaryLogFormat::zigzagDecode(value));
+                entry.values[i] = static_cast<float>(last / 100.0);
+            }
+            state.lastTimestamp += delta;
+            entry.timestampMs = state.lastTimestamp;
+            return true;
+        }
+
+        error = true; // Unknown tag
+        offset = recordStart;
+        return false;
+    }
+    return false;
+}
@@ -1,75 +1,75 @@
 #include "FileSystem.h"
-#include <Arduino.h> // For Serial output
-#include <LittleFS.h>
+#include <Hal.h> // For console output
+#include <HalFS.h>
 #include <string>
 
 // Constructor: Initializes the file system
 FileSystem::FileSystem() : firstBoot(true), bootFailCount(0) {
-    Serial.println("Mounting File System...");
+    Hal::println("Mounting File System...");
 
 
     if (!LittleFS.begin()) {
-        Serial.println("LittleFS failed to initialize. Formatting...");
+        Hal::println("LittleFS failed to initialize. Formatting...");
         if (!LittleFS.format()) {
-            Serial.println("LittleFS failed to format. Aborting initialization.");
+            Hal::println("LittleFS failed to format. Aborting initialization.");
             return;
         }
         else {
-            Serial.println("LittleFS formatted successfully.");
+            Hal::println("LittleFS formatted successfully.");
         }
 
         // Retry mounting after formatting
         if (!LittleFS.begin()) {
-            Serial.println("LittleFS failed to initialize after formatting. Aborting initialization.");
+            Hal::println("LittleFS failed to initialize after formatting. Aborting initialization.");
             return;
         }
         else {
-            Serial.println("LittleFS initialized successfully after formatting.");
+            Hal::println("LittleFS initialized successfully after formatting.");
         }
     } else {
-        Serial.println("LittleFS Mounted successfully.");
-        Serial.println("Checking if first boot...");
+        Hal::println("LittleFS Mounted successfully.");
+        Hal::println("Checking if first boot...");
         parseFirstBootFile(read("/logs/firstBoot.txt"));
     }
 
     // Validate if first boot
     // Check if /logs/firstBoot.txt exists
-    Serial.println("LittleFS initialized successfully.");
-    Serial.println("Verifying file system integrity...");
+    Hal::println("LittleFS initialized successfully.");
+    Hal::println("Verifying file system integrity...");
 
     // Check for the other three files
     if (!exists("/logs/data.txt")) {
-        Serial.println("Data file not found. Creating...");
+        Hal::println("Data file not found. Creating...");
         write("/logs/data.txt", "");
         if (!exists("/logs/data.txt")) {
-            Serial.println("Failed to create data file.");
+            Hal::println("Failed to create data file.");
         }
     } else {
-        Serial.println("data.txt already exists.");
+        Hal::println("data.txt already exists.");
     }
 
     if (!exists("/logs/error.txt")) {
-        Serial.println("Error file not found. Creating...");
+        Hal::println("Error file not found. Creating...");
         write("/logs/error.txt", "");
         if (!exists("/logs/error.txt")) {
-            Serial.println("Failed to create error file.");
+            Hal::println("Failed to create error file.");
         }
     } else {
-        Serial.println("error.txt already exists.");
+        Hal::println("error.txt already exists.");
     }
 
     if (!exists("/logs/info.txt")) {
-        Serial.println("Info file not found. Creating...");
+        Hal::println("Info file not found. Creating...");
         write("/logs/info.txt", "");
         // Check if the info file was created successfully
         if (!exists("/logs/info.txt")) {
-            Serial.println("Failed to create info file.");
+            Hal::println("Failed to create info file.");
         }
     } else {
-        Serial.println("info.txt already exists.");
+        Hal::println("info.txt already exists.");
     }
 
-    Serial.println("File system initialization complete.");
+    Hal::println("File system initialization complete.");
 }
 
 
@@ -80,6 +80,19 @@ FileSystem::FileSystem() : firstBoot(true), bootFailCount(0) {
  * @param data The data to write to the file
  */
 bool FileSystem::write(bool overwriteFile, const std::string& path, const std::string& data) {
+    AppendJournal* journal = findJournal(path);
+    if (journal) {
+        if (overwriteFile) {
+            // Start a fresh journal file holding only the new data
+            journal->close();
+            LittleFS.remove(path.c_str());
+            if (!journal->begin()) {
+                return false;
+            }
+        }
+        return journal->append(data);
+    }
+
     const char* mode = overwriteFile ? "w" : "a"; // Use "a" for append, "w" for overwrite
     File file = LittleFS.open(path.c_str(), mode);
     if (!file) {
@@ -97,6 +110,11 @@ bool FileSystem::write(bool overwriteFile, const std::string& path, const std::s
  * @param data The data to write to the file
  */
 bool FileSystem::write(const std::string& path, const std::string& data) {
+    AppendJournal* journal = findJournal(path);
+    if (journal) {
+        return journal->append(data); // Buffered, written as one frame per page or delay
+    }
+
     File file = LittleFS.open(path.c_str(), "a");
     if (!file) {
         return false;
@@ -110,20 +128,57 @@ bool FileSystem::write(const std::string& path, const std::string& data) {
 
 // Reads data from a file and returns it as a string
 std::string FileSystem::read(const std::string& path) {
+    AppendJournal* journal = findJournal(path);
+    if (journal) {
+        // The committed payloads and the appends not flushed yet
+        std::string content;
+        AppendJournal::Reader source(*journal);
+        ChunkedReader::readAll(source, content);
+        return content;
+    }
+
     File file = LittleFS.open(path.c_str(), "r");
     if (!file) {
         return "";
     }
     std::string content;
-    while (file.available()) {
-        content += static_cast<char>(file.read());
-    }
+    ChunkedReader::readAll(file, content, file.size());
     file.close();
     return content;
 }
 
+// Reads part of a file into a caller-provided buffer
+size_t FileSystem::read(const std::string& path, uint8_t* buffer, size_t size, size_t offset) {
+    AppendJournal* journal = findJournal(path);
+    if (journal) {
+        // Offsets count payload bytes, not the frames around them
+        AppendJournal::Reader source(*journal);
+        if (source.skip(offset) < offset) {
+            return 0;
+        }
+        return source.read(buffer, size);
+    }
+
+    File file = LittleFS.open(path.c_str(), "r");
+    if (!file) {
+        return 0;
+    }
+    if (offset > 0 && !file.seek(offset)) {
+        file.close();
+        return 0;
+    }
+    size_t length = file.read(buffer, size);
+    file.close();
+    return length;
+}
+
 // Removes a file
 bool FileSystem::remove(const std::string& path) {
+    AppendJournal* journal = findJournal(path);
+    if (journal) {
+        journal->close();
+        journals.erase(path);
+    }
     return LittleFS.remove(path.c_str());
 }
 
@@ -132,37 +187,77 @@ bool FileSystem::exists(const std::string& path) {
     return LittleFS.exists(path.c_str());
 }
 
+// Opens a journal for a path, reusing it if one is already open
+bool FileSystem::openJournal(const std::string& path, AppendJournal::Config config) {
+    if (findJournal(path)) {
+        return true;
+    }
+    Journal entry;
+    entry.file.reset(new LittleFSAppendFile(path));
+    entry.journal.reset(new AppendJournal(*entry.file, config));
+    if (!entry.journal->begin()) {
+        Hal::print("Failed to open journal for ");
+        Hal::println(path.c_str());
+        return false;
+    }
+    journals[path] = std::move(entry);
+    return true;
+}
+
+// Flushes every open journal
+bool FileSystem::flushJournals() {
+    bool flushed = true;
+    for (auto& entry : journals) {
+        flushed = entry.second.journal->flush() && flushed;
+    }
+    return flushed;
+}
+
+// Flushes and closes every open journal
+void FileSystem::closeJournals() {
+    for (auto& entry : journals) {
+        entry.second.journal->close();
+    }
+    journals.clear();
+}
+
+// Returns the journal for a path, or nullptr if the path is written directly
+AppendJournal* FileSystem::findJournal(const std::string& path) {
+    auto found = journals.find(path);
+    return found == journals.end() ? nullptr : found->second.journal.get();
+}
+
 // Create initial files on first boot
 void FileSystem::createInitialFiles() {
     // Ensure the /logs/ directory exists
     if (!LittleFS.exists("/logs")) {
-        Serial.println("Creating /logs directory...");
+        Hal::println("Creating /logs directory...");
         if (!LittleFS.mkdir("/logs")) {
-            Serial.println("Failed to create /logs directory. Cannot proceed with file creation.");
+            Hal::println("Failed to create /logs directory. Cannot proceed with file creation.");
             return;
         }
     } else {
-        Serial.println("/logs directory already exists.");
+        Hal::println("/logs directory already exists.");
     }
 
     // Create data file
     if (!write("/logs/data.txt", "")) {
-        Serial.println("Failed to create data file.");
+        Hal::println("Failed to create data file.");
     }
 
     // Create error file
     if (!write("/logs/error.txt", "")) {
-        Serial.println("Failed to create error file.");
+        Hal::println("Failed to create error file.");
     }
 
     // Create info file
     if (!write("/logs/info.txt", "")) {
-        Serial.println("Failed to create info file.");
+        Hal::println("Failed to create info file.");
     }
 
     // Create first boot marker file
     if (!write("/logs/firstBoot.txt", "First Boot: true")) {
-        Serial.println("Failed to create first boot marker file.");
+        Hal::println("Failed to create first boot marker file.");
     }
 
 }
@@ -174,13 +269,12 @@ void FileSystem::parseFirstBootFile(const std::string& content) {
         // overwrite the first boot file
         write(true, "/logs/firstBoot.txt", "First Boot: false");
     } else if (content.find("First Boot: false") != std::string::npos) {
-        Serial.println("First boot file found, device has booted before.");
+        Hal::println("First boot file found, device has booted before.");
         firstBoot = false;
     } else {
-        Serial.println("First boot file found, but could not determine boot status.");
-        Serial.println("Content of first boot file: ");
-        String fileContents = read("/logs/firstBoot.txt").c_str();
-        Serial.println(fileContents);
+        Hal::println("First boot file found, but could not determine boot status.");
+        Hal::println("Content of first boot file: ");
+        Hal::println(read("/logs/firstBoot.txt").c_str());
         firstBoot = false;
     }
 
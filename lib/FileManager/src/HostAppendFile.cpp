@@ -0,0 +1,104 @@
+#include "HostAppendFile.h"
+
+bool HostAppendFile::open() {
+    if (file) {
+        return true;
+    }
+    file = fopen(path.c_str(), "ab");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    currentSize = static_cast<size_t>(ftell(file));
+    syncedSize = currentSize;
+    stats.opens++;
+    return true;
+}
+
+size_t HostAppendFile::append(const uint8_t* data, size_t size) {
+    if (!file) {
+        return 0;
+    }
+    if (reader) {
+        fclose(reader);
+        reader = nullptr;
+    }
+    size_t written = fwrite(data, 1, size, file);
+    currentSize += written;
+    stats.bytesWritten += written;
+    return written;
+}
+
+bool HostAppendFile::sync() {
+    if (!file) {
+        return false;
+    }
+    if (currentSize == syncedSize) {
+        return true;
+    }
+    fflush(file);
+    size_t firstPage = syncedSize / pageSize;
+    size_t lastPage = (currentSize - 1) / pageSize;
+    stats.pageWrites += static_cast<uint32_t>(lastPage - firstPage + 1) + 1; // Data pages plus a metadata commit
+    stats.syncs++;
+    syncedSize = currentSize;
+    return true;
+}
+
+void HostAppendFile::close() {
+    if (reader) {
+        fclose(reader);
+        reader = nullptr;
+    }
+    if (!file) {
+        return;
+    }
+    sync();
+    fclose(file);
+    file = nullptr;
+}
+
+size_t HostAppendFile::size() {
+    if (file) {
+        return currentSize;
+    }
+    FILE* reader = fopen(path.c_str(), "rb");
+    if (!reader) {
+        return 0;
+    }
+    fseek(reader, 0, SEEK_END);
+    size_t length = static_cast<size_t>(ftell(reader));
+    fclose(reader);
+    return length;
+}
+
+size_t HostAppendFile::read(size_t offset, uint8_t* out, size_t size) {
+    if (file) {
+        fflush(file);
+    }
+    if (!reader) {
+        reader = fopen(path.c_str(), "rb");
+        if (!reader) {
+            return 0;
+        }
+        stats.readOpens++;
+    }
+    if (fseek(reader, static_cast<long>(offset), SEEK_SET) != 0) {
+        return 0;
+    }
+    return fread(out, 1, size, reader);
+}
+
+bool HostAppendFile::exists() {
+    FILE* reader = fopen(path.c_str(), "rb");
+    if (!reader) {
+        return false;
+    }
+    fclose(reader);
+    return true;
+}
+
+bool HostAppendFile::remove() {
+    close();
+    return std::remove(path.c_str()) == 0;
+}
@@ -0,0 +1,95 @@
+#include "LittleFSAppendFile.h"
+
+namespace {
+const size_t flashPageSize = 256; // ESP32 NOR flash program page
+}
+
+bool LittleFSAppendFile::open() {
+    if (file) {
+        return true;
+    }
+    file = LittleFS.open(path.c_str(), FILE_APPEND);
+    if (!file) {
+        return false;
+    }
+    currentSize = file.size();
+    syncedSize = currentSize;
+    stats.opens++;
+    return true;
+}
+
+size_t LittleFSAppendFile::append(const uint8_t* data, size_t size) {
+    if (!file) {
+        return 0;
+    }
+    if (reader) {
+        reader.close(); // Opened again by the next read(), so it sees the new size
+    }
+    size_t written = file.write(data, size);
+    currentSize += written;
+    stats.bytesWritten += written;
+    return written;
+}
+
+bool LittleFSAppendFile::sync() {
+    if (!file) {
+        return false;
+    }
+    if (currentSize == syncedSize) {
+        return true;
+    }
+    file.flush();
+    size_t firstPage = syncedSize / flashPageSize;
+    size_t lastPage = (currentSize - 1) / flashPageSize;
+    stats.pageWrites += static_cast<uint32_t>(lastPage - firstPage + 1) + 1; // Data pages plus a metadata commit
+    stats.syncs++;
+    syncedSize = currentSize;
+    return true;
+}
+
+void LittleFSAppendFile::close() {
+    if (reader) {
+        reader.close();
+    }
+    if (!file) {
+        return;
+    }
+    sync();
+    file.close();
+}
+
+size_t LittleFSAppendFile::size() {
+    if (file) {
+        return currentSize;
+    }
+    File reader = LittleFS.open(path.c_str(), FILE_READ);
+    if (!reader) {
+        return 0;
+    }
+    size_t length = reader.size();
+    reader.close();
+    return length;
+}
+
+size_t LittleFSAppendFile::read(size_t offset, uint8_t* out, size_t size) {
+    if (!reader) {
+        reader = LittleFS.open(path.c_str(), FILE_READ);
+        if (!reader) {
+            return 0;
+        }
+        stats.readOpens++;
+    }
+    if (!reader.seek(offset)) {
+        return 0;
+    }
+    return reader.read(out, size);
+}
+
+bool LittleFSAppendFile::exists() {
+    return LittleFS.exists(path.c_str());
+}
+
+bool LittleFSAppendFile::remove() {
+    close();
+    return LittleFS.remove(path.c_str());
+}
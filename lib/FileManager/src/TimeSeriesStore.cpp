@@ -0,0 +1,371 @@
+#include "TimeSeriesStore.h"
+#include <HalFS.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+const size_t flashPageSize = 256; // ESP32 NOR flash program page
+const size_t readChunkSize = 480; // Whole records of every tier
+
+// First bytes of every segment file
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint8_t tier;
+    uint8_t recordSize;
+    uint16_t reserved;
+};
+static_assert(sizeof(SegmentHeader) == TimeSeriesStore::headerSize, "segment header layout");
+static_assert(TIME_SERIES_BUFFER_SIZE % sizeof(TimeSeriesStore::Rollup) == 0 &&
+              TIME_SERIES_BUFFER_SIZE % sizeof(TimeSeriesStore::Sample) == 0, "buffers hold whole records");
+
+const uint32_t periodSeconds[TimeSeriesStore::tierCount] = {1, 60, 3600, 86400};
+
+uint32_t timeOf(const uint8_t* record) {
+    uint32_t time;
+    std::memcpy(&time, record, sizeof(time)); // Sample::time and Rollup::periodStart both come first
+    return time;
+}
+
+size_t recordsPerSegment(TimeSeriesStore::Tier tier) {
+    return (TIME_SERIES_SEGMENT_SIZE - TimeSeriesStore::headerSize) / TimeSeriesStore::recordSize(tier);
+}
+
+// Reads a segment's header; false if the file is not a segment of the tier
+bool readHeader(File& file, TimeSeriesStore::Tier tier, SegmentHeader& header) {
+    return file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+           header.magic == TimeSeriesStore::segmentMagic && header.tier == static_cast<uint8_t>(tier) &&
+           header.recordSize == TimeSeriesStore::recordSize(tier);
+}
+
+// Time of a segment's record, or UINT32_MAX if it cannot be read
+uint32_t timeAt(File& file, size_t recordSize, size_t index) {
+    uint8_t bytes[sizeof(uint32_t)];
+    if (!file.seek(TimeSeriesStore::headerSize + index * recordSize) || file.read(bytes, sizeof(bytes)) != sizeof(bytes)) {
+        return UINT32_MAX;
+    }
+    return timeOf(bytes);
+}
+} // namespace
+
+TimeSeriesStore::Config TimeSeriesStore::defaultConfig() {
+    return Config{"/series", {4, 4, 8, 8}};
+}
+
+TimeSeriesStore::TimeSeriesStore(State& state, Config config) : state(state), config(config) {}
+
+bool TimeSeriesStore::begin() {
+    if (config.segments[0] == 0) {
+        return false; // The rollups are rebuilt from the raw tier, which cannot be turned off
+    }
+    if (!LittleFS.exists(config.directory) && !LittleFS.mkdir(config.directory)) {
+        return false;
+    }
+    rebuilt = state.magic != stateMagic || state.checksum != checksumOf(state);
+    if (rebuilt) {
+        rebuild();
+    }
+    return true;
+}
+
+bool TimeSeriesStore::append(uint32_t time, uint8_t sensorId, uint8_t channel, float value) {
+    if (std::isnan(value)) {
+        return false;
+    }
+    if (state.lastTime != 0 && time > state.lastTime && time - state.lastTime > TIME_SERIES_MAX_STEP) {
+        stats.rejectedTimes++;
+        return false;
+    }
+    time = std::max(time, state.lastTime); // Keeps every tier in time order across a clock step back
+    state.lastTime = time;
+
+    Sample sample = {time, sensorId, channel, 0, value};
+    bool stored = aggregate(sample, nullptr);
+    stored = buffer(Tier::Raw, &sample) && stored;
+    stats.samples++;
+    seal();
+    return stored;
+}
+
+bool TimeSeriesStore::flush() {
+    bool written = true;
+    for (size_t t = 0; t < tierCount; ++t) {
+        written = writeBuffer(static_cast<Tier>(t)) && written;
+    }
+    seal();
+    return written;
+}
+
+bool TimeSeriesStore::getOpen(Tier tier, uint8_t sensorId, uint8_t channel, Rollup& out) const {
+    if (tier == Tier::Raw) {
+        return false;
+    }
+    for (const Rollup& rollup : state.open[static_cast<size_t>(tier) - 1]) {
+        if (rollup.count > 0 && rollup.sensorId == sensorId && rollup.channel == channel) {
+            out = rollup;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t TimeSeriesStore::getCapacity(Tier tier) const {
+    return config.segments[static_cast<size_t>(tier)] * recordsPerSegment(tier);
+}
+
+uint32_t TimeSeriesStore::periodStart(Tier tier, uint32_t time) {
+    return time - time % periodSeconds[static_cast<size_t>(tier)];
+}
+
+// Adds a sample to the open rollup of its channel in each tier, closing the tier's rollups
+// first when the sample starts a new period. While rebuilding, closedUntil skips periods
+// that are already stored
+bool TimeSeriesStore::aggregate(const Sample& sample, const uint32_t* closedUntil) {
+    bool stored = true;
+    for (size_t r = 0; r < rollupTierCount; ++r) {
+        Tier tier = static_cast<Tier>(r + 1);
+        uint32_t period = periodStart(tier, sample.time);
+        if (config.segments[r + 1] == 0 || (closedUntil != nullptr && period < closedUntil[r])) {
+            continue;
+        }
+
+        // Every open rollup of a tier is for the same period
+        Rollup* open = state.open[r];
+        Rollup* current = std::find_if(open, open + TIME_SERIES_MAX_CHANNELS, [](const Rollup& rollup) { return rollup.count > 0; });
+        if (current != open + TIME_SERIES_MAX_CHANNELS && current->periodStart != period) {
+            stored = close(r) && stored;
+        }
+
+        Rollup* slot = nullptr;
+        for (Rollup& rollup : state.open[r]) {
+            if (rollup.count > 0 && rollup.sensorId == sample.sensorId && rollup.channel == sample.channel) {
+                slot = &rollup;
+                break;
+            }
+            if (rollup.count == 0 && slot == nullptr) {
+                slot = &rollup;
+            }
+        }
+        if (slot == nullptr) {
+            stats.droppedRollups++;
+            stored = false;
+            continue;
+        }
+        if (slot->count == 0) {
+            *slot = Rollup{period, sample.sensorId, sample.channel, 0, 0, sample.value, sample.value, 0};
+        }
+        slot->count++;
+        slot->min = std::min(slot->min, sample.value);
+        slot->max = std::max(slot->max, sample.value);
+        slot->mean += (sample.value - slot->mean) / slot->count;
+    }
+    return stored;
+}
+
+// Stores the open rollups of a tier and frees their slots
+bool TimeSeriesStore::close(size_t rollupTier) {
+    bool stored = true;
+    for (Rollup& rollup : state.open[rollupTier]) {
+        if (rollup.count == 0) {
+            continue;
+        }
+        stored = buffer(static_cast<Tier>(rollupTier + 1), &rollup) && stored;
+        stats.rollups++;
+        rollup = Rollup{};
+    }
+    return stored;
+}
+
+// Queues a record; a full buffer is written first, and dropped if that fails
+bool TimeSeriesStore::buffer(Tier tier, const void* record) {
+    size_t t = static_cast<size_t>(tier);
+    size_t size = recordSize(tier);
+    if (state.buffered[t] + size > TIME_SERIES_BUFFER_SIZE && !writeBuffer(tier)) {
+        state.buffered[t] = 0;
+        return false;
+    }
+    std::memcpy(state.buffers[t] + state.buffered[t], record, size);
+    state.buffered[t] += size;
+    return true;
+}
+
+// Appends the buffer to the tier's newest segment, starting the next segment over the oldest
+// whenever one is full
+bool TimeSeriesStore::writeBuffer(Tier tier) {
+    size_t t = static_cast<size_t>(tier);
+    size_t size = recordSize(tier);
+    size_t perSegment = recordsPerSegment(tier);
+    Segment& segment = state.segments[t];
+    size_t done = 0;
+
+    while (done < state.buffered[t]) {
+        bool fresh = segment.sequence == 0 || segment.records >= perSegment;
+        File file;
+        size_t offset = 0;
+        if (fresh) {
+            uint16_t slot = segment.sequence == 0 ? 0 : static_cast<uint16_t>((segment.slot + 1) % config.segments[t]);
+            std::string path = pathOf(tier, slot);
+            if (LittleFS.exists(path.c_str())) {
+                stats.segmentsReused++;
+            }
+            file = LittleFS.open(path.c_str(), FILE_WRITE);
+            SegmentHeader header = {segmentMagic, segment.sequence + 1, static_cast<uint8_t>(tier), static_cast<uint8_t>(size), 0};
+            if (!file || file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) != sizeof(header)) {
+                break;
+            }
+            segment = Segment{header.sequence, slot, 0};
+        } else {
+            file = LittleFS.open(pathOf(tier, segment.slot).c_str(), FILE_APPEND);
+            offset = headerSize + segment.records * size;
+            if (!file) {
+                break;
+            }
+        }
+
+        size_t count = std::min((state.buffered[t] - done) / size, perSegment - segment.records);
+        size_t bytes = count * size;
+        bool written = file.write(state.buffers[t] + done, bytes) == bytes;
+        file.close();
+
+        size_t total = bytes + (fresh ? headerSize : 0);
+        stats.fileWrites++;
+        stats.bytesWritten += total;
+        stats.pageWrites += static_cast<uint32_t>((offset + total - 1) / flashPageSize - offset / flashPageSize + 1) + 1; // Data pages plus a metadata commit
+        if (!written) {
+            segment.records = static_cast<uint16_t>(perSegment); // A partial record may follow; carry on in a new segment
+            break;
+        }
+        segment.records += static_cast<uint16_t>(count);
+        done += bytes;
+    }
+
+    // Keep what was not written for the next try
+    std::memmove(state.buffers[t], state.buffers[t] + done, state.buffered[t] - done);
+    state.buffered[t] -= static_cast<uint16_t>(done);
+    return state.buffered[t] == 0;
+}
+
+// Visits the records of a tier from from to to in time order: the segments oldest first, then
+// the buffer. Segments that end before from are skipped and the rest are entered by binary
+// search, so a query reads little more than the records it returns
+size_t TimeSeriesStore::walk(Tier tier, uint32_t from, uint32_t to, const Visitor& visit) {
+    size_t t = static_cast<size_t>(tier);
+    size_t size = recordSize(tier);
+    const Segment& segment = state.segments[t];
+    uint32_t slots = config.segments[t];
+    size_t visited = 0;
+    uint8_t chunk[readChunkSize];
+
+    uint32_t first = segment.sequence > slots ? segment.sequence - slots + 1 : 1;
+    for (uint32_t sequence = first; sequence <= segment.sequence; ++sequence) {
+        size_t slot = (segment.slot + slots - (segment.sequence - sequence)) % slots;
+        File file = LittleFS.open(pathOf(tier, slot).c_str(), FILE_READ);
+        SegmentHeader header;
+        if (!file || !readHeader(file, tier, header) || header.sequence != sequence) {
+            continue;
+        }
+        size_t records = (file.size() - headerSize) / size;
+        if (records == 0 || timeAt(file, size, records - 1) < from) {
+            continue;
+        }
+
+        size_t low = 0;
+        size_t high = records - 1;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (timeAt(file, size, middle) < from) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        file.seek(headerSize + low * size);
+        for (size_t index = low; index < records;) {
+            size_t count = std::min(records - index, readChunkSize / size);
+            if (file.read(chunk, count * size) != count * size) {
+                break;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t* record = chunk + i * size;
+                if (timeOf(record) > to) {
+                    return visited;
+                }
+                visited += visit(record) ? 1 : 0;
+            }
+            index += count;
+        }
+    }
+
+    for (size_t offset = 0; offset < state.buffered[t]; offset += size) {
+        const uint8_t* record = state.buffers[t] + offset;
+        if (timeOf(record) > to) {
+            break;
+        }
+        if (timeOf(record) >= from) {
+            visited += visit(record) ? 1 : 0;
+        }
+    }
+    return visited;
+}
+
+// Finds the newest segment of each tier, then replays the raw window into the open rollups of
+// the periods no rollup has been stored for yet
+void TimeSeriesStore::rebuild() {
+    std::memset(&state, 0, sizeof(state));
+    state.magic = stateMagic;
+
+    for (size_t t = 0; t < tierCount; ++t) {
+        Tier tier = static_cast<Tier>(t);
+        for (uint16_t slot = 0; slot < config.segments[t]; ++slot) {
+            File file = LittleFS.open(pathOf(tier, slot).c_str(), FILE_READ);
+            SegmentHeader header;
+            if (file && readHeader(file, tier, header) && header.sequence > state.segments[t].sequence) {
+                size_t records = (file.size() - headerSize) / recordSize(tier);
+                state.segments[t] = Segment{header.sequence, slot, static_cast<uint16_t>(records)};
+            }
+        }
+    }
+
+    uint32_t closedUntil[rollupTierCount] = {};
+    for (size_t r = 0; r < rollupTierCount; ++r) {
+        Tier tier = static_cast<Tier>(r + 1);
+        const Segment& segment = state.segments[r + 1];
+        if (segment.records == 0) {
+            continue;
+        }
+        File file = LittleFS.open(pathOf(tier, segment.slot).c_str(), FILE_READ);
+        uint32_t lastPeriod = file ? timeAt(file, recordSize(tier), segment.records - 1) : UINT32_MAX;
+        closedUntil[r] = lastPeriod == UINT32_MAX ? UINT32_MAX : lastPeriod + periodSeconds[r + 1];
+        state.lastTime = std::max(state.lastTime, lastPeriod == UINT32_MAX ? 0 : lastPeriod);
+    }
+
+    walk(Tier::Raw, 0, UINT32_MAX, [this, &closedUntil](const uint8_t* record) {
+        Sample sample;
+        std::memcpy(&sample, record, sizeof(sample));
+        aggregate(sample, closedUntil);
+        state.lastTime = std::max(state.lastTime, sample.time);
+        return true;
+    });
+    seal();
+}
+
+std::string TimeSeriesStore::pathOf(Tier tier, size_t slot) const {
+    static const char prefixes[tierCount] = {'r', 'm', 'h', 'd'};
+    return std::string(config.directory) + "/" + prefixes[static_cast<size_t>(tier)] + std::to_string(slot);
+}
+
+void TimeSeriesStore::seal() {
+    state.checksum = checksumOf(state);
+}
+
+// FNV-1a over the fields before the checksum
+uint32_t TimeSeriesStore::checksumOf(const State& state) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(State, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,224 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#define HAL_INLINE inline // Device calls forward straight to the Arduino core
+#define HAL_RTC_DATA RTC_DATA_ATTR
+#else
+#define HAL_INLINE
+#define HAL_RTC_DATA __attribute__((section("hal_rtc_data"))) // Cleared by Hal::Sim::powerCycle()
+#endif
+
+/**
+ * @brief Thin hardware abstraction layer over the Arduino and FreeRTOS calls the libraries use.
+ *
+ * On the ESP32 every function is an inline forward to the Arduino core, so going through the
+ * HAL costs nothing. On the host (the PlatformIO `native` environment) the same calls run
+ * against a simulation: a steady or manually stepped clock, ADC channels fed by fixed values or
+ * callbacks, GPIO state held in memory, and tasks on std::thread. HalSim.h holds the controls
+ * tests use to drive the simulation, and HalFS.h gives the same treatment to LittleFS.
+ *
+ * Variables declared HAL_RTC_DATA live in RTC slow memory on the ESP32 and keep their
+ * contents through deep sleep. They must be zero-initialized, as a power-on reset zeroes them.
+ *
+ * A native test environment only needs the host toolchain:
+ * @code
+ * [env:native]
+ * platform = native
+ * build_flags = -std=gnu++17 -pthread
+ * @endcode
+ */
+namespace Hal {
+
+/**
+ * @brief Pin directions, mirroring the Arduino pinMode() constants.
+ */
+enum class PinMode : uint8_t {
+    Input,
+    Output,
+    InputPullup,
+    InputPulldown
+};
+
+/**
+ * @brief Entry point of a task. The task ends when the function returns.
+ */
+using TaskFunction = void (*)(void* parameters);
+
+/**
+ * @brief Returns the milliseconds since boot. Wraps after about 49 days.
+ */
+HAL_INLINE uint32_t millis();
+
+/**
+ * @brief Returns the microseconds since boot. Wraps after about 71 minutes.
+ */
+HAL_INLINE uint32_t micros();
+
+/**
+ * @brief Returns the microseconds counted by the RTC timer since power-on.
+ *
+ * Unlike micros(), it keeps counting through deep sleep, so it can carry a wall clock from
+ * one wake to the next. On the ESP32 it runs from the RTC slow clock and drifts accordingly.
+ */
+uint64_t rtcMicros();
+
+/**
+ * @brief Blocks the calling task for a number of milliseconds, letting others run.
+ */
+HAL_INLINE void delay(uint32_t ms);
+
+/**
+ * @brief Blocks the calling task for a number of microseconds without yielding.
+ */
+HAL_INLINE void delayMicroseconds(uint32_t us);
+
+/**
+ * @brief Reads an ADC channel. Returns the raw 12-bit count on the ESP32.
+ */
+HAL_INLINE int analogRead(uint8_t pin);
+
+/**
+ * @brief Starts converting an ADC pin continuously in the background.
+ *
+ * On the ESP32 this is the ADC's continuous (DMA) mode: the hardware converts at sampleRateHz
+ * into frames of frameSamples without the CPU, two frames deep, so one frame fills while the
+ * other is read. Only one stream runs at a time, and only on an ADC1 pin (ADC2 is shared with
+ * WiFi). The ESP32 converts at 20 kHz at the least.
+ *
+ * @return False if a stream is already running, the pin or rate is not supported, or the core
+ * has no continuous ADC driver; callers fall back to analogRead().
+ */
+bool adcStreamBegin(uint8_t pin, uint32_t sampleRateHz, size_t frameSamples);
+
+/**
+ * @brief Takes converted samples from the stream, as raw counts like analogRead() returns.
+ *
+ * Waits up to timeoutMs for a frame when none is ready. Frames the caller did not take in time
+ * are overwritten by newer ones.
+ *
+ * @return The number of samples written to out; 0 on timeout or when no stream is running.
+ */
+size_t adcStreamRead(uint16_t* out, size_t capacity, uint32_t timeoutMs);
+
+/**
+ * @brief Stops the stream and powers the continuous mode down.
+ */
+void adcStreamEnd();
+
+/**
+ * @brief A level a pin held and for how long, as a pulse capture records it.
+ */
+struct Pulse {
+    uint16_t us; /**< Duration in microseconds. */
+    bool high;   /**< Level during the pulse. */
+};
+
+/**
+ * @brief Prepares a one-wire sensor line for pulse captures.
+ *
+ * The pin becomes an open-drain output with the pull-up on, released (high). On the ESP32 a
+ * capture is recorded by an RMT receive channel, so the CPU only arms it and collects the
+ * result, and pins with channels of their own capture at the same time. A capture ends once
+ * the line has stayed at one level for idleUs.
+ *
+ * @return False when no receive channel is free, the pin already captures, or the core has no
+ * RMT driver (ESP-IDF 4); callers fall back to bit-banging the line.
+ */
+bool pulseCaptureBegin(uint8_t pin, uint32_t idleUs);
+
+/**
+ * @brief Drives a capture line low, the start signal of a transaction. Let it go with
+ * pulseCaptureArm() once the device's start time has passed.
+ */
+void pulseCaptureLineLow(uint8_t pin);
+
+/**
+ * @brief Starts recording the line and releases it, so the device's answer is captured in the
+ * background.
+ * @return False if the pin was not prepared with pulseCaptureBegin().
+ */
+bool pulseCaptureArm(uint8_t pin);
+
+/**
+ * @brief Waits up to timeoutMs for the capture armed on a pin to end, blocking the calling
+ * task without using the CPU.
+ * @return The number of pulses written to out, in the order they came; 0 on timeout. The
+ * idle level that ended the capture is not included.
+ */
+size_t pulseCaptureRead(uint8_t pin, Pulse* out, size_t capacity, uint32_t timeoutMs);
+
+/**
+ * @brief Releases the pin's receive channel.
+ */
+void pulseCaptureEnd(uint8_t pin);
+
+/**
+ * @brief Configures the direction of a GPIO pin.
+ */
+HAL_INLINE void pinMode(uint8_t pin, PinMode mode);
+
+/**
+ * @brief Drives an output pin high or low.
+ */
+HAL_INLINE void digitalWrite(uint8_t pin, bool high);
+
+/**
+ * @brief Reads the level of a pin.
+ */
+HAL_INLINE bool digitalRead(uint8_t pin);
+
+/**
+ * @brief Starts a task that runs function(parameters) once and then ends.
+ *
+ * On the ESP32 this is a FreeRTOS task; on the host a detached std::thread, where the stack
+ * size and priority are ignored. Callers that need to wait for the task to end signal it
+ * themselves, e.g. with an atomic flag set before the function returns.
+ *
+ * @param name Name of the task, shown by FreeRTOS debugging tools.
+ * @param function The task body.
+ * @param parameters Passed to the task body.
+ * @param stackWords Stack size in words.
+ * @param priority FreeRTOS priority; higher runs first.
+ * @return False if the task could not be created.
+ */
+bool startTask(const char* name, TaskFunction function, void* parameters = nullptr,
+               uint32_t stackWords = 4096, unsigned priority = 1);
+
+/**
+ * @brief Writes text to the debug console (Serial on the ESP32, stdout on the host).
+ */
+HAL_INLINE void print(const char* text);
+
+/**
+ * @brief Writes text and a line break to the debug console.
+ */
+HAL_INLINE void println(const char* text = "");
+
+#ifdef ARDUINO
+
+inline uint32_t millis() { return ::millis(); }
+inline uint32_t micros() { return ::micros(); }
+inline void delay(uint32_t ms) { ::delay(ms); }
+inline void delayMicroseconds(uint32_t us) { ::delayMicroseconds(us); }
+inline int analogRead(uint8_t pin) { return ::analogRead(pin); }
+
+inline void pinMode(uint8_t pin, PinMode mode) {
+    static const uint8_t modes[] = {INPUT, OUTPUT, INPUT_PULLUP, INPUT_PULLDOWN};
+    ::pinMode(pin, modes[static_cast<uint8_t>(mode)]);
+}
+
+inline void digitalWrite(uint8_t pin, bool high) { ::digitalWrite(pin, high ? HIGH : LOW); }
+inline bool digitalRead(uint8_t pin) { return ::digitalRead(pin) == HIGH; }
+inline void print(const char* text) { Serial.print(text); }
+inline void println(const char* text) { Serial.println(text); }
+
+#endif
+
+} // namespace Hal
+
+#endif // HAL_H
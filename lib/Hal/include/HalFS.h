@@ -0,0 +1,131 @@
+#ifndef HALFS_H
+#define HALFS_H
+
+#ifdef ARDUINO
+
+#include <LittleFS.h>
+
+#else
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+/**
+ * @brief Host stand-in for the LittleFS File handle, backed by a RAM file.
+ *
+ * Implements the subset of the Arduino fs::File API the libraries use. A handle keeps the
+ * file's data alive, so removing an open file behaves like unlinking it on a POSIX system.
+ */
+class File {
+public:
+    File() = default;
+
+    explicit operator bool() const { return data != nullptr; }
+
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    size_t print(const char* text);
+    size_t println(const char* text = "");
+
+    size_t read(uint8_t* buffer, size_t size);
+    int read();
+    int peek();
+    int available();
+
+    bool seek(uint32_t position);
+    size_t position() const { return pos; }
+    size_t size() const;
+    void flush();
+    void close();
+    const char* name() const { return path.c_str(); }
+
+private:
+    friend class HostLittleFS;
+
+    std::shared_ptr<std::vector<uint8_t>> data; // File contents shared with the file system
+    std::string path;                           // Path the file was opened with
+    size_t pos = 0;                             // Read and write position
+    bool writable = false;                      // Opened with "w" or "a"
+    bool appending = false;                     // Writes always go to the end
+    class HostLittleFS* owner = nullptr;        // File system that accounts for writes
+};
+
+/**
+ * @brief Host stand-in for the ESP32 LittleFS object, holding every file in RAM.
+ *
+ * The whole file system can be written to and loaded from an image file, which lets host
+ * tests simulate a reboot: save the image, reset the simulation, load it back. A capacity
+ * limit makes writes fail once the image is full, like a full flash partition.
+ *
+ * Only open, close, read, write and directory bookkeeping are simulated; wear, block
+ * allocation and power-loss atomicity are not.
+ */
+class HostLittleFS {
+public:
+    /**
+     * @brief Counters of file system activity since the last resetStats().
+     */
+    struct Stats {
+        uint32_t opens;        /**< Successful open() calls. */
+        uint32_t flushes;      /**< File::flush() and close() calls on writable files. */
+        uint64_t bytesRead;    /**< Bytes returned by File::read(). */
+        uint64_t bytesWritten; /**< Bytes accepted by File::write(). */
+    };
+
+    explicit HostLittleFS(size_t capacity = 1536 * 1024) : capacity(capacity), stats{} {}
+
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; mounted = true; return true; }
+    void end() { mounted = false; }
+    bool format();
+
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+
+    size_t totalBytes() const { return capacity; }
+    size_t usedBytes();
+
+    /**
+     * @brief Writes every file and directory to an image file on the host.
+     */
+    bool saveImage(const std::string& imagePath);
+
+    /**
+     * @brief Replaces the contents with an image written by saveImage().
+     */
+    bool loadImage(const std::string& imagePath);
+
+    void setCapacity(size_t bytes) { capacity = bytes; }
+    Stats getStats() const { return stats; }
+    void resetStats() { stats = Stats{}; }
+
+private:
+    friend class File;
+
+    bool reserve(size_t bytes); // Accounts for growth, false if the capacity is exceeded
+
+    std::mutex lock;
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    std::vector<std::string> directories;
+    size_t capacity;
+    bool mounted = false;
+    Stats stats;
+};
+
+extern HostLittleFS LittleFS;
+
+#endif // ARDUINO
+
+#endif // HALFS_H
@@ -0,0 +1,175 @@
+#ifndef HALSIM_H
+#define HALSIM_H
+
+#ifndef ARDUINO
+
+#include "Hal.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Controls for the host simulation behind Hal.h. Not available on the device.
+ *
+ * By default the clock follows the host's steady clock from process start, every ADC channel
+ * reads 0 and every pin reads low. Tests switch to a manual clock to make timing exact: it only
+ * moves when advanced, and Hal::delay() advances it instead of sleeping, so a simulated hour
+ * runs in microseconds.
+ *
+ * ADC conversion time is only simulated on the manual clock: analogRead() then costs
+ * setAnalogReadCost(), and an ADC stream delivers a frame once its samples' time has passed.
+ * On the steady clock both return at once.
+ *
+ * Example:
+ * @code
+ * Hal::Sim::reset();
+ * Hal::Sim::useManualClock(true);
+ * Hal::Sim::setAnalogValue(36, 2048);
+ * Hal::Sim::setAnalogReadCost(10); // Each read takes 10 us of simulated time
+ * Hal::delay(500);                 // Returns immediately, Hal::millis() is now 500
+ * @endcode
+ */
+namespace Hal {
+namespace Sim {
+
+/**
+ * @brief Computes an ADC reading from the pin and the simulated time in microseconds.
+ */
+using AnalogSource = std::function<int(uint8_t pin, uint64_t nowUs)>;
+
+/**
+ * @brief Clears ADC sources, pin state, counters and the clock mode.
+ */
+void reset();
+
+/**
+ * @brief Switches between the manual clock (starting at 0) and the host's steady clock.
+ */
+void useManualClock(bool manual);
+
+/**
+ * @brief Moves the manual clock forward.
+ */
+void advanceMicros(uint64_t us);
+
+/**
+ * @brief Moves the manual clock forward.
+ */
+void advanceMillis(uint32_t ms);
+
+/**
+ * @brief Returns the simulated time in microseconds without wrapping.
+ */
+uint64_t nowMicros();
+
+/**
+ * @brief Simulates a deep sleep and the wake that follows it.
+ *
+ * Hal::rtcMicros() moves on by the sleep time. On the manual clock Hal::micros() and
+ * Hal::millis() start again from 0, as they do after a wake. HAL_RTC_DATA variables keep
+ * their contents.
+ */
+void deepSleep(uint64_t us);
+
+/**
+ * @brief Makes the RTC timer run fast (positive) or slow (negative) during deepSleep(), like
+ * the ESP32's RC slow clock does. 0, the default, keeps it exact.
+ */
+void setRtcDriftPpm(int32_t ppm);
+
+/**
+ * @brief Simulates a power-on reset: HAL_RTC_DATA variables are zeroed and Hal::rtcMicros()
+ * starts again from the current clock.
+ */
+void powerCycle();
+
+/**
+ * @brief Makes a pin's ADC channel read a fixed value.
+ */
+void setAnalogValue(uint8_t pin, int value);
+
+/**
+ * @brief Makes a pin's ADC channel read from a callback, e.g. a waveform with noise.
+ */
+void setAnalogSource(uint8_t pin, AnalogSource source);
+
+/**
+ * @brief Sets the simulated time one Hal::analogRead() takes on the manual clock.
+ */
+void setAnalogReadCost(uint32_t us);
+
+/**
+ * @brief Returns the number of Hal::analogRead() calls on a pin since reset().
+ */
+uint32_t getAnalogReadCount(uint8_t pin);
+
+/**
+ * @brief Makes Hal::adcStreamBegin() fail, as on a core without a continuous ADC driver.
+ */
+void setAdcStreamSupported(bool supported);
+
+/**
+ * @brief Checks whether a Hal::adcStreamBegin() stream is running.
+ */
+bool isAdcStreamRunning();
+
+/**
+ * @brief Returns the number of samples Hal::adcStreamRead() has handed out since reset().
+ */
+uint32_t getAdcStreamSampleCount();
+
+/**
+ * @brief Returns the number of samples overwritten before Hal::adcStreamRead() took them.
+ */
+uint32_t getAdcStreamDropCount();
+
+/**
+ * @brief Sets the pulses a device on the pin answers every armed capture with, e.g. a DHT
+ * frame. Empty, the default, is a line with nothing on it: reads time out.
+ *
+ * A capture ends once the pulses' total duration has passed since it was armed. On the manual
+ * clock Hal::pulseCaptureRead() advances the clock to that point, on the steady clock it sleeps.
+ */
+void setPulseResponse(uint8_t pin, const std::vector<Pulse>& pulses);
+
+/**
+ * @brief Sets how many pins can capture at once, 4 by default like the ESP32-S3's and C3's
+ * RMT receive channels.
+ */
+void setPulseCaptureChannels(size_t channels);
+
+/**
+ * @brief Returns the number of captures armed on a pin since reset().
+ */
+uint32_t getPulseCaptureCount(uint8_t pin);
+
+/**
+ * @brief Sets the level an input pin reads.
+ */
+void setDigitalInput(uint8_t pin, bool high);
+
+/**
+ * @brief Returns the last level written to a pin.
+ */
+bool getDigitalOutput(uint8_t pin);
+
+/**
+ * @brief Returns the mode a pin was last configured with.
+ */
+PinMode getPinMode(uint8_t pin);
+
+/**
+ * @brief Returns the number of tasks started with Hal::startTask() since reset().
+ */
+uint32_t getStartedTaskCount();
+
+/**
+ * @brief Suppresses or restores Hal::print() output, e.g. to keep benchmark logs readable.
+ */
+void setConsoleEnabled(bool enabled);
+
+} // namespace Sim
+} // namespace Hal
+
+#endif // ARDUINO
+
+#endif // HALSIM_H
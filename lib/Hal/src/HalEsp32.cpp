@@ -0,0 +1,307 @@
+#ifdef ARDUINO
+
+#include "Hal.h"
+#include <algorithm>
+
+#if __has_include(<esp_rtc_time.h>)
+#include <esp_rtc_time.h> // ESP-IDF 5
+#else
+#include <esp32/rtc.h>    // ESP-IDF 4
+#endif
+
+#if __has_include(<esp_adc/adc_continuous.h>)
+#include <esp_adc/adc_continuous.h> // ESP-IDF 5; on ESP-IDF 4 streams are unsupported
+#include <vector>
+#define HAL_ADC_STREAM 1
+#endif
+
+#if __has_include(<driver/rmt_rx.h>)
+#include <driver/gpio.h>
+#include <driver/rmt_rx.h> // ESP-IDF 5; on ESP-IDF 4 pulse captures are unsupported
+#include <freertos/queue.h>
+#include <mutex>
+#include <soc/soc_caps.h>
+#define HAL_PULSE_CAPTURE 1
+#endif
+
+namespace {
+
+// FreeRTOS tasks must not return, so the task body runs inside a wrapper that deletes the task
+struct TaskStart {
+    Hal::TaskFunction function;
+    void* parameters;
+};
+
+void runTask(void* start) {
+    TaskStart task = *static_cast<TaskStart*>(start);
+    delete static_cast<TaskStart*>(start);
+    task.function(task.parameters);
+    vTaskDelete(NULL);
+}
+
+#ifdef HAL_ADC_STREAM
+adc_continuous_handle_t adcStream = nullptr;
+std::vector<uint8_t> adcFrame; // One frame of raw driver output
+
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+const adc_digi_output_format_t adcFormat = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+inline uint16_t adcData(const adc_digi_output_data_t& result) { return result.type1.data; }
+#else
+const adc_digi_output_format_t adcFormat = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+inline uint16_t adcData(const adc_digi_output_data_t& result) { return result.type2.data; }
+#endif
+#endif
+
+#ifdef HAL_PULSE_CAPTURE
+// One RMT receive channel and the buffer its capture lands in
+struct PulseCapture {
+    uint8_t pin;
+    uint32_t idleUs;
+    rmt_channel_handle_t channel;
+    QueueHandle_t done;             // Receives the end of a capture from the RMT interrupt
+    rmt_symbol_word_t symbols[64];  // Two pulses each; a DHT frame takes 43
+};
+
+PulseCapture* pulseCaptures[SOC_RMT_RX_CANDIDATES_PER_GROUP] = {};
+std::mutex pulseCaptureLock; // Guards pulseCaptures; tasks on several pins start and end captures
+
+PulseCapture* pulseCaptureOf(uint8_t pin) {
+    std::lock_guard<std::mutex> guard(pulseCaptureLock);
+    for (PulseCapture* capture : pulseCaptures) {
+        if (capture != nullptr && capture->pin == pin) {
+            return capture;
+        }
+    }
+    return nullptr;
+}
+
+bool IRAM_ATTR onPulseCaptureDone(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t* event, void* context) {
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(static_cast<PulseCapture*>(context)->done, event, &woken);
+    return woken == pdTRUE;
+}
+#endif
+
+} // namespace
+
+namespace Hal {
+
+uint64_t rtcMicros() {
+    return esp_rtc_get_time_us();
+}
+
+#ifdef HAL_ADC_STREAM
+bool adcStreamBegin(uint8_t pin, uint32_t sampleRateHz, size_t frameSamples) {
+    adc_unit_t unit;
+    adc_channel_t channel;
+    if (adcStream != nullptr || adc_continuous_io_to_channel(pin, &unit, &channel) != ESP_OK || unit != ADC_UNIT_1) {
+        return false;
+    }
+
+    uint32_t frameBytes = static_cast<uint32_t>(frameSamples) * SOC_ADC_DIGI_RESULT_BYTES;
+    adc_continuous_handle_cfg_t handleConfig = {};
+    handleConfig.max_store_buf_size = frameBytes * 2; // One frame fills while the other is read
+    handleConfig.conv_frame_size = frameBytes;
+    if (adc_continuous_new_handle(&handleConfig, &adcStream) != ESP_OK) {
+        adcStream = nullptr;
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_12; // Full 0-3.3 V range, as analogRead() uses
+    pattern.channel = channel;
+    pattern.unit = unit;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    adc_continuous_config_t config = {};
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = sampleRateHz;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = adcFormat;
+    if (adc_continuous_config(adcStream, &config) != ESP_OK || adc_continuous_start(adcStream) != ESP_OK) {
+        adc_continuous_deinit(adcStream);
+        adcStream = nullptr;
+        return false;
+    }
+    adcFrame.resize(frameBytes);
+    return true;
+}
+
+size_t adcStreamRead(uint16_t* out, size_t capacity, uint32_t timeoutMs) {
+    if (adcStream == nullptr) {
+        return 0;
+    }
+    uint32_t maxBytes = static_cast<uint32_t>(std::min(capacity * SOC_ADC_DIGI_RESULT_BYTES, adcFrame.size()));
+    uint32_t length = 0;
+    if (adc_continuous_read(adcStream, adcFrame.data(), maxBytes, &length, timeoutMs) != ESP_OK) {
+        return 0;
+    }
+    size_t count = length / SOC_ADC_DIGI_RESULT_BYTES;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = adcData(*reinterpret_cast<const adc_digi_output_data_t*>(&adcFrame[i * SOC_ADC_DIGI_RESULT_BYTES]));
+    }
+    return count;
+}
+
+void adcStreamEnd() {
+    if (adcStream != nullptr) {
+        adc_continuous_stop(adcStream);
+        adc_continuous_deinit(adcStream);
+        adcStream = nullptr;
+    }
+}
+#else
+bool adcStreamBegin(uint8_t pin, uint32_t sampleRateHz, size_t frameSamples) {
+    return false;
+}
+
+size_t adcStreamRead(uint16_t* out, size_t capacity, uint32_t timeoutMs) {
+    return 0;
+}
+
+void adcStreamEnd() {}
+#endif
+
+#ifdef HAL_PULSE_CAPTURE
+bool pulseCaptureBegin(uint8_t pin, uint32_t idleUs) {
+    std::lock_guard<std::mutex> guard(pulseCaptureLock);
+    PulseCapture** slot = nullptr;
+    for (PulseCapture*& capture : pulseCaptures) {
+        if (capture != nullptr && capture->pin == pin) {
+            return false;
+        }
+        if (capture == nullptr && slot == nullptr) {
+            slot = &capture;
+        }
+    }
+    if (slot == nullptr) {
+        return false;
+    }
+    PulseCapture* capture = new PulseCapture{pin, idleUs, nullptr, xQueueCreate(1, sizeof(rmt_rx_done_event_data_t)), {}};
+
+    rmt_rx_channel_config_t config = {};
+    config.gpio_num = static_cast<gpio_num_t>(pin);
+    config.clk_src = RMT_CLK_SRC_DEFAULT;
+    config.resolution_hz = 1000000; // Durations in microseconds
+    config.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL;
+    rmt_rx_event_callbacks_t callbacks = {};
+    callbacks.on_recv_done = onPulseCaptureDone;
+    if (capture->done == nullptr || rmt_new_rx_channel(&config, &capture->channel) != ESP_OK) {
+        if (capture->done != nullptr) {
+            vQueueDelete(capture->done);
+        }
+        delete capture;
+        return false;
+    }
+    if (rmt_rx_register_event_callbacks(capture->channel, &callbacks, capture) != ESP_OK ||
+        rmt_enable(capture->channel) != ESP_OK) {
+        rmt_del_channel(capture->channel);
+        vQueueDelete(capture->done);
+        delete capture;
+        return false;
+    }
+
+    // Open drain, so the line can be driven low while the RMT keeps listening to it
+    gpio_set_pull_mode(config.gpio_num, GPIO_PULLUP_ONLY);
+    gpio_set_direction(config.gpio_num, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(config.gpio_num, 1);
+    *slot = capture;
+    return true;
+}
+
+void pulseCaptureLineLow(uint8_t pin) {
+    if (pulseCaptureOf(pin) != nullptr) {
+        gpio_set_level(static_cast<gpio_num_t>(pin), 0);
+    }
+}
+
+bool pulseCaptureArm(uint8_t pin) {
+    PulseCapture* capture = pulseCaptureOf(pin);
+    if (capture == nullptr) {
+        return false;
+    }
+    rmt_receive_config_t receive = {};
+    receive.signal_range_min_ns = 1000;                  // Ignore glitches shorter than 1 us
+    receive.signal_range_max_ns = capture->idleUs * 1000; // A level held this long ends the capture
+    xQueueReset(capture->done);
+    bool armed = rmt_receive(capture->channel, capture->symbols, sizeof(capture->symbols), &receive) == ESP_OK;
+    gpio_set_level(static_cast<gpio_num_t>(pin), 1); // Release the line; the device answers within 40 us
+    return armed;
+}
+
+size_t pulseCaptureRead(uint8_t pin, Pulse* out, size_t capacity, uint32_t timeoutMs) {
+    PulseCapture* capture = pulseCaptureOf(pin);
+    rmt_rx_done_event_data_t event;
+    if (capture == nullptr || xQueueReceive(capture->done, &event, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) {
+        if (capture != nullptr) {
+            rmt_disable(capture->channel); // Abort the capture so the channel can be armed again
+            rmt_enable(capture->channel);
+        }
+        return 0;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < event.num_symbols; ++i) {
+        const rmt_symbol_word_t& symbol = event.received_symbols[i];
+        if (symbol.duration0 == 0 || count == capacity) {
+            break;
+        }
+        out[count++] = Pulse{static_cast<uint16_t>(symbol.duration0), symbol.level0 != 0};
+        if (symbol.duration1 == 0 || count == capacity) {
+            break;
+        }
+        out[count++] = Pulse{static_cast<uint16_t>(symbol.duration1), symbol.level1 != 0};
+    }
+    return count;
+}
+
+void pulseCaptureEnd(uint8_t pin) {
+    std::lock_guard<std::mutex> guard(pulseCaptureLock);
+    for (PulseCapture*& capture : pulseCaptures) {
+        if (capture != nullptr && capture->pin == pin) {
+            rmt_disable(capture->channel);
+            rmt_del_channel(capture->channel);
+            vQueueDelete(capture->done);
+            delete capture;
+            capture = nullptr;
+            gpio_set_direction(static_cast<gpio_num_t>(pin), GPIO_MODE_INPUT);
+        }
+    }
+}
+#else
+bool pulseCaptureBegin(uint8_t pin, uint32_t idleUs) {
+    return false;
+}
+
+void pulseCaptureLineLow(uint8_t pin) {}
+
+bool pulseCaptureArm(uint8_t pin) {
+    return false;
+}
+
+size_t pulseCaptureRead(uint8_t pin, Pulse* out, size_t capacity, uint32_t timeoutMs) {
+    return 0;
+}
+
+void pulseCaptureEnd(uint8_t pin) {}
+#endif
+
+bool startTask(const char* name, TaskFunction function, void* parameters, uint32_t stackWords, unsigned priority) {
+    TaskStart* start = new TaskStart{function, parameters};
+    BaseType_t created = xTaskCreate(
+        runTask,       // Task function
+        name,          // Name of the task
+        stackWords,    // Stack size (in words)
+        start,         // Parameters to the task
+        priority,      // Priority
+        NULL           // Task handle
+    );
+    if (created != pdPASS) {
+        delete start;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Hal
+
+#endif // ARDUINO
@@ -0,0 +1,265 @@
+#ifndef ARDUINO
+
+#include "HalFS.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+HostLittleFS LittleFS;
+
+namespace {
+
+const char imageMagic[4] = {'H', 'F', 'S', '1'};
+
+void putU32(std::FILE* image, uint32_t value) {
+    uint8_t bytes[4] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+                        static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)};
+    std::fwrite(bytes, 1, sizeof(bytes), image);
+}
+
+bool getU32(std::FILE* image, uint32_t& value) {
+    uint8_t bytes[4];
+    if (std::fread(bytes, 1, sizeof(bytes), image) != sizeof(bytes)) {
+        return false;
+    }
+    value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool getString(std::FILE* image, std::string& value) {
+    uint32_t length;
+    if (!getU32(image, length)) {
+        return false;
+    }
+    value.resize(length);
+    return length == 0 || std::fread(&value[0], 1, length, image) == length;
+}
+
+} // namespace
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!data || !writable || size == 0) {
+        return 0;
+    }
+    if (appending) {
+        pos = data->size();
+    }
+    size_t end = pos + size;
+    if (end > data->size()) {
+        if (!owner->reserve(end - data->size())) {
+            return 0; // File system full
+        }
+        data->resize(end);
+    }
+    std::memcpy(data->data() + pos, buffer, size);
+    pos = end;
+    owner->stats.bytesWritten += size;
+    return size;
+}
+
+size_t File::print(const char* text) {
+    return write(reinterpret_cast<const uint8_t*>(text), std::strlen(text));
+}
+
+size_t File::println(const char* text) {
+    size_t written = print(text);
+    return written + print("\r\n");
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!data || pos >= data->size()) {
+        return 0;
+    }
+    size_t length = std::min(size, data->size() - pos);
+    std::memcpy(buffer, data->data() + pos, length);
+    pos += length;
+    owner->stats.bytesRead += length;
+    return length;
+}
+
+int File::read() {
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+int File::peek() {
+    return data && pos < data->size() ? (*data)[pos] : -1;
+}
+
+int File::available() {
+    return data && pos < data->size() ? static_cast<int>(data->size() - pos) : 0;
+}
+
+bool File::seek(uint32_t position) {
+    if (!data || position > data->size()) {
+        return false;
+    }
+    pos = position;
+    return true;
+}
+
+size_t File::size() const {
+    return data ? data->size() : 0;
+}
+
+void File::flush() {
+    if (data && writable) {
+        owner->stats.flushes++;
+    }
+}
+
+void File::close() {
+    flush();
+    data.reset();
+}
+
+bool HostLittleFS::format() {
+    std::lock_guard<std::mutex> guard(lock);
+    files.clear();
+    directories.clear();
+    return true;
+}
+
+File HostLittleFS::open(const char* path, const char* mode) {
+    std::lock_guard<std::mutex> guard(lock);
+    File file;
+    auto found = files.find(path);
+
+    if (mode[0] == 'r') {
+        if (found == files.end()) {
+            return file;
+        }
+        file.data = found->second;
+    } else if (mode[0] == 'w' || mode[0] == 'a') {
+        if (found == files.end() || mode[0] == 'w') {
+            file.data = std::make_shared<std::vector<uint8_t>>();
+            files[path] = file.data; // Truncating replaces the contents; open readers keep the old ones
+        } else {
+            file.data = found->second;
+        }
+        file.writable = true;
+        file.appending = mode[0] == 'a';
+        file.pos = mode[0] == 'a' ? file.data->size() : 0;
+    } else {
+        return file;
+    }
+
+    file.path = path;
+    file.owner = this;
+    stats.opens++;
+    return file;
+}
+
+bool HostLittleFS::exists(const char* path) {
+    std::lock_guard<std::mutex> guard(lock);
+    return files.count(path) > 0 ||
+           std::find(directories.begin(), directories.end(), path) != directories.end();
+}
+
+bool HostLittleFS::remove(const char* path) {
+    std::lock_guard<std::mutex> guard(lock);
+    return files.erase(path) > 0;
+}
+
+bool HostLittleFS::rename(const char* from, const char* to) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = files.find(from);
+    if (found == files.end()) {
+        return false;
+    }
+    std::shared_ptr<std::vector<uint8_t>> contents = found->second;
+    files.erase(found);
+    files[to] = contents;
+    return true;
+}
+
+bool HostLittleFS::mkdir(const char* path) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (std::find(directories.begin(), directories.end(), path) == directories.end()) {
+        directories.push_back(path);
+    }
+    return true;
+}
+
+bool HostLittleFS::rmdir(const char* path) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = std::find(directories.begin(), directories.end(), path);
+    if (found == directories.end()) {
+        return false;
+    }
+    directories.erase(found);
+    return true;
+}
+
+size_t HostLittleFS::usedBytes() {
+    std::lock_guard<std::mutex> guard(lock);
+    size_t total = 0;
+    for (const auto& entry : files) {
+        total += entry.second->size();
+    }
+    return total;
+}
+
+bool HostLittleFS::saveImage(const std::string& imagePath) {
+    std::FILE* image = std::fopen(imagePath.c_str(), "wb");
+    if (!image) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    std::fwrite(imageMagic, 1, sizeof(imageMagic), image);
+    putU32(image, static_cast<uint32_t>(directories.size()));
+    for (const std::string& directory : directories) {
+        putU32(image, static_cast<uint32_t>(directory.size()));
+        std::fwrite(directory.data(), 1, directory.size(), image);
+    }
+    putU32(image, static_cast<uint32_t>(files.size()));
+    for (const auto& entry : files) {
+        putU32(image, static_cast<uint32_t>(entry.first.size()));
+        std::fwrite(entry.first.data(), 1, entry.first.size(), image);
+        putU32(image, static_cast<uint32_t>(entry.second->size()));
+        std::fwrite(entry.second->data(), 1, entry.second->size(), image);
+    }
+    return std::fclose(image) == 0;
+}
+
+bool HostLittleFS::loadImage(const std::string& imagePath) {
+    std::FILE* image = std::fopen(imagePath.c_str(), "rb");
+    if (!image) {
+        return false;
+    }
+
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> loadedFiles;
+    std::vector<std::string> loadedDirectories;
+    char magic[sizeof(imageMagic)];
+    uint32_t count;
+    bool ok = std::fread(magic, 1, sizeof(magic), image) == sizeof(magic) &&
+              std::memcmp(magic, imageMagic, sizeof(magic)) == 0 && getU32(image, count);
+
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        std::string directory;
+        ok = getString(image, directory);
+        loadedDirectories.push_back(directory);
+    }
+    ok = ok && getU32(image, count);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        std::string path;
+        std::string contents;
+        ok = getString(image, path) && getString(image, contents);
+        loadedFiles[path] = std::make_shared<std::vector<uint8_t>>(contents.begin(), contents.end());
+    }
+    std::fclose(image);
+    if (!ok) {
+        return false; // Leave the current contents alone on a truncated image
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    files = std::move(loadedFiles);
+    directories = std::move(loadedDirectories);
+    return true;
+}
+
+bool HostLittleFS::reserve(size_t bytes) {
+    return usedBytes() + bytes <= capacity;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,510 @@
+#ifndef ARDUINO
+
+#include "Hal.h"
+#include "HalSim.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t pinCount = 64; // Covers the ESP32's 40 GPIOs with room to spare
+
+struct PinState {
+    Hal::Sim::AnalogSource source; // Computes ADC readings, or empty for analogValue
+    int analogValue = 0;
+    uint32_t analogReads = 0;
+    Hal::PinMode mode = Hal::PinMode::Input;
+    bool input = false;            // Level an input reads
+    bool output = false;           // Last level written
+    std::vector<Hal::Pulse> pulseResponse; // What a device on the pin answers a capture with
+    bool capturing = false;        // Prepared by pulseCaptureBegin()
+    bool captureArmed = false;
+    uint64_t captureEndUs = 0;     // When the armed capture ends
+    uint32_t captures = 0;
+};
+
+// A continuous ADC conversion, two frames deep like the ESP32's DMA buffer
+struct AdcStream {
+    bool running = false;
+    uint8_t pin = 0;
+    uint32_t sampleRateHz = 0;
+    size_t frameSamples = 0;
+    uint64_t startUs = 0;     // Manual clock time the stream started at
+    uint64_t nextSample = 0;  // Index of the next sample to hand out
+    uint32_t delivered = 0;
+    uint32_t dropped = 0;
+};
+
+const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+
+std::atomic<bool> manualClock{false};
+std::atomic<uint64_t> manualMicros{0};
+std::atomic<uint32_t> analogReadCost{0};
+std::atomic<uint32_t> startedTasks{0};
+std::atomic<bool> consoleEnabled{true};
+std::atomic<uint64_t> rtcBaseMicros{0}; // Added to nowMicros() to give the RTC time
+std::atomic<int32_t> rtcDriftPpm{0};
+std::atomic<std::thread::id> clockOwner{}; // Thread whose delays advance the manual clock
+
+std::mutex pinLock;
+PinState pins[pinCount];
+AdcStream adcStream;              // Guarded by pinLock
+bool adcStreamSupported = true;   // Guarded by pinLock
+size_t pulseCaptureChannels = 4;  // Guarded by pinLock
+
+} // namespace
+
+// Bounds of the HAL_RTC_DATA section, provided by the GNU linker; null when nothing uses it
+extern "C" char __start_hal_rtc_data[] __attribute__((weak));
+extern "C" char __stop_hal_rtc_data[] __attribute__((weak));
+
+namespace {
+
+uint64_t hostMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - hostStart).count());
+}
+
+// Delays on the thread that drives the manual clock advance it; other threads (tasks) keep
+// sleeping in host time so a background loop cannot race the simulated clock forward
+bool advancesClock() {
+    return manualClock.load(std::memory_order_acquire) &&
+           std::this_thread::get_id() == clockOwner.load(std::memory_order_relaxed);
+}
+
+// Samples of the stream whose frame has finished converting by nowUs; caller holds pinLock
+uint64_t completedSamples(const AdcStream& stream, uint64_t nowUs) {
+    uint64_t converted = (nowUs - stream.startUs) * stream.sampleRateHz / 1000000;
+    return converted / stream.frameSamples * stream.frameSamples;
+}
+
+int clampCount(int value) {
+    return value < 0 ? 0 : value > 4095 ? 4095 : value;
+}
+
+} // namespace
+
+namespace Hal {
+
+uint32_t millis() {
+    return static_cast<uint32_t>(Sim::nowMicros() / 1000);
+}
+
+uint32_t micros() {
+    return static_cast<uint32_t>(Sim::nowMicros());
+}
+
+uint64_t rtcMicros() {
+    return rtcBaseMicros.load(std::memory_order_relaxed) + Sim::nowMicros();
+}
+
+void delay(uint32_t ms) {
+    if (advancesClock()) {
+        Sim::advanceMicros(static_cast<uint64_t>(ms) * 1000);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    if (advancesClock()) {
+        Sim::advanceMicros(us);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+int analogRead(uint8_t pin) {
+    if (pin >= pinCount) {
+        return 0;
+    }
+    Sim::AnalogSource source;
+    int value;
+    {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].analogReads++;
+        source = pins[pin].source;
+        value = pins[pin].analogValue;
+    }
+    if (manualClock.load(std::memory_order_acquire)) {
+        Sim::advanceMicros(analogReadCost.load(std::memory_order_relaxed));
+    }
+    return source ? source(pin, Sim::nowMicros()) : value;
+}
+
+bool adcStreamBegin(uint8_t pin, uint32_t sampleRateHz, size_t frameSamples) {
+    if (pin >= pinCount || sampleRateHz == 0 || frameSamples == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    if (!adcStreamSupported || adcStream.running) {
+        return false;
+    }
+    uint32_t delivered = adcStream.delivered;
+    uint32_t dropped = adcStream.dropped;
+    adcStream = AdcStream{true, pin, sampleRateHz, frameSamples, Sim::nowMicros(), 0, delivered, dropped};
+    return true;
+}
+
+size_t adcStreamRead(uint16_t* out, size_t capacity, uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> guard(pinLock);
+    if (!adcStream.running || capacity == 0) {
+        return 0;
+    }
+    Sim::AnalogSource source = pins[adcStream.pin].source;
+    int value = pins[adcStream.pin].analogValue;
+    uint8_t pin = adcStream.pin;
+
+    if (!manualClock.load(std::memory_order_acquire)) {
+        // No conversion time on the steady clock: a frame is always ready
+        size_t count = capacity < adcStream.frameSamples ? capacity : adcStream.frameSamples;
+        adcStream.delivered += count;
+        guard.unlock();
+        uint64_t nowUs = Sim::nowMicros();
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<uint16_t>(clampCount(source ? source(pin, nowUs) : value));
+        }
+        return count;
+    }
+
+    uint64_t completed = completedSamples(adcStream, Sim::nowMicros());
+    if (completed == adcStream.nextSample && timeoutMs > 0 && advancesClock()) {
+        // Block until the next frame finishes, if that is within the timeout
+        uint64_t frameEnd = completed + adcStream.frameSamples;
+        uint64_t readyUs = adcStream.startUs + (frameEnd * 1000000 + adcStream.sampleRateHz - 1) / adcStream.sampleRateHz;
+        uint64_t waitUs = readyUs - Sim::nowMicros();
+        if (waitUs <= static_cast<uint64_t>(timeoutMs) * 1000) {
+            Sim::advanceMicros(waitUs);
+            completed = frameEnd;
+        }
+    }
+    uint64_t keep = 2 * adcStream.frameSamples;
+    if (completed - adcStream.nextSample > keep) {
+        adcStream.dropped += static_cast<uint32_t>(completed - keep - adcStream.nextSample);
+        adcStream.nextSample = completed - keep;
+    }
+    size_t count = static_cast<size_t>(std::min<uint64_t>(capacity, completed - adcStream.nextSample));
+    uint64_t first = adcStream.nextSample;
+    uint64_t startUs = adcStream.startUs;
+    uint32_t sampleRateHz = adcStream.sampleRateHz;
+    adcStream.nextSample += count;
+    adcStream.delivered += count;
+    guard.unlock();
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t sampleUs = startUs + (first + i + 1) * 1000000 / sampleRateHz;
+        out[i] = static_cast<uint16_t>(clampCount(source ? source(pin, sampleUs) : value));
+    }
+    return count;
+}
+
+void adcStreamEnd() {
+    std::lock_guard<std::mutex> guard(pinLock);
+    adcStream.running = false;
+}
+
+bool pulseCaptureBegin(uint8_t pin, uint32_t idleUs) {
+    (void)idleUs; // A simulated capture ends with its last pulse
+    if (pin >= pinCount) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    size_t used = std::count_if(std::begin(pins), std::end(pins), [](const PinState& state) { return state.capturing; });
+    if (pins[pin].capturing || used >= pulseCaptureChannels) {
+        return false;
+    }
+    pins[pin].capturing = true;
+    pins[pin].mode = PinMode::InputPullup;
+    pins[pin].output = true;
+    return true;
+}
+
+void pulseCaptureLineLow(uint8_t pin) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].output = false;
+    }
+}
+
+bool pulseCaptureArm(uint8_t pin) {
+    if (pin >= pinCount) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    PinState& state = pins[pin];
+    if (!state.capturing) {
+        return false;
+    }
+    uint64_t durationUs = 0;
+    for (const Pulse& pulse : state.pulseResponse) {
+        durationUs += pulse.us;
+    }
+    state.captureArmed = true;
+    state.captureEndUs = state.pulseResponse.empty() ? UINT64_MAX : Sim::nowMicros() + durationUs;
+    state.captures++;
+    state.output = true;
+    return true;
+}
+
+size_t pulseCaptureRead(uint8_t pin, Pulse* out, size_t capacity, uint32_t timeoutMs) {
+    if (pin >= pinCount) {
+        return 0;
+    }
+    std::vector<Pulse> response;
+    uint64_t endUs;
+    {
+        std::lock_guard<std::mutex> guard(pinLock);
+        if (!pins[pin].captureArmed) {
+            return 0;
+        }
+        pins[pin].captureArmed = false;
+        response = pins[pin].pulseResponse;
+        endUs = pins[pin].captureEndUs;
+    }
+
+    // Waiting for the capture: the manual clock advances, other threads sleep without using the CPU
+    uint64_t nowUs = Sim::nowMicros();
+    uint64_t waitUs = endUs > nowUs ? endUs - nowUs : 0;
+    if (waitUs > static_cast<uint64_t>(timeoutMs) * 1000) {
+        delay(timeoutMs);
+        return 0;
+    }
+    delayMicroseconds(static_cast<uint32_t>(waitUs));
+    size_t count = std::min(capacity, response.size());
+    std::copy(response.begin(), response.begin() + count, out);
+    return count;
+}
+
+void pulseCaptureEnd(uint8_t pin) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].capturing = false;
+        pins[pin].captureArmed = false;
+    }
+}
+
+void pinMode(uint8_t pin, PinMode mode) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].mode = mode;
+        pins[pin].input = mode == PinMode::InputPullup;
+    }
+}
+
+void digitalWrite(uint8_t pin, bool high) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].output = high;
+    }
+}
+
+bool digitalRead(uint8_t pin) {
+    if (pin >= pinCount) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    return pins[pin].mode == PinMode::Output ? pins[pin].output : pins[pin].input;
+}
+
+bool startTask(const char* name, TaskFunction function, void* parameters, uint32_t stackWords, unsigned priority) {
+    (void)name;
+    (void)stackWords;
+    (void)priority;
+    try {
+        std::thread(function, parameters).detach();
+    } catch (const std::system_error&) {
+        return false;
+    }
+    startedTasks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void print(const char* text) {
+    if (consoleEnabled.load(std::memory_order_relaxed)) {
+        std::fputs(text, stdout);
+    }
+}
+
+void println(const char* text) {
+    if (consoleEnabled.load(std::memory_order_relaxed)) {
+        std::fputs(text, stdout);
+        std::fputc('\n', stdout);
+    }
+}
+
+namespace Sim {
+
+void reset() {
+    {
+        std::lock_guard<std::mutex> guard(pinLock);
+        for (PinState& pin : pins) {
+            pin = PinState();
+        }
+        adcStream = AdcStream();
+        adcStreamSupported = true;
+        pulseCaptureChannels = 4;
+    }
+    manualClock.store(false, std::memory_order_release);
+    manualMicros.store(0, std::memory_order_relaxed);
+    analogReadCost.store(0, std::memory_order_relaxed);
+    startedTasks.store(0, std::memory_order_relaxed);
+    consoleEnabled.store(true, std::memory_order_relaxed);
+    rtcBaseMicros.store(0, std::memory_order_relaxed);
+    rtcDriftPpm.store(0, std::memory_order_relaxed);
+}
+
+void useManualClock(bool manual) {
+    clockOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    manualMicros.store(0, std::memory_order_relaxed);
+    manualClock.store(manual, std::memory_order_release);
+}
+
+void advanceMicros(uint64_t us) {
+    manualMicros.fetch_add(us, std::memory_order_relaxed);
+}
+
+void advanceMillis(uint32_t ms) {
+    advanceMicros(static_cast<uint64_t>(ms) * 1000);
+}
+
+uint64_t nowMicros() {
+    if (manualClock.load(std::memory_order_acquire)) {
+        return manualMicros.load(std::memory_order_relaxed);
+    }
+    return hostMicros();
+}
+
+void deepSleep(uint64_t us) {
+    uint64_t rtcUs = us + static_cast<int64_t>(us) * rtcDriftPpm.load(std::memory_order_relaxed) / 1000000;
+    if (manualClock.load(std::memory_order_acquire)) {
+        rtcBaseMicros.fetch_add(manualMicros.exchange(0, std::memory_order_relaxed) + rtcUs, std::memory_order_relaxed);
+        return;
+    }
+    rtcBaseMicros.fetch_add(rtcUs, std::memory_order_relaxed); // The host clock cannot restart
+}
+
+void setRtcDriftPpm(int32_t ppm) {
+    rtcDriftPpm.store(ppm, std::memory_order_relaxed);
+}
+
+void powerCycle() {
+    if (__start_hal_rtc_data != nullptr && __stop_hal_rtc_data != nullptr) {
+        std::memset(__start_hal_rtc_data, 0, __stop_hal_rtc_data - __start_hal_rtc_data);
+    }
+    if (manualClock.load(std::memory_order_acquire)) {
+        manualMicros.store(0, std::memory_order_relaxed);
+        rtcBaseMicros.store(0, std::memory_order_relaxed);
+        return;
+    }
+    rtcBaseMicros.store(static_cast<uint64_t>(0) - hostMicros(), std::memory_order_relaxed); // Wraps to restart at 0
+}
+
+void setAnalogValue(uint8_t pin, int value) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].source = nullptr;
+        pins[pin].analogValue = value;
+    }
+}
+
+void setAnalogSource(uint8_t pin, AnalogSource source) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].source = std::move(source);
+    }
+}
+
+void setAnalogReadCost(uint32_t us) {
+    analogReadCost.store(us, std::memory_order_relaxed);
+}
+
+uint32_t getAnalogReadCount(uint8_t pin) {
+    if (pin >= pinCount) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    return pins[pin].analogReads;
+}
+
+void setAdcStreamSupported(bool supported) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    adcStreamSupported = supported;
+}
+
+bool isAdcStreamRunning() {
+    std::lock_guard<std::mutex> guard(pinLock);
+    return adcStream.running;
+}
+
+uint32_t getAdcStreamSampleCount() {
+    std::lock_guard<std::mutex> guard(pinLock);
+    return adcStream.delivered;
+}
+
+uint32_t getAdcStreamDropCount() {
+    std::lock_guard<std::mutex> guard(pinLock);
+    return adcStream.dropped;
+}
+
+void setPulseResponse(uint8_t pin, const std::vector<Pulse>& pulses) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].pulseResponse = pulses;
+    }
+}
+
+void setPulseCaptureChannels(size_t channels) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    pulseCaptureChannels = channels;
+}
+
+uint32_t getPulseCaptureCount(uint8_t pin) {
+    if (pin >= pinCount) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    return pins[pin].captures;
+}
+
+void setDigitalInput(uint8_t pin, bool high) {
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> guard(pinLock);
+        pins[pin].input = high;
+    }
+}
+
+bool getDigitalOutput(uint8_t pin) {
+    if (pin >= pinCount) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    return pins[pin].output;
+}
+
+PinMode getPinMode(uint8_t pin) {
+    if (pin >= pinCount) {
+        return PinMode::Input;
+    }
+    std::lock_guard<std::mutex> guard(pinLock);
+    return pins[pin].mode;
+}
+
+uint32_t getStartedTaskCount() {
+    return startedTasks.load(std::memory_order_relaxed);
+}
+
+void setConsoleEnabled(bool enabled) {
+    consoleEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+} // namespace Sim
+} // namespace Hal
+
+#endif // ARDUINO
@@ -1,6 +1,8 @@
 #ifndef LOGHANDLER_H
 #define LOGHANDLER_H
 
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <functional>
 #include "Logger.h"
@@ -20,9 +22,9 @@ public:
      * @brief Constructs a LogHandler instance.
      * 
      * @param writeFunc The function or callable to handle writing logs.
-     * @param minLevel The minimum log level to process. Defaults to Logger::LogLevel::INFO.
+     * @param minLevel The minimum log level to process. Defaults to LogLevel::INFO.
      */
-    explicit LogHandler(WriteFunc writeFunc, Logger::LogLevel minLevel = Logger::LogLevel::INFO)
+    explicit LogHandler(WriteFunc writeFunc, LogLevel minLevel = LogLevel::INFO)
         : writeFunction(writeFunc), minLogLevel(minLevel) {}
 
     /**
@@ -33,12 +35,41 @@ public:
     /**
      * @brief Processes a log message if the log level meets or exceeds the minimum level.
      * 
+     * Formatted messages longer than LOGGER_RENDER_BUFFER_SIZE - 1 characters are cut and end
+     * in truncationMark.
+     * 
      * @param level The log level of the message.
      * @param message The log message to process.
      */
-    void handleLog(Logger::LogLevel level, const std::string& message) {
+    void handleLog(LogLevel level, const std::string& message) {
         if (shouldLog(level)) {
-            std::string formattedMessage = "[" + Logger::logLevelToString(level) + "] " + message;
+            char formattedMessage[LOGGER_RENDER_BUFFER_SIZE];
+            int length = snprintf(formattedMessage, sizeof(formattedMessage), "[%s] %s", logLevelName(level), message.c_str());
+            if (length >= static_cast<int>(sizeof(formattedMessage))) {
+                markTruncated(formattedMessage);
+            }
+            writeFunction(formattedMessage);
+        }
+    }
+
+    /**
+     * @brief Processes a structured log record if its level meets or exceeds the minimum level.
+     * 
+     * The record is only rendered once it passes the level check, into a stack buffer, so a
+     * WriteFunc that accepts `const char*` handles the record without any heap allocation.
+     * Like handleLog(), it marks a message that had to be cut.
+     * 
+     * @param record The log record to process.
+     */
+    void handleRecord(const LogRecord& record) {
+        if (shouldLog(record.getLevel())) {
+            // One byte over the limit, so a message that does not fit fills it and shows it was cut
+            char formattedMessage[LOGGER_RENDER_BUFFER_SIZE + 1];
+            int prefixLength = snprintf(formattedMessage, sizeof(formattedMessage), "[%s] ", logLevelName(record.getLevel()));
+            size_t length = prefixLength + record.render(formattedMessage + prefixLength, sizeof(formattedMessage) - prefixLength);
+            if (length >= LOGGER_RENDER_BUFFER_SIZE) {
+                markTruncated(formattedMessage);
+            }
             writeFunction(formattedMessage);
         }
     }
@@ -48,7 +79,7 @@ public:
      * 
      * @param level The new minimum log level to set.
      */
-    void setMinLogLevel(Logger::LogLevel level) {
+    void setMinLogLevel(LogLevel level) {
         minLogLevel = level;
     }
 
@@ -57,13 +88,18 @@ public:
      * 
      * @return The current minimum log level.
      */
-    Logger::LogLevel getMinLogLevel() const {
+    LogLevel getMinLogLevel() const {
         return minLogLevel;
     }
 
+    /**
+     * @brief Ending of a formatted message that was cut to LOGGER_RENDER_BUFFER_SIZE - 1 characters.
+     */
+    static constexpr const char* truncationMark = "...";
+
 private:
     WriteFunc writeFunction;  /**< The callable function to handle log output. */
-    Logger::LogLevel minLogLevel;  /**< The minimum log level to process messages. */
+    LogLevel minLogLevel;  /**< The minimum log level to process messages. */
 
     /**
      * @brief Determines if the log level is allowed to be processed.
@@ -71,9 +107,20 @@ private:
      * @param level The log level to check.
      * @return True if the log level is greater than or equal to the minimum log level.
      */
-    bool shouldLog(Logger::LogLevel level) const {
+    bool shouldLog(LogLevel level) const {
         return level >= minLogLevel;
     }
+
+    /**
+     * @brief Ends a message at LOGGER_RENDER_BUFFER_SIZE - 1 characters with truncationMark.
+     * 
+     * @param message A buffer of at least LOGGER_RENDER_BUFFER_SIZE bytes holding the cut message.
+     */
+    static void markTruncated(char* message) {
+        size_t markLength = std::strlen(truncationMark);
+        std::memcpy(message + LOGGER_RENDER_BUFFER_SIZE - 1 - markLength, truncationMark, markLength);
+        message[LOGGER_RENDER_BUFFER_SIZE - 1] = '\0';
+    }
 };
 
 #endif // LOGHANDLER_H
@@ -1,8 +1,20 @@
 #ifndef LOGLEVEL_H
 #define LOGLEVEL_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+/**
+ * @brief Lowest log level compiled into the firmware.
+ * 
+ * Set through build flags, e.g. `-DLOGGER_MIN_LEVEL=2` to drop SETUP and INFO messages.
+ * Values follow the LogLevel order: 0 SETUP, 1 INFO, 2 WARNING, 3 ERROR, 4 CRITICAL.
+ */
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 0
+#endif
+
 /**
  * @brief Enum for standard log levels.
  */
@@ -14,6 +26,36 @@ enum class LogLevel {
     CRITICAL
 };
 
+/**
+ * @brief Number of values in LogLevel.
+ */
+constexpr size_t logLevelCount = 5;
+
+/**
+ * @brief Builds a bit mask with one bit set for each level at or above a minimum level.
+ * 
+ * @param minLevel The lowest level to include.
+ * @return The mask, where bit N stands for the LogLevel with value N.
+ */
+constexpr uint8_t logLevelMaskFrom(LogLevel minLevel) {
+    return static_cast<uint8_t>((0xFFu << static_cast<unsigned>(minLevel)) & ((1u << logLevelCount) - 1));
+}
+
+/**
+ * @brief The compile-time minimum log level, taken from LOGGER_MIN_LEVEL.
+ */
+constexpr LogLevel compiledMinLogLevel = static_cast<LogLevel>(LOGGER_MIN_LEVEL);
+
+/**
+ * @brief Checks whether messages at a level are compiled in at all.
+ * 
+ * @param level The log level to check.
+ * @return True if the level is at or above LOGGER_MIN_LEVEL.
+ */
+constexpr bool isLogLevelCompiledIn(LogLevel level) {
+    return level >= compiledMinLogLevel;
+}
+
 /**
  * @brief Converts a LogLevel to its string representation.
  * 
@@ -31,4 +73,21 @@ inline std::string logLevelToString(LogLevel level) {
     }
 }
 
+/**
+ * @brief Returns the name of a LogLevel without allocating.
+ * 
+ * @param level The log level to convert.
+ * @return A static string naming the log level.
+ */
+constexpr const char* logLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::SETUP: return "SETUP";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARNING: return "WARNING";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::CRITICAL: return "CRITICAL";
+        default: return "UNKNOWN";
+    }
+}
+
 #endif // LOGLEVEL_H
\ No newline at end of file
@@ -0,0 +1,193 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include "LogLevel.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#ifndef LOGGER_RECORD_ARG_BYTES
+#define LOGGER_RECORD_ARG_BYTES 96 /**< Bytes of packed argument storage per record. */
+#endif
+
+#ifndef LOGGER_RENDER_BUFFER_SIZE
+#define LOGGER_RENDER_BUFFER_SIZE 192 /**< Stack buffer used when a record is rendered to text. */
+#endif
+
+/**
+ * @brief A structured log message: a format string plus typed, packed arguments.
+ *
+ * The format string is a literal using `{}` placeholders, and its address doubles as the
+ * message id. Arguments are copied into a fixed buffer inside the record, so building a
+ * record never touches the heap. Text is only produced when a handler calls render().
+ *
+ * Example:
+ * @code
+ * LogRecord record = LogRecord::make(LogLevel::INFO, "File read successfully: {}", path);
+ * @endcode
+ */
+class LogRecord {
+public:
+    /**
+     * @brief Type tags stored in front of each packed argument.
+     */
+    enum class ArgType : uint8_t {
+        Int32,
+        UInt32,
+        Int64,
+        UInt64,
+        Float,
+        Double,
+        Bool,
+        Str
+    };
+
+    LogRecord() : LogRecord(LogLevel::INFO, "") {}
+
+    LogRecord(LogLevel level, const char* format)
+        : level(level), format(format), argBytes(0), argCount(0), truncated(false) {}
+
+    /**
+     * @brief Builds a record from a format string and its arguments.
+     *
+     * Supported argument types are integers, floating point values, bools, C strings and
+     * std::string. Strings are copied, truncated to the space left in the record.
+     *
+     * @param level The severity level of the message.
+     * @param format A string literal with one `{}` placeholder per argument.
+     * @param args The values to substitute.
+     * @return The packed record.
+     */
+    template <typename... Args>
+    static LogRecord make(LogLevel level, const char* format, const Args&... args) {
+        LogRecord record(level, format);
+        (record.add(args), ...);
+        return record;
+    }
+
+    /**
+     * @brief Appends one argument to the record.
+     */
+    template <typename T>
+    void add(const T& value) {
+        if constexpr (std::is_same<T, bool>::value) {
+            uint8_t flag = value ? 1 : 0;
+            pack(ArgType::Bool, &flag, sizeof(flag));
+        } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+            addInteger(value);
+        } else if constexpr (std::is_floating_point<T>::value) {
+            if constexpr (sizeof(T) <= sizeof(float)) {
+                float number = value;
+                pack(ArgType::Float, &number, sizeof(number));
+            } else {
+                double number = static_cast<double>(value);
+                pack(ArgType::Double, &number, sizeof(number));
+            }
+        } else if constexpr (std::is_convertible<const T&, const char*>::value) {
+            const char* text = value;
+            addString(text, text ? std::strlen(text) : 0);
+        } else {
+            static_assert(std::is_same<T, std::string>::value, "Unsupported LogRecord argument type");
+            addString(value.data(), value.size());
+        }
+    }
+
+    /**
+     * @brief Formats the record into a caller-provided buffer.
+     *
+     * The output is always NUL-terminated and truncated to fit the buffer.
+     *
+     * @param buffer The destination buffer.
+     * @param size The size of the destination buffer in bytes.
+     * @return The number of characters written, excluding the terminator.
+     */
+    size_t render(char* buffer, size_t size) const;
+
+    /**
+     * @brief Formats the record into a std::string.
+     *
+     * Reuses the string's existing capacity, so a long-lived string does not reallocate.
+     * Output longer than LOGGER_RENDER_BUFFER_SIZE - 1 characters is truncated.
+     */
+    void renderTo(std::string& out) const;
+
+    LogLevel getLevel() const { return level; }
+    const char* getFormat() const { return format; }
+    uint8_t getArgCount() const { return argCount; }
+    bool isTruncated() const { return truncated; }
+
+    /**
+     * @brief Returns the packed argument bytes (type tag followed by value, per argument).
+     */
+    const uint8_t* getArgData() const { return args; }
+    size_t getArgDataSize() const { return argBytes; }
+
+private:
+    template <typename T>
+    void addInteger(T value) {
+        using Raw = typename std::conditional<std::is_enum<T>::value, int32_t, T>::type;
+        Raw raw = static_cast<Raw>(value);
+        if constexpr (std::is_signed<Raw>::value) {
+            if constexpr (sizeof(Raw) <= sizeof(int32_t)) {
+                int32_t number = raw;
+                pack(ArgType::Int32, &number, sizeof(number));
+            } else {
+                int64_t number = raw;
+                pack(ArgType::Int64, &number, sizeof(number));
+            }
+        } else {
+            if constexpr (sizeof(Raw) <= sizeof(uint32_t)) {
+                uint32_t number = raw;
+                pack(ArgType::UInt32, &number, sizeof(number));
+            } else {
+                uint64_t number = raw;
+                pack(ArgType::UInt64, &number, sizeof(number));
+            }
+        }
+    }
+
+    void pack(ArgType type, const void* value, size_t size) {
+        if (argBytes + 1 + size > sizeof(args)) {
+            truncated = true; // No room left for this argument
+            return;
+        }
+        args[argBytes++] = static_cast<uint8_t>(type);
+        std::memcpy(args + argBytes, value, size);
+        argBytes += static_cast<uint8_t>(size);
+        ++argCount;
+    }
+
+    void addString(const char* text, size_t length) {
+        size_t room = sizeof(args) - argBytes;
+        if (room < 2) {
+            truncated = true;
+            return;
+        }
+        size_t maxLength = room - 2; // Type tag and length byte
+        if (maxLength > UINT8_MAX) {
+            maxLength = UINT8_MAX;
+        }
+        if (length > maxLength) {
+            length = maxLength;
+            truncated = true;
+        }
+        args[argBytes++] = static_cast<uint8_t>(ArgType::Str);
+        args[argBytes++] = static_cast<uint8_t>(length);
+        std::memcpy(args + argBytes, text, length);
+        argBytes += static_cast<uint8_t>(length);
+        ++argCount;
+    }
+
+    LogLevel level;                         /**< The severity level of the message. */
+    const char* format;                     /**< The format string, also used as the message id. */
+    uint8_t argBytes;                       /**< Bytes of args in use. */
+    uint8_t argCount;                       /**< Number of packed arguments. */
+    bool truncated;                         /**< True if an argument did not fit. */
+    uint8_t args[LOGGER_RECORD_ARG_BYTES];  /**< Packed argument storage. */
+
+    static_assert(LOGGER_RECORD_ARG_BYTES <= UINT8_MAX, "LOGGER_RECORD_ARG_BYTES must fit in a uint8_t");
+};
+
+#endif // LOGRECORD_H
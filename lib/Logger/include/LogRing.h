@@ -0,0 +1,148 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded lock-free ring buffer for fixed-size log records.
+ *
+ * All slots are preallocated, so pushing a record never touches the heap. Any number
+ * of producers may push concurrently; pops are meant to be made by one consumer at a
+ * time (the Logger drain task). Each slot carries a sequence number that tells producers
+ * and the consumer whether the slot is free or holds a published record.
+ *
+ * When the ring is full, the push fails immediately and is counted as an overrun, so
+ * producers never block on a slow consumer.
+ *
+ * @tparam T The record type. It must be trivially copyable.
+ * @tparam Capacity The number of slots. It must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class LogRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "LogRing capacity must be a power of two");
+
+public:
+    /**
+     * @brief Constructs an empty ring.
+     */
+    LogRing() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    /**
+     * @brief Copies a record into the next free slot.
+     *
+     * @param record The record to enqueue.
+     * @return True if the record was enqueued, false if the ring was full.
+     */
+    bool tryPush(const T& record) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (Capacity - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = record;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    pushCount.fetch_add(1, std::memory_order_relaxed);
+                    // Other producers and the consumer may have moved tail past this slot meanwhile
+                    intptr_t depth = static_cast<intptr_t>(pos + 1 - tail.load(std::memory_order_relaxed));
+                    updateHighWater(depth > 0 ? static_cast<size_t>(depth) : 0);
+                    return true;
+                }
+            } else if (diff < 0) {
+                overrunCount.fetch_add(1, std::memory_order_relaxed);
+                return false; // Ring is full
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Moves the oldest published record out of the ring.
+     *
+     * @param record Receives the record.
+     * @return True if a record was popped, false if the ring was empty.
+     */
+    bool tryPop(T& record) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (Capacity - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    record = slot.value;
+                    slot.sequence.store(pos + Capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Ring is empty
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns an approximate count of records waiting to be popped.
+     */
+    size_t size() const {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_relaxed);
+        return h - t;
+    }
+
+    /**
+     * @brief Returns the number of slots in the ring.
+     */
+    static constexpr size_t capacity() { return Capacity; }
+
+    uint32_t getPushCount() const { return pushCount.load(std::memory_order_relaxed); }
+    uint32_t getOverrunCount() const { return overrunCount.load(std::memory_order_relaxed); }
+    uint32_t getHighWater() const { return highWater.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Resets the push, overrun, and high-water counters.
+     */
+    void resetCounters() {
+        pushCount.store(0, std::memory_order_relaxed);
+        overrunCount.store(0, std::memory_order_relaxed);
+        highWater.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence; /**< Publication state of the slot. */
+        T value;                      /**< The stored record. */
+    };
+
+    void updateHighWater(size_t depth) {
+        uint32_t current = highWater.load(std::memory_order_relaxed);
+        while (depth > current &&
+               !highWater.compare_exchange_weak(current, static_cast<uint32_t>(depth),
+                                                std::memory_order_relaxed)) {
+        }
+    }
+
+    Slot slots[Capacity];                    /**< Preallocated record storage. */
+    alignas(64) std::atomic<size_t> head{0}; /**< Next position to claim for a push. */
+    alignas(64) std::atomic<size_t> tail{0}; /**< Next position to pop from. */
+    std::atomic<uint32_t> pushCount{0};      /**< Records successfully enqueued. */
+    std::atomic<uint32_t> overrunCount{0};   /**< Pushes rejected because the ring was full. */
+    std::atomic<uint32_t> highWater{0};      /**< Deepest observed fill level. */
+};
+
+#endif // LOGRING_H
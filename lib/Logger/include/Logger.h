@@ -2,10 +2,21 @@
 #define LOGGER_H
 
 #include "LogLevel.h"
+#include "LogRecord.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <functional>
 #include <string>
 
+#ifndef LOGGER_RING_CAPACITY
+#define LOGGER_RING_CAPACITY 64 /**< Records held by the async ring. Must be a power of two. */
+#endif
+
+#ifndef LOGGER_DRAIN_BATCH_SIZE
+#define LOGGER_DRAIN_BATCH_SIZE 16 /**< Records the drain task dispatches per batch. */
+#endif
+
 /**
  * @brief A global logger for managing and routing log messages.
  * 
@@ -24,16 +35,86 @@ public:
      */
     using LogHandler = std::function<void(LogLevel, const std::string&)>;
 
+    /**
+     * @brief A callable type for structured log handlers.
+     * 
+     * Record handlers receive the packed LogRecord and decide themselves whether, and where,
+     * to render it as text. Handlers that only forward or store records never format anything.
+     */
+    using RecordHandler = std::function<void(const LogRecord&)>;
+
+    /**
+     * @brief Counters describing the asynchronous logging pipeline.
+     */
+    struct AsyncStats {
+        uint32_t enqueued;   /**< Records written into the ring. */
+        uint32_t dispatched; /**< Records delivered to the handlers by the drain. */
+        uint32_t overruns;   /**< Records dropped because the ring was full. */
+        uint32_t truncated;  /**< Records with an argument that did not fit in the record. */
+        uint32_t highWater;  /**< Deepest observed ring fill level. */
+    };
+
     /**
      * @brief Adds a log handler to the logger.
      * 
      * Handlers process log messages and route them to a specific backend (e.g., file system, serial, network).
+     * The logger only calls a handler for messages at or above its minimum level, so handlers
+     * do not need to filter messages themselves.
+     * 
+     * Handlers should be registered before asynchronous mode is started, since the drain
+     * task reads the handler list without locking.
+     * 
+     * @param handlerId A unique ID used to update or remove the handler later.
+     * @param handler A callable object that processes log messages.
+     * @param minLevel The lowest level delivered to this handler. Default is LogLevel::SETUP.
+     * @param priority The priority of the handler (higher priorities execute first). Default is 0.
+     * @return False if a handler with the same ID is already registered.
+     */
+    static bool addHandler(const std::string& handlerId, LogHandler handler,
+                           LogLevel minLevel = LogLevel::SETUP, int priority = 0);
+
+    /**
+     * @brief Adds a log handler under a generated ID that receives every level.
      * 
      * @param handler A callable object that processes log messages.
      * @param priority The priority of the handler (higher priorities execute first). Default is 0.
      */
     static void addHandler(LogHandler handler, int priority = 0);
 
+    /**
+     * @brief Adds a structured log handler to the logger.
+     * 
+     * @param handlerId A unique ID used to update or remove the handler later.
+     * @param handler A callable object that processes log records.
+     * @param minLevel The lowest level delivered to this handler. Default is LogLevel::SETUP.
+     * @param priority The priority of the handler (higher priorities execute first). Default is 0.
+     * @return False if a handler with the same ID is already registered.
+     */
+    static bool addRecordHandler(const std::string& handlerId, RecordHandler handler,
+                                 LogLevel minLevel = LogLevel::SETUP, int priority = 0);
+
+    /**
+     * @brief Adds a structured log handler under a generated ID that receives every level.
+     * 
+     * @param handler A callable object that processes log records.
+     * @param priority The priority of the handler (higher priorities execute first). Default is 0.
+     */
+    static void addRecordHandler(RecordHandler handler, int priority = 0);
+
+    /**
+     * @brief Changes the minimum level delivered to a registered handler.
+     * 
+     * @param handlerId The ID of the handler to update.
+     * @param minLevel The new lowest level delivered to the handler.
+     * @return False if no handler with that ID is registered.
+     */
+    static bool setHandlerLevel(const std::string& handlerId, LogLevel minLevel);
+
+    /**
+     * @brief Returns the number of registered handlers.
+     */
+    static size_t getHandlerCount();
+
     /**
      * @brief Removes a log handler by its unique ID.
      * 
@@ -44,17 +125,82 @@ public:
      */
     static void removeHandler(const std::string& handlerId);
 
+    /**
+     * @brief Removes every registered handler.
+     */
+    static void clearHandlers();
+
     /**
      * @brief Logs a message to all registered handlers.
      * 
      * Messages are filtered based on the global log level. Only messages with a severity
      * level greater than or equal to the global log level are processed by the handlers.
      * 
+     * In asynchronous mode the message is copied into a fixed-size ring slot and the call
+     * returns without running any handler. Messages longer than LOGGER_RECORD_ARG_BYTES - 2
+     * bytes are truncated, and messages logged while the ring is full are dropped and counted.
+     * 
      * @param level The severity level of the log message.
      * @param message The content of the log message.
      */
     static void log(LogLevel level, const std::string& message);
 
+    /**
+     * @brief Logs a structured record to all registered handlers.
+     * 
+     * Text handlers receive the record rendered once into a reused buffer; record handlers
+     * receive it unformatted. Filtering and async behaviour match log(LogLevel, const std::string&).
+     * 
+     * @param record The record to log.
+     */
+    static void log(const LogRecord& record);
+
+    /**
+     * @brief Logs a format string with typed arguments without building a std::string.
+     * 
+     * The arguments are only packed if the level passes the global filter.
+     * 
+     * @param level The severity level of the log message.
+     * @param format A string literal with one `{}` placeholder per argument.
+     * @param args The values to substitute.
+     */
+    template <typename... Args>
+    static void logf(LogLevel level, const char* format, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        log(LogRecord::make(level, format, args...));
+    }
+
+    /**
+     * @brief Logs a format string at a level fixed at compile time.
+     * 
+     * Calls below LOGGER_MIN_LEVEL compile to nothing. Note that the arguments are still
+     * evaluated by the caller; use the LOG_* macros to skip their evaluation as well.
+     * 
+     * @tparam Level The severity level of the log message.
+     * @param format A string literal with one `{}` placeholder per argument.
+     * @param args The values to substitute.
+     */
+    template <LogLevel Level, typename... Args>
+    static void logf(const char* format, const Args&... args) {
+        if constexpr (isLogLevelCompiledIn(Level)) {
+            logf(Level, format, args...);
+        }
+    }
+
+    /**
+     * @brief Checks whether a message at a level would reach the handlers.
+     * 
+     * @param level The log level to check.
+     * @return True if the level is compiled in, passes the global log level, and at least
+     *         one registered handler accepts it.
+     */
+    static bool isEnabled(LogLevel level) {
+        return isLogLevelCompiledIn(level) && level >= globalLogLevel &&
+               (activeLevelMask & (1u << static_cast<unsigned>(level))) != 0;
+    }
+
     /**
      * @brief Sets the global log level.
      * 
@@ -68,32 +214,126 @@ public:
     /**
      * @brief Flushes all registered handlers.
      * 
-     * This method is a placeholder for handlers that support flushing, such as file-based handlers
-     * that may need to persist buffered logs to disk.
+     * In asynchronous mode this delivers every queued record to the handlers on the calling
+     * thread, which should be done before deep sleep so no records are lost.
      */
     static void flush();
 
+    /**
+     * @brief Switches the logger to asynchronous mode and starts the drain task.
+     * 
+     * On the ESP32 the drain runs as a FreeRTOS task; on the host it runs on a std::thread.
+     * 
+     * @param drainIntervalMs How long the drain task sleeps once the ring is empty.
+     * @return True if the drain task was started or was already running.
+     */
+    static bool startAsync(uint32_t drainIntervalMs = 10);
+
+    /**
+     * @brief Stops the drain task and returns to inline dispatch.
+     * 
+     * Records still in the ring are delivered before this returns.
+     */
+    static void stopAsync();
+
+    /**
+     * @brief Checks whether the logger is in asynchronous mode.
+     */
+    static bool isAsync();
+
+    /**
+     * @brief Delivers queued records to the handlers on the calling thread.
+     * 
+     * Only one caller drains at a time; concurrent callers return 0 immediately.
+     * 
+     * @param maxRecords The maximum number of records to deliver.
+     * @return The number of records delivered.
+     */
+    static size_t drain(size_t maxRecords = SIZE_MAX);
+
+    /**
+     * @brief Returns the asynchronous pipeline counters.
+     */
+    static AsyncStats getAsyncStats();
+
+    /**
+     * @brief Resets the asynchronous pipeline counters.
+     */
+    static void resetAsyncStats();
+
 private:
     /**
      * @brief A wrapper for log handlers with metadata.
      * 
-     * Each handler is stored with a unique ID and a priority to determine its execution order.
+     * Each handler is stored with a unique ID, a priority to determine its execution order,
+     * and a mask of the levels it accepts.
      */
     struct HandlerWrapper {
-        LogHandler handler; /**< The log handler function. */
+        LogHandler handler; /**< The text log handler function, if this is a text handler. */
+        RecordHandler recordHandler; /**< The record handler function, if this is a record handler. */
         std::string id;     /**< A unique identifier for the handler. */
         int priority;       /**< The priority of the handler (higher values are executed first). */
+        uint8_t levelMask;  /**< Bit N set if the handler accepts the LogLevel with value N. */
     };
 
     static LogLevel globalLogLevel; /**< The global log level filter. */
     static std::vector<HandlerWrapper> handlers; /**< A collection of registered handlers. */
+    static std::vector<uint8_t> levelDispatch[logLevelCount]; /**< Per level, indices into handlers that accept it, in priority order. */
+    static uint8_t activeLevelMask; /**< Union of all handler level masks. */
+    static uint32_t generatedIdCount; /**< Counter used to name handlers registered without an ID. */
 
     /**
-     * @brief Sorts handlers by their priority.
+     * @brief Sorts handlers by their priority and rebuilds the per-level dispatch lists.
      * 
      * Ensures that higher-priority handlers are executed before lower-priority ones.
      */
     static void sortHandlers();
+
+    /**
+     * @brief Registers a handler after checking that its ID is unused.
+     */
+    static bool insertHandler(HandlerWrapper wrapper);
+
+    /**
+     * @brief Creates an ID for a handler registered without one.
+     */
+    static std::string generateHandlerId();
+
+    /**
+     * @brief Runs every registered handler for one text message.
+     */
+    static void dispatch(LogLevel level, const std::string& message);
+
+    /**
+     * @brief Runs every registered handler for one record, rendering it at most once.
+     */
+    static void dispatch(const LogRecord& record);
 };
 
+/**
+ * @brief Logging macros that cost nothing for disabled levels.
+ * 
+ * Levels below LOGGER_MIN_LEVEL are discarded at compile time, and levels below the global
+ * log level are rejected before any argument is evaluated.
+ * 
+ * Example:
+ * @code
+ * LOG_INFO("File read successfully: {}", path);
+ * @endcode
+ */
+#define LOGGER_LOG_AT(level, ...)                        \
+    do {                                                 \
+        if constexpr (isLogLevelCompiledIn(level)) {     \
+            if (Logger::isEnabled(level)) {              \
+                Logger::logf((level), __VA_ARGS__);      \
+            }                                            \
+        }                                                \
+    } while (0)
+
+#define LOG_SETUP(...) LOGGER_LOG_AT(LogLevel::SETUP, __VA_ARGS__)
+#define LOG_INFO(...) LOGGER_LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARNING(...) LOGGER_LOG_AT(LogLevel::WARNING, __VA_ARGS__)
+#define LOG_ERROR(...) LOGGER_LOG_AT(LogLevel::ERROR, __VA_ARGS__)
+#define LOG_CRITICAL(...) LOGGER_LOG_AT(LogLevel::CRITICAL, __VA_ARGS__)
+
 #endif // LOGGER_H
@@ -0,0 +1,107 @@
+#include "LogRecord.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Appends formatted text at buffer[pos], clamping to the buffer size
+size_t appendText(char* buffer, size_t size, size_t pos, const char* text, size_t length) {
+    if (pos + 1 >= size) {
+        return pos;
+    }
+    size_t room = size - 1 - pos;
+    if (length > room) {
+        length = room;
+    }
+    std::memcpy(buffer + pos, text, length);
+    return pos + length;
+}
+
+template <typename T>
+T readValue(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+size_t LogRecord::render(char* buffer, size_t size) const {
+    if (size == 0) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    size_t offset = 0;
+    const char* cursor = format;
+
+    while (*cursor != '\0' && pos + 1 < size) {
+        const char* placeholder = std::strstr(cursor, "{}");
+        if (placeholder == nullptr) {
+            pos = appendText(buffer, size, pos, cursor, std::strlen(cursor));
+            break;
+        }
+
+        pos = appendText(buffer, size, pos, cursor, static_cast<size_t>(placeholder - cursor));
+        cursor = placeholder + 2;
+
+        if (offset >= argBytes) {
+            pos = appendText(buffer, size, pos, "{}", 2); // More placeholders than arguments
+            continue;
+        }
+
+        char number[32];
+        int written = 0;
+        ArgType type = static_cast<ArgType>(args[offset++]);
+        switch (type) {
+            case ArgType::Int32:
+                written = snprintf(number, sizeof(number), "%ld", static_cast<long>(readValue<int32_t>(args + offset)));
+                offset += sizeof(int32_t);
+                break;
+            case ArgType::UInt32:
+                written = snprintf(number, sizeof(number), "%lu", static_cast<unsigned long>(readValue<uint32_t>(args + offset)));
+                offset += sizeof(uint32_t);
+                break;
+            case ArgType::Int64:
+                written = snprintf(number, sizeof(number), "%lld", static_cast<long long>(readValue<int64_t>(args + offset)));
+                offset += sizeof(int64_t);
+                break;
+            case ArgType::UInt64:
+                written = snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(readValue<uint64_t>(args + offset)));
+                offset += sizeof(uint64_t);
+                break;
+            case ArgType::Float:
+                written = snprintf(number, sizeof(number), "%.2f", static_cast<double>(readValue<float>(args + offset)));
+                offset += sizeof(float);
+                break;
+            case ArgType::Double:
+                written = snprintf(number, sizeof(number), "%.2f", readValue<double>(args + offset));
+                offset += sizeof(double);
+                break;
+            case ArgType::Bool:
+                written = snprintf(number, sizeof(number), "%s", args[offset] ? "true" : "false");
+                offset += 1;
+                break;
+            case ArgType::Str: {
+                size_t length = args[offset++];
+                pos = appendText(buffer, size, pos, reinterpret_cast<const char*>(args + offset), length);
+                offset += length;
+                break;
+            }
+        }
+
+        if (written > 0) {
+            size_t length = static_cast<size_t>(written) < sizeof(number) ? static_cast<size_t>(written) : sizeof(number) - 1;
+            pos = appendText(buffer, size, pos, number, length);
+        }
+    }
+
+    buffer[pos] = '\0';
+    return pos;
+}
+
+void LogRecord::renderTo(std::string& out) const {
+    char buffer[LOGGER_RENDER_BUFFER_SIZE];
+    size_t length = render(buffer, sizeof(buffer));
+    out.assign(buffer, length);
+}
@@ -1,14 +1,73 @@
 #include "Logger.h"
+#include "LogRing.h"
+#include <Hal.h>
+#include <Metrics.h>
 #include <algorithm>
+#include <atomic>
+#include <utility>
 #include <vector>
 
+namespace {
+
+LogRing<LogRecord, LOGGER_RING_CAPACITY> asyncRing;
+LogRecord drainBatch[LOGGER_DRAIN_BATCH_SIZE]; // Only touched while drainLock is held
+
+std::atomic<bool> asyncEnabled{false};
+std::atomic<uint32_t> asyncProducers{0}; // log() calls between their asyncEnabled check and their push
+std::atomic<bool> drainRunning{false};
+std::atomic_flag drainLock = ATOMIC_FLAG_INIT;
+std::atomic<uint32_t> dispatchedCount{0};
+std::atomic<uint32_t> truncatedCount{0};
+uint32_t drainInterval = 10;
+
+std::atomic<bool> drainTaskExited{true};
+
+void drainTask(void*) {
+    while (drainRunning.load(std::memory_order_acquire)) {
+        Logger::drain();
+        Hal::delay(drainInterval);
+    }
+    drainTaskExited.store(true, std::memory_order_release);
+}
+
+} // namespace
+
 // Initialize static members
 LogLevel Logger::globalLogLevel = LogLevel::INFO;
 std::vector<Logger::HandlerWrapper> Logger::handlers;
+std::vector<uint8_t> Logger::levelDispatch[logLevelCount];
+uint8_t Logger::activeLevelMask = 0;
+uint32_t Logger::generatedIdCount = 0;
+
+bool Logger::addHandler(const std::string& handlerId, LogHandler handler, LogLevel minLevel, int priority) {
+    return insertHandler({handler, nullptr, handlerId, priority, logLevelMaskFrom(minLevel)});
+}
 
 void Logger::addHandler(LogHandler handler, int priority) {
-    handlers.push_back({handler, "", priority});
-    sortHandlers();
+    insertHandler({handler, nullptr, generateHandlerId(), priority, logLevelMaskFrom(LogLevel::SETUP)});
+}
+
+bool Logger::addRecordHandler(const std::string& handlerId, RecordHandler handler, LogLevel minLevel, int priority) {
+    return insertHandler({nullptr, handler, handlerId, priority, logLevelMaskFrom(minLevel)});
+}
+
+void Logger::addRecordHandler(RecordHandler handler, int priority) {
+    insertHandler({nullptr, handler, generateHandlerId(), priority, logLevelMaskFrom(LogLevel::SETUP)});
+}
+
+bool Logger::setHandlerLevel(const std::string& handlerId, LogLevel minLevel) {
+    for (auto& wrapper : handlers) {
+        if (wrapper.id == handlerId) {
+            wrapper.levelMask = logLevelMaskFrom(minLevel);
+            sortHandlers();
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Logger::getHandlerCount() {
+    return handlers.size();
 }
 
 void Logger::removeHandler(const std::string& handlerId) {
@@ -18,16 +77,47 @@ void Logger::removeHandler(const std::string& handlerId) {
                            return wrapper.id == handlerId;
                        }),
         handlers.end());
+    sortHandlers();
+}
+
+void Logger::clearHandlers() {
+    handlers.clear();
+    sortHandlers();
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level < globalLogLevel) {
-        return; // Skip logs below the global log level
+    if (!isEnabled(level)) {
+        return; // Skip logs below the compiled or global log level
     }
 
-    for (const auto& wrapper : handlers) {
-        wrapper.handler(level, message);
+    if (!asyncEnabled.load(std::memory_order_acquire)) {
+        METRICS_COUNT(LogRecords);
+        dispatch(level, message);
+        return;
     }
+
+    log(LogRecord::make(level, "{}", message));
+}
+
+void Logger::log(const LogRecord& record) {
+    if (!isEnabled(record.getLevel())) {
+        return;
+    }
+    METRICS_COUNT(LogRecords);
+
+    // Sequentially consistent with stopAsync(), so it either sees this push or waits for it
+    asyncProducers.fetch_add(1);
+    if (!asyncEnabled.load()) {
+        asyncProducers.fetch_sub(1, std::memory_order_release);
+        dispatch(record);
+        return;
+    }
+
+    if (record.isTruncated()) {
+        truncatedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    asyncRing.tryPush(record); // A full ring drops the record and counts the overrun
+    asyncProducers.fetch_sub(1, std::memory_order_release);
 }
 
 void Logger::setGlobalLogLevel(LogLevel level) {
@@ -35,14 +125,169 @@ void Logger::setGlobalLogLevel(LogLevel level) {
 }
 
 void Logger::flush() {
-    for (const auto& wrapper : handlers) {
-        // Placeholder for flush logic if handlers require it
+    drain();
+}
+
+bool Logger::startAsync(uint32_t drainIntervalMs) {
+    if (drainRunning.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    drainInterval = drainIntervalMs > 0 ? drainIntervalMs : 1;
+    drainRunning.store(true, std::memory_order_release);
+
+    drainTaskExited.store(false, std::memory_order_release);
+    if (!Hal::startTask("LogDrainTask", drainTask)) {
+        drainRunning.store(false, std::memory_order_release);
+        drainTaskExited.store(true, std::memory_order_release);
+        return false;
+    }
+
+    asyncEnabled.store(true, std::memory_order_release);
+    return true;
+}
+
+void Logger::stopAsync() {
+    if (!drainRunning.exchange(false, std::memory_order_acq_rel)) {
+        asyncEnabled.store(false);
+        return;
+    }
+
+    // Records keep going to the ring until the drain task is gone, so no producer dispatches
+    // inline while it still runs the handlers
+    while (!drainTaskExited.load(std::memory_order_acquire)) {
+        Hal::delay(1); // Wait for the drain task to finish its current batch
+    }
+    asyncEnabled.store(false);
+    while (asyncProducers.load() != 0) {
+        Hal::delay(1); // A producer that saw async mode still on is about to push
+    }
+
+    drain(); // Deliver anything logged before async mode was switched off
+}
+
+bool Logger::isAsync() {
+    return asyncEnabled.load(std::memory_order_acquire);
+}
+
+size_t Logger::drain(size_t maxRecords) {
+    if (drainLock.test_and_set(std::memory_order_acquire)) {
+        return 0; // Another caller is already draining
+    }
+
+    size_t delivered = 0;
+    while (delivered < maxRecords) {
+        // Pop a batch first so producers get their slots back before the handlers run
+        size_t batchSize = 0;
+        size_t batchLimit = std::min<size_t>(LOGGER_DRAIN_BATCH_SIZE, maxRecords - delivered);
+        while (batchSize < batchLimit && asyncRing.tryPop(drainBatch[batchSize])) {
+            ++batchSize;
+        }
+        if (batchSize == 0) {
+            break;
+        }
+
+        for (size_t i = 0; i < batchSize; ++i) {
+            dispatch(drainBatch[i]);
+        }
+        delivered += batchSize;
+    }
+
+    dispatchedCount.fetch_add(static_cast<uint32_t>(delivered), std::memory_order_relaxed);
+    drainLock.clear(std::memory_order_release);
+    return delivered;
+}
+
+Logger::AsyncStats Logger::getAsyncStats() {
+    AsyncStats stats;
+    stats.enqueued = asyncRing.getPushCount();
+    stats.dispatched = dispatchedCount.load(std::memory_order_relaxed);
+    stats.overruns = asyncRing.getOverrunCount();
+    stats.truncated = truncatedCount.load(std::memory_order_relaxed);
+    stats.highWater = asyncRing.getHighWater();
+    return stats;
+}
+
+void Logger::resetAsyncStats() {
+    asyncRing.resetCounters();
+    dispatchedCount.store(0, std::memory_order_relaxed);
+    truncatedCount.store(0, std::memory_order_relaxed);
+}
+
+void Logger::dispatch(LogLevel level, const std::string& message) {
+    METRICS_TIME(LogDispatch);
+    bool packed = false;
+    LogRecord record;
+
+    for (uint8_t index : levelDispatch[static_cast<size_t>(level)]) {
+        const HandlerWrapper& wrapper = handlers[index];
+        if (wrapper.handler) {
+            wrapper.handler(level, message);
+            continue;
+        }
+        if (!packed) {
+            record = LogRecord::make(level, "{}", message);
+            packed = true;
+        }
+        wrapper.recordHandler(record);
+    }
+}
+
+void Logger::dispatch(const LogRecord& record) {
+    METRICS_TIME(LogDispatch);
+    // One buffer per thread keeps its capacity between calls, so rendering stops allocating
+    thread_local std::string text;
+    bool rendered = false;
+
+    for (uint8_t index : levelDispatch[static_cast<size_t>(record.getLevel())]) {
+        const HandlerWrapper& wrapper = handlers[index];
+        if (wrapper.recordHandler) {
+            wrapper.recordHandler(record);
+            continue;
+        }
+        if (!rendered) {
+            record.renderTo(text);
+            rendered = true;
+        }
+        wrapper.handler(record.getLevel(), text);
     }
 }
 
 void Logger::sortHandlers() {
-    std::sort(handlers.begin(), handlers.end(),
-              [](const HandlerWrapper& a, const HandlerWrapper& b) {
-                  return a.priority > b.priority; // Higher priority handlers first
-              });
+    std::stable_sort(handlers.begin(), handlers.end(),
+                     [](const HandlerWrapper& a, const HandlerWrapper& b) {
+                         return a.priority > b.priority; // Higher priority handlers first
+                     });
+
+    // Precompute which handlers accept each level so log() never tests a mask
+    activeLevelMask = 0;
+    for (size_t level = 0; level < logLevelCount; ++level) {
+        levelDispatch[level].clear();
+        for (size_t index = 0; index < handlers.size(); ++index) {
+            if (handlers[index].levelMask & (1u << level)) {
+                levelDispatch[level].push_back(static_cast<uint8_t>(index));
+            }
+        }
+        if (!levelDispatch[level].empty()) {
+            activeLevelMask |= static_cast<uint8_t>(1u << level);
+        }
+    }
+}
+
+bool Logger::insertHandler(HandlerWrapper wrapper) {
+    if (handlers.size() > UINT8_MAX) {
+        return false; // Dispatch lists index handlers with a uint8_t
+    }
+    for (const auto& existing : handlers) {
+        if (existing.id == wrapper.id) {
+            return false;
+        }
+    }
+    handlers.push_back(std::move(wrapper));
+    sortHandlers();
+    return true;
+}
+
+std::string Logger::generateHandlerId() {
+    return "handler-" + std::to_string(generatedIdCount++);
 }
@@ -0,0 +1,204 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Hal.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1 /**< Set to 0 to compile every METRICS_* macro to nothing. */
+#endif
+
+#define METRICS_HISTOGRAM_BUCKETS 16 /**< Power-of-two microsecond buckets, the last one open ended. */
+
+/**
+ * @brief Fixed-size counters and timing histograms for the hot paths of a wake.
+ *
+ * Every metric is a slot in a static array indexed by an enum, so recording one is a few
+ * relaxed atomic operations with no allocation, lookup or lock. Timers record microseconds
+ * from Hal::micros() into power-of-two buckets: bucket 0 holds durations below 2 us and
+ * bucket N durations from 2^N up to 2^(N+1) us.
+ *
+ * Instrument code through the METRICS_* macros so that building with
+ * `-DMETRICS_ENABLED=0` removes the instrumentation entirely. The benchmark suite measures
+ * the cost of each macro.
+ *
+ * Example:
+ * @code
+ * bool FileSystem::write(const std::string& path, const std::string& data) {
+ *     METRICS_TIME(FileWrite);
+ *     ...
+ * }
+ *
+ * char payload[BATCH_PUBLISHER_PAYLOAD_SIZE];
+ * Metrics::Snapshot snapshot = Metrics::snapshot();
+ * size_t length = Metrics::formatJson(snapshot, payload, sizeof(payload));
+ * client.publish("greenhouse/metrics", reinterpret_cast<uint8_t*>(payload), length);
+ * @endcode
+ */
+namespace Metrics {
+
+/**
+ * @brief Event counters.
+ */
+enum class Counter : uint8_t {
+    LogRecords,      /**< Records accepted by Logger::log. */
+    FileErrors,      /**< File operations that failed. */
+    SensorReads,     /**< Sensor readings taken by SensorManager. */
+    SensorErrors,    /**< Sensor readings that failed. */
+    WifiAttempts,    /**< WiFi association attempts started. */
+    MqttAttempts,    /**< MQTT connection attempts. */
+    MqttFailures,    /**< MQTT connection attempts that failed. */
+    Published,       /**< MQTT publishes that succeeded. */
+    PublishFailures, /**< MQTT publishes that failed. */
+    PublishedBytes,  /**< Payload bytes of successful publishes. */
+    PublishesLost,   /**< Payloads that failed to publish and could not be queued either. */
+    Count
+};
+
+/**
+ * @brief Timed operations.
+ */
+enum class Timer : uint8_t {
+    LogDispatch, /**< Running the handlers for one record. */
+    FileWrite,   /**< One file write or append. */
+    FileRead,    /**< One file read. */
+    SensorRead,  /**< One sensor reading. */
+    WifiBegin,   /**< Starting a WiFi association. */
+    MqttConnect, /**< One MQTT connection attempt. */
+    Publish,     /**< One MQTT publish. */
+    Count
+};
+
+const size_t counterCount = static_cast<size_t>(Counter::Count);
+const size_t timerCount = static_cast<size_t>(Timer::Count);
+
+/**
+ * @brief Totals of one timer.
+ */
+struct TimerStats {
+    uint32_t count;                              /**< Recorded durations. */
+    uint32_t totalUs;                            /**< Sum of the durations. */
+    uint32_t maxUs;                              /**< Longest duration. */
+    uint32_t buckets[METRICS_HISTOGRAM_BUCKETS]; /**< Durations per power-of-two bucket. */
+};
+
+/**
+ * @brief A copy of every metric at one point in time.
+ */
+struct Snapshot {
+    uint32_t counters[counterCount];
+    TimerStats timers[timerCount];
+};
+
+/**
+ * @brief Live storage of one timer. Use the TimerStats copy from snapshot() to read it.
+ */
+struct TimerSlot {
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> totalUs;
+    std::atomic<uint32_t> maxUs;
+    std::atomic<uint32_t> buckets[METRICS_HISTOGRAM_BUCKETS];
+};
+
+extern std::atomic<uint32_t> counters[counterCount];
+extern TimerSlot timers[timerCount];
+
+/**
+ * @brief Adds to a counter.
+ */
+inline void add(Counter counter, uint32_t amount = 1) {
+    counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the histogram bucket of a duration.
+ */
+inline size_t bucketOf(uint32_t us) {
+    size_t bucket = 0;
+    while (us > 1 && bucket < METRICS_HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Records one duration of a timer.
+ */
+void record(Timer timer, uint32_t us);
+
+/**
+ * @brief Times the enclosing scope and records it on destruction.
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Timer timer) : timer(timer), startUs(Hal::micros()) {}
+    ~ScopedTimer() { record(timer, Hal::micros() - startUs); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Timer timer;      // Timer the scope is recorded under
+    uint32_t startUs; // Hal::micros() at construction
+};
+
+/**
+ * @brief Copies every metric.
+ */
+Snapshot snapshot();
+
+/**
+ * @brief Sets every metric back to zero.
+ */
+void reset();
+
+/**
+ * @brief Returns the name of a counter, e.g. "sensor.err".
+ */
+const char* getName(Counter counter);
+
+/**
+ * @brief Returns the name of a timer, e.g. "fs.write".
+ */
+const char* getName(Timer timer);
+
+/**
+ * @brief Estimates a percentile of a timer from its histogram.
+ * @return The upper bound of the bucket holding the percentile, capped at maxUs.
+ */
+uint32_t percentileUs(const TimerStats& stats, uint32_t percent);
+
+/**
+ * @brief Writes the non-zero metrics of a snapshot as one compact JSON object.
+ *
+ * Layout: `{"c":{"name":value,...},"t":{"name":[count,totalUs,maxUs,p50Us,p99Us],...}}`.
+ * A busy wake comes to about 400 characters, so it goes out as a single MQTT message.
+ *
+ * @return The number of characters written, or 0 if the output did not fit.
+ */
+size_t formatJson(const Snapshot& snapshot, char* out, size_t capacity);
+
+/**
+ * @brief Prints every non-zero metric to the debug console, one per line.
+ */
+void dump(const Snapshot& snapshot);
+
+} // namespace Metrics
+
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+#if METRICS_ENABLED
+#define METRICS_COUNT(counter) Metrics::add(Metrics::Counter::counter)
+#define METRICS_ADD(counter, amount) Metrics::add(Metrics::Counter::counter, (amount))
+#define METRICS_TIME(timer) Metrics::ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(Metrics::Timer::timer)
+#else
+#define METRICS_COUNT(counter) do {} while (0)
+#define METRICS_ADD(counter, amount) do {} while (0)
+#define METRICS_TIME(timer) do {} while (0)
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,172 @@
+#include "Metrics.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace Metrics {
+
+std::atomic<uint32_t> counters[counterCount];
+TimerSlot timers[timerCount];
+
+namespace {
+
+const char* const counterNames[counterCount] = {
+    "log", "fs.err", "sensor", "sensor.err", "wifi", "mqtt", "mqtt.err", "pub", "pub.err", "pub.bytes", "pub.lost",
+};
+
+const char* const timerNames[timerCount] = {
+    "log", "fs.write", "fs.read", "sensor", "wifi", "mqtt", "pub",
+};
+
+// Appends to a fixed buffer; remembers when something did not fit
+struct Writer {
+    char* out;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+
+    void append(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+void Writer::append(const char* format, ...) {
+    if (overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out + length, capacity - length, format, args);
+    va_end(args);
+    if (written < 0 || static_cast<size_t>(written) >= capacity - length) {
+        overflow = true;
+        return;
+    }
+    length += written;
+}
+
+} // namespace
+
+void record(Timer timer, uint32_t us) {
+    TimerSlot& slot = timers[static_cast<size_t>(timer)];
+    slot.count.fetch_add(1, std::memory_order_relaxed);
+    slot.totalUs.fetch_add(us, std::memory_order_relaxed);
+    slot.buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t seen = slot.maxUs.load(std::memory_order_relaxed);
+    while (us > seen && !slot.maxUs.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+}
+
+Snapshot snapshot() {
+    Snapshot copy;
+    for (size_t i = 0; i < counterCount; ++i) {
+        copy.counters[i] = counters[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < timerCount; ++i) {
+        copy.timers[i].count = timers[i].count.load(std::memory_order_relaxed);
+        copy.timers[i].totalUs = timers[i].totalUs.load(std::memory_order_relaxed);
+        copy.timers[i].maxUs = timers[i].maxUs.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; ++b) {
+            copy.timers[i].buckets[b] = timers[i].buckets[b].load(std::memory_order_relaxed);
+        }
+    }
+    return copy;
+}
+
+void reset() {
+    for (size_t i = 0; i < counterCount; ++i) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < timerCount; ++i) {
+        timers[i].count.store(0, std::memory_order_relaxed);
+        timers[i].totalUs.store(0, std::memory_order_relaxed);
+        timers[i].maxUs.store(0, std::memory_order_relaxed);
+        for (size_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; ++b) {
+            timers[i].buckets[b].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+const char* getName(Counter counter) {
+    size_t index = static_cast<size_t>(counter);
+    return index < counterCount ? counterNames[index] : "unknown";
+}
+
+const char* getName(Timer timer) {
+    size_t index = static_cast<size_t>(timer);
+    return index < timerCount ? timerNames[index] : "unknown";
+}
+
+uint32_t percentileUs(const TimerStats& stats, uint32_t percent) {
+    if (stats.count == 0) {
+        return 0;
+    }
+    uint64_t rank = (static_cast<uint64_t>(stats.count) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; ++b) {
+        seen += stats.buckets[b];
+        if (seen >= rank && b < METRICS_HISTOGRAM_BUCKETS - 1) {
+            uint32_t upper = (2u << b) - 1;
+            return upper < stats.maxUs ? upper : stats.maxUs;
+        }
+    }
+    return stats.maxUs;
+}
+
+size_t formatJson(const Snapshot& snapshot, char* out, size_t capacity) {
+    if (capacity == 0) {
+        return 0;
+    }
+    Writer writer{out, capacity, 0, false};
+    writer.append("{\"c\":{");
+    const char* separator = "";
+    for (size_t i = 0; i < counterCount; ++i) {
+        if (snapshot.counters[i] != 0) {
+            writer.append("%s\"%s\":%lu", separator, counterNames[i], static_cast<unsigned long>(snapshot.counters[i]));
+            separator = ",";
+        }
+    }
+    writer.append("},\"t\":{");
+    separator = "";
+    for (size_t i = 0; i < timerCount; ++i) {
+        const TimerStats& stats = snapshot.timers[i];
+        if (stats.count != 0) {
+            writer.append("%s\"%s\":[%lu,%lu,%lu,%lu,%lu]", separator, timerNames[i],
+                          static_cast<unsigned long>(stats.count), static_cast<unsigned long>(stats.totalUs),
+                          static_cast<unsigned long>(stats.maxUs),
+                          static_cast<unsigned long>(percentileUs(stats, 50)),
+                          static_cast<unsigned long>(percentileUs(stats, 99)));
+            separator = ",";
+        }
+    }
+    writer.append("}}");
+
+    if (writer.overflow) {
+        out[0] = '\0';
+        return 0;
+    }
+    return writer.length;
+}
+
+void dump(const Snapshot& snapshot) {
+    char line[128];
+    for (size_t i = 0; i < counterCount; ++i) {
+        if (snapshot.counters[i] != 0) {
+            snprintf(line, sizeof(line), "METRIC %s = %lu", counterNames[i],
+                     static_cast<unsigned long>(snapshot.counters[i]));
+            Hal::println(line);
+        }
+    }
+    for (size_t i = 0; i < timerCount; ++i) {
+        const TimerStats& stats = snapshot.timers[i];
+        if (stats.count != 0) {
+            snprintf(line, sizeof(line), "METRIC %s count=%lu total_us=%lu max_us=%lu p50_us=%lu p99_us=%lu",
+                     timerNames[i], static_cast<unsigned long>(stats.count),
+                     static_cast<unsigned long>(stats.totalUs), static_cast<unsigned long>(stats.maxUs),
+                     static_cast<unsigned long>(percentileUs(stats, 50)),
+                     static_cast<unsigned long>(percentileUs(stats, 99)));
+            Hal::println(line);
+        }
+    }
+}
+
+} // namespace Metrics
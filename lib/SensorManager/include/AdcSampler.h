@@ -0,0 +1,141 @@
+#ifndef ADCSAMPLER_H
+#define ADCSAMPLER_H
+
+#include <Hal.h>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ADC_SAMPLER_FRAME_SAMPLES
+#define ADC_SAMPLER_FRAME_SAMPLES 256 /**< Samples per DMA frame; the sampler holds one frame. */
+#endif
+
+#ifndef ADC_SAMPLER_FALLBACK_CHUNK
+#define ADC_SAMPLER_FALLBACK_CHUNK 32 /**< analogRead() samples between checks of the standard error. */
+#endif
+
+/**
+ * @brief Running count, sum, mean and variance of a series of ADC counts, in constant memory.
+ *
+ * Single values are folded in with Welford's update. Batches are summed in integers first and
+ * then merged with the pairwise form of the same update (Chan et al.), so the per-sample work
+ * for a DMA frame is two integer adds and a multiply. The exact integer sum is kept alongside,
+ * so a caller can take the mean in fixed point without going through floating point.
+ */
+class SampleStats {
+public:
+    void add(uint16_t value);
+    void addBatch(const uint16_t* values, size_t count);
+    void reset();
+
+    uint32_t getCount() const { return count; }
+    uint64_t getSum() const { return sum; }
+    float getMean() const { return static_cast<float>(mean); }
+
+    /**
+     * @brief Returns the sample variance, or 0 below two samples.
+     */
+    float getVariance() const;
+
+    /**
+     * @brief Returns the standard error of the mean, or 0 below two samples.
+     */
+    float getStandardError() const;
+
+private:
+    uint32_t count = 0;
+    uint64_t sum = 0;
+    double mean = 0; // Merged per frame, so double costs little even without a double FPU
+    double m2 = 0;   // Sum of squared deviations from the mean
+};
+
+/**
+ * @brief Averages an ADC pin over many samples without keeping the CPU busy.
+ *
+ * The sampler streams the pin with Hal::adcStreamBegin(): the ADC converts into DMA frames on
+ * its own and the sampler folds each finished frame into its SampleStats. It keeps the ADC
+ * running only while a reading is in progress and ends the stream as soon as it has either
+ * maxSamples samples or, with maxStandardError set, a mean whose standard error is that small.
+ * A quiet signal is then done after minSamples while a noisy one takes up to the cap. When no
+ * stream can be started (another sampler holds it, or the core has no continuous driver), it
+ * reads the samples with Hal::analogRead() instead, checking the standard error every
+ * ADC_SAMPLER_FALLBACK_CHUNK samples.
+ *
+ * Example:
+ * @code
+ * AdcSampler sampler(34, AdcSampler::Config{20000, 64, 10000, 0.5f, 100});
+ * sampler.start();
+ * while (!sampler.poll()) {
+ *     // Other work; poll() never waits for the ADC
+ * }
+ * float counts = sampler.getStats().getMean();
+ * @endcode
+ */
+class AdcSampler {
+public:
+    /**
+     * @brief How fast to sample and when a reading is complete.
+     */
+    struct Config {
+        uint32_t sampleRateHz;     /**< Conversion rate of the stream. */
+        uint32_t minSamples;       /**< Samples before the standard error is trusted. */
+        uint32_t maxSamples;       /**< Hard cap on the samples of one reading. */
+        float maxStandardError;    /**< Stop at this standard error of the mean, in counts; 0 to always take maxSamples. */
+        uint32_t timeoutMs;        /**< Longest run() waits for a frame before giving up. */
+    };
+
+    /**
+     * @brief Returns the default config: 20 kHz (the ESP32's lowest rate), 10000 samples.
+     */
+    static Config defaultConfig();
+
+    explicit AdcSampler(uint8_t pin, Config config = defaultConfig());
+    ~AdcSampler();
+
+    AdcSampler(const AdcSampler&) = delete;
+    AdcSampler& operator=(const AdcSampler&) = delete;
+
+    /**
+     * @brief Clears the statistics and starts a reading.
+     * @return True if the reading streams, false if it falls back to analogRead().
+     */
+    bool start();
+
+    /**
+     * @brief Folds in whatever the ADC has finished, without waiting. On the analogRead()
+     * fallback it reads ADC_SAMPLER_FALLBACK_CHUNK samples.
+     * @return True once the reading is complete and the ADC has been stopped.
+     */
+    bool poll();
+
+    /**
+     * @brief Samples until the reading is complete.
+     * @return False if the stream stalled for timeoutMs or no valid sample was read.
+     */
+    bool run();
+
+    /**
+     * @brief Ends the reading early and stops the ADC. The statistics so far are kept.
+     */
+    void stop();
+
+    bool isRunning() const { return running; }
+    bool isStreaming() const { return streaming; }
+    bool hasTimedOut() const { return timedOut; }
+    const SampleStats& getStats() const { return stats; }
+    const Config& getConfig() const { return config; }
+
+private:
+    bool take(uint32_t timeoutMs); // Reads one frame or less; false if nothing arrived
+    bool isComplete() const;
+
+    const uint8_t pin;
+    Config config;
+    SampleStats stats;
+    uint32_t taken = 0;     // Samples read this reading, valid or not
+    bool running = false;
+    bool streaming = false; // Owns the Hal ADC stream
+    bool timedOut = false;
+    uint16_t frame[ADC_SAMPLER_FRAME_SAMPLES];
+};
+
+#endif // ADCSAMPLER_H
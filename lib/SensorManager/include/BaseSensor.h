@@ -1,7 +1,11 @@
 #ifndef BASESENSOR_H
 #define BASESENSOR_H
 
+#include <Hal.h>
+#include <cmath>
+#include <cstddef>
 #include <string>
+#include "Reading.h"
 
 class BaseSensor {
 public:
@@ -12,10 +16,17 @@ public:
         Undefined, // Fallback for sensors that are not yet implemented
     };
 
+    // Name and unit of one of the values a sensor reads
+    struct ChannelInfo {
+        const char* name;
+        Reading::Unit unit;
+    };
+
     BaseSensor(int sensorPin, const std::string& sensorName, SensorType type = SensorType::Undefined)
         : name(sensorName), sensorPin(sensorPin), sensorType(type) {}
 
     SensorType getType() const { return sensorType; }
+    int getPin() const { return sensorPin; }
 
     virtual bool begin() = 0;
     virtual ~BaseSensor() = default;
@@ -30,6 +41,19 @@ public:
         return -1.0; // Magic number error value indicating async not supported
     }
 
+    // Number of values a reading gives, at most SENSOR_MANAGER_MAX_CHANNELS; one unless overridden
+    virtual size_t getChannelCount() const { return 1; }
+
+    // Name and unit of a channel
+    virtual ChannelInfo getChannelInfo(size_t /*channel*/) const { return {"value", Reading::Unit::None}; }
+
+    // Read every channel into values, from one reading; false if the reading failed. The
+    // default is getReading() as channel 0
+    virtual bool readChannels(float* values) {
+        values[0] = getReading();
+        return !std::isnan(values[0]);
+    }
+
     // Virtual method to get the last error message
     virtual const char* getErrorMessage() const { return "Async not implemented for this sensor."; }
 
@@ -43,9 +67,8 @@ protected:
 
     // Helper method to log an error or debug message
     virtual void logUnsupportedAsync() const {
-        // For Arduino, you could use Serial logging or other debugging tools
-        Serial.print("Error: Async getReading not implemented for sensor ");
-        Serial.println(name.c_str());
+        Hal::print("Error: Async getReading not implemented for sensor ");
+        Hal::println(name.c_str());
     }
 };
 
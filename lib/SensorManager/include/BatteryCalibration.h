@@ -0,0 +1,149 @@
+#ifndef BATTERYCALIBRATION_H
+#define BATTERYCALIBRATION_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Battery chemistries with a discharge curve in BatteryCalibration.
+ */
+enum class BatteryChemistry : uint8_t {
+    LiIon,   // 18650 and similar cells, 4.2 V full
+    LiFePO4, // 3.4 V at rest when full, very flat in between
+};
+
+#ifndef BATTERY_CHEMISTRY
+#define BATTERY_CHEMISTRY BatteryChemistry::LiIon /**< Chemistry whose curve the battery sensor uses. */
+#endif
+
+#ifndef BATTERY_ADC_VREF_MV
+#define BATTERY_ADC_VREF_MV 1100 /**< ADC reference from the eFuse (`espefuse.py adc_info`); 1100 is nominal. */
+#endif
+
+#ifndef BATTERY_DIVIDER_R1
+#define BATTERY_DIVIDER_R1 36000 /**< Divider resistor from the battery to the ADC pin, in ohms. */
+#endif
+
+#ifndef BATTERY_DIVIDER_R2
+#define BATTERY_DIVIDER_R2 10000 /**< Divider resistor from the ADC pin to ground, in ohms. */
+#endif
+
+/**
+ * @brief ADC counts to battery millivolts and state of charge, computed at compile time.
+ *
+ * Readings are averaged in raw counts and converted once, from the mean in 1/16 counts:
+ *
+ * 1. Counts to millivolts at the pin, characterized from the eFuse Vref the way esp_adc_cal
+ *    does for ADC1 at 11 dB: a slope scaled by Vref plus a fixed offset (the ADC reads 0 below
+ *    about 140 mV).
+ * 2. Pin to battery millivolts through the divider.
+ * 3. Battery millivolts to state of charge along the chemistry's open-circuit discharge curve,
+ *    interpolated between its points. A Li-ion cell spends most of its charge between 3.7 and
+ *    4.0 V, so a straight line from empty to full reads far too high in the middle.
+ *
+ * Table<chemistry> holds step 3 applied to steps 1 and 2 for every whole count, generated by
+ * the compiler, so a reading costs one table lookup and one interpolation in integers.
+ */
+namespace BatteryCalibration {
+
+/**
+ * @brief A point of a discharge curve.
+ */
+struct CurvePoint {
+    uint16_t millivolts;   /**< Open-circuit voltage of the cell. */
+    uint16_t centiPercent; /**< State of charge at that voltage, in hundredths of a percent. */
+};
+
+template <BatteryChemistry chemistry>
+struct Curve;
+
+// Typical resting voltages of an 18650 cell, empty to full
+template <>
+struct Curve<BatteryChemistry::LiIon> {
+    static constexpr CurvePoint points[] = {
+        {3270, 0},    {3610, 500},  {3690, 1000}, {3710, 1500}, {3730, 2000}, {3750, 2500}, {3770, 3000},
+        {3790, 3500}, {3800, 4000}, {3820, 4500}, {3840, 5000}, {3850, 5500}, {3870, 6000}, {3910, 6500},
+        {3950, 7000}, {3980, 7500}, {4020, 8000}, {4080, 8500}, {4110, 9000}, {4150, 9500}, {4200, 10000},
+    };
+};
+
+// Typical resting voltages of a LiFePO4 cell, empty to full
+template <>
+struct Curve<BatteryChemistry::LiFePO4> {
+    static constexpr CurvePoint points[] = {
+        {2500, 0},    {3000, 900},  {3200, 1400}, {3220, 1700}, {3250, 2000}, {3260, 3000},
+        {3270, 4000}, {3300, 7000}, {3320, 9000}, {3350, 9900}, {3400, 10000},
+    };
+};
+
+const uint32_t countsScale = 16;   // Means are passed in 1/16 counts
+const uint32_t maxCounts = 4095;   // 12-bit ADC
+const uint32_t slopeScale = 65536; // esp_adc_cal's fixed-point scale for the slope
+const uint32_t atten11dbScale = 196602; // esp_adc_cal's ADC1 11 dB slope per mV of Vref
+const uint32_t atten11dbOffsetMv = 142; // esp_adc_cal's ADC1 11 dB offset
+
+/**
+ * @brief Returns the battery voltage in millivolts for a mean reading in 1/16 counts.
+ */
+constexpr uint32_t batteryMillivolts(uint32_t countsQ4, uint32_t vrefMv = BATTERY_ADC_VREF_MV) {
+    uint64_t slope = static_cast<uint64_t>(vrefMv) * atten11dbScale / 4096;
+    uint64_t pinMicrovolts = slope * countsQ4 * 1000 / (slopeScale * countsScale) + atten11dbOffsetMv * 1000;
+    return static_cast<uint32_t>((pinMicrovolts * (BATTERY_DIVIDER_R1 + BATTERY_DIVIDER_R2) / BATTERY_DIVIDER_R2 + 500) / 1000);
+}
+
+/**
+ * @brief Returns the state of charge in hundredths of a percent along a chemistry's curve.
+ */
+template <BatteryChemistry chemistry>
+constexpr uint16_t centiPercentAt(uint32_t millivolts) {
+    const CurvePoint* points = Curve<chemistry>::points;
+    const size_t count = sizeof(Curve<chemistry>::points) / sizeof(CurvePoint);
+    if (millivolts <= points[0].millivolts) {
+        return points[0].centiPercent;
+    }
+    for (size_t i = 1; i < count; ++i) {
+        if (millivolts <= points[i].millivolts) {
+            uint32_t span = points[i].millivolts - points[i - 1].millivolts;
+            uint32_t rise = points[i].centiPercent - points[i - 1].centiPercent;
+            return static_cast<uint16_t>(points[i - 1].centiPercent + (rise * (millivolts - points[i - 1].millivolts) + span / 2) / span);
+        }
+    }
+    return points[count - 1].centiPercent;
+}
+
+/**
+ * @brief State of charge for every whole count, in hundredths of a percent.
+ */
+template <BatteryChemistry chemistry>
+struct Table {
+    uint16_t centiPercent[maxCounts + 1];
+
+    constexpr Table() : centiPercent() {
+        for (uint32_t counts = 0; counts <= maxCounts; ++counts) {
+            centiPercent[counts] = centiPercentAt<chemistry>(batteryMillivolts(counts * countsScale));
+        }
+    }
+};
+
+template <BatteryChemistry chemistry>
+inline constexpr Table<chemistry> table = Table<chemistry>(); // In flash; only the selected chemistry is emitted
+
+/**
+ * @brief Looks up the state of charge for a mean reading in 1/16 counts, interpolating
+ * between the whole counts around it.
+ */
+template <BatteryChemistry chemistry = BATTERY_CHEMISTRY>
+inline uint16_t centiPercentFromCounts(uint32_t countsQ4) {
+    const uint16_t* entries = table<chemistry>.centiPercent;
+    uint32_t index = countsQ4 / countsScale;
+    if (index >= maxCounts) {
+        return entries[maxCounts];
+    }
+    int32_t low = entries[index];
+    int32_t high = entries[index + 1];
+    return static_cast<uint16_t>(low + (high - low) * static_cast<int32_t>(countsQ4 % countsScale) / static_cast<int32_t>(countsScale));
+}
+
+} // namespace BatteryCalibration
+
+#endif // BATTERYCALIBRATION_H
@@ -1,30 +1,42 @@
 #ifndef BATTERYZENERSENSOR_H
 #define BATTERYZENERSENSOR_H
 
-#include <Arduino.h>
+#include <Hal.h>
+#include <string>
 #include "BaseSensor.h"
+#include "AdcSampler.h"
+#include "BatteryCalibration.h"
+
+#ifndef BATTERY_MAX_ERROR_MV
+#define BATTERY_MAX_ERROR_MV 2.0f /**< Standard error at the battery a reading stops at, in millivolts. */
+#endif
 
 class BatteryZenerSensor : public BaseSensor {
 public:
-    BatteryZenerSensor(float battVoltHigh = 4.2, float battVoltLow = 2.7, int batteryPin = 34, int controlPin = 35, int batteryReadsToAverage = 10000);
+    // batteryReadsToAverage caps the samples of a reading; it stops earlier once the standard error
+    // of the mean at the battery is below maxErrorMv, so a quiet ADC takes a few hundred samples
+    BatteryZenerSensor(float battVoltHigh = 4.2, float battVoltLow = 2.7, int batteryPin = 34, int controlPin = 35,
+                       int batteryReadsToAverage = 10000, float maxErrorMv = BATTERY_MAX_ERROR_MV);
     bool begin() override;                        // Initialize the sensor
     // Overload `getReading` to allow for synchronization
     float getReading(const bool* readyToReport) const override; // With synchronization
     float getReading() const override; // Without synchronization
+    ChannelInfo getChannelInfo(size_t channel) const override; // "battery", in percent
     const char* getErrorMessage() const override; // Get the last error message
+    uint32_t getSamplesUsed() const;              // Samples averaged by the last reading
 
 private:
-    float battVoltHigh;      // Maximum battery voltage - ~4.2v for a fully charged 18650 battery
-    float battVoltLow;       // Minimum battery voltage - going below 2.7v can damage the battery and result in unreliable readings
+    uint32_t battMillivoltsHigh; // Reads 100% at or above - ~4.2v for a fully charged 18650 battery
+    uint32_t battMillivoltsLow;  // Reads 0% at or below - going below 2.7v can damage the battery and result in unreliable readings
     const int batteryPin;          // ADC pin for reading voltage level
     const int controlPin;          // Optional control pin (e.g., to enable/disable the sensor)
-    mutable String lastError; // Stores the last error message
-    int numOfReadings; // Number of raw values to average - defaults to 10k for a zener sensor. 
+    mutable std::string lastError; // Stores the last error message
+    int numOfReadings; // Most raw values to average - defaults to 10k for a zener sensor. 
+    mutable AdcSampler sampler;    // Streams the battery pin, one sampler per sensor
+    mutable bool sampling = false; // An async reading is in progress
 
-    virtual float readPin() const;                                // Read raw ADC voltage
-    float convertToNormalLevel(const float rawVoltage, const float R1 = 36.0, const float R2 = 10.0) const;
-  // Convert raw voltage to battery voltageusing default values
-    float convertToPercentage(float batteryVoltage) const; // Convert voltage to percentage
+    virtual int readPin() const;      // Read raw ADC counts, -1 on error
+    float readingFromSampler() const; // Percentage from the sampler's mean, or -1
 };
 
 #endif // BATTERYZENERSENSOR_H
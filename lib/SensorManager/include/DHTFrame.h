@@ -0,0 +1,70 @@
+#ifndef DHTFRAME_H
+#define DHTFRAME_H
+
+#include <Hal.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Decodes the 40-bit frame a DHT sensor answers with from captured pulse widths.
+ *
+ * After the start signal the sensor pulls the line low and high for 80 us each, then sends 40
+ * bits, each a 50 us low followed by a high of 26-28 us for a 0 or 70 us for a 1, and a final
+ * 50 us low. The bits are the last 40 highs of the capture, so whatever the line did before
+ * the sensor answered is skipped. A bit is 1 when its high is longer than the low before it,
+ * as the Adafruit driver decides, which holds whatever the sensor's clock is off by.
+ *
+ * The five bytes are humidity and temperature, two bytes each, and a checksum: the low byte of
+ * the sum of the other four. Temperature and humidity come from the same frame, so they
+ * always belong together.
+ */
+namespace DHTFrame {
+
+/**
+ * @brief Sensor families with different data formats. Not named DHT11 and DHT22, which the
+ * Adafruit driver defines as macros.
+ */
+enum class Model : uint8_t {
+    Dht11, // Whole degrees and percent, tenths in the second byte of each
+    Dht22, // Tenths of a degree and percent as 16-bit values; also the DHT21 and AM2302
+};
+
+/**
+ * @brief Outcome of a decode.
+ */
+enum class Status : uint8_t {
+    Ok,
+    NoResponse, // Nothing was captured: no sensor, or it did not answer in time
+    TooShort,   // Fewer than 40 bits
+    Checksum,   // The bits arrived but do not add up
+};
+
+/**
+ * @brief Decoded values.
+ */
+struct Reading {
+    float temperature; /**< Degrees Celsius. */
+    float humidity;    /**< Relative humidity in percent. */
+};
+
+const size_t frameBits = 40;
+const size_t maxPulses = 100; /**< Enough for a frame and what precedes it. */
+
+/**
+ * @brief Collects the 40 bits of a capture into five bytes, most significant bit first.
+ */
+Status bitsFromPulses(const Hal::Pulse* pulses, size_t count, uint8_t bytes[5]);
+
+/**
+ * @brief Converts the five bytes of a frame, checking the checksum.
+ */
+Status fromBytes(const uint8_t bytes[5], Model model, Reading& out);
+
+/**
+ * @brief Decodes a capture: bitsFromPulses() then fromBytes().
+ */
+Status decode(const Hal::Pulse* pulses, size_t count, Model model, Reading& out);
+
+} // namespace DHTFrame
+
+#endif // DHTFRAME_H
@@ -0,0 +1,92 @@
+#ifndef DHTREADER_H
+#define DHTREADER_H
+
+#include <Hal.h>
+#include <cstddef>
+#include <cstdint>
+#include "DHTFrame.h"
+
+#ifndef DHT_READ_TIMEOUT_MS
+#define DHT_READ_TIMEOUT_MS 20 /**< Longest to wait for a frame after the start signal; a frame takes about 5 ms. */
+#endif
+
+/**
+ * @brief Reads a DHT sensor through a pulse capture instead of bit-banging the line.
+ *
+ * The Adafruit driver times every bit with the CPU: it holds the start signal with
+ * delayMicroseconds() and then polls the line for the whole 4-5 ms frame with interrupts
+ * disabled. Here the start signal is a Hal::delay(), which lets other tasks run, and the
+ * frame is recorded by the RMT peripheral (see Hal::pulseCaptureBegin()) while the task
+ * waits on it. The CPU is busy for the few microseconds it takes to arm the capture and
+ * decode it.
+ *
+ * One transaction gives both temperature and humidity. Like the Adafruit driver, a read
+ * within the sensor's minimum interval (2 s for a DHT22, 1 s for a DHT11) returns the last
+ * result instead of starting another transaction the sensor would not answer.
+ *
+ * readAll() runs the transactions of several sensors at the same time: one start signal for
+ * all of them, then every frame is captured in parallel, so reading n sensors takes about as
+ * long as reading one.
+ *
+ * Example:
+ * @code
+ * DHTReader indoor(26);
+ * DHTReader outdoor(27);
+ * if (indoor.begin() && outdoor.begin()) {
+ *     DHTReader* readers[] = {&indoor, &outdoor};
+ *     DHTReader::readAll(readers, 2);
+ *     float temperature = indoor.getLastReading().temperature;
+ * }
+ * @endcode
+ */
+class DHTReader {
+public:
+    explicit DHTReader(uint8_t pin, DHTFrame::Model model = DHTFrame::Model::Dht22);
+    ~DHTReader();
+
+    DHTReader(const DHTReader&) = delete;
+    DHTReader& operator=(const DHTReader&) = delete;
+
+    /**
+     * @brief Takes a capture channel for the pin.
+     * @return False when none is free or captures are not supported; use another driver then.
+     */
+    bool begin();
+
+    /**
+     * @brief Reads temperature and humidity in one transaction.
+     * @return True with the values in out, false if the sensor did not answer or the frame was
+     * corrupt; getLastStatus() tells which.
+     */
+    bool read(DHTFrame::Reading& out);
+
+    /**
+     * @brief Reads several sensors with their transactions running at the same time.
+     * @return The number of sensors read successfully; each one's result is in its
+     * getLastReading() and getLastStatus().
+     */
+    static size_t readAll(DHTReader* const* readers, size_t count);
+
+    DHTFrame::Status getLastStatus() const { return lastStatus; }
+    const DHTFrame::Reading& getLastReading() const { return lastReading; }
+    uint8_t getPin() const { return pin; }
+
+private:
+    bool isFresh() const;             // The last transaction is within the minimum interval
+    void start();                     // Drives the start signal; the caller waits startMs()
+    void listen();                    // Arms the capture and releases the line
+    bool collect();                   // Waits for the frame and decodes it
+    uint32_t startMs() const;         // How long the start signal is held
+    uint32_t minIntervalMs() const;   // Shortest time between transactions
+
+    uint8_t pin;
+    DHTFrame::Model model;
+    bool started = false;             // Holds a capture channel
+    bool awaiting = false;            // Started a transaction whose frame is not collected yet
+    bool hasTransaction = false;      // A transaction has run
+    uint32_t lastTransactionMs = 0;
+    DHTFrame::Status lastStatus = DHTFrame::Status::NoResponse;
+    DHTFrame::Reading lastReading = {};
+};
+
+#endif // DHTREADER_H
@@ -3,27 +3,44 @@
 
 #include <DHT.h>
 #include "BaseSensor.h"
+#include "DHTReader.h"
 
 class DHTSensor : public BaseSensor {
 public:
     // Constructor
     DHTSensor(int pin, int dhtType = DHT22)
-        : BaseSensor(pin, "DHT Sensor", BaseSensor::SensorType::DHT), dht(pin, dhtType), lastError("") {}
+        : BaseSensor(pin, "DHT Sensor", BaseSensor::SensorType::DHT), dht(pin, dhtType),
+          reader(pin, dhtType == DHT11 ? DHTFrame::Model::Dht11 : DHTFrame::Model::Dht22), lastError("") {}
 
     // Initialize the sensor
     bool begin() override;
 
+    // Initialize the driver without begin()'s test read, for a sensor already known to be on the pin
+    void start();
+
     // Override the virtual method to get the temperature as the default reading
     float getReading() const override;
 
     // Override the virtual method to get the last error message
     const char* getErrorMessage() const override;
 
-    // Method to read both temperature and humidity
+    // Method to read both temperature and humidity, from one transaction
     bool readTempAndHumidity(float& temperature, float& humidity);
 
+    // Channel 0 is the temperature in degrees Celsius, channel 1 the relative humidity
+    size_t getChannelCount() const override { return 2; }
+    ChannelInfo getChannelInfo(size_t channel) const override;
+    bool readChannels(float* values) override;
+
+    // Whether the sensor is read through an RMT capture rather than the bit-banging driver
+    bool usesCapture() const { return useCapture; }
+
 private:
-    mutable DHT dht;                  // DHT sensor object
+    void startDriver();               // The capture when a channel is free, the Adafruit driver otherwise
+
+    mutable DHT dht;                  // Bit-banging driver, without a capture channel
+    mutable DHTReader reader;         // Capture driver
+    bool useCapture = false;          // reader holds a capture channel
     mutable std::string lastError;    // Stores the last error message
 };
 
@@ -0,0 +1,102 @@
+#ifndef LATESTVALUE_H
+#define LATESTVALUE_H
+
+#include <Hal.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#ifndef LATEST_VALUE_SPINS
+#define LATEST_VALUE_SPINS 64 /**< Retries of a read before it sleeps a tick to let the writer finish. */
+#endif
+
+/**
+ * @brief The latest value of a trivially copyable struct, published by one writer and read by
+ * any number of readers without a lock (a seqlock).
+ *
+ * The writer makes the sequence odd, stores the value and makes it even again. A reader copies
+ * the value between two reads of the sequence and retries if they differ or are odd, so it
+ * always gets one whole store and never a mix of two. Reads do not write shared memory and
+ * therefore do not slow down each other or the writer.
+ *
+ * The value is held as atomic words, stored with release and loaded with acquire ordering
+ * rather than through fences, so the copies are race-free under the C++ memory model and
+ * ThreadSanitizer can check them. On the ESP32 these are plain loads and stores plus a memory
+ * barrier. Only one task may call store() for a given value; give each writer its own
+ * LatestValue.
+ *
+ * A reader that keeps catching the writer mid-store sleeps a tick after LATEST_VALUE_SPINS
+ * tries, so a higher priority reader on the writer's core cannot spin forever.
+ *
+ * Example:
+ * @code
+ * LatestValue<SensorData> latest;
+ * latest.store(SensorData{{21.5f, 48.0f}, true, Hal::millis()}); // Sensor task
+ * SensorData data = latest.load();                              // Any other task
+ * @endcode
+ */
+template <typename T>
+class LatestValue {
+    static_assert(std::is_trivially_copyable<T>::value, "LatestValue copies the value word by word");
+
+public:
+    LatestValue() = default;
+    explicit LatestValue(const T& initial) { store(initial); }
+
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    /**
+     * @brief Publishes a new value. Only one task may store to a given LatestValue.
+     */
+    void store(const T& value) {
+        uint32_t buffer[wordCount] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        uint32_t sequence = version.load(std::memory_order_relaxed);
+        version.store(sequence + 1, std::memory_order_relaxed); // Odd: a store is in progress
+        for (size_t i = 0; i < wordCount; ++i) {
+            words[i].store(buffer[i], std::memory_order_release); // A reader that sees it sees the odd version
+        }
+        version.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns the latest whole value, or a zeroed T before the first store.
+     */
+    T load() const {
+        uint32_t buffer[wordCount];
+        for (uint32_t attempt = 1;; ++attempt) {
+            uint32_t before = version.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < wordCount; ++i) {
+                    buffer[i] = words[i].load(std::memory_order_acquire);
+                }
+                if (version.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            if (attempt % LATEST_VALUE_SPINS == 0) {
+                Hal::delay(1);
+            }
+        }
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Returns the number of stores so far, e.g. to tell whether a value is new.
+     */
+    uint32_t getStoreCount() const { return version.load(std::memory_order_acquire) / 2; }
+
+private:
+    static const size_t wordCount = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> version{0};          // Twice the stores, plus one during a store
+    std::atomic<uint32_t> words[wordCount] = {}; // The value, copied word by word
+};
+
+#endif // LATESTVALUE_H
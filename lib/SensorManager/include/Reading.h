@@ -0,0 +1,29 @@
+#ifndef READING_H
+#define READING_H
+
+#include <cstdint>
+
+/**
+ * @brief One value of one sensor channel at one time, whatever the sensor measures.
+ *
+ * A sensor has one or more channels, e.g. temperature and humidity for a DHT, each with a
+ * unit (see BaseSensor::getChannelInfo()). A reading names its sensor and channel instead of
+ * sitting in a field of a struct per sensor kind, so a new kind of sensor needs no new
+ * fields anywhere it is stored or sent. ReadingStore keeps them per channel.
+ */
+struct Reading {
+    enum class Unit : uint8_t {
+        None,
+        Celsius,
+        Percent,
+        Volts,
+    };
+
+    uint8_t sensorId;     /**< Index of the sensor, e.g. in its SensorManager. */
+    uint8_t channel;      /**< Channel of the sensor, from 0. */
+    Unit unit;
+    uint32_t timestampMs; /**< Hal::millis() of the reading. */
+    float value;
+};
+
+#endif // READING_H
@@ -0,0 +1,192 @@
+#ifndef READINGSTORE_H
+#define READINGSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Reading.h"
+
+/**
+ * @brief Recent readings of up to MaxChannels channels, Capacity of each, as structure-of-arrays
+ * rings.
+ *
+ * Each channel keeps its timestamps and its values in two arrays of their own, so a reading
+ * takes 8 bytes whatever sensor it came from, and the sensor, channel and unit are stored once
+ * per channel rather than once per reading. Bulk consumers (a publisher, the flash writer, an
+ * aggregation) walk a channel with forEachSpan(), which hands out the ring as at most two
+ * contiguous runs, oldest first. When a channel is full, append() overwrites its oldest
+ * reading and counts it in getOverwritten().
+ *
+ * Everything is in one fixed block and nothing is allocated. The store is not synchronized:
+ * fill and read it from one task, e.g. with SensorManager::appendReadings() from the task
+ * that publishes.
+ *
+ * Example:
+ * @code
+ * ReadingStore<4, 64> store;
+ * int temperature = store.addChannel(0, 0, Reading::Unit::Celsius, "temp");
+ * store.append(temperature, Hal::millis(), 21.5f);
+ * store.forEachSpan(temperature, [](const uint32_t* timestamps, const float* values, size_t count) {
+ *     // values[0..count) are contiguous
+ * });
+ * @endcode
+ */
+template <size_t MaxChannels, size_t Capacity>
+class ReadingStore {
+    static_assert(MaxChannels > 0 && Capacity > 0, "a store needs room for a channel and a reading");
+
+public:
+    /**
+     * @brief What a channel holds.
+     */
+    struct Channel {
+        uint8_t sensorId;
+        uint8_t channel;
+        Reading::Unit unit;
+        const char* name; /**< Field name for publishing, e.g. "temp"; not copied. */
+    };
+
+    static const size_t bytesPerReading = sizeof(uint32_t) + sizeof(float);
+
+    ReadingStore() = default;
+    ReadingStore(const ReadingStore&) = delete;
+    ReadingStore& operator=(const ReadingStore&) = delete;
+
+    /**
+     * @brief Adds a channel, or finds it if the sensor's channel is already there.
+     * @return Index of the channel, or -1 when MaxChannels are taken.
+     */
+    int addChannel(uint8_t sensorId, uint8_t channel, Reading::Unit unit, const char* name = "") {
+        int index = findChannel(sensorId, channel);
+        if (index >= 0 || channelCount == MaxChannels) {
+            return index;
+        }
+        channels[channelCount] = {sensorId, channel, unit, name};
+        return static_cast<int>(channelCount++);
+    }
+
+    /**
+     * @brief Index of a sensor's channel, or -1 if it has not been added.
+     */
+    int findChannel(uint8_t sensorId, uint8_t channel) const {
+        for (size_t i = 0; i < channelCount; ++i) {
+            if (channels[i].sensorId == sensorId && channels[i].channel == channel) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Appends to a channel from addChannel(), overwriting its oldest reading when full.
+     */
+    void append(size_t index, uint32_t timestampMs, float value) {
+        size_t slot = heads[index];
+        timestamps[index][slot] = timestampMs;
+        values[index][slot] = value;
+        heads[index] = slot + 1 == Capacity ? 0 : slot + 1;
+        if (counts[index] < Capacity) {
+            counts[index]++;
+        } else {
+            overwritten[index]++;
+        }
+    }
+
+    /**
+     * @brief Appends a reading, adding its channel if needed.
+     * @return False when the channel is new and MaxChannels are taken.
+     */
+    bool append(const Reading& reading) {
+        int index = addChannel(reading.sensorId, reading.channel, reading.unit);
+        if (index < 0) {
+            return false;
+        }
+        append(static_cast<size_t>(index), reading.timestampMs, reading.value);
+        return true;
+    }
+
+    size_t getChannelCount() const { return channelCount; }
+    const Channel& getChannel(size_t index) const { return channels[index]; }
+
+    /**
+     * @brief Readings a channel holds, at most Capacity.
+     */
+    size_t size(size_t index) const { return counts[index]; }
+
+    /**
+     * @brief Readings of a channel lost to newer ones since it was added.
+     */
+    uint32_t getOverwritten(size_t index) const { return overwritten[index]; }
+
+    /**
+     * @brief The i-th reading of a channel, 0 being the oldest; i must be below size().
+     */
+    Reading at(size_t index, size_t i) const {
+        size_t slot = oldest(index) + i;
+        slot = slot >= Capacity ? slot - Capacity : slot;
+        const Channel& channel = channels[index];
+        return {channel.sensorId, channel.channel, channel.unit, timestamps[index][slot], values[index][slot]};
+    }
+
+    /**
+     * @brief The newest reading of a channel.
+     * @return False if the channel holds none.
+     */
+    bool latest(size_t index, Reading& out) const {
+        if (counts[index] == 0) {
+            return false;
+        }
+        out = at(index, counts[index] - 1);
+        return true;
+    }
+
+    /**
+     * @brief Calls fn(const uint32_t* timestamps, const float* values, size_t count) for each
+     * contiguous run of a channel's readings, oldest first: once, or twice once the ring wraps.
+     * @return The number of readings visited.
+     */
+    template <typename Fn>
+    size_t forEachSpan(size_t index, Fn fn) const {
+        size_t count = counts[index];
+        size_t first = oldest(index);
+        size_t run = first + count > Capacity ? Capacity - first : count;
+        if (run > 0) {
+            fn(&timestamps[index][first], &values[index][first], run);
+        }
+        if (run < count) {
+            fn(&timestamps[index][0], &values[index][0], count - run);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Drops the readings of a channel, e.g. once they are published; keeps the channel.
+     */
+    void clear(size_t index) {
+        heads[index] = 0;
+        counts[index] = 0;
+    }
+
+    /**
+     * @brief Drops the readings of every channel.
+     */
+    void clear() {
+        for (size_t i = 0; i < channelCount; ++i) {
+            clear(i);
+        }
+    }
+
+private:
+    size_t oldest(size_t index) const {
+        return counts[index] < Capacity ? 0 : heads[index];
+    }
+
+    Channel channels[MaxChannels] = {};
+    size_t channelCount = 0;
+    size_t heads[MaxChannels] = {};         // Slot the next reading goes to
+    size_t counts[MaxChannels] = {};
+    uint32_t overwritten[MaxChannels] = {};
+    uint32_t timestamps[MaxChannels][Capacity] = {};
+    float values[MaxChannels][Capacity] = {};
+};
+
+#endif // READINGSTORE_H
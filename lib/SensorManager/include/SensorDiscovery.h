@@ -0,0 +1,148 @@
+#ifndef SENSORDISCOVERY_H
+#define SENSORDISCOVERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BaseSensor.h"
+
+#ifndef SENSOR_DISCOVERY_MAX_PINS
+#define SENSOR_DISCOVERY_MAX_PINS 8 /**< Pins a discovery covers; a multiple of 4 keeps State free of padding. */
+#endif
+
+#ifndef SENSOR_DISCOVERY_MANIFEST
+#define SENSOR_DISCOVERY_MANIFEST "/sensors.bin" /**< LittleFS path of the manifest kept for cold boots. */
+#endif
+
+#ifndef SENSOR_DISCOVERY_TIMEOUT_MS
+#define SENSOR_DISCOVERY_TIMEOUT_MS 3000 /**< Longest a rescan waits for its probes. */
+#endif
+
+/**
+ * @brief Finds out which sensor is on each pin once and remembers it, so a wake does not probe
+ * the pins again.
+ *
+ * Probing is slow: a DHT test read can time out and a battery sensor's reading averages
+ * thousands of ADC samples. The result of a probe is kept in two places: a State in RTC memory
+ * that survives deep sleep, and a manifest file on LittleFS for boots after a power loss. Both
+ * carry a fingerprint of the pins they describe and a checksum, and are ignored when either
+ * does not match, e.g. after the pin list changed in a firmware update or the RTC memory was
+ * lost.
+ *
+ * When neither cache matches, every pin is probed in a task of its own and discover() waits at
+ * most timeoutMs for them. Pins whose probe has not answered by then count as empty and the
+ * result is not cached, so the next boot probes again. Call forget() when a cached sensor turns
+ * out to be missing.
+ *
+ * The state is owned by the caller so it can be declared HAL_RTC_DATA. LittleFS must be mounted
+ * for the manifest to be read or written; without it only the RTC cache is used.
+ *
+ * Example:
+ * @code
+ * HAL_RTC_DATA SensorDiscovery::State discoveryState;
+ * SensorDiscovery discovery(discoveryState, probePin);
+ * for (const SensorDiscovery::Found& found : discovery.discover({26, 27})) {
+ *     // Create the sensor for found.type on found.pin
+ * }
+ * @endcode
+ */
+class SensorDiscovery {
+public:
+    /**
+     * @brief Decides which sensor is on a pin; SensorType::Undefined for none. Runs in a task of
+     * its own, concurrently with the probes of the other pins.
+     */
+    using Probe = std::function<BaseSensor::SensorType(int pin)>;
+
+    /**
+     * @brief A sensor found on a pin.
+     */
+    struct Found {
+        int pin;                     /**< The pin the sensor is on. */
+        BaseSensor::SensorType type; /**< The kind of sensor. */
+    };
+
+    /**
+     * @brief Where the last discover() got its result from.
+     */
+    enum class Source {
+        None,     /**< discover() has not run. */
+        Rtc,      /**< The RTC cache, on a wake from deep sleep. */
+        Manifest, /**< The LittleFS manifest, on a cold boot. */
+        Probe,    /**< Probing the pins. */
+    };
+
+    /**
+     * @brief Cached discovery. Zero-initialized memory reads as an empty cache.
+     *
+     * The same bytes are written to the manifest. The fields are ordered so the struct has no
+     * padding and the checksum covers only data.
+     */
+    struct State {
+        uint32_t magic;                           /**< stateMagic once the cache has been written. */
+        uint32_t fingerprint;                     /**< fingerprintOf() the probed pins. */
+        uint8_t count;                            /**< Pins probed. */
+        uint8_t reserved[3];                      /**< Keeps the layout free of padding. */
+        uint8_t pins[SENSOR_DISCOVERY_MAX_PINS];  /**< The probed pins, in order. */
+        uint8_t types[SENSOR_DISCOVERY_MAX_PINS]; /**< SensorType found on each pin. */
+        uint32_t checksum;                        /**< Over every field above. */
+    };
+
+    /**
+     * @brief Constructs a discovery over a state.
+     * @param state The cached discovery, typically declared HAL_RTC_DATA.
+     * @param probe Decides the sensor on one pin when the caches do not match.
+     * @param manifestPath LittleFS path of the manifest, or nullptr to use the RTC cache only.
+     */
+    SensorDiscovery(State& state, Probe probe, const char* manifestPath = SENSOR_DISCOVERY_MANIFEST);
+
+    /**
+     * @brief Returns the sensors on pins, from a cache when one matches and by probing otherwise.
+     *
+     * Only the first SENSOR_DISCOVERY_MAX_PINS pins are considered.
+     * @param pins The pins to look at.
+     * @param timeoutMs Longest to wait for the probes when the pins have to be probed.
+     * @return The sensors found, in the order of pins.
+     */
+    std::vector<Found> discover(const std::vector<int>& pins, uint32_t timeoutMs = SENSOR_DISCOVERY_TIMEOUT_MS);
+
+    /**
+     * @brief Drops the RTC cache and the manifest, so the next discover() probes.
+     */
+    void forget();
+
+    /**
+     * @brief Returns where the last discover() got its result from.
+     */
+    Source getLastSource() const { return lastSource; }
+
+    /**
+     * @brief Checks whether the last probe finished within its timeout. True after a cache hit.
+     */
+    bool isComplete() const { return complete; }
+
+    /**
+     * @brief Hashes a pin list together with the state layout, so a cache is only used for the
+     * pins it was made for.
+     */
+    static uint32_t fingerprintOf(const std::vector<int>& pins);
+
+    static const uint32_t stateMagic = 0x53444953; // "SDIS"
+
+private:
+    State probe(const std::vector<int>& pins, uint32_t fingerprint, uint32_t timeoutMs); // Sets complete
+    bool loadManifest(State& out) const;
+    void saveManifest() const;
+    static bool matches(const State& candidate, uint32_t fingerprint); // Valid and made for these pins
+    static std::vector<Found> foundIn(const State& candidate);         // The sensors a state records
+    static uint32_t checksumOf(const State& state);
+
+    State& state;             // Cached discovery, usually in RTC memory
+    Probe probeFunction;      // Decides the sensor on one pin
+    const char* manifestPath; // nullptr when there is no manifest
+    Source lastSource = Source::None;
+    bool complete = true;
+};
+
+#endif // SENSORDISCOVERY_H
@@ -1,14 +1,31 @@
 #ifndef SENSORMANAGER_H
 #define SENSORMANAGER_H
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include "BaseSensor.h"
 #include "DHTSensor.h"
 #include "BatteryZenerSensor.h"
+#include "LatestValue.h"
+#include "Reading.h"
+#include "ReadingStore.h"
+#include "SensorDiscovery.h"
+#include "SensorPool.h"
+#include "SensorScheduler.h"
 
+#ifndef SENSOR_MANAGER_MAX_SENSORS
+#define SENSOR_MANAGER_MAX_SENSORS 8 /**< Sensors a SensorManager can hold; results live in a fixed array. */
+#endif
+
+#ifndef SENSOR_MANAGER_MAX_CHANNELS
+#define SENSOR_MANAGER_MAX_CHANNELS 2 /**< Values one reading of a sensor can have; see BaseSensor::getChannelCount(). */
+#endif
+
+// The latest reading of a sensor; values[i] is channel i as its BaseSensor::getChannelInfo() describes
 struct SensorData {
-    float temperature;
-    float humidity;
+    float values[SENSOR_MANAGER_MAX_CHANNELS];
     bool isValid;
     unsigned long lastReadTime; // Timestamp of the last successful read
 };
@@ -22,24 +39,91 @@ public:
     bool registerSensor(int pin, BaseSensor::SensorType type, const String& sensorName);
 
     bool registerSensor(int pin, float highVoltage = 4.2, float lowVoltage = 2.5);
-    // Scan for sensors on default pins
+    // Register the sensors on the default pins. The pins are probed once, in parallel, and the
+    // result is kept in RTC memory and on LittleFS (mount it first), so later boots skip the probe
     void scanForSensors();
 
-    // Start concurrent reading tasks
-    void startConcurrentReading();
+    // Start the reading tasks: one scheduler task that sleeps until the next sensor is due, or with
+    // taskPerBus one per bus, so a slow DHT read does not hold up sensors on other pins. Register
+    // every sensor first; registering fails once the tasks run
+    void startConcurrentReading(bool taskPerBus = false);
+
+    // Read every sensor whose refresh interval has passed, once - for callers without the tasks
+    void pollSensors();
 
-    // Get the latest sensor data
+    // Change how often a sensor is read; takes effect from its next reading, also once the
+    // reading tasks run
+    void setRefreshInterval(int index, unsigned long intervalMs);
+
+    // Get the latest sensor data; safe from any task while the reading tasks run. Channels 0 and
+    // 1, which are temperature and humidity for a DHT
     bool getSensorData(int index, float& temperature, float& humidity);
 
+    // Get the latest value of one channel of a sensor, with its unit and time
+    bool getReading(int index, size_t channel, Reading& out) const;
+
+    // Copy a consistent snapshot of every sensor's latest data, without locking; returns the
+    // number of sensors, of which at most capacity are copied
+    size_t snapshotAll(SensorData* out, size_t capacity) const;
+
+    // Number of registered sensors
+    size_t getSensorCount() const { return sensorCount.load(std::memory_order_acquire); }
+
+    // Append each channel's latest reading to store unless the store already has it, adding the
+    // channels as they come; returns the number appended. Call it from the task that owns store
+    template <size_t MaxChannels, size_t Capacity>
+    size_t appendReadings(ReadingStore<MaxChannels, Capacity>& store) const;
+
 private:
     void waitForSensor(BaseSensor& sensor); // Waits for the sensor to refresh
+    bool addSensor(BaseSensor* sensor);     // Adds a sensor with its default interval, unless the tasks run
+    void readSensor(size_t index);          // Reads one sensor into its result
+    void buildSchedules(bool taskPerBus);   // One scheduler, or one per bus
+    static int busOf(const BaseSensor& sensor); // Sensors on the same bus must not be read concurrently
+    static BaseSensor::SensorType probePin(int pin); // Decides the sensor on a pin for the discovery
 
-    static void sensorTask(void* parameters); // Task function for FreeRTOS
-
-    std::vector<BaseSensor*> sensors;  // Vector of sensor pointers
-    std::vector<SensorData> sensorResults; // Vector to store sensor data
+    // Fixed arrays, so a registration never moves a result under a reader; a slot is filled
+    // before sensorCount is raised to include it
+    SensorPool<BaseSensor, SENSOR_MANAGER_MAX_SENSORS, DHTSensor, BatteryZenerSensor> pool; // Holds the sensors, no heap
+    std::array<BaseSensor*, SENSOR_MANAGER_MAX_SENSORS> sensors = {};
+    std::array<LatestValue<SensorData>, SENSOR_MANAGER_MAX_SENSORS> sensorResults; // Written by the sensor's task only
+    std::atomic<size_t> sensorCount{0};
+    std::vector<unsigned long> refreshIntervals; // Per sensor, in ms
+    std::vector<std::unique_ptr<SensorScheduler>> schedulers; // Built on the first poll or start
+    struct ScheduledRead {
+        SensorScheduler* scheduler;
+        size_t id;
+    };
+    std::vector<ScheduledRead> scheduledReads; // Per sensor, its job in schedulers
+    bool tasksStarted = false;
+    SensorDiscovery discovery; // Remembers what scanForSensors() found
+    std::atomic<bool> discoveryUnconfirmed{false}; // Sensors came from the cache and none has failed its first read yet
     const std::vector<int> defaultPins = {26, 27}; // Default pins for DHT22 and other sensors
     const unsigned long refreshInterval = 2000; // 2 seconds between sensor reads
+    const unsigned long batteryRefreshInterval = 30000; // The level moves slowly and a reading keeps the ADC busy
 };
 
+template <size_t MaxChannels, size_t Capacity>
+size_t SensorManager::appendReadings(ReadingStore<MaxChannels, Capacity>& store) const {
+    size_t count = 0;
+    size_t sensorTotal = getSensorCount();
+    for (size_t i = 0; i < sensorTotal; ++i) {
+        const SensorData data = sensorResults[i].load();
+        if (!data.isValid) {
+            continue;
+        }
+        for (size_t channel = 0; channel < sensors[i]->getChannelCount(); ++channel) {
+            BaseSensor::ChannelInfo info = sensors[i]->getChannelInfo(channel);
+            int index = store.addChannel(static_cast<uint8_t>(i), static_cast<uint8_t>(channel), info.unit, info.name);
+            Reading last;
+            if (index < 0 || (store.latest(index, last) && last.timestampMs == static_cast<uint32_t>(data.lastReadTime))) {
+                continue; // No room for the channel, or nothing new on it
+            }
+            store.append(index, static_cast<uint32_t>(data.lastReadTime), data.values[channel]);
+            count++;
+        }
+    }
+    return count;
+}
+
 #endif // SENSORMANAGER_H
@@ -0,0 +1,94 @@
+#ifndef SENSORPOOL_H
+#define SENSORPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Fixed-capacity storage for sensors registered at runtime, in place of new and delete.
+ *
+ * The pool holds Capacity slots, each large and aligned enough for any of Types, in one static
+ * block: creating a sensor is a placement new into a free slot, destroying it runs its
+ * destructor and frees the slot. Nothing is taken from the heap, so probing pins in
+ * scanForSensors() cannot fragment it, and the pool's whole footprint shows in the RAM the
+ * linker reports. Sensors left in the pool are destroyed with it.
+ *
+ * Example:
+ * @code
+ * SensorPool<BaseSensor, 8, DHTSensor, BatteryZenerSensor> pool;
+ * BaseSensor* sensor = pool.create<DHTSensor>(26);
+ * if (sensor == nullptr || !sensor->begin()) {
+ *     pool.destroy(sensor);
+ * }
+ * @endcode
+ */
+template <typename Base, size_t Capacity, typename... Types>
+class SensorPool {
+public:
+    static constexpr size_t slotSize = std::max({sizeof(Types)...});
+    static constexpr size_t slotAlign = std::max({alignof(Types)...});
+
+    SensorPool() = default;
+    SensorPool(const SensorPool&) = delete;
+    SensorPool& operator=(const SensorPool&) = delete;
+
+    ~SensorPool() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (objects[i] != nullptr) {
+                objects[i]->~Base();
+            }
+        }
+    }
+
+    /**
+     * @brief Constructs a T in a free slot.
+     * @return The sensor, or nullptr when every slot is taken.
+     */
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_base_of<Base, T>::value, "pool slots are destroyed through Base");
+        static_assert(sizeof(T) <= slotSize && alignof(T) <= slotAlign, "add the type to the pool's Types");
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (objects[i] == nullptr) {
+                T* object = new (slots[i].bytes) T(std::forward<Args>(args)...);
+                objects[i] = object;
+                count++;
+                return object;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Destroys a sensor made by create() and frees its slot. Ignores nullptr and
+     * pointers the pool did not make.
+     */
+    void destroy(Base* object) {
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (object != nullptr && objects[i] == object) {
+                object->~Base();
+                objects[i] = nullptr;
+                count--;
+                return;
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Slot {
+        alignas(slotAlign) unsigned char bytes[slotSize];
+    };
+
+    Slot slots[Capacity];
+    Base* objects[Capacity] = {}; // The Base subobject of each slot's sensor, nullptr when free
+    size_t count = 0;
+};
+
+#endif // SENSORPOOL_H
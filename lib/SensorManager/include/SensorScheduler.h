@@ -0,0 +1,110 @@
+#ifndef SENSORSCHEDULER_H
+#define SENSORSCHEDULER_H
+
+#include <Hal.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Runs periodic jobs, each on its own interval, from one task that sleeps until the
+ * next one is due.
+ *
+ * The due times are kept in a min-heap, so finding the next job is O(1) and rescheduling it
+ * O(log n): the task wakes once per deadline rather than on a fixed tick, and does not look at
+ * the jobs that are not due. A job that runs late is rescheduled from its deadline, so the
+ * lateness does not accumulate; one that falls a whole interval behind skips the missed runs
+ * instead of running back to back.
+ *
+ * Add every job before run() starts; setInterval() is the one call that is safe from another
+ * task while it runs. A scheduler belongs to the task that runs it, so jobs that
+ * must not run concurrently (sensors on the same bus) share a scheduler and independent ones can
+ * each get their own task.
+ *
+ * Example:
+ * @code
+ * SensorScheduler scheduler;
+ * scheduler.add(2000, [&dht] { dht.readTempAndHumidity(temperature, humidity); });
+ * scheduler.add(30000, [&battery] { level = battery.getReading(); });
+ * Hal::startTask("Sensors", SensorScheduler::task, &scheduler);
+ * @endcode
+ */
+class SensorScheduler {
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * @brief Wakeups and lateness since the scheduler was created.
+     */
+    struct Stats {
+        uint32_t wakeups;    /**< Calls to runDue(), i.e. times the task woke. */
+        uint32_t runs;       /**< Jobs run. */
+        uint32_t skipped;    /**< Runs skipped because a job fell an interval behind. */
+        uint32_t maxLateMs;  /**< Largest delay between a deadline and its run. */
+        uint64_t totalLateMs; /**< Sum of those delays, for the mean. */
+    };
+
+    /**
+     * @brief Adds a job that first runs firstDelayMs from now and then every intervalMs.
+     * @return The job's id, its index in the order of adding.
+     */
+    size_t add(uint32_t intervalMs, Job job, uint32_t firstDelayMs = 0);
+
+    /**
+     * @brief Changes a job's interval from its next run on. Safe from any task, also while
+     * run() is running: the deadline already set is kept, the one after it uses the new interval.
+     */
+    void setInterval(size_t id, uint32_t intervalMs);
+
+    /**
+     * @brief Runs every job whose deadline is at or before nowMs, each once.
+     * @return Milliseconds from nowMs until the next deadline, or UINT32_MAX with no jobs.
+     */
+    uint32_t runDue(uint32_t nowMs);
+
+    /**
+     * @brief Runs the jobs until stop() is called: runDue(), then Hal::delay() until the next
+     * deadline. A stop takes effect when the current sleep ends.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return after its current sleep, or at once if it has not started.
+     */
+    void stop() { stopping.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Hal::startTask() entry point: runs the scheduler passed as parameters.
+     */
+    static void task(void* parameters);
+
+    size_t size() const { return jobs.size(); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Entry {
+        uint32_t dueMs;
+        uint32_t id;
+    };
+
+    struct Scheduled {
+        Scheduled(uint32_t intervalMs, Job job) : intervalMs(intervalMs), job(std::move(job)) {}
+        Scheduled(Scheduled&& other) noexcept
+            : intervalMs(other.intervalMs.load(std::memory_order_relaxed)), job(std::move(other.job)) {}
+
+        std::atomic<uint32_t> intervalMs; // setInterval() may change it from another task
+        Job job;
+    };
+
+    static bool later(const Entry& a, const Entry& b); // Heap order, safe across millis() wrapping
+
+    std::vector<Scheduled> jobs;
+    std::vector<Entry> heap; // Earliest deadline at the front
+    std::vector<Entry> due;  // Jobs of the current runDue(), reused to avoid allocating
+    Stats stats = {};
+    std::atomic<bool> stopping{false};
+};
+
+#endif // SENSORSCHEDULER_H
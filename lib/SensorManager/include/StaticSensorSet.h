@@ -0,0 +1,78 @@
+#ifndef STATICSENSORSET_H
+#define STATICSENSORSET_H
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief A sensor set fixed at compile time and read without virtual calls.
+ *
+ * The sensors are statically allocated objects (globals or statics) and the set is a tuple of
+ * references to them, so nothing is on the heap and the RAM they take is known to the linker;
+ * sensors hold ADC buffers and driver state that cannot be copied, so the set does not own
+ * them. Every call names the concrete type (`sensor.Sensor::getReading()`), so it is a
+ * direct call the compiler can inline, with no vtable lookup and no getType() check and
+ * downcast as in SensorManager's runtime path. The sensor types need not derive from
+ * BaseSensor; they only need begin() and getReading().
+ *
+ * Use it when the board's sensors are known when building; SensorManager remains for sets
+ * found at runtime by scanForSensors().
+ *
+ * Example:
+ * @code
+ * DHTSensor indoor(26);
+ * DHTSensor outdoor(27);
+ * BatteryZenerSensor battery(4.2, 2.7, 34, -1);
+ * StaticSensorSet sensors(indoor, outdoor, battery); // StaticSensorSet<DHTSensor, DHTSensor, BatteryZenerSensor>
+ *
+ * sensors.beginAll();
+ * float readings[sensors.size];
+ * sensors.readAll(readings);
+ * float level = sensors.get<2>().getReading();
+ * @endcode
+ */
+template <typename... Sensors>
+class StaticSensorSet {
+public:
+    static constexpr size_t size = sizeof...(Sensors);
+
+    explicit StaticSensorSet(Sensors&... members) : sensors(members...) {}
+
+    /**
+     * @brief Calls begin() on every sensor.
+     * @return True if all of them started.
+     */
+    bool beginAll() const {
+        return std::apply([](Sensors&... sensor) { return (static_cast<int>(sensor.Sensors::begin()) & ... & 1) != 0; }, sensors);
+    }
+
+    /**
+     * @brief Reads every sensor into out[0] to out[size - 1], in declaration order.
+     */
+    void readAll(float* out) const {
+        std::apply([out](const Sensors&... sensor) {
+            size_t index = 0;
+            ((out[index++] = sensor.Sensors::getReading()), ...);
+        }, sensors);
+    }
+
+    /**
+     * @brief Calls visit(sensor) for every sensor with its concrete type, in declaration order.
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        std::apply([&visit](Sensors&... sensor) { (visit(sensor), ...); }, sensors);
+    }
+
+    /**
+     * @brief Returns the sensor at a compile-time index.
+     */
+    template <size_t Index>
+    auto& get() const { return std::get<Index>(sensors); }
+
+private:
+    std::tuple<Sensors&...> sensors;
+};
+
+#endif // STATICSENSORSET_H
@@ -0,0 +1,144 @@
+#include "AdcSampler.h"
+#include <cmath>
+
+void SampleStats::add(uint16_t value) {
+    count++;
+    sum += value;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+void SampleStats::addBatch(const uint16_t* values, size_t batchCount) {
+    if (batchCount == 0) {
+        return;
+    }
+    uint32_t batchSum = 0;
+    uint64_t sumSquares = 0;
+    for (size_t i = 0; i < batchCount; ++i) {
+        batchSum += values[i];
+        sumSquares += static_cast<uint32_t>(values[i]) * values[i];
+    }
+
+    double batchMean = static_cast<double>(batchSum) / batchCount;
+    double batchM2 = static_cast<double>(sumSquares) - static_cast<double>(batchSum) * batchMean;
+    double total = static_cast<double>(count) + batchCount;
+    double delta = batchMean - mean;
+    mean += delta * batchCount / total;
+    m2 += batchM2 + delta * delta * count * batchCount / total;
+    count += static_cast<uint32_t>(batchCount);
+    sum += batchSum;
+}
+
+void SampleStats::reset() {
+    count = 0;
+    sum = 0;
+    mean = 0;
+    m2 = 0;
+}
+
+float SampleStats::getVariance() const {
+    return count > 1 ? static_cast<float>(m2 / (count - 1)) : 0.0f;
+}
+
+float SampleStats::getStandardError() const {
+    return count > 1 ? std::sqrt(getVariance() / count) : 0.0f;
+}
+
+AdcSampler::Config AdcSampler::defaultConfig() {
+    return Config{20000, 500, 10000, 0.0f, 100};
+}
+
+AdcSampler::AdcSampler(uint8_t pin, Config config) : pin(pin), config(config) {
+    if (this->config.maxSamples == 0) {
+        this->config.maxSamples = 1;
+    }
+}
+
+AdcSampler::~AdcSampler() {
+    stop();
+}
+
+bool AdcSampler::start() {
+    stop();
+    stats.reset();
+    taken = 0;
+    timedOut = false;
+    running = true;
+
+    // No larger than the reading, so a short one does not wait for samples it will not use;
+    // a multiple of 4 as the ESP32's DMA frames are word aligned
+    uint32_t frameSamples = config.maxSamples < ADC_SAMPLER_FRAME_SAMPLES ? config.maxSamples : ADC_SAMPLER_FRAME_SAMPLES;
+    frameSamples = (frameSamples + 3) / 4 * 4;
+    if (frameSamples > ADC_SAMPLER_FRAME_SAMPLES) {
+        frameSamples = ADC_SAMPLER_FRAME_SAMPLES;
+    }
+    streaming = Hal::adcStreamBegin(pin, config.sampleRateHz, frameSamples);
+    return streaming;
+}
+
+bool AdcSampler::poll() {
+    if (running) {
+        take(0);
+    }
+    return !running;
+}
+
+bool AdcSampler::run() {
+    while (running) {
+        if (!take(config.timeoutMs) && streaming) {
+            timedOut = true; // The DMA stopped delivering; keep what arrived
+            stop();
+        }
+    }
+    return !timedOut && stats.getCount() > 0;
+}
+
+void AdcSampler::stop() {
+    if (streaming) {
+        Hal::adcStreamEnd();
+        streaming = false;
+    }
+    running = false;
+}
+
+bool AdcSampler::take(uint32_t timeoutMs) {
+    size_t wanted = config.maxSamples - taken;
+    if (wanted > ADC_SAMPLER_FRAME_SAMPLES) {
+        wanted = ADC_SAMPLER_FRAME_SAMPLES;
+    }
+
+    size_t count = 0;
+    if (streaming) {
+        count = Hal::adcStreamRead(frame, wanted, timeoutMs);
+        stats.addBatch(frame, count);
+    } else {
+        if (wanted > ADC_SAMPLER_FALLBACK_CHUNK) {
+            wanted = ADC_SAMPLER_FALLBACK_CHUNK; // Each read costs CPU time, so check more often
+        }
+        size_t valid = 0;
+        for (; count < wanted; ++count) {
+            int value = Hal::analogRead(pin);
+            if (value >= 0) { // Skip failed conversions
+                frame[valid++] = static_cast<uint16_t>(value);
+            }
+        }
+        stats.addBatch(frame, valid);
+    }
+
+    taken += static_cast<uint32_t>(count);
+    if (isComplete()) {
+        stop();
+    }
+    return count > 0;
+}
+
+bool AdcSampler::isComplete() const {
+    if (taken >= config.maxSamples) {
+        return true;
+    }
+    if (config.maxStandardError <= 0 || stats.getCount() < config.minSamples) {
+        return false;
+    }
+    return stats.getStandardError() <= config.maxStandardError;
+}
@@ -1,22 +1,39 @@
 #include "BatteryZenerSensor.h"
 
+namespace {
+
+// Sampler settings for a reading of at most numOfReadings samples that stops at maxErrorMv
+AdcSampler::Config samplerConfig(int numOfReadings, float maxErrorMv) {
+    // Millivolts at the battery to ADC counts at the pin, behind the divider
+    const float pinMvPerCount = static_cast<float>(BATTERY_ADC_VREF_MV) * BatteryCalibration::atten11dbScale /
+                                4096.0f / BatteryCalibration::slopeScale;
+    const float countsPerMv = static_cast<float>(BATTERY_DIVIDER_R2) / (BATTERY_DIVIDER_R1 + BATTERY_DIVIDER_R2) / pinMvPerCount;
+    const uint32_t minSamples = 64; // Fewer give too rough an estimate of the noise to stop on
+    return AdcSampler::Config{20000, minSamples, static_cast<uint32_t>(numOfReadings > 0 ? numOfReadings : 1),
+                              maxErrorMv * countsPerMv, 100};
+}
+
+} // namespace
+
 // Constructor
-BatteryZenerSensor::BatteryZenerSensor(float battVoltHigh, float battVoltLow, int batteryPin, int controlPin, int numOfReadings)
+BatteryZenerSensor::BatteryZenerSensor(float battVoltHigh, float battVoltLow, int batteryPin, int controlPin, int numOfReadings,
+                                       float maxErrorMv)
     : BaseSensor(batteryPin, "Battery Zener Sensor", SensorType::BatteryZener),
-      battVoltHigh(battVoltHigh), battVoltLow(battVoltLow),
-      batteryPin(batteryPin), controlPin(controlPin), lastError(""), numOfReadings(numOfReadings) {}
+      battMillivoltsHigh(static_cast<uint32_t>(battVoltHigh * 1000 + 0.5f)),
+      battMillivoltsLow(static_cast<uint32_t>(battVoltLow * 1000 + 0.5f)),
+      batteryPin(batteryPin), controlPin(controlPin), lastError(""), numOfReadings(numOfReadings),
+      sampler(batteryPin, samplerConfig(numOfReadings, maxErrorMv)) {}
 
 // Initialize the sensor
 bool BatteryZenerSensor::begin() {
     // Set up the control pin if available
     if (controlPin >= 0) {
-        pinMode(controlPin, OUTPUT);
-        digitalWrite(controlPin, HIGH); // Enable the sensor
+        Hal::pinMode(controlPin, Hal::PinMode::Output);
+        Hal::digitalWrite(controlPin, true); // Enable the sensor
     }
 
     // Perform a test read to ensure initialization
-    float voltage = readPin();
-    if (voltage < 0) {
+    if (readPin() < 0) {
         lastError = "Failed to initialize battery sensor!";
         return false;
     }
@@ -26,39 +43,27 @@ bool BatteryZenerSensor::begin() {
 }
 
 /**
- * @brief takes 10,000 samples of the battery voltage and returns the average 
- * @return float of battery voltage converted to a percent of capacity
+ * @brief Streams the battery pin while the other sensors are not ready and returns the average
+ * once they are. The ADC stops on its own once the average is precise enough.
+ * @return float of battery voltage converted to a percent of capacity, -1 while sampling
  */
- 
 float BatteryZenerSensor::getReading(const bool* readyToReport) const {
-    static float batteryValues = 0.0;          // Accumulator for readings
-    static int numSamples = 0;                 // Count of samples taken
-    static unsigned long lastSampleTime = 0;   // Timestamp of last sample
-    const unsigned long sampleInterval = 5;    // Interval between samples (ms)
-
     // Check if sensors are not ready
     if (!(*readyToReport)) {
-        // Time to take a new sample
-        if (millis() - lastSampleTime >= sampleInterval) {
-            lastSampleTime = millis();
-            batteryValues += readPin(); // Accumulate readings
-            numSamples++;
+        if (!sampling) {
+            sampler.start();
+            sampling = true;
         }
+        sampler.poll(); // Folds in the finished DMA frames without waiting
         // Return -1 to indicate ongoing sampling
         return -1;
     }
 
     // Sensors are ready, finalize the calculation
-    if (numSamples > 0) {
-        float averagedVoltage = batteryValues / numSamples;
-
-        // Reset static variables for the next cycle
-        batteryValues = 0.0;
-        numSamples = 0;
-
-        // Normalize and convert to percentage
-        float normalizedVoltage = convertToNormalLevel(averagedVoltage);
-        return convertToPercentage(normalizedVoltage);
+    if (sampling) {
+        sampling = false;
+        sampler.stop();
+        return readingFromSampler();
     }
 
     // No samples taken - this is an error state
@@ -66,64 +71,52 @@ float BatteryZenerSensor::getReading(const bool* readyToReport) const {
     return -1;
 }
 
+/**
+ * @brief Averages samples of the battery voltage, streamed by the ADC's DMA, until the standard
+ * error is below maxErrorMv or numOfReadings samples have been taken
+ * @return float of battery voltage converted to a percent of capacity, -1 if no sample was read
+ */
 float BatteryZenerSensor::getReading() const {
-    float batteryValues = 0.0; // Accumulator for readings
+    sampler.start();
+    sampler.run();
+    return readingFromSampler();
+}
 
-    // Take numOfReadings samples
-    for (int i = 0; i < numOfReadings; i++) {
-        batteryValues += readPin();
+float BatteryZenerSensor::readingFromSampler() const {
+    const SampleStats& stats = sampler.getStats();
+    if (stats.getCount() == 0) {
+        lastError = "[ERROR] Battery reading took no samples";
+        return -1;
     }
 
-    // Calculate the average voltage
-    float averagedVoltage = batteryValues / numOfReadings;
-
-    // Normalize the voltage and convert to percentage
-    float normalizedVoltage = convertToNormalLevel(averagedVoltage);
-    return convertToPercentage(normalizedVoltage);
+    // Samples are summed in counts; convert once per reading, from the mean in 1/16 counts
+    uint64_t count = stats.getCount();
+    uint32_t countsQ4 = static_cast<uint32_t>((stats.getSum() * BatteryCalibration::countsScale + count / 2) / count);
+    uint32_t millivolts = BatteryCalibration::batteryMillivolts(countsQ4);
+    if (millivolts >= battMillivoltsHigh) {
+        return 100;
+    }
+    if (millivolts <= battMillivoltsLow) {
+        return 0;
+    }
+    return BatteryCalibration::centiPercentFromCounts(countsQ4) / 100.0f;
 }
 
-// Override to get the last error message
-const char* BatteryZenerSensor::getErrorMessage() const {
-    return lastError.c_str();
+uint32_t BatteryZenerSensor::getSamplesUsed() const {
+    return sampler.getStats().getCount();
 }
 
-// Read the raw voltage from the battery pin
-float BatteryZenerSensor::readPin() const {
-    // Assuming a 12-bit ADC (0-4095), convert the ADC reading to a voltage
-    int adcValue = analogRead(batteryPin);
-    if (adcValue < 0) { // ADC read error
-        return -1.0;
-    }
-    const float voltage = (adcValue / 4095.0) * 3.3; // Adjust based on your ADC reference voltage
-    return voltage;
+// One channel, the charge left in percent
+BaseSensor::ChannelInfo BatteryZenerSensor::getChannelInfo(size_t) const {
+    return {"battery", Reading::Unit::Percent};
 }
 
-// Convert the raw voltage from the voltage divider to the actual battery voltage
-float BatteryZenerSensor::convertToNormalLevel(float rawVoltage, const float R1, const float R2 ) const {
-    // Divider ratio: R2 / (R1 + R2)
-    const float dividerRatio = R2 / (R1 + R2); // Using 36kΩ and 10kΩ resistors will put us in a voltage range of ~ 1.91V-3.27V
-    // Calculate the actual battery voltage
-    float batteryVoltage = rawVoltage / dividerRatio;
-    return batteryVoltage;
+// Override to get the last error message
+const char* BatteryZenerSensor::getErrorMessage() const {
+    return lastError.c_str();
 }
 
-
-// Convert the battery voltage to a percentage
-float BatteryZenerSensor::convertToPercentage(float batteryVoltage) const {
-    // Clamp the battery voltage to ensure it's within the valid range
-    if (batteryVoltage > battVoltHigh) {
-        batteryVoltage = battVoltHigh;
-    } else if (batteryVoltage < battVoltLow) {
-        batteryVoltage = battVoltLow;
-    }
-
-    // Map the battery voltage to a percentage
-    float percentage = ((batteryVoltage - battVoltLow) / (battVoltHigh - battVoltLow)) * 100;
-
-    // Ensure percentage stays within 0-100 range
-    if (percentage > 100) percentage = 100;
-    if (percentage < 0) percentage = 0;
-
-    return percentage;
-
+// Read the raw ADC counts from the battery pin
+int BatteryZenerSensor::readPin() const {
+    return Hal::analogRead(batteryPin); // Negative on an ADC read error
 }
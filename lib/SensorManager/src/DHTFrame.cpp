@@ -0,0 +1,66 @@
+#include "DHTFrame.h"
+#include <cstring>
+
+namespace DHTFrame {
+
+Status bitsFromPulses(const Hal::Pulse* pulses, size_t count, uint8_t bytes[5]) {
+    if (count == 0) {
+        return Status::NoResponse;
+    }
+
+    // Walk back from the end to the first of the last 40 highs
+    size_t bits = 0;
+    size_t first = count;
+    while (first > 0 && bits < frameBits) {
+        first--;
+        if (pulses[first].high) {
+            bits++;
+        }
+    }
+    if (bits < frameBits) {
+        return Status::TooShort;
+    }
+
+    std::memset(bytes, 0, 5);
+    size_t bit = 0;
+    for (size_t i = first; i < count; ++i) {
+        if (!pulses[i].high) {
+            continue;
+        }
+        // The low before each bit is 50 us; without one, 50 us is assumed
+        uint16_t lowUs = i > 0 && !pulses[i - 1].high ? pulses[i - 1].us : 50;
+        if (pulses[i].us > lowUs) {
+            bytes[bit / 8] |= static_cast<uint8_t>(0x80 >> (bit % 8));
+        }
+        bit++;
+    }
+    return Status::Ok;
+}
+
+Status fromBytes(const uint8_t bytes[5], Model model, Reading& out) {
+    if (static_cast<uint8_t>(bytes[0] + bytes[1] + bytes[2] + bytes[3]) != bytes[4]) {
+        return Status::Checksum;
+    }
+    if (model == Model::Dht11) {
+        out.humidity = bytes[0] + bytes[1] * 0.1f;
+        out.temperature = bytes[2] + (bytes[3] & 0x0F) * 0.1f;
+        if (bytes[3] & 0x80) {
+            out.temperature = -out.temperature;
+        }
+    } else {
+        out.humidity = ((bytes[0] << 8) | bytes[1]) * 0.1f;
+        out.temperature = (((bytes[2] & 0x7F) << 8) | bytes[3]) * 0.1f;
+        if (bytes[2] & 0x80) {
+            out.temperature = -out.temperature;
+        }
+    }
+    return Status::Ok;
+}
+
+Status decode(const Hal::Pulse* pulses, size_t count, Model model, Reading& out) {
+    uint8_t bytes[5];
+    Status status = bitsFromPulses(pulses, count, bytes);
+    return status == Status::Ok ? fromBytes(bytes, model, out) : status;
+}
+
+} // namespace DHTFrame
@@ -0,0 +1,94 @@
+#include "DHTReader.h"
+
+DHTReader::DHTReader(uint8_t pin, DHTFrame::Model model) : pin(pin), model(model) {}
+
+DHTReader::~DHTReader() {
+    if (started) {
+        Hal::pulseCaptureEnd(pin);
+    }
+}
+
+// A frame ends with the line released; 200 us at one level is longer than any pulse in it
+bool DHTReader::begin() {
+    if (!started) {
+        started = Hal::pulseCaptureBegin(pin, 200);
+    }
+    return started;
+}
+
+bool DHTReader::read(DHTFrame::Reading& out) {
+    DHTReader* self = this;
+    readAll(&self, 1);
+    out = lastReading;
+    return lastStatus == DHTFrame::Status::Ok;
+}
+
+size_t DHTReader::readAll(DHTReader* const* readers, size_t count) {
+    // One start signal for every sensor that is due, held as long as the slowest needs
+    uint32_t holdMs = 0;
+    for (size_t i = 0; i < count; ++i) {
+        DHTReader& reader = *readers[i];
+        if (reader.started && !reader.isFresh()) {
+            reader.start();
+            holdMs = reader.startMs() > holdMs ? reader.startMs() : holdMs;
+        } else if (!reader.started) {
+            reader.lastStatus = DHTFrame::Status::NoResponse;
+        }
+    }
+    if (holdMs > 0) {
+        Hal::delay(holdMs);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (readers[i]->awaiting) {
+            readers[i]->listen();
+        }
+    }
+
+    size_t successes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (readers[i]->awaiting) {
+            readers[i]->collect();
+        }
+        if (readers[i]->lastStatus == DHTFrame::Status::Ok) {
+            successes++;
+        }
+    }
+    return successes;
+}
+
+bool DHTReader::isFresh() const {
+    return hasTransaction && Hal::millis() - lastTransactionMs < minIntervalMs();
+}
+
+void DHTReader::start() {
+    Hal::pulseCaptureLineLow(pin);
+    awaiting = true;
+}
+
+void DHTReader::listen() {
+    Hal::pulseCaptureArm(pin);
+    hasTransaction = true;
+    lastTransactionMs = Hal::millis();
+}
+
+bool DHTReader::collect() {
+    awaiting = false;
+    Hal::Pulse pulses[DHTFrame::maxPulses];
+    size_t count = Hal::pulseCaptureRead(pin, pulses, DHTFrame::maxPulses, DHT_READ_TIMEOUT_MS);
+    DHTFrame::Reading reading;
+    lastStatus = DHTFrame::decode(pulses, count, model, reading);
+    if (lastStatus == DHTFrame::Status::Ok) {
+        lastReading = reading;
+    }
+    return lastStatus == DHTFrame::Status::Ok;
+}
+
+// A DHT22 needs the line low for at least 1 ms, a DHT11 for 18 ms; a tick on top covers the
+// rounding of the delay
+uint32_t DHTReader::startMs() const {
+    return model == DHTFrame::Model::Dht11 ? 20 : 2;
+}
+
+uint32_t DHTReader::minIntervalMs() const {
+    return model == DHTFrame::Model::Dht11 ? 1000 : 2000;
+}
@@ -1,11 +1,14 @@
+// Needs the Adafruit DHT driver, so it is only built for the device
+#ifdef ARDUINO
+
 #include "DHTSensor.h"
 
 // Initialize the sensor
 bool DHTSensor::begin() {
-    dht.begin();
+    startDriver();
 
     // Perform a test read to ensure initialization
-    float temp = dht.readTemperature();
+    float temp = getReading();
     if (isnan(temp)) {
         lastError = "Failed to initialize DHT sensor!";
         return false;
@@ -15,9 +18,25 @@ bool DHTSensor::begin() {
     return true;
 }
 
+// Initialize the driver only; the first reading tells whether the sensor answers
+void DHTSensor::start() {
+    startDriver();
+    lastError = "";
+}
+
+// The capture frees the CPU during a read; the Adafruit driver is the fallback on cores
+// without RMT support or when every receive channel is taken
+void DHTSensor::startDriver() {
+    useCapture = reader.begin();
+    if (!useCapture) {
+        dht.begin();
+    }
+}
+
 // Override to get temperature as the default reading
 float DHTSensor::getReading() const {
-    float temp = dht.readTemperature();
+    DHTFrame::Reading reading;
+    float temp = useCapture ? (reader.read(reading) ? reading.temperature : NAN) : dht.readTemperature();
     if (isnan(temp)) {
         lastError = "Failed to read temperature!";
         return NAN;
@@ -33,8 +52,15 @@ const char* DHTSensor::getErrorMessage() const {
 
 // Method to read both temperature and humidity
 bool DHTSensor::readTempAndHumidity(float& temperature, float& humidity) {
-    temperature = dht.readTemperature();
-    humidity = dht.readHumidity();
+    if (useCapture) {
+        DHTFrame::Reading reading;
+        bool valid = reader.read(reading);
+        temperature = valid ? reading.temperature : NAN;
+        humidity = valid ? reading.humidity : NAN;
+    } else {
+        temperature = dht.readTemperature();
+        humidity = dht.readHumidity(); // Served from the frame readTemperature() just read
+    }
 
     if (isnan(temperature) || isnan(humidity)) {
         lastError = "Failed to read temperature and humidity!";
@@ -44,3 +70,15 @@ bool DHTSensor::readTempAndHumidity(float& temperature, float& humidity) {
     lastError = "";
     return true;
 }
+
+// "temp" and "hum", the field names readings are published under
+BaseSensor::ChannelInfo DHTSensor::getChannelInfo(size_t channel) const {
+    return channel == 0 ? ChannelInfo{"temp", Reading::Unit::Celsius} : ChannelInfo{"hum", Reading::Unit::Percent};
+}
+
+// Both channels from one transaction
+bool DHTSensor::readChannels(float* values) {
+    return readTempAndHumidity(values[0], values[1]);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,176 @@
+#include "SensorDiscovery.h"
+#include <HalFS.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+static_assert(SENSOR_DISCOVERY_MAX_PINS % 4 == 0, "SENSOR_DISCOVERY_MAX_PINS must be a multiple of 4");
+static_assert(sizeof(SensorDiscovery::State) == 16 + 2 * SENSOR_DISCOVERY_MAX_PINS,
+              "SensorDiscovery::State must not contain padding");
+
+namespace {
+
+const uint8_t pending = 0xFF; // A probe that has not answered yet
+
+// Shared by discover() and the probe tasks, which may outlive it when they time out
+struct ProbeRun {
+    SensorDiscovery::Probe probe;
+    std::atomic<uint8_t> types[SENSOR_DISCOVERY_MAX_PINS];
+    std::atomic<size_t> remaining;
+};
+
+struct ProbeTask {
+    std::shared_ptr<ProbeRun> run;
+    int pin;
+    size_t index;
+};
+
+void probeTask(void* parameters) {
+    std::unique_ptr<ProbeTask> task(static_cast<ProbeTask*>(parameters));
+    uint8_t type = static_cast<uint8_t>(task->run->probe(task->pin));
+    task->run->types[task->index].store(type, std::memory_order_release);
+    task->run->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+// FNV-1a, continuing from hash
+uint32_t hashBytes(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+SensorDiscovery::SensorDiscovery(State& state, Probe probe, const char* manifestPath)
+    : state(state), probeFunction(probe), manifestPath(manifestPath) {}
+
+std::vector<SensorDiscovery::Found> SensorDiscovery::discover(const std::vector<int>& pins, uint32_t timeoutMs) {
+    uint32_t fingerprint = fingerprintOf(pins);
+    complete = true;
+    if (matches(state, fingerprint)) {
+        lastSource = Source::Rtc;
+        return foundIn(state);
+    }
+
+    State stored;
+    if (loadManifest(stored) && matches(stored, fingerprint)) {
+        state = stored; // Wakes from deep sleep skip the file from now on
+        lastSource = Source::Manifest;
+        return foundIn(state);
+    }
+
+    lastSource = Source::Probe;
+    State probed = probe(pins, fingerprint, timeoutMs);
+    if (!complete) {
+        return foundIn(probed); // Not cached, so the next boot probes the silent pins again
+    }
+    state = probed;
+    saveManifest();
+    return foundIn(state);
+}
+
+void SensorDiscovery::forget() {
+    std::memset(&state, 0, sizeof(state));
+    if (manifestPath != nullptr && LittleFS.exists(manifestPath)) {
+        LittleFS.remove(manifestPath);
+    }
+}
+
+// Probes every pin in a task of its own and waits for them until the timeout
+SensorDiscovery::State SensorDiscovery::probe(const std::vector<int>& pins, uint32_t fingerprint, uint32_t timeoutMs) {
+    size_t count = std::min(pins.size(), static_cast<size_t>(SENSOR_DISCOVERY_MAX_PINS));
+    std::shared_ptr<ProbeRun> run = std::make_shared<ProbeRun>();
+    run->probe = probeFunction;
+    run->remaining.store(count, std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        run->types[i].store(pending, std::memory_order_relaxed);
+    }
+
+    uint32_t startMs = Hal::millis();
+    for (size_t i = 0; i < count; ++i) {
+        ProbeTask* task = new ProbeTask{run, pins[i], i};
+        if (!Hal::startTask("SensorProbe", probeTask, task, 2048, 1)) {
+            probeTask(task); // Probe it here instead
+        }
+    }
+    while (run->remaining.load(std::memory_order_acquire) > 0 && Hal::millis() - startMs < timeoutMs) {
+        Hal::delay(1);
+    }
+
+    State probed;
+    std::memset(&probed, 0, sizeof(probed));
+    probed.magic = stateMagic;
+    probed.fingerprint = fingerprint;
+    probed.count = static_cast<uint8_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t type = run->types[i].load(std::memory_order_acquire);
+        if (type == pending) {
+            complete = false;
+            type = static_cast<uint8_t>(BaseSensor::SensorType::Undefined);
+        }
+        probed.pins[i] = static_cast<uint8_t>(pins[i]);
+        probed.types[i] = type;
+    }
+    probed.checksum = checksumOf(probed);
+    return probed;
+}
+
+bool SensorDiscovery::loadManifest(State& out) const {
+    if (manifestPath == nullptr || !LittleFS.exists(manifestPath)) {
+        return false;
+    }
+    File file = LittleFS.open(manifestPath, FILE_READ);
+    if (!file) {
+        return false;
+    }
+    size_t bytesRead = file.read(reinterpret_cast<uint8_t*>(&out), sizeof(out));
+    file.close();
+    return bytesRead == sizeof(out);
+}
+
+// A write cut short by a reset fails the checksum and reads as no manifest
+void SensorDiscovery::saveManifest() const {
+    if (manifestPath == nullptr) {
+        return;
+    }
+    File file = LittleFS.open(manifestPath, FILE_WRITE);
+    if (!file) {
+        return;
+    }
+    file.write(reinterpret_cast<const uint8_t*>(&state), sizeof(state));
+    file.close();
+}
+
+bool SensorDiscovery::matches(const State& candidate, uint32_t fingerprint) {
+    return candidate.magic == stateMagic && candidate.checksum == checksumOf(candidate) &&
+           candidate.fingerprint == fingerprint && candidate.count <= SENSOR_DISCOVERY_MAX_PINS;
+}
+
+std::vector<SensorDiscovery::Found> SensorDiscovery::foundIn(const State& candidate) {
+    std::vector<Found> found;
+    for (size_t i = 0; i < candidate.count; ++i) {
+        auto type = static_cast<BaseSensor::SensorType>(candidate.types[i]);
+        if (type != BaseSensor::SensorType::Undefined) {
+            found.push_back(Found{candidate.pins[i], type});
+        }
+    }
+    return found;
+}
+
+uint32_t SensorDiscovery::fingerprintOf(const std::vector<int>& pins) {
+    uint32_t layout[2] = {stateMagic, static_cast<uint32_t>(sizeof(State))};
+    uint32_t hash = hashBytes(2166136261u, layout, sizeof(layout));
+    for (int pin : pins) {
+        int32_t value = pin;
+        hash = hashBytes(hash, &value, sizeof(value));
+    }
+    return hash;
+}
+
+// FNV-1a over the fields before the checksum
+uint32_t SensorDiscovery::checksumOf(const State& state) {
+    return hashBytes(2166136261u, &state, offsetof(State, checksum));
+}
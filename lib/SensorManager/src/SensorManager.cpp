@@ -1,23 +1,29 @@
+// Needs the Adafruit DHT driver and FreeRTOS, so it is only built for the device
+#ifdef ARDUINO
+
 #include "SensorManager.h"
 #include <Arduino.h>
-#include <Sensor.h>
-#include <stdexcept>
+#include <Metrics.h>
+#include <algorithm>
+
+// What scanForSensors() found, kept across deep sleep
+HAL_RTC_DATA static SensorDiscovery::State discoveryState;
 
 // Constructor
-SensorManager::SensorManager() {}
+SensorManager::SensorManager() : discovery(discoveryState, probePin) {}
 
-// Register a sensor by type and pin, dynamically creating the sensor
+// Register a sensor by type and pin, creating the sensor in the pool
 // Register a generic sensor by type and pin
 bool SensorManager::registerSensor(int pin, BaseSensor::SensorType type, const String& sensorName) {
     BaseSensor* sensor = nullptr;
 
     switch (type) {
         case BaseSensor::SensorType::DHT:
-            sensor = new DHTSensor(pin);
-            if (!sensor->begin()) {
+            sensor = pool.create<DHTSensor>(pin);
+            if (sensor == nullptr || !sensor->begin()) {
                 Serial.print("Failed to initialize DHT Sensor on pin ");
                 Serial.println(pin);
-                delete sensor;
+                pool.destroy(sensor);
                 return false;
             }
             break;
@@ -27,8 +33,10 @@ bool SensorManager::registerSensor(int pin, BaseSensor::SensorType type, const S
             return false;
     }
 
-    sensors.push_back(sensor);
-    sensorResults.push_back({NAN, NAN, false, 0}); // Initialize results
+    if (!addSensor(sensor)) {
+        pool.destroy(sensor);
+        return false;
+    }
     Serial.print("Registered sensor: ");
     Serial.println(sensor->getName().c_str());
     return true;
@@ -36,115 +44,183 @@ bool SensorManager::registerSensor(int pin, BaseSensor::SensorType type, const S
 
 // Overloaded: Register a battery sensor with custom high and low voltage
 bool SensorManager::registerSensor(int pin, float highVoltage, float lowVoltage) {
-    auto* batterySensor = new BatteryZenerSensor(highVoltage, lowVoltage, pin);
-    if (batterySensor->getReading() < 0) {
+    auto* batterySensor = pool.create<BatteryZenerSensor>(highVoltage, lowVoltage, pin);
+    if (batterySensor == nullptr || batterySensor->getReading() < 0) {
         Serial.print("Failed to initialize Battery Sensor on pin ");
         Serial.println(pin);
-        delete batterySensor;
+        pool.destroy(batterySensor);
         return false;
     }
 
-    sensors.push_back(batterySensor);
-    sensorResults.push_back({NAN, NAN, false, 0}); // Initialize results
+    if (!addSensor(batterySensor)) {
+        pool.destroy(batterySensor);
+        return false;
+    }
     Serial.print("Battery sensor registered on pin ");
     Serial.println(pin);
     return true;
 }
 
-// Scan for sensors on default pins
+// Register the sensors on the default pins, probing them only when no cached discovery matches
 void SensorManager::scanForSensors() {
-    for (int pin : defaultPins) {
-        Serial.print("Scanning pin ");
-        Serial.println(pin);
+    std::vector<SensorDiscovery::Found> found = discovery.discover(defaultPins);
+    bool cached = discovery.getLastSource() != SensorDiscovery::Source::Probe;
+    Serial.println(cached ? "Sensors taken from the discovery cache." : "Probed the default pins for sensors.");
 
-        // Try to detect DHT sensors
-        auto* dhtSensor = new DHTSensor(pin);
-        if (dhtSensor->begin()) {
-            Serial.print("DHT Sensor detected and initialized on pin ");
-            Serial.println(pin);
-            sensors.push_back(dhtSensor);
-            sensorResults.push_back({NAN, NAN, false, 0}); // Initialize results
-            continue;
+    for (const SensorDiscovery::Found& entry : found) {
+        BaseSensor* sensor = nullptr;
+        if (entry.type == BaseSensor::SensorType::DHT) {
+            auto* dhtSensor = pool.create<DHTSensor>(entry.pin);
+            if (dhtSensor != nullptr) {
+                dhtSensor->start(); // The probe or the cache already answered for it
+            }
+            sensor = dhtSensor;
+        } else if (entry.type == BaseSensor::SensorType::BatteryZener) {
+            sensor = pool.create<BatteryZenerSensor>(4.2, 2.5, entry.pin);
         }
-        delete dhtSensor;
-
-        // Try to detect Battery sensors
-        auto* batterySensor = new BatteryZenerSensor(4.2, 2.5, pin);
-        if (batterySensor->getReading() >= 0) {
-            Serial.print("Battery Sensor detected and initialized on pin ");
-            Serial.println(pin);
-            sensors.push_back(batterySensor);
-            sensorResults.push_back({NAN, NAN, false, 0}); // Initialize results
+        if (sensor == nullptr || !addSensor(sensor)) {
+            pool.destroy(sensor);
             continue;
         }
-        delete batterySensor;
+        Serial.print(sensor->getType() == BaseSensor::SensorType::DHT ? "DHT Sensor" : "Battery Sensor");
+        Serial.print(" detected and initialized on pin ");
+        Serial.println(entry.pin);
+    }
+    discoveryUnconfirmed.store(cached && !found.empty());
+}
 
-        Serial.print("No sensor detected on pin ");
-        Serial.println(pin);
+// Runs in a probe task per pin, in parallel with the other pins
+BaseSensor::SensorType SensorManager::probePin(int pin) {
+    DHTSensor dhtSensor(pin);
+    if (dhtSensor.begin()) {
+        return BaseSensor::SensorType::DHT;
+    }
+    // As before, a pin without a DHT is taken for a battery divider when the ADC reads it; one
+    // conversion tells as much as the 10,000 a battery reading averages
+    if (Hal::analogRead(pin) >= 0) {
+        return BaseSensor::SensorType::BatteryZener;
     }
+    return BaseSensor::SensorType::Undefined;
 }
 
-// Sensor reading task
-void SensorManager::sensorTask(void* parameters) {
-    SensorManager* manager = static_cast<SensorManager*>(parameters);
-
-    while (true) {
-        for (size_t i = 0; i < manager->sensors.size(); ++i) {
-            BaseSensor* sensor = manager->sensors[i];
-            SensorData& data = manager->sensorResults[i];
-
-            if (sensor->getType() == BaseSensor::SensorType::DHT) {
-                float temperature = NAN;
-                float humidity = NAN;
-
-                if (millis() - data.lastReadTime >= manager->refreshInterval) {
-                    auto* dhtSensor = static_cast<DHTSensor*>(sensor);
-                    dhtSensor->readTempAndHumidity(temperature, humidity);
-
-                    if (!isnan(temperature) && !isnan(humidity)) {
-                        data.temperature = temperature;
-                        data.humidity = humidity;
-                        data.isValid = true;
-                        data.lastReadTime = millis();
-                    } else {
-                        data.isValid = false;
-                    }
-                }
-            } else if (sensor->getType() == BaseSensor::SensorType::BatteryZener) {
-                float batteryLevel = sensor->getReading();
-
-                if (!isnan(batteryLevel)) {
-                    data.temperature = batteryLevel; // Storing battery level in temperature field
-                    data.isValid = true;
-                    data.lastReadTime = millis();
-                } else {
-                    data.isValid = false;
-                }
-            } else if(sensor->getType() == BaseSensor::SensorType::BatteryVoltage) {
-                // TODO: Add support for a raw battery voltage sensor
-                throw std::logic_error("BatteryVoltage sensor type not yet implemented.");
-            }
+// Adds a sensor with the default interval of its type; the schedule is rebuilt on the next poll
+bool SensorManager::addSensor(BaseSensor* sensor) {
+    if (tasksStarted) {
+        Serial.println("Register sensors before starting the reading tasks.");
+        return false;
+    }
+    if (sensor->getChannelCount() > SENSOR_MANAGER_MAX_CHANNELS) {
+        Serial.println("Sensor has more channels than a result holds; raise SENSOR_MANAGER_MAX_CHANNELS.");
+        return false;
+    }
+    size_t index = getSensorCount();
+    if (index >= sensors.size()) {
+        Serial.println("No room for another sensor; raise SENSOR_MANAGER_MAX_SENSORS.");
+        return false;
+    }
+    sensors[index] = sensor;
+    SensorData empty = {};
+    std::fill(empty.values, empty.values + SENSOR_MANAGER_MAX_CHANNELS, NAN);
+    sensorResults[index].store(empty); // Initialize results
+    sensorCount.store(index + 1, std::memory_order_release);
+    refreshIntervals.push_back(sensor->getType() == BaseSensor::SensorType::DHT ? refreshInterval : batteryRefreshInterval);
+    schedulers.clear();
+    return true;
+}
+
+void SensorManager::setRefreshInterval(int index, unsigned long intervalMs) {
+    if (index < 0 || index >= static_cast<int>(refreshIntervals.size())) {
+        return;
+    }
+    refreshIntervals[index] = intervalMs;
+    if (tasksStarted) {
+        // The running task picks it up after the reading already scheduled
+        scheduledReads[index].scheduler->setInterval(scheduledReads[index].id, intervalMs);
+    } else {
+        schedulers.clear(); // Picked up when the schedule is rebuilt
+    }
+}
+
+// Reads every sensor whose refresh interval has passed, once
+void SensorManager::pollSensors() {
+    if (tasksStarted) {
+        return; // The tasks own the sensors
+    }
+    if (schedulers.empty()) {
+        buildSchedules(false);
+    }
+    schedulers[0]->runDue(millis());
+}
+
+// Reads one sensor and stores the result; each channel's value goes in its slot, whatever the sensor
+void SensorManager::readSensor(size_t index) {
+    BaseSensor* sensor = sensors[index];
+    SensorData data = sensorResults[index].load(); // This task is the only writer, so it cannot change meanwhile
 
+    float values[SENSOR_MANAGER_MAX_CHANNELS];
+    bool valid;
+    {
+        METRICS_TIME(SensorRead);
+        valid = sensor->readChannels(values);
+    }
+    METRICS_COUNT(SensorReads);
+
+    if (valid) {
+        std::copy(values, values + sensor->getChannelCount(), data.values);
+        data.isValid = true;
+        data.lastReadTime = millis();
+    } else {
+        METRICS_COUNT(SensorErrors);
+        data.isValid = false;
+        if (data.lastReadTime == 0 && discoveryUnconfirmed.exchange(false)) {
+            discovery.forget(); // A cached sensor that never answered; probe again on the next boot
         }
+    }
+    sensorResults[index].store(data); // Readers see the old reading or this one, never a mix
+}
+
+// Each DHT has a wire of its own; battery sensors share the ADC, which streams one pin at a time
+int SensorManager::busOf(const BaseSensor& sensor) {
+    return sensor.getType() == BaseSensor::SensorType::DHT ? sensor.getPin() : -1;
+}
 
-        vTaskDelay(pdMS_TO_TICKS(500)); // Wait 500ms before next iteration
+// One scheduler for every sensor, or one per bus
+void SensorManager::buildSchedules(bool taskPerBus) {
+    schedulers.clear();
+    scheduledReads.clear();
+    std::vector<int> buses;
+    for (size_t i = 0; i < getSensorCount(); ++i) {
+        size_t slot = 0;
+        if (taskPerBus) {
+            int bus = busOf(*sensors[i]);
+            slot = std::find(buses.begin(), buses.end(), bus) - buses.begin();
+            if (slot == buses.size()) {
+                buses.push_back(bus);
+            }
+        }
+        if (slot == schedulers.size()) {
+            schedulers.emplace_back(new SensorScheduler());
+        }
+        SensorScheduler* scheduler = schedulers[slot].get();
+        scheduledReads.push_back(ScheduledRead{scheduler, scheduler->add(refreshIntervals[i], [this, i] { readSensor(i); })});
+    }
+    if (schedulers.empty()) {
+        schedulers.emplace_back(new SensorScheduler()); // Nothing registered; polls do nothing
     }
 }
 
-// Start concurrent reading tasks
-void SensorManager::startConcurrentReading() {
-    for (size_t i = 0; i < sensors.size(); ++i) {
-        if (sensors[i]->getType() == BaseSensor::SensorType::DHT) {
-            xTaskCreate(
-                sensorTask,                  // Task function
-                "SensorTask",                // Name of the task
-                2048,                        // Stack size (in words)
-                this,                        // Parameters to the task
-                1,                           // Priority
-                NULL                         // Task handle
-            );
+// Start the reading tasks; each writes only the results of its own sensors
+void SensorManager::startConcurrentReading(bool taskPerBus) {
+    if (tasksStarted || getSensorCount() == 0) {
+        return;
+    }
+    buildSchedules(taskPerBus);
+    for (auto& scheduler : schedulers) {
+        if (!Hal::startTask("SensorTask", SensorScheduler::task, scheduler.get(), 2048, 1)) {
+            Serial.println("Failed to start a sensor task.");
         }
     }
+    tasksStarted = true;
 }
 
 // Waits for the sensor to refresh
@@ -157,18 +233,43 @@ void SensorManager::waitForSensor(BaseSensor& sensor) {
 
 // Get the latest sensor data
 bool SensorManager::getSensorData(int index, float& temperature, float& humidity) {
-    if (index < 0 || index >= sensorResults.size()) {
+    if (index < 0 || index >= static_cast<int>(getSensorCount())) {
         Serial.println("Invalid sensor index.");
         return false;
     }
 
-    SensorData& data = sensorResults[index];
+    SensorData data = sensorResults[index].load(); // One consistent reading, even mid-update
     if (!data.isValid) {
         Serial.println("Sensor data is not valid.");
         return false;
     }
 
-    temperature = data.temperature;
-    humidity = data.humidity;
+    temperature = data.values[0];
+    humidity = data.values[1];
     return true;
 }
+
+// Get the latest value of one channel
+bool SensorManager::getReading(int index, size_t channel, Reading& out) const {
+    if (index < 0 || index >= static_cast<int>(getSensorCount()) || channel >= sensors[index]->getChannelCount()) {
+        return false;
+    }
+    SensorData data = sensorResults[index].load();
+    if (!data.isValid) {
+        return false;
+    }
+    out = {static_cast<uint8_t>(index), static_cast<uint8_t>(channel), sensors[index]->getChannelInfo(channel).unit,
+           static_cast<uint32_t>(data.lastReadTime), data.values[channel]};
+    return true;
+}
+
+// Copy every sensor's latest data
+size_t SensorManager::snapshotAll(SensorData* out, size_t capacity) const {
+    size_t count = getSensorCount();
+    for (size_t i = 0; i < count && i < capacity; ++i) {
+        out[i] = sensorResults[i].load();
+    }
+    return count;
+}
+
+#endif // ARDUINO
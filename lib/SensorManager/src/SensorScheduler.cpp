@@ -0,0 +1,74 @@
+#include "SensorScheduler.h"
+#include <algorithm>
+
+bool SensorScheduler::later(const Entry& a, const Entry& b) {
+    return static_cast<int32_t>(a.dueMs - b.dueMs) > 0;
+}
+
+size_t SensorScheduler::add(uint32_t intervalMs, Job job, uint32_t firstDelayMs) {
+    size_t id = jobs.size();
+    jobs.emplace_back(intervalMs > 0 ? intervalMs : 1, std::move(job));
+    heap.push_back(Entry{Hal::millis() + firstDelayMs, static_cast<uint32_t>(id)});
+    std::push_heap(heap.begin(), heap.end(), later);
+    due.reserve(jobs.size());
+    return id;
+}
+
+void SensorScheduler::setInterval(size_t id, uint32_t intervalMs) {
+    if (id < jobs.size()) {
+        jobs[id].intervalMs.store(intervalMs > 0 ? intervalMs : 1, std::memory_order_relaxed);
+    }
+}
+
+uint32_t SensorScheduler::runDue(uint32_t nowMs) {
+    stats.wakeups++;
+
+    // Take every due job off the heap first, so a short interval cannot make one run twice
+    due.clear();
+    while (!heap.empty() && static_cast<int32_t>(nowMs - heap.front().dueMs) >= 0) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        due.push_back(heap.back());
+        heap.pop_back();
+    }
+
+    for (Entry& entry : due) {
+        uint32_t lateMs = nowMs - entry.dueMs;
+        stats.runs++;
+        stats.totalLateMs += lateMs;
+        stats.maxLateMs = std::max(stats.maxLateMs, lateMs);
+
+        Scheduled& scheduled = jobs[entry.id];
+        scheduled.job();
+
+        // From the deadline rather than from now, so lateness does not add up over time
+        uint32_t intervalMs = scheduled.intervalMs.load(std::memory_order_relaxed);
+        entry.dueMs += intervalMs;
+        if (static_cast<int32_t>(nowMs - entry.dueMs) >= 0) {
+            uint32_t missed = (nowMs - entry.dueMs) / intervalMs + 1;
+            stats.skipped += missed;
+            entry.dueMs += missed * intervalMs;
+        }
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    if (heap.empty()) {
+        return UINT32_MAX;
+    }
+    return heap.front().dueMs - nowMs;
+}
+
+void SensorScheduler::run() {
+    while (!stopping.load(std::memory_order_relaxed)) {
+        uint32_t startMs = Hal::millis();
+        uint32_t waitMs = runDue(startMs);
+        uint32_t spentMs = Hal::millis() - startMs; // The jobs' own time counts towards the wait
+        if (waitMs > spentMs) {
+            Hal::delay(waitMs - spentMs);
+        }
+    }
+}
+
+void SensorScheduler::task(void* parameters) {
+    static_cast<SensorScheduler*>(parameters)->run();
+}
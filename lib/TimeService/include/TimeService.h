@@ -0,0 +1,125 @@
+#ifndef TIMESERVICE_H
+#define TIMESERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Wall clock carried across deep sleep on the RTC timer, synced over NTP every few
+ * wakes and corrected for the RTC's drift.
+ *
+ * Between syncs the time is the last synced epoch plus the RTC time elapsed since, scaled by
+ * the learned drift. The ESP32's RTC slow clock is an RC oscillator that typically runs a few
+ * hundred ppm off (more with temperature), so without correction an hour between syncs costs
+ * around a second. Each sync compares the RTC against NTP over the interval since the start
+ * of the current measurement, at least minLearnIntervalS long so the 1 s resolution of
+ * NTPClient does not dominate, and folds the result into the correction.
+ *
+ * Timestamps are epoch milliseconds; formatTimeOfDay() turns one into text where text is
+ * needed, e.g. in a log line or an error report.
+ *
+ * The state is owned by the caller so it can be declared RTC_DATA_ATTR. A power-on reset, a
+ * corrupted state or an RTC that went backwards all read as "never synced".
+ *
+ * Example:
+ * @code
+ * RTC_DATA_ATTR TimeService::State clockState;
+ * TimeService wallClock(clockState);
+ *
+ * wallClock.wake();
+ * if (connected && wallClock.needsSync() && timeClient.update()) {
+ *     wallClock.sync(timeClient.getEpochTime() * 1000ULL + 500);
+ * }
+ * uint64_t epochMs = wallClock.nowMs();
+ * @endcode
+ */
+class TimeService {
+public:
+    /**
+     * @brief When to sync and how to learn the drift.
+     */
+    struct Config {
+        uint32_t syncEveryWakes;    /**< Wakes between NTP syncs. */
+        uint32_t maxSyncAgeS;       /**< Sync regardless of wakes once the last sync is this old. */
+        uint32_t minLearnIntervalS; /**< Shortest interval a drift measurement spans. */
+        bool learnDrift;            /**< False to use the RTC uncorrected. */
+    };
+
+    /**
+     * @brief Sync and learning state. Zero-initialized memory reads as never synced.
+     *
+     * The fields are ordered so the struct has no padding and the checksum covers only data.
+     */
+    struct State {
+        uint32_t magic;          /**< stateMagic once synced. */
+        int32_t driftPpm;        /**< Learned RTC rate error; positive when the RTC runs fast. */
+        uint64_t syncRtcUs;      /**< RTC time of the last sync. */
+        uint64_t syncEpochMs;    /**< Epoch of the last sync. */
+        uint64_t anchorRtcUs;    /**< RTC time the current drift measurement started at. */
+        uint64_t anchorEpochMs;  /**< Epoch the current drift measurement started at. */
+        int32_t lastErrorMs;     /**< Predicted minus synced time at the last sync. */
+        uint16_t wakesSinceSync; /**< wake() calls since the last sync. */
+        uint8_t driftKnown;      /**< 1 once a drift measurement has completed. */
+        uint8_t reserved;        /**< Keeps the layout free of padding. */
+        uint32_t syncs;          /**< Syncs since the state was created. */
+        uint32_t checksum;       /**< Over every field above. */
+    };
+
+    /**
+     * @brief Returns the default config: sync every 12 wakes (an hour at 5 minute sleeps) or
+     * every 24 hours, measure drift over at least 3 hours.
+     */
+    static Config defaultConfig();
+
+    /**
+     * @brief Constructs a clock over a state.
+     * @param state The sync state, typically declared RTC_DATA_ATTR.
+     * @param config When to sync and how to learn the drift.
+     */
+    explicit TimeService(State& state, Config config = defaultConfig());
+
+    /**
+     * @brief Counts a wake toward the next sync. Call once per wake.
+     */
+    void wake();
+
+    /**
+     * @brief Checks whether the caller should fetch the time over NTP this wake.
+     */
+    bool needsSync() const;
+
+    /**
+     * @brief Sets the clock from a reference time and learns from how far off it was.
+     * @param epochMs The reference time, e.g. from NTP.
+     */
+    void sync(uint64_t epochMs);
+
+    /**
+     * @brief Returns the current time in epoch milliseconds, or 0 before the first sync.
+     */
+    uint64_t nowMs() const;
+
+    bool isSynced() const;
+    int32_t getDriftPpm() const { return isSynced() ? state.driftPpm : 0; }
+    int32_t getLastErrorMs() const { return isSynced() ? state.lastErrorMs : 0; }
+    uint32_t getSyncCount() const { return isSynced() ? state.syncs : 0; }
+
+    /**
+     * @brief Formats the time of day of an epoch as HH:MM:SS.
+     * @return The number of characters written, or 0 if the buffer is too small.
+     */
+    static size_t formatTimeOfDay(uint64_t epochMs, char* out, size_t capacity);
+
+    static const uint32_t stateMagic = 0x54494d45; // "TIME"
+
+private:
+    uint64_t correctedElapsedMs(uint64_t rtcElapsedUs) const; // RTC interval with the drift taken out
+    void learn(uint64_t rtcUs, uint64_t epochMs);              // Fold a finished measurement into driftPpm
+    void seal();                                               // Recompute the checksum
+    static uint32_t checksumOf(const State& state);
+
+    State& state;  // Sync state, usually in RTC memory
+    Config config; // When to sync and how to learn
+};
+
+#endif // TIMESERVICE_H
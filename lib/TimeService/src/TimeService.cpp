@@ -0,0 +1,118 @@
+#include "TimeService.h"
+#include <Hal.h>
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(TimeService::State) == 56, "TimeService::State must not contain padding");
+
+namespace {
+
+// Beyond what the RC oscillator does; a measurement this far off means the reference or the RTC jumped
+const int64_t maxDriftPpm = 50000;
+
+} // namespace
+
+TimeService::Config TimeService::defaultConfig() {
+    return Config{12, 24 * 3600, 3 * 3600, true};
+}
+
+TimeService::TimeService(State& state, Config config) : state(state), config(config) {
+    if (this->config.syncEveryWakes == 0) {
+        this->config.syncEveryWakes = 1;
+    }
+}
+
+bool TimeService::isSynced() const {
+    return state.magic == stateMagic && state.checksum == checksumOf(state) && Hal::rtcMicros() >= state.syncRtcUs;
+}
+
+void TimeService::wake() {
+    if (isSynced() && state.wakesSinceSync < UINT16_MAX) {
+        state.wakesSinceSync++;
+        seal();
+    }
+}
+
+bool TimeService::needsSync() const {
+    if (!isSynced()) {
+        return true;
+    }
+    uint64_t ageMs = (Hal::rtcMicros() - state.syncRtcUs) / 1000;
+    return state.wakesSinceSync >= config.syncEveryWakes || ageMs >= static_cast<uint64_t>(config.maxSyncAgeS) * 1000;
+}
+
+void TimeService::sync(uint64_t epochMs) {
+    uint64_t rtcUs = Hal::rtcMicros();
+    if (!isSynced()) {
+        std::memset(&state, 0, sizeof(state));
+        state.magic = stateMagic;
+        state.anchorRtcUs = rtcUs;
+        state.anchorEpochMs = epochMs;
+    } else {
+        int64_t errorMs = static_cast<int64_t>(nowMs() - epochMs);
+        state.lastErrorMs = static_cast<int32_t>(errorMs > INT32_MAX ? INT32_MAX : errorMs < INT32_MIN ? INT32_MIN : errorMs);
+        learn(rtcUs, epochMs);
+    }
+    state.syncRtcUs = rtcUs;
+    state.syncEpochMs = epochMs;
+    state.wakesSinceSync = 0;
+    state.syncs++;
+    seal();
+}
+
+uint64_t TimeService::nowMs() const {
+    if (!isSynced()) {
+        return 0;
+    }
+    return state.syncEpochMs + correctedElapsedMs(Hal::rtcMicros() - state.syncRtcUs);
+}
+
+size_t TimeService::formatTimeOfDay(uint64_t epochMs, char* out, size_t capacity) {
+    uint32_t seconds = static_cast<uint32_t>((epochMs / 1000) % 86400);
+    int length = snprintf(out, capacity, "%02u:%02u:%02u", static_cast<unsigned>(seconds / 3600),
+                          static_cast<unsigned>(seconds / 60 % 60), static_cast<unsigned>(seconds % 60));
+    return length > 0 && static_cast<size_t>(length) < capacity ? static_cast<size_t>(length) : 0;
+}
+
+// A clock running ppm fast counts rtc = true * (1 + ppm / 10^6), so true = rtc - rtc * ppm / (10^6 + ppm)
+uint64_t TimeService::correctedElapsedMs(uint64_t rtcElapsedUs) const {
+    int64_t ms = static_cast<int64_t>(rtcElapsedUs / 1000);
+    if (!config.learnDrift) {
+        return static_cast<uint64_t>(ms);
+    }
+    int64_t ppm = state.driftPpm;
+    return static_cast<uint64_t>(ms - ms * ppm / (1000000 + ppm));
+}
+
+void TimeService::learn(uint64_t rtcUs, uint64_t epochMs) {
+    int64_t trueMs = static_cast<int64_t>(epochMs - state.anchorEpochMs);
+    if (trueMs >= 0 && trueMs < static_cast<int64_t>(config.minLearnIntervalS) * 1000) {
+        return; // Keep measuring until the interval is long enough
+    }
+
+    if (config.learnDrift && trueMs > 0) {
+        int64_t rtcMs = static_cast<int64_t>((rtcUs - state.anchorRtcUs) / 1000);
+        int64_t measuredPpm = (rtcMs - trueMs) * 1000000 / trueMs;
+        if (measuredPpm > -maxDriftPpm && measuredPpm < maxDriftPpm) {
+            // Average with the previous estimate to damp the reference's resolution
+            state.driftPpm = static_cast<int32_t>(state.driftKnown ? (state.driftPpm + measuredPpm) / 2 : measuredPpm);
+            state.driftKnown = 1;
+        }
+    }
+    state.anchorRtcUs = rtcUs; // The next measurement starts here
+    state.anchorEpochMs = epochMs;
+}
+
+void TimeService::seal() {
+    state.checksum = checksumOf(state);
+}
+
+// FNV-1a over the fields before the checksum
+uint32_t TimeService::checksumOf(const State& state) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(State, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
@@ -5,6 +5,16 @@
 #include <LittleFS.h>
 #include <NTPClient.h>
 #include <WiFiUdp.h>
+#include <BatchPublisher.h>
+#include <LittleFSAppendFile.h>
+#include <OfflineQueue.h>
+#include <ConnectionManager.h>
+#include <WifiCommunication.h>
+#include <MqttConnection.h>
+#include <FastResume.h>
+#include <TimeService.h>
+#include <Metrics.h>
+#include <TimeSeriesStore.h>
 
 
 // Variables that need to be set
@@ -20,10 +30,15 @@ const char* mqtt_password = "your_mqtt_password";
 const char* mqtt_topic_temperature = "temperature/greenhouse/reading";
 const char* mqtt_topic_error = "temperature/greenhouse/error";
 const char* mqtt_topic_battery = "temperature/greenhouse/battery";
+const char* mqtt_topic_metrics = "temperature/greenhouse/metrics";
+const char* mqtt_topic_summary = "temperature/greenhouse/summary";
 // TODO: change these to their individual components for use in the string builder function utilized by the MQTT publish method.
 
 const char* device_identifier = "esp32-temperature"; 
 
+// Encoding of the batched reading payloads - Json is readable, Cbor is ~25% smaller
+const BatchPublisher::Format mqtt_payload_format = BatchPublisher::Format::Json;
+
 
 
 // TODO: Set up a unique identifier for the device, this should either be user set or generated if there is no user input
@@ -39,7 +54,7 @@ const char* device_identifier = "esp32-temperature";
 // It may be a good idea to split that into its own branch as arduino IDE removed the ability to push files to the ESP32
 // and I'd like this to be easy to use so I can offer it to others
 // TODO: Implement transistor control to avoid voltage drain as a result of the voltage monitor
-// TODO: Add QoS levels or error handling failing to publish to MQTT - if it's unable to publish it should store in the file system and try again on next cycle
+// TODO: Add QoS levels for MQTT publishes - failed publishes are queued in mqttQueue and retried on the next connection
 // TODO: Move MQTT publishing to its own function - I only expected to publish once when I started this project - clearly that changed
 // It should create a string with values, timestamp, and identifier then publish that string to the MQTT topic
 // TODO: Move methods to their own classes - this is a mess
@@ -55,22 +70,34 @@ DHT dht(DHTPIN, DHTTYPE);
 WiFiUDP ntpUDP;
 NTPClient timeClient(ntpUDP, "pool.ntp.org", -7 * 3600, 60000); // Denver time (UTC-7)
 
-// File path for storing data
-const char* dataFilePath = "/sensor_data.txt";
+// Sensor history on LittleFS: raw readings for about a day and a half, and min/max/mean per
+// minute, hour and day going back over a year, in at most 96 KB of segments under /series
+const uint8_t dhtSensorId = 0;     // Channel 0 is the temperature, 1 the humidity
+const uint8_t batterySensorId = 1; // Channel 0 is the voltage
+const size_t summaryHoursPerWake = 1; // Hourly summaries published per wake, one payload that fits an offline queue entry; a backlog catches up over later wakes
 
-void connectToWiFi() {
-  if (WiFi.status() == WL_CONNECTED) return;
+// Write buffers and open rollups of the history, kept in RTC memory so they survive deep sleep
+RTC_DATA_ATTR TimeSeriesStore::State historyState;
+TimeSeriesStore sensorHistory(historyState);
+RTC_DATA_ATTR uint32_t lastSummaryHour = 0; // Start of the last hour published to mqtt_topic_summary
 
-  Serial.print("Connecting to Wi-Fi: " + String(ssid) + "\n");
-  WiFi.begin(ssid, password);
+// Readings of the current wake, published together at the end of loop()
+BatchPublisher readingBatch(device_identifier, mqtt_payload_format);
 
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
-  }
+// Publishes that failed, kept on LittleFS and sent oldest first once MQTT is connected again
+OfflineQueue mqttQueue("/mqtt_queue", [](const std::string& path) {
+  return std::unique_ptr<BaseAppendFile>(new LittleFSAppendFile(path));
+});
 
-  Serial.println("\nConnected to Wi-Fi");
-  Serial.println("IP Address: " + WiFi.localIP().toString());
+// Publishes a message, queueing it for the next connection if the publish fails
+bool publishOrQueue(const char* topic, const char* message) {
+  if (client.publish(topic, message)) {
+    return true;
+  }
+  if (!mqttQueue.enqueue(topic, message)) {
+    Serial.println("Failed to queue MQTT message");
+  }
+  return false;
 }
 
 // Builds a string from the topic type, location, and attribute
@@ -79,32 +106,32 @@ String buildMqttTopic(const char* topicType, const char* location, const char* a
   return topic;
 }
 
-void connectToMQTT() {
-  if (client.connected()) return;
-
-  while (!client.connected()) {
-    Serial.println("Connecting to MQTT...");
-
-    if (client.connect("ESP32Client")) {
-      Serial.println("Connected to MQTT broker");
-    } else {
-      Serial.println("Failed to connect to MQTT. State: " + String(client.state()));
-      delay(2000);
-    }
+// Brings up WiFi and then the MQTT session without blocking; loop() samples sensors meanwhile
+WiFiCommunication wifi(ssid, password);
+MqttConnection mqtt(client, "ESP32Client");
+ConnectionManager connection(wifi, mqtt);
+const uint32_t connectWindowMs = 15000; // Longest a wake waits for the connection before sleeping
+
+// AP, lease and broker address of the last full connect, so most wakes skip the scan, DHCP and DNS
+RTC_DATA_ATTR FastResume::State resumeState;
+FastResume resume(resumeState);
+
+// Wall clock carried on the RTC timer across deep sleep; NTP only runs every few wakes
+RTC_DATA_ATTR TimeService::State clockState;
+TimeService wallClock(clockState);
+
+// Pumps the connection state machine until connected or the wake's connect window has passed
+bool waitForConnection(uint32_t startedMs) {
+  while (!connection.isConnected() && millis() - startedMs < connectWindowMs) {
+    connection.update();
+    delay(10);
   }
-}
-
-bool mqttPublish(const String& topic, const char* message, const char* mqtt_broker, int mqtt_port, const char* mqtt_username, const char* mqtt_password) {
-
-  if (client.publish(topic.c_str(), message)) {
-    Serial.println("Message published successfully");
-    client.disconnect();
+  if (connection.isConnected()) {
+    Serial.println("Connected in " + String(static_cast<int>(connection.getConnectTimeMs())) + " ms");
     return true;
-  } else {
-    Serial.println("Failed to publish message");
-    client.disconnect();
-    return false;
   }
+  Serial.println("No connection, state: " + String(connectionStateToString(connection.getState())));
+  return false;
 }
 
 // Methods for the file system
@@ -130,93 +157,80 @@ void checkAndMountLittleFS() {
     }
   }
   Serial.println("LittleFS mounted successfully");
-  Serial.println("Checking to see if log file exists...");
-  // After mounting LittleFS, check if the data file exists
-
-  // TODO: Utilize MQTT publish method to publish an error message if the file exists as something has gone wrong
-  if (!LittleFS.exists(dataFilePath)) {
-    Serial.println("Data file does not exist. Creating a new file...");
-    File file = LittleFS.open(dataFilePath, FILE_WRITE);
-    if (!file) {
-      Serial.println("Failed to create file");
-      return;
-    }
-    file.close();
-    Serial.println("File created successfully");
-  } else {
-    Serial.println("Data file already exists");
+
+  // Rebuilds the buffers and open rollups from flash after a power loss
+  if (!sensorHistory.begin()) {
+    Serial.println("Failed to open the sensor history");
+  } else if (sensorHistory.wasRebuilt()) {
+    Serial.println("Sensor history rebuilt from flash");
   }
 }
 
 
-// Generate string from temp, hum, timestamp, and unique ID, and save it to LittleFS
-// If the file does not exist, create it - but throw an error as that is unexpected
-void saveToLittleFS(float temp, float hum, const String& timestamp) {
-  // Check if the file exists, create it if not
-  if (!LittleFS.exists(dataFilePath)) {
-
-    // While it's possible for this to have happened for other reasons, this should have already happened during setup. 
-    // It's important to verify ram and flash memory if this error occurs
-    // It might be a sign of failing flash memory 
-    // ESP32's flash memory is rated for 100,000 write cycles - this device may be reaching the end of its life
-    Serial.println("Error, file does not exist");
-    Serial.println("This file should have been created during checkAndMountLittleFS()");
-    Serial.println("Recreating the file, but logging this as an error - data will be lost, verify ram and flash memory");
-    // Create an error message and publish it to MQTT
-    char errorMessage[256];
-    snprintf(errorMessage, sizeof(errorMessage), "Filesystem Error on device %s at %s", device_identifier, timestamp);
-    client.publish(mqtt_topic_error, errorMessage);
-
-    File file = LittleFS.open(dataFilePath, FILE_WRITE);
-    if (!file) {
-      Serial.println("Failed to create file");
-      return;
-    }
-    file.close();
-    Serial.println("File created successfully");
-  }
-
-  // Open the file for appending
-  File file = LittleFS.open(dataFilePath, FILE_APPEND);
-  if (!file) {
-    Serial.println("Failed to open file for appending");
+// Add a temp/hum reading with an epoch timestamp to the sensor history on LittleFS
+// The history only writes to flash once its buffers fill, so most wakes write nothing
+void saveToLittleFS(float temp, float hum, uint64_t epochMs) {
+  uint32_t time = static_cast<uint32_t>(epochMs / 1000);
+  if (sensorHistory.append(time, dhtSensorId, 0, temp) && sensorHistory.append(time, dhtSensorId, 1, hum)) {
     return;
   }
 
-  // Write data to the file
-  file.printf("[%s] Temp: %.2fC, Humidity: %.2f%%\n", timestamp.c_str(), temp, hum);
-  file.close();
-  Serial.println("Data saved to LittleFS");
+  // The history could not write its buffer to flash - the partition may be full or the flash failing
+  // ESP32's flash memory is rated for 100,000 write cycles - this device may be reaching the end of its life
+  Serial.println("Error, failed to write the sensor history - verify ram and flash memory");
+  char timestamp[9];
+  TimeService::formatTimeOfDay(epochMs, timestamp, sizeof(timestamp));
+  char errorMessage[256];
+  snprintf(errorMessage, sizeof(errorMessage), "Filesystem Error on device %s at %s", device_identifier, timestamp);
+  publishOrQueue(mqtt_topic_error, errorMessage);
 }
 
-// Read data from LittleFS and print it to the serial monitor
+// Print the hourly temperature summaries of the last day to the serial monitor
 // TODO: Debugging method: Remove this method when code is finished
-void readFromLittleFS() {
-  File file = LittleFS.open(dataFilePath, FILE_READ);
-  if (!file) {
-    Serial.println("Failed to open file for reading");
-    return;
+void readFromLittleFS(uint64_t epochMs) {
+  uint32_t now = static_cast<uint32_t>(epochMs / 1000);
+  Serial.println("Hourly temperatures of the last day:");
+  size_t hours = sensorHistory.query(TimeSeriesStore::Tier::Hour, dhtSensorId, 0, now - 86400, now,
+                                     [](const TimeSeriesStore::Rollup& hour) {
+    char timestamp[9];
+    TimeService::formatTimeOfDay(static_cast<uint64_t>(hour.periodStart) * 1000, timestamp, sizeof(timestamp));
+    Serial.printf("[%s] Min: %.2fC, Max: %.2fC, Mean: %.2fC over %u readings\n", timestamp, hour.min, hour.max, hour.mean,
+                  static_cast<unsigned>(hour.count));
+  });
+  if (hours == 0) {
+    Serial.println("No hourly summaries yet");
   }
+}
 
-  Serial.println("Reading data from LittleFS:");
-  while (file.available()) {
-    char line[128];
-    int index = 0;
-
-    while (file.available()) {
-      char c = file.read();
-      if (c == '\n' || index >= 127) {
-        line[index] = '\0';
-        Serial.println(line);
-        index = 0;
-        if (c == '\n') break;
-      } else {
-        line[index++] = c;
+// Adds the hourly min/max/mean of hours closed since the last published one to this wake's batch,
+// read from the history's hour rollups for MQTT topic temperature/greenhouse/summary. Returns the
+// start of the newest hour added in full for both channels, or lastSummaryHour if none was; it
+// only becomes lastSummaryHour once the batch has published or queued the summaries
+uint32_t pushHourlySummaries() {
+  const char* fields[2][3] = {{"temp_min", "temp_max", "temp_mean"}, {"hum_min", "hum_max", "hum_mean"}};
+  uint32_t from = lastSummaryHour == 0 ? 0 : lastSummaryHour + 1;
+  uint32_t newest = UINT32_MAX;
+  for (uint8_t channel = 0; channel < 2; ++channel) {
+    size_t hours = 0;
+    bool full = false;
+    uint32_t channelNewest = lastSummaryHour;
+    sensorHistory.query(TimeSeriesStore::Tier::Hour, dhtSensorId, channel, from, UINT32_MAX,
+                        [&](const TimeSeriesStore::Rollup& hour) {
+      if (full || hours++ >= summaryHoursPerWake) {
+        return;
       }
-    }
+      uint64_t hourMs = static_cast<uint64_t>(hour.periodStart) * 1000;
+      // Stop at the first hour that does not fit, so the hours sent stay contiguous
+      full = !readingBatch.add(mqtt_topic_summary, "dht", fields[channel][0], hour.min, hourMs) ||
+             !readingBatch.add(mqtt_topic_summary, "dht", fields[channel][1], hour.max, hourMs) ||
+             !readingBatch.add(mqtt_topic_summary, "dht", fields[channel][2], hour.mean, hourMs);
+      if (!full) {
+        channelNewest = hour.periodStart;
+      }
+    });
+    newest = channelNewest < newest ? channelNewest : newest;
   }
-
-  file.close();
+  return newest;
 }
 
 // Battery interface methods 
@@ -237,32 +251,30 @@ void controlVoltage(bool state) {
   Serial.println(String("Voltage control set to: ") + (state ? "ON" : "OFF"));
 }
 
-// Pushes battery voltage to MQTT topic temperature/greenhouse/battery
-// TODO: when MQTT is moved to its own function, this should implement that functionality
-void pushBatteryVoltage(float voltage) {
-  String message = String(voltage) + "V";
-  if (client.publish(mqtt_topic_battery, message.c_str())) {
-    Serial.println("Battery voltage published to MQTT");
-  } else {
-    Serial.println("Failed to publish battery voltage to MQTT");
+// Adds the battery voltage to the sensor history and to this wake's batch for MQTT topic temperature/greenhouse/battery
+void pushBatteryVoltage(float voltage, uint64_t epochMs) {
+  sensorHistory.append(static_cast<uint32_t>(epochMs / 1000), batterySensorId, 0, voltage);
+  if (!readingBatch.add(mqtt_topic_battery, "battery", "volts", voltage, epochMs)) {
+    Serial.println("Failed to add battery voltage to the MQTT batch");
   }
 }
 
 void setup() {
   Serial.begin(115200);
 
-  connectToWiFi();
-
   client.setServer(mqtt_broker, mqtt_port);
+  client.setBufferSize(BATCH_PUBLISHER_PAYLOAD_SIZE + 64); // Room for a full batch plus topic and header
+  wifi.setFastResume(&resume);
+  mqtt.setFastResume(&resume, mqtt_broker, mqtt_port);
 
   dht.begin();
 
   checkAndMountLittleFS();
-  // Get the current time from NTP server for timestamping the data
+  if (!mqttQueue.begin()) {
+    Serial.println("Failed to open the MQTT offline queue");
+  }
+  // NTP is synced in loop() once the connection is up, and only when the RTC clock is due for it
   timeClient.begin();
-  timeClient.update();
-
-  readFromLittleFS();
 
   // 
   // Initialize ADC
@@ -270,36 +282,77 @@ void setup() {
 
 }
 
-// Connects to wifi, connects to MQTT, pulls a timestamp, reads the temperature and humidity, saves it to LittleFS, and publishes it to MQTT
+// Starts connecting, reads the sensors while WiFi associates, pulls a timestamp, saves the readings to LittleFS, and publishes them to MQTT
 void loop() {
-  connectToWiFi();
-  connectToMQTT();
-
-  // TODO: Move to a self contained time read function that handles all time activity
-  timeClient.update();
-  String timestamp = timeClient.getFormattedTime();
-
+  uint32_t wakeMs = millis();
+  connection.begin();
 
   // TODO: Move to a self contained sensor read function that handles all DHT sensor activity
   float temp = dht.readTemperature();
+  connection.update();
   float hum = dht.readHumidity();
+  connection.update();
+
+  // TODO: Move to a self contained battery read function that handles all battery activity
+  float voltage = readBatteryVoltage();
+
+  bool connected = waitForConnection(wakeMs);
+  if (connected) {
+    // Only does anything after a full connect; the next wake then resumes from the cache
+    wifi.rememberLink();
+    mqtt.rememberBroker();
 
-  if (isnan(temp) || isnan(hum)) {
-    Serial.println("Failed to read from DHT sensor");
+    // Send anything that failed to publish on earlier wakes before the new readings
+    size_t resent = mqttQueue.drain(client);
+    if (resent > 0) {
+      Serial.println("Published " + String(static_cast<int>(resent)) + " queued messages");
+    }
+  }
+
+  wallClock.wake();
+  if (connected && wallClock.needsSync() && timeClient.update()) {
+    // NTPClient truncates to whole seconds; half a second is the middle of the possible error
+    wallClock.sync(static_cast<uint64_t>(timeClient.getEpochTime()) * 1000 + 500);
+  }
+  if (!wallClock.isSynced()) {
+    // Before the first NTP sync NTPClient only has its offset plus the uptime, which wraps to
+    // 2106 and would hold the history there, so the readings of this wake are dropped
+    Serial.println("Clock not set yet; readings of this wake are not stored");
   } else {
-    saveToLittleFS(temp, hum, timestamp);
-    String message = "[" + timestamp + "] Temp: " + String(temp) + "C, Humidity: " + String(hum) + "%";
-    if (client.publish(mqtt_topic_temperature, message.c_str())) {
-      Serial.println("Message published to MQTT");
+    uint64_t epochMs = wallClock.nowMs();
+    if (isnan(temp) || isnan(hum)) {
+      Serial.println("Failed to read from DHT sensor");
     } else {
-      Serial.println("Failed to publish message to MQTT");
+      saveToLittleFS(temp, hum, epochMs);
+      readingBatch.add(mqtt_topic_temperature, "dht", "temp", temp, epochMs);
+      readingBatch.add(mqtt_topic_temperature, "dht", "hum", hum, epochMs);
     }
+    pushBatteryVoltage(voltage, epochMs);
+    readFromLittleFS(epochMs);
+  }
+  uint32_t summaryHour = pushHourlySummaries();
+
+  // One payload per topic over the open connection; failures (or no connection) are queued for the next wake
+  BatchPublisher::Result result;
+  size_t published = readingBatch.publish(client, &mqttQueue, &result);
+  Serial.println("Published " + String(static_cast<int>(published)) + " batched payloads to MQTT");
+  if (result.isDelivered(mqtt_topic_summary)) {
+    lastSummaryHour = summaryHour; // Otherwise the same hours are summarized again next wake
+  } else if (summaryHour != lastSummaryHour) {
+    Serial.println("Hourly summaries were neither published nor queued; retrying next wake");
   }
 
-
-  // TODO: Move to a self contained battery read function that handles all battery activity
-  float voltage = readBatteryVoltage();
-  pushBatteryVoltage(voltage);
+  // Counters and timings of this wake as one message; they start from zero again after deep sleep
+  if (connected) {
+    char metrics[BATCH_PUBLISHER_PAYLOAD_SIZE];
+    if (Metrics::formatJson(Metrics::snapshot(), metrics, sizeof(metrics)) > 0) {
+      client.publish(mqtt_topic_metrics, metrics);
+    }
+  }
+  connection.stop();
+  if (!connected) {
+    resume.forgetNetwork(); // Connect the full way next wake in case the cached AP, lease or broker went stale
+  }
 
   // Sleep for 5 minutes - good night, sweet prince.
   Serial.println("Going to deep sleep for 5 minutes...");
@@ -0,0 +1,669 @@
+#include <unity.h>
+#include <Benchmark.h>
+#include <Hal.h>
+#include <HalFS.h>
+#include <Logger.h>
+#include <FileSystem.h>
+#include <BinaryLogFile.h>
+#include <LittleFSAppendFile.h>
+#include <BatchPublisher.h>
+#include <OfflineQueue.h>
+#include <BatteryZenerSensor.h>
+#include <AdcSampler.h>
+#include <LatestValue.h>
+#include <ReadingStore.h>
+#include <SensorPool.h>
+#include <StaticSensorSet.h>
+#include <Metrics.h>
+#include <ConnectionManager.h>
+#include <FastResume.h>
+#include <TimeService.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <SensorManager.h>
+#else
+#include <HalSim.h>
+#include <chrono>
+#endif
+
+// Benchmarks for the work done on every wake. Each case prints a `BENCH {json}` line; collect
+// them with `grep '^BENCH '` from the test output or the serial log and compare against a
+// baseline to catch regressions. On the host the HAL is simulated, so the figures are CPU time
+// of the code paths only; ADC conversion and flash time show up in the on-device run.
+
+const int batteryPin = 36;
+const char* writePath = "/bench_write.txt";
+const char* readPath = "/bench_read.txt";
+const char* dataPath = "/bench_data.bin";
+const char* queuePrefix = "/bench_queue";
+
+// Stands in for PubSubClient: accepts every publish and counts the bytes
+class NullClient {
+public:
+    bool publish(const char*, const uint8_t*, unsigned int length) {
+        bytes += length;
+        return true;
+    }
+
+    bool publish(const char* topic, const char* message) {
+        return publish(topic, reinterpret_cast<const uint8_t*>(message), 0);
+    }
+
+    size_t bytes = 0;
+};
+
+#ifndef ARDUINO
+// Radio costs of one connect in simulated ms, typical of an ESP32 on a home access point
+const uint32_t scanAndAssociateMs = 1200; // Scan of every channel, then association
+const uint32_t cachedAssociateMs = 150;   // Known BSSID and channel: association only
+const uint32_t dhcpMs = 700;
+const uint32_t dnsMs = 100;
+const uint32_t mqttConnectMs = 50;
+const uint32_t ntpMs = 300;
+const uint64_t sleepUs = 300ULL * 1000 * 1000;
+
+HAL_RTC_DATA FastResume::State resumeState;
+HAL_RTC_DATA TimeService::State clockState;
+
+// WiFi as WiFiCommunication drives it, on the manual clock: a cached link skips scan and DHCP
+class SimulatedWifi : public BaseConnection {
+public:
+    explicit SimulatedWifi(FastResume& resume) : BaseConnection("Simulated WiFi", ConnType::WiFi), resume(resume) {}
+
+    bool begin() override {
+        fastAttempt = resume.hasLink();
+        readyAtMs = Hal::millis() + (fastAttempt ? cachedAssociateMs : scanAndAssociateMs + dhcpMs);
+        associating = true;
+        return true;
+    }
+    void start() override { begin(); }
+    void stop() override { associating = false; }
+    bool isConnected() const override { return associating && Hal::millis() >= readyAtMs; }
+
+    void rememberLink() {
+        if (!fastAttempt) {
+            resume.saveLink(FastResume::Link{{0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56}, 6, 0, 0x3201A8C0, 0x0101A8C0, 0x00FFFFFF, 0x0101A8C0});
+        }
+    }
+
+private:
+    FastResume& resume;
+    uint32_t readyAtMs = 0;
+    bool associating = false;
+    bool fastAttempt = false;
+};
+
+// MQTT as MqttConnection drives it: connect() blocks for the DNS lookup unless the address is cached
+class SimulatedBroker : public BaseConnection {
+public:
+    explicit SimulatedBroker(FastResume& resume) : BaseConnection("Simulated broker", ConnType::WiFi), resume(resume) {}
+
+    bool begin() override {
+        cachedAttempt = resume.hasBroker();
+        Hal::delay((cachedAttempt ? 0 : dnsMs) + mqttConnectMs);
+        connected = true;
+        return true;
+    }
+    void start() override { begin(); }
+    void stop() override { connected = false; }
+    bool isConnected() const override { return connected; }
+
+    void rememberBroker() {
+        if (!cachedAttempt) {
+            resume.saveBroker(0x0A01A8C0);
+        }
+    }
+
+private:
+    FastResume& resume;
+    bool cachedAttempt = false;
+    bool connected = false;
+};
+#endif
+
+std::unique_ptr<BaseAppendFile> openQueueFile(const std::string& path) {
+    return std::unique_ptr<BaseAppendFile>(new LittleFSAppendFile(path));
+}
+
+void expectSane(const Benchmark::Result& result) {
+    Benchmark::report(result);
+    TEST_ASSERT_TRUE(result.samples > 0);
+    TEST_ASSERT_TRUE(result.p50Ns <= result.p99Ns);
+    TEST_ASSERT_TRUE(result.p99Ns <= result.maxNs);
+}
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+    Hal::Sim::setAnalogValue(batteryPin, 971);
+#endif
+}
+
+void tearDown() {
+    Logger::clearHandlers();
+}
+
+void test_logger_dispatch() {
+    uint32_t delivered = 0;
+    Logger::setGlobalLogLevel(LogLevel::INFO);
+    Logger::addRecordHandler("bench", [&delivered](const LogRecord&) { delivered++; });
+    expectSane(Benchmark::run("logger.dispatch.record", {200, 1000, 100}, [] {
+        LOG_INFO("Battery {} pct after {} ms", 87, 12);
+    }));
+    Logger::clearHandlers();
+
+    size_t rendered = 0;
+    Logger::addHandler("bench", [&rendered](LogLevel, const std::string& message) { rendered += message.size(); });
+    expectSane(Benchmark::run("logger.dispatch.text", {200, 1000, 100}, [] {
+        LOG_INFO("Battery {} pct after {} ms", 87, 12);
+    }));
+    TEST_ASSERT_TRUE(delivered > 0 && rendered > 0);
+}
+
+void test_filesystem_write_and_read() {
+#ifndef ARDUINO
+    Hal::Sim::setConsoleEnabled(false); // FileSystem reports every mount step
+#endif
+    FileSystem fs;
+#ifndef ARDUINO
+    Hal::Sim::setConsoleEnabled(true);
+#endif
+    fs.remove(writePath);
+    fs.remove(readPath);
+    for (int i = 0; i < 64; ++i) {
+        fs.write(readPath, "12:00:00,21.50,48.00\n");
+    }
+
+    expectSane(Benchmark::run("filesystem.write", {50, 100, 10}, [&fs] {
+        fs.write(writePath, "12:00:00,21.50,48.00\n");
+    }));
+    size_t bytes = 0;
+    expectSane(Benchmark::run("filesystem.read", {50, 50, 5}, [&fs, &bytes] {
+        bytes += fs.read(readPath).size();
+    }));
+    TEST_ASSERT_TRUE(bytes > 0);
+
+    fs.remove(writePath);
+    fs.remove(readPath);
+}
+
+void test_battery_get_reading() {
+    BatteryZenerSensor battery(4.2, 3.0, batteryPin, -1, 100);
+    float level = 0;
+    expectSane(Benchmark::run("battery.getReading.100", {50, 20, 2}, [&battery, &level] {
+        level += battery.getReading();
+    }));
+    TEST_ASSERT_TRUE(level > 0);
+}
+
+// Turning 10k battery samples into a percentage: each sample converted to volts in floating
+// point and the volts averaged, as the sensor used to, versus summed in integers and converted
+// once through the compile-time calibration table
+void test_battery_conversion() {
+    static uint16_t samples[10000];
+    for (size_t i = 0; i < 10000; ++i) {
+        samples[i] = static_cast<uint16_t>(917 + (i * 7919) % 17 - 8); // Some spread around 4.05 V
+    }
+    volatile float sink = 0;
+
+    expectSane(Benchmark::run("battery.convert.float.10k", {50, 1, 2}, [&sink] {
+        float sum = 0;
+        for (uint16_t counts : samples) {
+            float pinVolts = (counts / 4095.0f) * 3.3f;
+            sum += pinVolts / (10.0f / (36.0f + 10.0f));
+        }
+        float batteryVolts = sum / 10000;
+        sink = (batteryVolts - 3.0f) / (4.2f - 3.0f) * 100;
+    }));
+
+    expectSane(Benchmark::run("battery.convert.table.10k", {50, 1, 2}, [&sink] {
+        SampleStats stats;
+        for (size_t i = 0; i < 10000; i += ADC_SAMPLER_FRAME_SAMPLES) {
+            stats.addBatch(samples + i, std::min<size_t>(ADC_SAMPLER_FRAME_SAMPLES, 10000 - i));
+        }
+        uint32_t countsQ4 = static_cast<uint32_t>((stats.getSum() * BatteryCalibration::countsScale + 5000) / 10000);
+        sink = BatteryCalibration::centiPercentFromCounts(countsQ4) / 100.0f;
+    }));
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 82.7, sink);
+}
+
+#ifndef ARDUINO
+// 10k battery samples the old way, a blocking analogRead() loop (about 10 us a conversion on the
+// ESP32, all of it CPU time), versus streamed by the DMA at 20 kHz. The BENCH lines are the host
+// CPU time of each path per reading; samples/s and time per reading are simulated device time
+void test_battery_sampling() {
+    Hal::Sim::useManualClock(true);
+    Hal::Sim::setAnalogReadCost(10);
+    const char* names[] = {"battery.sample.loop.10k", "battery.sample.stream.10k"};
+    const uint32_t readings = 20;
+
+    for (int streamed = 0; streamed < 2; ++streamed) {
+        Hal::Sim::setAdcStreamSupported(streamed == 1);
+        AdcSampler sampler(batteryPin, AdcSampler::Config{20000, 0, 10000, 0.0f, 100});
+        std::vector<uint32_t> cpuNs;
+        uint64_t simulatedUs = 0;
+        for (uint32_t i = 0; i < readings; ++i) {
+            uint64_t startUs = Hal::Sim::nowMicros();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            TEST_ASSERT_EQUAL(streamed == 1, sampler.start());
+            TEST_ASSERT_TRUE(sampler.run());
+            cpuNs.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+            simulatedUs += Hal::Sim::nowMicros() - startUs;
+            TEST_ASSERT_EQUAL(10000, sampler.getStats().getCount());
+        }
+
+        expectSane(Benchmark::summarize(names[streamed], cpuNs, 1, 0, 0));
+        char line[128];
+        snprintf(line, sizeof(line), "%s: %u samples/s, %u ms per reading, CPU busy %s",
+                 names[streamed], static_cast<unsigned>(10000ULL * readings * 1000000 / simulatedUs),
+                 static_cast<unsigned>(simulatedUs / readings / 1000), streamed ? "only while folding frames" : "throughout");
+        TEST_MESSAGE(line);
+    }
+}
+#endif
+
+// Same layout as SensorManager's SensorData
+struct SensorReading {
+    float temperature;
+    float humidity;
+    bool isValid;
+    unsigned long lastReadTime;
+};
+
+LatestValue<SensorReading> latestReadings[8];
+
+#ifndef ARDUINO
+std::atomic<bool> snapshotWriterStop{false};
+std::atomic<bool> snapshotWriterDone{false};
+
+// A sensor task storing as fast as it can, far more often than a real one
+void snapshotWriterTask(void*) {
+    uint32_t n = 0;
+    while (!snapshotWriterStop.load()) {
+        latestReadings[0].store(SensorReading{21.5f, 48.0f, true, ++n});
+    }
+    snapshotWriterDone.store(true);
+}
+#endif
+
+// Readers of SensorManager's results: one latest value, then all eight as snapshotAll() copies
+// them, idle and (on the host) while a writer keeps storing to the one being read
+void test_sensor_snapshot_reads() {
+    for (LatestValue<SensorReading>& latest : latestReadings) {
+        latest.store(SensorReading{21.5f, 48.0f, true, 1});
+    }
+    float sum = 0;
+    expectSane(Benchmark::run("sensors.snapshot.load", {200, 1000, 100}, [&sum] {
+        sum += latestReadings[0].load().temperature;
+    }));
+    SensorReading all[8];
+    expectSane(Benchmark::run("sensors.snapshot.all.8", {200, 100, 10}, [&sum, &all] {
+        for (size_t i = 0; i < 8; ++i) {
+            all[i] = latestReadings[i].load();
+        }
+        sum += all[7].humidity;
+    }));
+
+#ifndef ARDUINO
+    snapshotWriterStop.store(false);
+    snapshotWriterDone.store(false);
+    TEST_ASSERT_TRUE(Hal::startTask("Writer", snapshotWriterTask));
+    expectSane(Benchmark::run("sensors.snapshot.load.contended", {200, 1000, 100}, [&sum] {
+        sum += latestReadings[0].load().temperature;
+    }));
+    snapshotWriterStop.store(true);
+    while (!snapshotWriterDone.load()) {
+        Hal::delay(1);
+    }
+#endif
+    TEST_ASSERT_TRUE(sum > 0);
+}
+
+// Histories of a DHT and a battery sensor: rings of SensorData, the array of structs a history
+// of today's results would be, and the same readings as ReadingStore channels
+const size_t historyLength = 256;
+SensorReading structHistory[2][historyLength];
+size_t structHeads[2] = {};
+ReadingStore<3, historyLength> readingHistory;
+
+void appendStruct(size_t sensor, const SensorReading& reading) {
+    structHistory[sensor][structHeads[sensor]] = reading;
+    structHeads[sensor] = structHeads[sensor] + 1 == historyLength ? 0 : structHeads[sensor] + 1;
+}
+
+// Appending one wake's readings, then the mean temperature over the whole history as a
+// publisher or an aggregation would walk it
+void test_reading_store() {
+    int temperature = readingHistory.addChannel(0, 0, Reading::Unit::Celsius, "temp");
+    int humidity = readingHistory.addChannel(0, 1, Reading::Unit::Percent, "hum");
+    int battery = readingHistory.addChannel(1, 0, Reading::Unit::Percent, "battery");
+    uint32_t nowMs = 0;
+    expectSane(Benchmark::run("readings.insert.structs", {200, 1000, 100}, [&nowMs] {
+        nowMs += 2000;
+        appendStruct(0, SensorReading{21.5f + (nowMs & 1), 48.0f, true, nowMs});
+        appendStruct(1, SensorReading{87.0f, NAN, true, nowMs}); // Battery level in the temperature field
+    }));
+    nowMs = 0;
+    expectSane(Benchmark::run("readings.insert.store", {200, 1000, 100}, [&] {
+        nowMs += 2000;
+        readingHistory.append(temperature, nowMs, 21.5f + (nowMs & 1));
+        readingHistory.append(humidity, nowMs, 48.0f);
+        readingHistory.append(battery, nowMs, 87.0f);
+    }));
+
+    // Reached through volatile pointers, so the compiler cannot sum the unchanged history once
+    // for a whole batch
+    const SensorReading* volatile structs = structHistory[0];
+    const ReadingStore<3, historyLength>* volatile store = &readingHistory;
+    float sum = 0;
+    expectSane(Benchmark::run("readings.iterate.structs.256", {200, 100, 10}, [&sum, &structs] {
+        const SensorReading* history = structs;
+        float total = 0;
+        for (size_t i = 0; i < historyLength; ++i) {
+            total += history[i].temperature;
+        }
+        sum += total / historyLength;
+    }));
+    expectSane(Benchmark::run("readings.iterate.store.256", {200, 100, 10}, [&sum, &store, temperature] {
+        float total = 0;
+        store->forEachSpan(temperature, [&total](const uint32_t*, const float* values, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                total += values[i];
+            }
+        });
+        sum += total / historyLength;
+    }));
+    TEST_ASSERT_TRUE(sum > 0);
+
+    size_t channelBytes = (sizeof(readingHistory) - 3 * historyLength * readingHistory.bytesPerReading) / 3;
+    char line[192];
+    snprintf(line, sizeof(line), "RAM per value: structs %u bytes for a DHT value, %u for a battery value; store %u bytes + %u per channel",
+             static_cast<unsigned>(sizeof(SensorReading) / 2), static_cast<unsigned>(sizeof(SensorReading)),
+             static_cast<unsigned>(readingHistory.bytesPerReading), static_cast<unsigned>(channelBytes));
+    TEST_MESSAGE(line);
+}
+
+// Stand-ins for DHTSensor and BatteryZenerSensor whose readings cost next to nothing, so the
+// dispatch cases time the dispatch
+class BenchClimateSensor : public BaseSensor {
+public:
+    explicit BenchClimateSensor(int pin) : BaseSensor(pin, "Climate", SensorType::DHT) {}
+    bool begin() override { return true; }
+    float getReading() const override { return 21.5f + (reads++ & 1); }
+    bool readTempAndHumidity(float& temperature, float& humidity) {
+        temperature = 21.5f + (reads++ & 1);
+        humidity = 48.0f;
+        return true;
+    }
+
+private:
+    mutable uint32_t reads = 0;
+};
+
+class BenchLevelSensor : public BaseSensor {
+public:
+    explicit BenchLevelSensor(int pin) : BaseSensor(pin, "Level", SensorType::BatteryZener) {}
+    bool begin() override { return true; }
+    float getReading() const override { return 87.0f + (reads++ & 1); }
+
+private:
+    mutable uint32_t reads = 0;
+};
+
+// One pass over eight sensors three ways: heap objects dispatched as SensorManager does (type
+// check, then a downcast or a virtual call), the same from a SensorPool, and a StaticSensorSet
+// of statically allocated sensors with direct calls
+void test_sensor_dispatch() {
+    float sum = 0;
+    auto readRuntime = [&sum](BaseSensor* const* sensors, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (sensors[i]->getType() == BaseSensor::SensorType::DHT) {
+                float temperature, humidity;
+                static_cast<BenchClimateSensor*>(sensors[i])->readTempAndHumidity(temperature, humidity);
+                sum += temperature + humidity;
+            } else {
+                sum += sensors[i]->getReading();
+            }
+        }
+    };
+
+    std::vector<BaseSensor*> heapSensors;
+    heapSensors.reserve(8);
+    uint64_t heapBefore = AllocationCounter::getBytes();
+    for (int i = 0; i < 8; ++i) {
+        heapSensors.push_back(i % 4 == 3 ? static_cast<BaseSensor*>(new BenchLevelSensor(i)) : new BenchClimateSensor(i));
+    }
+    uint64_t heapBytes = AllocationCounter::getBytes() - heapBefore;
+    expectSane(Benchmark::run("sensors.dispatch.heap.8", {200, 1000, 100}, [&] {
+        readRuntime(heapSensors.data(), heapSensors.size());
+    }));
+
+    static SensorPool<BaseSensor, 8, BenchClimateSensor, BenchLevelSensor> pool;
+    BaseSensor* pooled[8];
+    for (int i = 0; i < 8; ++i) {
+        pooled[i] = i % 4 == 3 ? static_cast<BaseSensor*>(pool.create<BenchLevelSensor>(i)) : pool.create<BenchClimateSensor>(i);
+    }
+    expectSane(Benchmark::run("sensors.dispatch.pool.8", {200, 1000, 100}, [&] {
+        readRuntime(pooled, 8);
+    }));
+
+    static BenchClimateSensor c0(0), c1(1), c2(2), c4(4), c5(5), c6(6);
+    static BenchLevelSensor l3(3), l7(7);
+    static StaticSensorSet<BenchClimateSensor, BenchClimateSensor, BenchClimateSensor, BenchLevelSensor,
+                           BenchClimateSensor, BenchClimateSensor, BenchClimateSensor, BenchLevelSensor>
+        staticSensors(c0, c1, c2, l3, c4, c5, c6, l7);
+    expectSane(Benchmark::run("sensors.dispatch.static.8", {200, 1000, 100}, [&sum] {
+        staticSensors.forEach([&sum](auto& sensor) {
+            if constexpr (std::is_same<std::decay_t<decltype(sensor)>, BenchClimateSensor>::value) {
+                float temperature, humidity;
+                sensor.readTempAndHumidity(temperature, humidity);
+                sum += temperature + humidity;
+            } else {
+                sum += sensor.BenchLevelSensor::getReading();
+            }
+        });
+    }));
+
+    char line[160];
+    snprintf(line, sizeof(line), "sensor RAM: heap %u bytes in %u allocations, pool %u bytes static, set %u bytes static + %u for the set",
+             static_cast<unsigned>(heapBytes), 8u, static_cast<unsigned>(sizeof(pool)),
+             static_cast<unsigned>(6 * sizeof(BenchClimateSensor) + 2 * sizeof(BenchLevelSensor)),
+             static_cast<unsigned>(sizeof(staticSensors)));
+    TEST_MESSAGE(line);
+
+    for (BaseSensor* sensor : heapSensors) {
+        delete sensor;
+    }
+    for (BaseSensor* sensor : pooled) {
+        pool.destroy(sensor);
+    }
+    TEST_ASSERT_TRUE(sum > 0);
+}
+
+void test_mqtt_payload_build() {
+    const char* topic = "temperature/greenhouse/reading";
+    BatchPublisher::Format formats[] = {BatchPublisher::Format::Json, BatchPublisher::Format::Cbor};
+    const char* names[] = {"mqtt.payload.json", "mqtt.payload.cbor"};
+
+    for (int f = 0; f < 2; ++f) {
+        BatchPublisher batch("esp32-temperature", formats[f]);
+        uint8_t payload[BATCH_PUBLISHER_PAYLOAD_SIZE];
+        size_t total = 0;
+        Benchmark::Result result = Benchmark::run(names[f], {200, 100, 10}, [&] {
+            batch.clear();
+            for (int i = 0; i < 3; ++i) {
+                batch.add(topic, "dht", "temp", 21.5f + i, 1700000000000ULL + i * 40);
+                batch.add(topic, "dht", "hum", 48.0f + i, 1700000000000ULL + i * 40);
+            }
+            batch.add(topic, "battery", "v", 3.71f, 1700000000200ULL);
+            size_t position = 0;
+            total += batch.encode(0, payload, sizeof(payload), position);
+        });
+        expectSane(result);
+        TEST_ASSERT_TRUE(total > 0);
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, result.allocsPerCall); // Building a payload never allocates
+    }
+}
+
+// Cost of the instrumentation itself; build with -DMETRICS_ENABLED=0 to compare against none
+void test_metrics_overhead() {
+    expectSane(Benchmark::run("metrics.count", {200, 1000, 100}, [] {
+        METRICS_COUNT(SensorReads);
+    }));
+    Benchmark::Result timed = Benchmark::run("metrics.time", {200, 1000, 100}, [] {
+        METRICS_TIME(SensorRead);
+    });
+    expectSane(timed);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, timed.allocsPerCall);
+}
+
+#ifndef ARDUINO
+// Simulated time from wake to the first publish over four hours of 5 minute sleeps, connecting
+// the full way (and syncing NTP) every wake versus resuming from the RTC cache and clock
+void test_time_to_first_publish() {
+    Hal::Sim::useManualClock(true);
+    const char* names[] = {"wake.first_publish.full", "wake.first_publish.resume"};
+    uint32_t p50Ns[2];
+
+    for (int cached = 0; cached < 2; ++cached) {
+        Hal::Sim::powerCycle();
+        FastResume resume(resumeState);
+        TimeService wallClock(clockState);
+        SimulatedWifi wifi(resume);
+        SimulatedBroker broker(resume);
+        ConnectionManager connection(wifi, broker);
+        NullClient client;
+        std::vector<uint32_t> sampleNs;
+
+        for (int wake = 0; wake < 48; ++wake) {
+            Hal::Sim::deepSleep(sleepUs);
+            if (!cached) {
+                resume.clear();
+                std::memset(&clockState, 0, sizeof(clockState));
+            }
+            connection.begin();
+            while (!connection.isConnected()) {
+                connection.update();
+                Hal::delay(10);
+            }
+            wifi.rememberLink();
+            broker.rememberBroker();
+            wallClock.wake();
+            if (wallClock.needsSync()) {
+                Hal::delay(ntpMs);
+                wallClock.sync(1700000000000ULL + Hal::rtcMicros() / 1000);
+            }
+            TEST_ASSERT_TRUE(wallClock.nowMs() > 0);
+            client.publish("temperature/greenhouse/reading", "{}");
+            sampleNs.push_back(Hal::micros() * 1000);
+            connection.stop();
+        }
+
+        Benchmark::Result result = Benchmark::summarize(names[cached], sampleNs, 1, 0, 0);
+        Benchmark::report(result);
+        p50Ns[cached] = result.p50Ns;
+    }
+    TEST_ASSERT_TRUE(p50Ns[1] * 4 < p50Ns[0]);
+}
+#endif
+
+#ifdef ARDUINO
+void test_sensor_manager_poll() {
+    SensorManager manager;
+    manager.registerSensor(34); // Battery sensor; DHT sensors are only polled every 2 s
+    manager.setRefreshInterval(0, 1); // Due on every poll rather than every 30 s
+    expectSane(Benchmark::run("sensormanager.poll", {20, 1, 1}, [&manager] {
+        manager.pollSensors();
+    }));
+}
+#endif
+
+// One wake as main.cpp runs it, minus the radio: battery sample, binary data file append,
+// batch build and publish, offline queue check, and the log lines along the way
+void test_wake_cycle() {
+    static BinaryLogEncoder::State logState;
+    BinaryLogFile dataLog(dataPath, logState);
+    LittleFS.remove(dataPath);
+    TEST_ASSERT_TRUE(dataLog.begin());
+
+    OfflineQueue queue(queuePrefix, openQueueFile);
+    TEST_ASSERT_TRUE(queue.begin());
+
+    BatteryZenerSensor battery(4.2, 3.0, batteryPin, -1, 100);
+    BatchPublisher batch("esp32-temperature");
+    NullClient client;
+    uint32_t logged = 0;
+    Logger::addRecordHandler("bench", [&logged](const LogRecord&) { logged++; });
+
+    uint64_t epochMs = 1700000000000ULL;
+    expectSane(Benchmark::run("wake.cycle", {50, 10, 2}, [&] {
+        epochMs += 300000;
+        LOG_INFO("Wake at {}", static_cast<uint32_t>(epochMs / 1000));
+        float temp = 21.5f;
+        float hum = 48.0f;
+        float level = battery.getReading();
+
+        float values[] = {temp, hum};
+        dataLog.appendReading(epochMs, 0, values, 2);
+        dataLog.flush();
+
+        queue.drain(client);
+        batch.add("temperature/greenhouse/reading", "dht", "temp", temp, epochMs);
+        batch.add("temperature/greenhouse/reading", "dht", "hum", hum, epochMs);
+        batch.add("temperature/greenhouse/battery", "battery", "pct", level, epochMs);
+        batch.publish(client, &queue);
+        LOG_INFO("Published {} bytes", static_cast<uint32_t>(client.bytes));
+    }));
+    TEST_ASSERT_TRUE(client.bytes > 0);
+    TEST_ASSERT_TRUE(logged > 0);
+    LittleFS.remove(dataPath);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_logger_dispatch);
+    RUN_TEST(test_filesystem_write_and_read);
+    RUN_TEST(test_battery_get_reading);
+    RUN_TEST(test_battery_conversion);
+#ifndef ARDUINO
+    RUN_TEST(test_battery_sampling);
+#endif
+    RUN_TEST(test_sensor_snapshot_reads);
+    RUN_TEST(test_sensor_dispatch);
+    RUN_TEST(test_reading_store);
+    RUN_TEST(test_mqtt_payload_build);
+    RUN_TEST(test_metrics_overhead);
+#ifndef ARDUINO
+    RUN_TEST(test_time_to_first_publish);
+#endif
+#ifdef ARDUINO
+    RUN_TEST(test_sensor_manager_poll);
+#endif
+    RUN_TEST(test_wake_cycle);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    LittleFS.begin(true);
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,325 @@
+#include <unity.h>
+#include "BatchPublisher.h"
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "LittleFSAppendFile.h"
+using QueueFile = LittleFSAppendFile;
+const char* queuePrefix = "/test_batch_queue";
+#else
+#include "HostAppendFile.h"
+using QueueFile = HostAppendFile;
+const char* queuePrefix = "/tmp/test_batch_queue";
+#endif
+
+// Stands in for PubSubClient and models the radio time of each publish: one round trip to
+// the broker plus the packet's airtime
+class SimulatedClient {
+public:
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length) {
+        if (failing) {
+            return false;
+        }
+        size_t packet = 2 + 2 + std::strlen(topic) + length; // Fixed header, topic length, topic, payload
+        bytes += packet;
+        radioMs += roundTripMs + packet * 8.0 / linkKbps;
+        payloads.push_back(std::string(reinterpret_cast<const char*>(payload), length));
+        return true;
+    }
+
+    bool publish(const char* topic, const char* message) {
+        return publish(topic, reinterpret_cast<const uint8_t*>(message), std::strlen(message));
+    }
+
+    // Connect and disconnect, as mqttPublish did around every message
+    void reconnect() {
+        bytes += 14 + 2 + 2;
+        radioMs += 2 * roundTripMs;
+    }
+
+    double roundTripMs = 30.0;
+    double linkKbps = 1000.0;
+    double radioMs = 0.0;
+    size_t bytes = 0;
+    bool failing = false;
+    std::vector<std::string> payloads;
+};
+
+const uint64_t baseTime = 1700000000000ULL;
+
+void removeQueueFiles() {
+    QueueFile(std::string(queuePrefix) + ".head0").remove();
+    QueueFile(std::string(queuePrefix) + ".head1").remove();
+    QueueFile(std::string(queuePrefix) + ".0").remove();
+}
+
+void setUp() {
+    removeQueueFiles();
+}
+
+void tearDown() {
+    removeQueueFiles();
+}
+
+void test_json_payload_groups_readings_by_topic() {
+    BatchPublisher batch("esp32");
+    TEST_ASSERT_TRUE(batch.add("gh/readings", "dht", "temp", 21.5f, baseTime));
+    TEST_ASSERT_TRUE(batch.add("gh/battery", "zener", "battery", 87.0f, baseTime + 5));
+    TEST_ASSERT_TRUE(batch.add("gh/readings", "dht", "hum", 48.25f, baseTime + 20));
+    TEST_ASSERT_FALSE(batch.add("gh/readings", "dht", "temp", NAN, baseTime));
+    TEST_ASSERT_EQUAL(3, batch.getReadingCount());
+    TEST_ASSERT_EQUAL(2, batch.getTopicCount());
+
+    SimulatedClient client;
+    TEST_ASSERT_EQUAL(2, batch.publish(client));
+    TEST_ASSERT_EQUAL(2, client.payloads.size());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"d\":\"esp32\",\"t\":1700000000000,\"r\":[[\"dht\",\"temp\",21.50,0],[\"dht\",\"hum\",48.25,20]]}",
+        client.payloads[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"d\":\"esp32\",\"t\":1700000000005,\"r\":[[\"zener\",\"battery\",87.00,0]]}",
+                             client.payloads[1].c_str());
+    TEST_ASSERT_EQUAL(0, batch.getReadingCount()); // Published batches are cleared
+}
+
+void test_cbor_payload_layout() {
+    BatchPublisher batch("d1", BatchPublisher::Format::Cbor);
+    batch.add("t", "s", "f", 1.5f, 10);
+
+    uint8_t payload[64];
+    size_t position = 0;
+    size_t length = batch.encode(0, payload, sizeof(payload), position);
+    const uint8_t expected[] = {
+        0xA3,                                   // Map of 3
+        0x61, 'd', 0x62, 'd', '1',              // "d": "d1"
+        0x61, 't', 0x0A,                        // "t": 10
+        0x61, 'r', 0x9F,                        // "r": [ (indefinite)
+        0x84, 0x61, 's', 0x61, 'f',             // ["s", "f",
+        0xFA, 0x3F, 0xC0, 0x00, 0x00,           //  1.5 (float32),
+        0x00,                                   //  0]
+        0xFF                                    // ]
+    };
+    TEST_ASSERT_EQUAL(sizeof(expected), length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, payload, sizeof(expected));
+    TEST_ASSERT_EQUAL(1, position);
+    TEST_ASSERT_EQUAL(0, batch.encode(0, payload, sizeof(payload), position)); // Nothing left
+}
+
+void test_large_group_is_split_across_payloads() {
+    BatchPublisher batch("esp32");
+    for (int i = 0; i < 20; ++i) {
+        TEST_ASSERT_TRUE(batch.add("gh/readings", "dht", "temp", 20.0f + i, baseTime + i));
+    }
+
+    uint8_t payload[128];
+    size_t position = 0;
+    size_t payloads = 0;
+    size_t readings = 0;
+    size_t length;
+    while ((length = batch.encode(0, payload, sizeof(payload), position)) > 0) {
+        std::string json(reinterpret_cast<const char*>(payload), length);
+        TEST_ASSERT_TRUE(json.size() <= sizeof(payload));
+        TEST_ASSERT_TRUE(json.compare(json.size() - 2, 2, "]}") == 0);
+        for (size_t at = json.find("\"temp\""); at != std::string::npos; at = json.find("\"temp\"", at + 1)) {
+            ++readings;
+        }
+        ++payloads;
+    }
+    TEST_ASSERT_EQUAL(20, readings);
+    TEST_ASSERT_TRUE(payloads > 1);
+}
+
+void test_extreme_values_encode_in_full() {
+    BatchPublisher batch("esp32");
+    TEST_ASSERT_TRUE(batch.add("gh/readings", "dht", "temp", FLT_MAX, baseTime));
+    TEST_ASSERT_TRUE(batch.add("gh/readings", "dht", "temp", -FLT_MAX, baseTime));
+    uint8_t payload[256];
+    size_t position = 0;
+    size_t length = batch.encode(0, payload, sizeof(payload), position);
+    std::string json(reinterpret_cast<const char*>(payload), length);
+    TEST_ASSERT_TRUE(json.find("\"temp\",340282346638528859811704183484516925440.00,0]") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"temp\",-340282346638528859811704183484516925440.00,0]") != std::string::npos);
+}
+
+void test_failed_publish_goes_to_fallback_queue() {
+    OfflineQueue queue(queuePrefix, [](const std::string& path) {
+        return std::unique_ptr<BaseAppendFile>(new QueueFile(path));
+    });
+    TEST_ASSERT_TRUE(queue.begin());
+
+    BatchPublisher batch("esp32");
+    batch.add("gh/readings", "dht", "temp", 21.5f, baseTime);
+    SimulatedClient client;
+    client.failing = true;
+    BatchPublisher::Result result;
+    TEST_ASSERT_EQUAL(0, batch.publish(client, &queue, &result));
+    TEST_ASSERT_EQUAL(0, batch.getReadingCount());
+    TEST_ASSERT_FALSE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(1, result.queued);
+    TEST_ASSERT_EQUAL(0, result.lost);
+    TEST_ASSERT_TRUE(result.isDelivered("gh/readings"));
+
+    // The queued payload is the one that would have been published
+    client.failing = false;
+    TEST_ASSERT_EQUAL(1, queue.drain(client));
+    TEST_ASSERT_EQUAL_STRING("{\"d\":\"esp32\",\"t\":1700000000000,\"r\":[[\"dht\",\"temp\",21.50,0]]}",
+                             client.payloads[0].c_str());
+}
+
+void test_payload_the_queue_rejects_is_reported_lost() {
+    // Not begun, so every enqueue fails
+    OfflineQueue queue(queuePrefix, [](const std::string& path) {
+        return std::unique_ptr<BaseAppendFile>(new QueueFile(path));
+    });
+    Metrics::reset();
+
+    BatchPublisher batch("esp32");
+    batch.add("gh/readings", "dht", "temp", 21.5f, baseTime);
+    batch.add("gh/battery", "battery", "volts", 3.7f, baseTime);
+    SimulatedClient client;
+    client.failing = true;
+    BatchPublisher::Result result;
+    TEST_ASSERT_EQUAL(0, batch.publish(client, &queue, &result));
+    TEST_ASSERT_EQUAL(2, result.lost);
+    TEST_ASSERT_EQUAL(2, result.topicCount);
+    TEST_ASSERT_FALSE(result.isDelivered("gh/readings"));
+    TEST_ASSERT_FALSE(result.isDelivered("gh/battery"));
+    TEST_ASSERT_FALSE(result.isDelivered("gh/other")); // Had no readings
+#if METRICS_ENABLED
+    TEST_ASSERT_EQUAL_UINT32(2, Metrics::snapshot().counters[static_cast<size_t>(Metrics::Counter::PublishesLost)]);
+#endif
+
+    client.failing = false;
+    batch.add("gh/readings", "dht", "temp", 21.5f, baseTime);
+    TEST_ASSERT_EQUAL(1, batch.publish(client, &queue, &result));
+    TEST_ASSERT_TRUE(result.isDelivered("gh/readings"));
+    TEST_ASSERT_EQUAL(1, result.published);
+}
+
+void test_payloads_for_the_queue_fit_an_entry() {
+    // A topic long enough that the queue takes less than a full payload
+    static const std::string topic(OFFLINE_QUEUE_ENTRY_SIZE - 301, 't');
+    OfflineQueue queue(queuePrefix, [](const std::string& path) {
+        return std::unique_ptr<BaseAppendFile>(new QueueFile(path));
+    });
+    TEST_ASSERT_TRUE(queue.begin());
+    TEST_ASSERT_EQUAL(300, OfflineQueue::maxPayloadSize(topic.c_str()));
+
+    BatchPublisher batch("esp32");
+    for (int i = 0; i < 20; ++i) {
+        batch.add(topic.c_str(), "dht", "temp", 21.5f, baseTime + i);
+    }
+    SimulatedClient client;
+    client.failing = true;
+    BatchPublisher::Result result;
+    batch.publish(client, &queue, &result);
+    TEST_ASSERT_EQUAL(0, result.lost);
+    TEST_ASSERT_TRUE(result.queued > 1); // Split to fit, where 512 byte payloads would be rejected
+    TEST_ASSERT_TRUE(result.isDelivered(topic.c_str()));
+
+    client.failing = false;
+    TEST_ASSERT_EQUAL(result.queued, queue.drain(client));
+    for (const std::string& payload : client.payloads) {
+        TEST_ASSERT_TRUE(payload.size() <= 300);
+    }
+}
+
+#ifndef ARDUINO
+// Simulates one wake cycle with three DHT sensors and a battery sensor and compares the
+// radio-on time and bytes per reading of one publish per value (with and without the
+// reconnect mqttPublish did), the current per-sensor text messages, and batched payloads.
+void test_radio_time_and_bytes_per_reading() {
+    const char* names[] = {"dht-a", "dht-b", "dht-c"};
+    const float temperatures[] = {21.5f, 22.25f, 19.75f};
+    const float humidities[] = {48.0f, 51.5f, 55.25f};
+    const float battery = 3.71f;
+    const size_t readings = 7;
+
+    SimulatedClient perValue;
+    SimulatedClient perValueReconnect;
+    for (int i = 0; i < 3; ++i) {
+        char value[16];
+        snprintf(value, sizeof(value), "%.2f", temperatures[i]);
+        perValue.publish("temperature/greenhouse/reading", value);
+        perValueReconnect.reconnect();
+        perValueReconnect.publish("temperature/greenhouse/reading", value);
+        snprintf(value, sizeof(value), "%.2f", humidities[i]);
+        perValue.publish("temperature/greenhouse/reading", value);
+        perValueReconnect.reconnect();
+        perValueReconnect.publish("temperature/greenhouse/reading", value);
+    }
+    perValue.publish("temperature/greenhouse/battery", "3.71V");
+    perValueReconnect.reconnect();
+    perValueReconnect.publish("temperature/greenhouse/battery", "3.71V");
+
+    SimulatedClient text;
+    for (int i = 0; i < 3; ++i) {
+        char message[80];
+        snprintf(message, sizeof(message), "[12:00:00] Temp: %.2fC, Humidity: %.2f%%", temperatures[i], humidities[i]);
+        text.publish("temperature/greenhouse/reading", message);
+    }
+    text.publish("temperature/greenhouse/battery", "3.71V");
+
+    SimulatedClient batched[2];
+    BatchPublisher::Format formats[] = {BatchPublisher::Format::Json, BatchPublisher::Format::Cbor};
+    for (int f = 0; f < 2; ++f) {
+        BatchPublisher batch("esp32-temperature", formats[f]);
+        for (int i = 0; i < 3; ++i) {
+            batch.add("temperature/greenhouse/reading", names[i], "temp", temperatures[i], baseTime + i * 40);
+            batch.add("temperature/greenhouse/reading", names[i], "hum", humidities[i], baseTime + i * 40);
+        }
+        batch.add("temperature/greenhouse/reading", "battery", "v", battery, baseTime + 200);
+        TEST_ASSERT_EQUAL(1, batch.publish(batched[f]));
+    }
+
+    char report[240];
+    snprintf(report, sizeof(report),
+             "radio ms per-value=%.1f per-value+reconnect=%.1f text=%.1f json=%.1f cbor=%.1f | "
+             "bytes/reading per-value=%.1f text=%.1f json=%.1f cbor=%.1f",
+             perValue.radioMs, perValueReconnect.radioMs, text.radioMs, batched[0].radioMs, batched[1].radioMs,
+             static_cast<double>(perValue.bytes) / readings, static_cast<double>(text.bytes) / readings,
+             static_cast<double>(batched[0].bytes) / readings, static_cast<double>(batched[1].bytes) / readings);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_TRUE(batched[1].radioMs < text.radioMs / 2);
+    TEST_ASSERT_TRUE(batched[1].bytes < batched[0].bytes);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_json_payload_groups_readings_by_topic);
+    RUN_TEST(test_cbor_payload_layout);
+    RUN_TEST(test_large_group_is_split_across_payloads);
+    RUN_TEST(test_extreme_values_encode_in_full);
+    RUN_TEST(test_failed_publish_goes_to_fallback_queue);
+    RUN_TEST(test_payload_the_queue_rejects_is_reported_lost);
+    RUN_TEST(test_payloads_for_the_queue_fit_an_entry);
+#ifndef ARDUINO
+    RUN_TEST(test_radio_time_and_bytes_per_reading);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    LittleFS.begin(true);
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,277 @@
+#include <unity.h>
+#include "ConnectionManager.h"
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+uint32_t fakeNow = 0;
+
+uint32_t fakeClock() {
+    return fakeNow;
+}
+
+// A link that associates a fixed time after begin(); the first failedAttempts never do
+class FakeLink : public BaseConnection {
+public:
+    FakeLink() : BaseConnection("Fake link", ConnType::WiFi) {}
+
+    bool begin() override {
+        begins++;
+        startedMs = fakeNow;
+        associating = begins > failedAttempts;
+        dropped = false;
+        return true;
+    }
+    void start() override { begin(); }
+    void stop() override { associating = false; dropped = false; }
+    bool isConnected() const override {
+        return associating && !dropped && fakeNow - startedMs >= associateMs;
+    }
+    uint32_t getAttemptTimeoutMs() const override { return begins == 1 ? firstAttemptTimeoutMs : 0; }
+
+    uint32_t associateMs = 1200;
+    uint32_t firstAttemptTimeoutMs = 0;
+    int failedAttempts = 0;
+    int begins = 0;
+    bool dropped = false;
+
+private:
+    uint32_t startedMs = 0;
+    bool associating = false;
+};
+
+// A broker session whose first failedAttempts connection attempts are refused
+class FakeBroker : public BaseConnection {
+public:
+    FakeBroker() : BaseConnection("Fake broker", ConnType::WiFi) {}
+
+    bool begin() override {
+        begins++;
+        fakeNow += connectMs; // PubSubClient's connect() blocks for the handshake
+        connected = begins > failedAttempts;
+        return connected;
+    }
+    void start() override { begin(); }
+    void stop() override { connected = false; }
+    bool isConnected() const override { return connected; }
+    void loop() override { loops++; }
+
+    uint32_t connectMs = 40;
+    int failedAttempts = 0;
+    int begins = 0;
+    int loops = 0;
+    bool connected = false;
+};
+
+ConnectionManager::Config testConfig() {
+    return ConnectionManager::Config{10000, 500, 4000, fakeClock};
+}
+
+// Pumps update() every stepMs until connected or the limit, counting the "sensor samples"
+// the caller gets to take in between
+uint32_t runUntilConnected(ConnectionManager& connection, uint32_t limitMs, uint32_t stepMs = 10, int* samples = nullptr) {
+    uint32_t start = fakeNow;
+    while (!connection.isConnected() && fakeNow - start < limitMs) {
+        connection.update();
+        if (samples != nullptr && !connection.isConnected()) {
+            ++*samples;
+        }
+        fakeNow += stepMs;
+    }
+    return fakeNow - start;
+}
+
+void setUp() {
+    fakeNow = 1000;
+}
+
+void tearDown() {}
+
+void test_connects_link_then_broker_without_blocking() {
+    FakeLink link;
+    FakeBroker broker;
+    ConnectionManager connection(link, broker, testConfig());
+    TEST_ASSERT_EQUAL(ConnectionManager::State::Idle, connection.getState());
+
+    connection.begin();
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkConnecting, connection.getState());
+    fakeNow += 500;
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkConnecting, connection.update()); // Returns while associating
+
+    int samples = 0;
+    runUntilConnected(connection, 5000, 10, &samples);
+    TEST_ASSERT_TRUE(connection.isConnected());
+    TEST_ASSERT_TRUE(samples > 50); // Work got done during association
+    TEST_ASSERT_EQUAL(1, link.begins);
+    TEST_ASSERT_EQUAL(1, broker.begins);
+    TEST_ASSERT_UINT32_WITHIN(60, 1200 + 40, connection.getConnectTimeMs());
+
+    connection.update();
+    TEST_ASSERT_EQUAL(1, broker.loops); // Connected updates service the session
+}
+
+void test_link_timeout_retries_with_backoff() {
+    FakeLink link;
+    link.failedAttempts = 2;
+    FakeBroker broker;
+    ConnectionManager connection(link, broker, testConfig());
+
+    connection.begin();
+    fakeNow += 10000;
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkBackoff, connection.update());
+    fakeNow += 499;
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkBackoff, connection.update());
+    fakeNow += 1;
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkConnecting, connection.update());
+    TEST_ASSERT_EQUAL(2, link.begins);
+
+    runUntilConnected(connection, 60000);
+    TEST_ASSERT_TRUE(connection.isConnected());
+    TEST_ASSERT_EQUAL(3, link.begins);
+    // Two timeouts, waits of 500 and 1000 ms, then association and the broker handshake
+    TEST_ASSERT_UINT32_WITHIN(60, 2 * 10000 + 500 + 1000 + 1200 + 40, connection.getConnectTimeMs());
+}
+
+// A link can shorten its own attempt, e.g. WiFi trying a cached AP before a full scan
+void test_link_attempt_timeout_overrides_config() {
+    FakeLink link;
+    link.failedAttempts = 1;
+    link.firstAttemptTimeoutMs = 3000;
+    link.associateMs = 6000;
+    FakeBroker broker;
+    ConnectionManager connection(link, broker, testConfig());
+
+    connection.begin();
+    fakeNow += 2999;
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkConnecting, connection.update());
+    fakeNow += 1;
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkBackoff, connection.update());
+
+    fakeNow += 500;
+    connection.update();
+    fakeNow += 5000; // The second attempt gets the config's 10 s again
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkConnecting, connection.update());
+    runUntilConnected(connection, 10000);
+    TEST_ASSERT_TRUE(connection.isConnected());
+    TEST_ASSERT_EQUAL(2, link.begins);
+}
+
+void test_broker_backoff_doubles_up_to_limit() {
+    FakeLink link;
+    link.associateMs = 0;
+    FakeBroker broker;
+    broker.failedAttempts = 5;
+    ConnectionManager connection(link, broker, testConfig());
+
+    connection.begin();
+    const uint32_t expected[] = {1000, 2000, 4000, 4000, 4000};
+    for (uint32_t next : expected) {
+        while (connection.update() != ConnectionManager::State::BrokerBackoff) {
+            fakeNow += 10;
+        }
+        TEST_ASSERT_EQUAL(next, connection.getBackoffMs());
+        while (connection.update() == ConnectionManager::State::BrokerBackoff) {
+            fakeNow += 10;
+        }
+    }
+    runUntilConnected(connection, 10000);
+    TEST_ASSERT_TRUE(connection.isConnected());
+    TEST_ASSERT_EQUAL(6, broker.begins);
+    TEST_ASSERT_EQUAL(500, connection.getBackoffMs()); // Reset after success
+}
+
+void test_reconnects_after_drop() {
+    FakeLink link;
+    FakeBroker broker;
+    ConnectionManager connection(link, broker, testConfig());
+    connection.begin();
+    runUntilConnected(connection, 5000);
+    TEST_ASSERT_TRUE(connection.isConnected());
+
+    broker.connected = false; // Broker closed the session
+    TEST_ASSERT_EQUAL(ConnectionManager::State::BrokerConnecting, connection.update());
+    TEST_ASSERT_EQUAL(ConnectionManager::State::Connected, connection.update());
+
+    link.dropped = true; // Access point went away
+    TEST_ASSERT_EQUAL(ConnectionManager::State::LinkConnecting, connection.update());
+    TEST_ASSERT_FALSE(broker.connected);
+    runUntilConnected(connection, 5000);
+    TEST_ASSERT_TRUE(connection.isConnected());
+    TEST_ASSERT_EQUAL(2, link.begins);
+
+    connection.stop();
+    TEST_ASSERT_EQUAL(ConnectionManager::State::Idle, connection.getState());
+    TEST_ASSERT_FALSE(broker.connected);
+}
+
+#ifndef ARDUINO
+// Reports time-to-connect and the share of the wake window left for other work, for a
+// clean connect, a flaky broker and a slow access point. The blocking connectToWiFi /
+// connectToMQTT loops left no time for sampling until both were up.
+void test_time_to_connect() {
+    struct Scenario {
+        const char* name;
+        uint32_t associateMs;
+        int linkFailures;
+        int brokerFailures;
+    };
+    const Scenario scenarios[] = {
+        {"clean", 1200, 0, 0},
+        {"flaky-broker", 1200, 0, 3},
+        {"slow-ap", 3500, 1, 0},
+    };
+
+    char report[240];
+    int length = 0;
+    for (const Scenario& scenario : scenarios) {
+        fakeNow = 1000;
+        FakeLink link;
+        link.associateMs = scenario.associateMs;
+        link.failedAttempts = scenario.linkFailures;
+        FakeBroker broker;
+        broker.failedAttempts = scenario.brokerFailures;
+        ConnectionManager connection(link, broker, testConfig());
+
+        int samples = 0;
+        connection.begin();
+        uint32_t total = runUntilConnected(connection, 120000, 10, &samples);
+        TEST_ASSERT_TRUE(connection.isConnected());
+        length += snprintf(report + length, sizeof(report) - length, "%s%s: connect=%lums attempts=%lu free=%.0f%%",
+                           length ? " | " : "", scenario.name, static_cast<unsigned long>(connection.getConnectTimeMs()),
+                           static_cast<unsigned long>(connection.getAttempts()), 100.0 * samples * 10 / total);
+    }
+    TEST_MESSAGE(report);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_connects_link_then_broker_without_blocking);
+    RUN_TEST(test_link_timeout_retries_with_backoff);
+    RUN_TEST(test_link_attempt_timeout_overrides_config);
+    RUN_TEST(test_broker_backoff_doubles_up_to_limit);
+    RUN_TEST(test_reconnects_after_drop);
+#ifndef ARDUINO
+    RUN_TEST(test_time_to_connect);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,128 @@
+#include <unity.h>
+#include "FastResume.h"
+#include <Hal.h>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+HAL_RTC_DATA FastResume::State testState;
+
+const uint64_t sleepUs = 300ULL * 1000 * 1000; // One 5 minute deep sleep
+
+FastResume::Link testLink() {
+    FastResume::Link link = {};
+    const uint8_t bssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+    std::memcpy(link.bssid, bssid, sizeof(bssid));
+    link.channel = 6;
+    link.localIp = 0x3201A8C0; // 192.168.1.50
+    link.gateway = 0x0101A8C0;
+    link.subnet = 0x00FFFFFF;
+    link.dns = 0x0101A8C0;
+    return link;
+}
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+    Hal::Sim::useManualClock(true);
+#endif
+    std::memset(&testState, 0, sizeof(testState));
+}
+
+void tearDown() {}
+
+void test_empty_cache_has_nothing() {
+    FastResume resume(testState);
+    TEST_ASSERT_FALSE(resume.isValid());
+    TEST_ASSERT_FALSE(resume.hasLink());
+    TEST_ASSERT_FALSE(resume.hasBroker());
+}
+
+void test_parts_are_saved_and_forgotten_separately() {
+    FastResume resume(testState);
+    resume.saveLink(testLink());
+    resume.saveBroker(0x0A01A8C0);
+    TEST_ASSERT_TRUE(resume.isValid());
+    TEST_ASSERT_TRUE(resume.hasLink());
+    TEST_ASSERT_TRUE(resume.hasBroker());
+    TEST_ASSERT_EQUAL(6, resume.getLink().channel);
+    TEST_ASSERT_EQUAL(0x56, resume.getLink().bssid[5]);
+    TEST_ASSERT_EQUAL(0x0A01A8C0, resume.getBrokerIp());
+
+    resume.forgetBroker();
+    TEST_ASSERT_TRUE(resume.hasLink());
+    TEST_ASSERT_FALSE(resume.hasBroker());
+
+    resume.saveBroker(0x0A01A8C0);
+    resume.forgetNetwork();
+    TEST_ASSERT_FALSE(resume.hasLink());
+    TEST_ASSERT_FALSE(resume.hasBroker());
+    TEST_ASSERT_TRUE(resume.isValid());
+
+    resume.saveLink(testLink());
+    resume.clear();
+    TEST_ASSERT_FALSE(resume.isValid());
+}
+
+void test_corruption_reads_as_empty() {
+    FastResume resume(testState);
+    resume.saveLink(testLink());
+    testState.link.channel = 11; // A bit flipped in RTC memory
+    TEST_ASSERT_FALSE(resume.isValid());
+    TEST_ASSERT_FALSE(resume.hasLink());
+
+    resume.saveBroker(0x0A01A8C0); // Writing starts over from an empty cache
+    TEST_ASSERT_TRUE(resume.hasBroker());
+    TEST_ASSERT_FALSE(resume.hasLink());
+}
+
+#ifndef ARDUINO
+void test_cache_survives_deep_sleep_not_power_loss() {
+    {
+        FastResume resume(testState);
+        resume.saveLink(testLink());
+        resume.saveBroker(0x0A01A8C0);
+    }
+    Hal::Sim::deepSleep(sleepUs);
+    {
+        FastResume resume(testState); // The next wake constructs a new cache over the same state
+        TEST_ASSERT_TRUE(resume.hasLink());
+        TEST_ASSERT_TRUE(resume.hasBroker());
+    }
+    Hal::Sim::powerCycle();
+    FastResume resume(testState);
+    TEST_ASSERT_FALSE(resume.isValid());
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_cache_has_nothing);
+    RUN_TEST(test_parts_are_saved_and_forgotten_separately);
+    RUN_TEST(test_corruption_reads_as_empty);
+#ifndef ARDUINO
+    RUN_TEST(test_cache_survives_deep_sleep_not_power_loss);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,354 @@
+#include <unity.h>
+#include "OfflineQueue.h"
+#include "BatchPublisher.h"
+#include "AppendJournal.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "LittleFSAppendFile.h"
+using QueueFile = LittleFSAppendFile;
+const char* queuePrefix = "/test_queue";
+#else
+#include <chrono>
+#include "HostAppendFile.h"
+using QueueFile = HostAppendFile;
+const char* queuePrefix = "/tmp/test_queue";
+#endif
+
+// Stands in for PubSubClient: records publishes and can be told to start failing
+class FakePubSubClient {
+public:
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length) {
+        if (failAfter == 0) {
+            return false;
+        }
+        if (failAfter > 0) {
+            --failAfter;
+        }
+        messages.push_back(std::string(topic) + "=" + std::string(reinterpret_cast<const char*>(payload), length));
+        return true;
+    }
+
+    std::vector<std::string> messages;
+    int failAfter = -1; // Publishes that succeed before every publish fails; -1 never fails
+};
+
+std::unique_ptr<BaseAppendFile> makeFile(const std::string& path) {
+    return std::unique_ptr<BaseAppendFile>(new QueueFile(path));
+}
+
+int appendsUntilFailure = -1; // Appends that succeed before every append of a FailingQueueFile fails; -1 never fails
+
+// A queue file that runs out of space when appendsUntilFailure says so
+class FailingQueueFile : public QueueFile {
+public:
+    using QueueFile::QueueFile;
+
+    size_t append(const uint8_t* data, size_t size) override {
+        if (appendsUntilFailure == 0) {
+            return 0;
+        }
+        if (appendsUntilFailure > 0) {
+            --appendsUntilFailure;
+        }
+        return QueueFile::append(data, size);
+    }
+};
+
+std::unique_ptr<BaseAppendFile> makeFailingFile(const std::string& path) {
+    return std::unique_ptr<BaseAppendFile>(new FailingQueueFile(path));
+}
+
+void removeQueueFiles() {
+    for (int i = 0; i < 2; ++i) {
+        makeFile(std::string(queuePrefix) + ".head" + std::to_string(i))->remove();
+    }
+    for (int segment = 0; segment < 256; ++segment) {
+        makeFile(std::string(queuePrefix) + "." + std::to_string(segment))->remove();
+    }
+}
+
+std::string message(int index) {
+    return "reading-" + std::to_string(index);
+}
+
+void setUp() {
+    appendsUntilFailure = -1;
+    removeQueueFiles();
+}
+
+void tearDown() {
+    removeQueueFiles();
+}
+
+void test_entries_drain_oldest_first() {
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    TEST_ASSERT_TRUE(queue.isEmpty());
+
+    TEST_ASSERT_TRUE(queue.enqueue("greenhouse/reading", "first"));
+    TEST_ASSERT_TRUE(queue.enqueue("greenhouse/battery", "3.70V"));
+    TEST_ASSERT_FALSE(queue.isEmpty());
+
+    FakePubSubClient client;
+    TEST_ASSERT_EQUAL(2, queue.drain(client));
+    TEST_ASSERT_EQUAL(2, client.messages.size());
+    TEST_ASSERT_EQUAL_STRING("greenhouse/reading=first", client.messages[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("greenhouse/battery=3.70V", client.messages[1].c_str());
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(0, queue.drain(client));
+}
+
+void test_failed_publish_keeps_remaining_entries() {
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    for (int i = 0; i < 5; ++i) {
+        TEST_ASSERT_TRUE(queue.enqueue("t", message(i).c_str()));
+    }
+
+    FakePubSubClient client;
+    client.failAfter = 2; // The connection drops during the drain
+    TEST_ASSERT_EQUAL(2, queue.drain(client));
+    TEST_ASSERT_FALSE(queue.isEmpty());
+
+    client.failAfter = -1;
+    TEST_ASSERT_EQUAL(3, queue.drain(client));
+    TEST_ASSERT_EQUAL(5, client.messages.size());
+    for (int i = 0; i < 5; ++i) {
+        TEST_ASSERT_TRUE(client.messages[i] == "t=" + message(i));
+    }
+}
+
+void test_queue_survives_reboots_without_loss() {
+    const int total = 400; // Spans several segments
+    int next = 0;
+    FakePubSubClient client;
+
+    // Each "boot" queues some entries, then drains part of the queue before the reset
+    for (int boot = 0; boot < 8; ++boot) {
+        OfflineQueue queue(queuePrefix, makeFile);
+        TEST_ASSERT_TRUE(queue.begin());
+        for (int i = 0; i < total / 8; ++i, ++next) {
+            TEST_ASSERT_TRUE(queue.enqueue("t", message(next).c_str()));
+        }
+        client.failAfter = 20 + boot * 3;
+        queue.drain(client);
+        client.failAfter = -1;
+    }
+
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    queue.drain(client);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(1, queue.getSegmentCount()); // Drained segments are deleted
+
+    TEST_ASSERT_EQUAL(total, client.messages.size());
+    for (int i = 0; i < total; ++i) {
+        TEST_ASSERT_TRUE(client.messages[i] == "t=" + message(i));
+    }
+}
+
+void test_reset_mid_batch_resends_instead_of_losing() {
+    {
+        OfflineQueue queue(queuePrefix, makeFile);
+        TEST_ASSERT_TRUE(queue.begin());
+        for (int i = 0; i < OFFLINE_QUEUE_DRAIN_BATCH * 2; ++i) {
+            TEST_ASSERT_TRUE(queue.enqueue("t", message(i).c_str()));
+        }
+    }
+
+    // Publishing stops part way into the second batch; the reset happens before the head
+    // is saved, so that partial batch is sent again after the reboot
+    FakePubSubClient client;
+    {
+        OfflineQueue queue(queuePrefix, makeFile);
+        TEST_ASSERT_TRUE(queue.begin());
+        client.failAfter = OFFLINE_QUEUE_DRAIN_BATCH + 2;
+        queue.drain(client);
+    }
+
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    client.failAfter = -1;
+    queue.drain(client);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+
+    // Nothing is lost, and the last sent entry is the last queued one
+    TEST_ASSERT_TRUE(client.messages.size() >= static_cast<size_t>(OFFLINE_QUEUE_DRAIN_BATCH * 2));
+    TEST_ASSERT_TRUE(client.messages.back() == "t=" + message(OFFLINE_QUEUE_DRAIN_BATCH * 2 - 1));
+}
+
+void test_full_queue_drops_oldest_segment() {
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    std::string payload(200, 'p');
+    int count = 0;
+    while (queue.getStats().droppedSegments == 0) {
+        TEST_ASSERT_TRUE(queue.enqueue("t", payload.c_str()));
+        ++count;
+    }
+    TEST_ASSERT_EQUAL(OFFLINE_QUEUE_MAX_SEGMENTS, queue.getSegmentCount());
+
+    std::string tooLarge(OfflineQueue::maxPayloadSize("t") + 1, 'x');
+    TEST_ASSERT_FALSE(queue.enqueue("t", tooLarge.c_str()));
+    TEST_ASSERT_EQUAL(1, queue.getStats().rejected);
+
+    FakePubSubClient client;
+    size_t drained = queue.drain(client);
+    TEST_ASSERT_TRUE(drained < static_cast<size_t>(count));
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+void test_full_size_batch_payload_round_trips() {
+    // As many readings as fit in one BATCH_PUBLISHER_PAYLOAD_SIZE payload
+    const char* topic = "temperature/greenhouse/reading";
+    BatchPublisher batch("esp32-temperature");
+    for (int i = 0; i < BATCH_PUBLISHER_MAX_READINGS; ++i) {
+        batch.add(topic, "dht", i % 2 ? "hum" : "temp", 21.25f + i, 1700000000000ULL + i * 1000);
+    }
+    uint8_t payload[BATCH_PUBLISHER_PAYLOAD_SIZE];
+    size_t position = 0;
+    size_t length = batch.encode(0, payload, sizeof(payload), position);
+    TEST_ASSERT_TRUE(length > BATCH_PUBLISHER_PAYLOAD_SIZE - 40);
+    TEST_ASSERT_TRUE(length <= OfflineQueue::maxPayloadSize(topic));
+
+    {
+        OfflineQueue queue(queuePrefix, makeFile);
+        TEST_ASSERT_TRUE(queue.begin());
+        TEST_ASSERT_TRUE(queue.enqueue(topic, "before"));
+        TEST_ASSERT_TRUE(queue.enqueue(topic, payload, length)); // Takes several journal frames
+        TEST_ASSERT_TRUE(queue.enqueue(topic, "after"));
+    }
+
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    FakePubSubClient client;
+    client.failAfter = 1; // The split entry is kept when its publish fails
+    TEST_ASSERT_EQUAL(1, queue.drain(client));
+    client.failAfter = -1;
+    TEST_ASSERT_EQUAL(2, queue.drain(client));
+    TEST_ASSERT_TRUE(queue.isEmpty());
+
+    TEST_ASSERT_EQUAL(3, client.messages.size());
+    TEST_ASSERT_TRUE(client.messages[1] == std::string(topic) + "=" + std::string(reinterpret_cast<const char*>(payload), length));
+    TEST_ASSERT_TRUE(client.messages[2] == std::string(topic) + "=after");
+}
+
+void test_split_entry_cut_short_is_skipped() {
+    std::string large(600, 'l');
+    {
+        OfflineQueue queue(queuePrefix, makeFile);
+        TEST_ASSERT_TRUE(queue.begin());
+        TEST_ASSERT_TRUE(queue.enqueue("t", large.c_str()));
+    }
+    {
+        // A reset after the first part of the next entry was written
+        QueueFile file(std::string(queuePrefix) + ".0");
+        AppendJournal journal(file);
+        TEST_ASSERT_TRUE(journal.begin());
+        const uint8_t part[] = {OfflineQueue::partFirst, 't', 0, 'c', 'u', 't'};
+        TEST_ASSERT_TRUE(journal.append(part, sizeof(part)));
+        journal.close();
+    }
+
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    TEST_ASSERT_TRUE(queue.enqueue("t", large.c_str()));
+    TEST_ASSERT_TRUE(queue.enqueue("t", "small"));
+
+    FakePubSubClient client;
+    TEST_ASSERT_EQUAL(3, queue.drain(client));
+    TEST_ASSERT_EQUAL(3, client.messages.size());
+    TEST_ASSERT_TRUE(client.messages[0] == "t=" + large);
+    TEST_ASSERT_TRUE(client.messages[1] == "t=" + large);
+    TEST_ASSERT_TRUE(client.messages[2] == "t=small");
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+void test_rejected_entries_are_never_published() {
+    OfflineQueue queue(queuePrefix, makeFailingFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    TEST_ASSERT_TRUE(queue.enqueue("t", "before"));
+
+    appendsUntilFailure = 0;
+    TEST_ASSERT_FALSE(queue.enqueue("t", "rejected"));
+    std::string large(AppendJournal::maxPayload * 2, 'x'); // Three parts
+    appendsUntilFailure = 1; // The first part is written, the second is not
+    TEST_ASSERT_FALSE(queue.enqueue("t", large.c_str()));
+    TEST_ASSERT_EQUAL(2, queue.getStats().rejected);
+
+    appendsUntilFailure = -1;
+    TEST_ASSERT_TRUE(queue.enqueue("t", "after"));
+    FakePubSubClient client;
+    TEST_ASSERT_EQUAL(2, queue.drain(client));
+    TEST_ASSERT_EQUAL(2, client.messages.size());
+    TEST_ASSERT_EQUAL_STRING("t=before", client.messages[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("t=after", client.messages[1].c_str());
+}
+
+#ifndef ARDUINO
+// Measures how fast a backlog of queued readings drains into a client that always accepts,
+// and the head pointer saves it costs.
+void test_drain_rate() {
+    const int entries = 600; // Fits in OFFLINE_QUEUE_MAX_SEGMENTS, so nothing is dropped
+    OfflineQueue queue(queuePrefix, makeFile);
+    TEST_ASSERT_TRUE(queue.begin());
+    for (int i = 0; i < entries; ++i) {
+        queue.enqueue("temperature/greenhouse/reading", ("[12:00:00] Temp: 21.50C, Humidity: 48.20% #" + std::to_string(i)).c_str());
+    }
+    uint32_t savesBefore = queue.getStats().headSaves;
+
+    FakePubSubClient client;
+    auto start = std::chrono::steady_clock::now();
+    size_t drained = queue.drain(client);
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start).count();
+
+    char report[160];
+    snprintf(report, sizeof(report), "drained=%lu entries/s=%.0f head saves=%lu segments dropped=%lu",
+             static_cast<unsigned long>(drained), drained / seconds,
+             static_cast<unsigned long>(queue.getStats().headSaves - savesBefore),
+             static_cast<unsigned long>(queue.getStats().droppedSegments));
+    TEST_MESSAGE(report);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(entries, drained);
+    TEST_ASSERT_EQUAL(drained, client.messages.size());
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_entries_drain_oldest_first);
+    RUN_TEST(test_failed_publish_keeps_remaining_entries);
+    RUN_TEST(test_queue_survives_reboots_without_loss);
+    RUN_TEST(test_reset_mid_batch_resends_instead_of_losing);
+    RUN_TEST(test_full_queue_drops_oldest_segment);
+    RUN_TEST(test_full_size_batch_payload_round_trips);
+    RUN_TEST(test_split_entry_cut_short_is_skipped);
+    RUN_TEST(test_rejected_entries_are_never_published);
+#ifndef ARDUINO
+    RUN_TEST(test_drain_rate);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    LittleFS.begin(true);
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
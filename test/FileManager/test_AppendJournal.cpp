@@ -0,0 +1,337 @@
+#include <unity.h>
+#include "AppendJournal.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "LittleFSAppendFile.h"
+using JournalFile = LittleFSAppendFile;
+const char* journalPath = "/test_journal.bin";
+#else
+#include <chrono>
+#include "HostAppendFile.h"
+using JournalFile = HostAppendFile;
+const char* journalPath = "/tmp/test_journal.bin";
+#endif
+
+uint32_t fakeNow = 0;
+
+// A file whose appends, or only its syncs after the data was appended, can be made to fail
+class FailingFile : public JournalFile {
+public:
+    using JournalFile::JournalFile;
+
+    size_t append(const uint8_t* data, size_t size) override {
+        return failAppend ? 0 : JournalFile::append(data, size);
+    }
+
+    bool sync() override {
+        return failSync ? false : JournalFile::sync();
+    }
+
+    bool failAppend = false;
+    bool failSync = false;
+};
+
+uint32_t fakeClock() {
+    return fakeNow;
+}
+
+AppendJournal::Config testConfig(size_t flushThreshold, uint32_t maxDelayMs) {
+    return AppendJournal::Config{flushThreshold, maxDelayMs, fakeClock};
+}
+
+void removeJournalFile() {
+#ifdef ARDUINO
+    LittleFS.remove(journalPath);
+#else
+    std::remove(journalPath);
+#endif
+}
+
+std::string replayAll(AppendJournal& journal) {
+    std::string content;
+    journal.replay([&content](const uint8_t* payload, size_t size) {
+        content.append(reinterpret_cast<const char*>(payload), size);
+    });
+    return content;
+}
+
+void setUp() {
+    fakeNow = 0;
+    removeJournalFile();
+}
+
+void tearDown() {
+    removeJournalFile();
+}
+
+void test_appends_replay_in_order_after_flush() {
+    JournalFile file(journalPath);
+    AppendJournal journal(file, testConfig(AppendJournal::maxPayload, 0));
+    TEST_ASSERT_TRUE(journal.begin());
+
+    TEST_ASSERT_TRUE(journal.append("first,"));
+    TEST_ASSERT_TRUE(journal.append("second,"));
+    TEST_ASSERT_EQUAL(13, journal.getBufferedBytes());
+    TEST_ASSERT_EQUAL(0, file.size()); // Nothing reaches the file before a flush
+
+    TEST_ASSERT_TRUE(journal.flush());
+    TEST_ASSERT_TRUE(journal.append("third"));
+    journal.close(); // Flushes the rest
+
+    JournalFile reopened(journalPath);
+    AppendJournal replayed(reopened);
+    TEST_ASSERT_TRUE(replayed.begin());
+    TEST_ASSERT_EQUAL_STRING("first,second,third", replayAll(replayed).c_str());
+    TEST_ASSERT_EQUAL(0, replayed.getStats().tornFrames);
+    TEST_ASSERT_EQUAL(2, journal.getStats().frames);
+}
+
+void test_size_threshold_flushes_one_frame() {
+    JournalFile file(journalPath);
+    AppendJournal journal(file, testConfig(32, 0));
+    TEST_ASSERT_TRUE(journal.begin());
+
+    for (int i = 0; i < 7; ++i) {
+        TEST_ASSERT_TRUE(journal.append("12345")); // 35 bytes: one 32 byte frame, 3 bytes buffered
+    }
+    TEST_ASSERT_EQUAL(1, journal.getStats().frames);
+    TEST_ASSERT_EQUAL(1, journal.getStats().sizeFlushes);
+    TEST_ASSERT_EQUAL(3, journal.getBufferedBytes());
+    TEST_ASSERT_EQUAL(32 + AppendJournal::frameOverhead, file.size());
+
+    // Data larger than a frame is split
+    std::string large(100, 'x');
+    TEST_ASSERT_TRUE(journal.append(large));
+    TEST_ASSERT_EQUAL(4, journal.getStats().frames);
+    TEST_ASSERT_TRUE(journal.flush());
+    TEST_ASSERT_EQUAL(35 + 100, replayAll(journal).size());
+}
+
+void test_delay_threshold_flushes_on_poll() {
+    JournalFile file(journalPath);
+    AppendJournal journal(file, testConfig(AppendJournal::maxPayload, 1000));
+    TEST_ASSERT_TRUE(journal.begin());
+
+    fakeNow = 5000;
+    TEST_ASSERT_TRUE(journal.append("sample"));
+    fakeNow = 5999;
+    TEST_ASSERT_TRUE(journal.poll());
+    TEST_ASSERT_EQUAL(0, journal.getStats().frames);
+
+    fakeNow = 6000; // The buffered sample is now 1000 ms old
+    TEST_ASSERT_TRUE(journal.poll());
+    TEST_ASSERT_EQUAL(1, journal.getStats().frames);
+    TEST_ASSERT_EQUAL(1, journal.getStats().timeFlushes);
+    TEST_ASSERT_EQUAL(0, journal.getBufferedBytes());
+
+    // append() also checks the delay, measured from the first buffered byte
+    fakeNow = 10000;
+    TEST_ASSERT_TRUE(journal.append("a"));
+    fakeNow = 11000;
+    TEST_ASSERT_TRUE(journal.append("b"));
+    TEST_ASSERT_EQUAL(2, journal.getStats().frames);
+    TEST_ASSERT_EQUAL_STRING("sampleab", replayAll(journal).c_str());
+}
+
+void test_torn_frame_is_skipped_on_replay() {
+    {
+        JournalFile file(journalPath);
+        AppendJournal journal(file, testConfig(AppendJournal::maxPayload, 0));
+        TEST_ASSERT_TRUE(journal.begin());
+        TEST_ASSERT_TRUE(journal.append("before,"));
+        TEST_ASSERT_TRUE(journal.flush());
+
+        // A reset halfway through a frame leaves its header and part of the payload behind
+        const uint8_t torn[] = {AppendJournal::frameMagic, 20, 0, 'l', 'o', 's', 't'};
+        file.append(torn, sizeof(torn));
+        file.sync();
+    }
+
+    // After the reset the journal is reopened and appends continue behind the torn frame
+    JournalFile file(journalPath);
+    AppendJournal journal(file, testConfig(AppendJournal::maxPayload, 0));
+    TEST_ASSERT_TRUE(journal.begin());
+    TEST_ASSERT_TRUE(journal.append("after"));
+    TEST_ASSERT_TRUE(journal.flush());
+
+    TEST_ASSERT_EQUAL_STRING("before,after", replayAll(journal).c_str());
+    TEST_ASSERT_TRUE(journal.getStats().tornFrames > 0);
+
+    // A frame with a bad CRC is skipped as well
+    const uint8_t corrupt[] = {AppendJournal::frameMagic, 1, 0, 'x', 0, 0, 0, 0, AppendJournal::commitMarker};
+    file.append(corrupt, sizeof(corrupt));
+    file.sync();
+    TEST_ASSERT_TRUE(journal.append("end"));
+    TEST_ASSERT_TRUE(journal.flush());
+    TEST_ASSERT_EQUAL_STRING("before,afterend", replayAll(journal).c_str());
+}
+
+void test_reader_opens_the_file_once() {
+    JournalFile file(journalPath);
+    AppendJournal journal(file, testConfig(8, 0));
+    TEST_ASSERT_TRUE(journal.begin());
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        TEST_ASSERT_TRUE(journal.append("frame-" + std::to_string(i) + ";")); // About one frame each
+        expected += "frame-" + std::to_string(i) + ";";
+    }
+    // A torn frame in the middle, then more frames
+    const uint8_t torn[] = {AppendJournal::frameMagic, 20, 0, 'l', 'o', 's', 't'};
+    TEST_ASSERT_TRUE(journal.flush());
+    file.append(torn, sizeof(torn));
+    TEST_ASSERT_TRUE(journal.append("last-frame")); // One frame and two buffered bytes
+    expected += "last-frame";
+    file.resetStats();
+
+    AppendJournal::Reader reader(journal);
+    std::string content;
+    uint8_t chunk[5];
+    size_t length;
+    while ((length = reader.read(chunk, sizeof(chunk))) > 0) {
+        content.append(reinterpret_cast<const char*>(chunk), length);
+    }
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), content.c_str());
+    TEST_ASSERT_EQUAL(1, file.getStats().readOpens);
+    TEST_ASSERT_EQUAL(1, journal.getStats().tornFrames); // Still counted after the later frames
+}
+
+void test_failed_sync_does_not_write_the_frame_twice() {
+    FailingFile file(journalPath);
+    AppendJournal journal(file, testConfig(AppendJournal::maxPayload, 0));
+    TEST_ASSERT_TRUE(journal.begin());
+    TEST_ASSERT_TRUE(journal.append("once"));
+
+    file.failSync = true;
+    TEST_ASSERT_TRUE(journal.flush()); // The frame is written, so a retry must not append it again
+    TEST_ASSERT_TRUE(journal.isSyncPending());
+    TEST_ASSERT_EQUAL(1, journal.getStats().syncFailures);
+    TEST_ASSERT_EQUAL(0, journal.getBufferedBytes());
+    TEST_ASSERT_TRUE(journal.flush());
+    TEST_ASSERT_TRUE(journal.isSyncPending());
+
+    file.failSync = false;
+    TEST_ASSERT_TRUE(journal.flush()); // Retries only the sync
+    TEST_ASSERT_FALSE(journal.isSyncPending());
+    TEST_ASSERT_EQUAL(1, journal.getStats().frames);
+    TEST_ASSERT_EQUAL_STRING("once", replayAll(journal).c_str());
+}
+
+void test_failed_append_is_not_written_later() {
+    FailingFile file(journalPath);
+    AppendJournal journal(file, testConfig(8, 0));
+    TEST_ASSERT_TRUE(journal.begin());
+    TEST_ASSERT_TRUE(journal.append("AB"));
+
+    file.failAppend = true;
+    TEST_ASSERT_FALSE(journal.append("CDEFGH")); // Fills the buffer, and its flush fails
+    TEST_ASSERT_EQUAL(2, journal.getBufferedBytes());
+    TEST_ASSERT_EQUAL(1, journal.getStats().appends);
+
+    file.failAppend = false;
+    TEST_ASSERT_TRUE(journal.append("CDEFGH")); // Appending again, as the contract allows
+    TEST_ASSERT_TRUE(journal.flush());
+    TEST_ASSERT_EQUAL_STRING("ABCDEFGH", replayAll(journal).c_str());
+
+    // A caller that gives up instead drops what it buffered
+    TEST_ASSERT_TRUE(journal.append("XY"));
+    journal.discard();
+    TEST_ASSERT_TRUE(journal.flush());
+    TEST_ASSERT_EQUAL_STRING("ABCDEFGH", replayAll(journal).c_str());
+}
+
+#ifndef ARDUINO
+// Compares the per-sample open/append/close pattern of saveToLittleFS against the journal
+// for the same samples, in host throughput and estimated flash page programs.
+void test_journal_versus_direct_appends() {
+    const int samples = 2000;
+    const char* directPath = "/tmp/test_journal_direct.txt";
+    std::remove(directPath);
+
+    std::vector<std::string> lines;
+    for (int i = 0; i < samples; ++i) {
+        char line[64];
+        snprintf(line, sizeof(line), "[%02d:%02d:%02d] Temp: %.2fC, Humidity: %.2f%%\n",
+                 (i / 3600) % 24, (i / 60) % 60, i % 60, 20.0 + (i % 50) / 10.0, 50.0 + (i % 30) / 10.0);
+        lines.push_back(line);
+    }
+
+    HostAppendFile direct(directPath);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& line : lines) {
+        direct.open();
+        direct.append(reinterpret_cast<const uint8_t*>(line.data()), line.size());
+        direct.close();
+    }
+    auto directTime = std::chrono::steady_clock::now() - start;
+
+    HostAppendFile journaled(journalPath);
+    AppendJournal journal(journaled, testConfig(AppendJournal::maxPayload, 0));
+    start = std::chrono::steady_clock::now();
+    journal.begin();
+    for (const auto& line : lines) {
+        journal.append(line);
+    }
+    journal.close();
+    auto journalTime = std::chrono::steady_clock::now() - start;
+
+    auto microseconds = [](std::chrono::steady_clock::duration elapsed) {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    };
+    char report[200];
+    snprintf(report, sizeof(report),
+             "writes/s direct=%.0f journal=%.0f | page writes direct=%lu journal=%lu | opens direct=%lu journal=%lu",
+             samples / (microseconds(directTime) / 1e6), samples / (microseconds(journalTime) / 1e6),
+             static_cast<unsigned long>(direct.getStats().pageWrites),
+             static_cast<unsigned long>(journaled.getStats().pageWrites),
+             static_cast<unsigned long>(direct.getStats().opens),
+             static_cast<unsigned long>(journaled.getStats().opens));
+    TEST_MESSAGE(report);
+
+    std::string expected;
+    for (const auto& line : lines) {
+        expected += line;
+    }
+    TEST_ASSERT_TRUE(replayAll(journal) == expected);
+    TEST_ASSERT_LESS_THAN(direct.getStats().pageWrites / 4, journaled.getStats().pageWrites);
+    std::remove(directPath);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_appends_replay_in_order_after_flush);
+    RUN_TEST(test_size_threshold_flushes_one_frame);
+    RUN_TEST(test_delay_threshold_flushes_on_poll);
+    RUN_TEST(test_torn_frame_is_skipped_on_replay);
+    RUN_TEST(test_reader_opens_the_file_once);
+    RUN_TEST(test_failed_sync_does_not_write_the_frame_twice);
+    RUN_TEST(test_failed_append_is_not_written_later);
+#ifndef ARDUINO
+    RUN_TEST(test_journal_versus_direct_appends);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    LittleFS.begin(true);
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,179 @@
+#include <unity.h>
+#include "BinaryLogFile.h"
+#include "FileSystemManager.h"
+#include <HalFS.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+const char* logPath = "/test_binlog.bin";
+BinaryLogEncoder::State logState;
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+    LittleFS.begin(true);
+    LittleFS.remove(logPath);
+    std::memset(&logState, 0, sizeof(logState));
+}
+
+void tearDown() {}
+
+// Appends reading n of a series whose every value follows from n
+bool appendReading(BinaryLogFile& log, int n) {
+    float values[] = {20.0f + n, 40.0f + 2 * n};
+    return log.appendReading(1700000000000ULL + n * 300000ULL, 0, values, 2);
+}
+
+// Decodes the file and checks it holds exactly the readings in expected, in order
+void assertFileHolds(const std::vector<int>& expected) {
+    File file = LittleFS.open(logPath, "r");
+    TEST_ASSERT_TRUE(static_cast<bool>(file));
+    std::vector<uint8_t> data(file.size());
+    TEST_ASSERT_EQUAL(data.size(), file.read(data.data(), data.size()));
+    file.close();
+
+    BinaryLogDecoder decoder(data.data(), data.size());
+    TEST_ASSERT_TRUE(decoder.isValid());
+    BinaryLogEntry entry;
+    size_t decoded = 0;
+    while (decoder.next(entry)) {
+        TEST_ASSERT_TRUE(decoded < expected.size());
+        int n = expected[decoded++];
+        TEST_ASSERT_EQUAL(1700000000000ULL + n * 300000ULL, entry.timestampMs);
+        TEST_ASSERT_FLOAT_WITHIN(0.006f, 20.0f + n, entry.values[0]);
+        TEST_ASSERT_FLOAT_WITHIN(0.006f, 40.0f + 2 * n, entry.values[1]);
+    }
+    TEST_ASSERT_FALSE(decoder.hasError());
+    TEST_ASSERT_EQUAL(expected.size(), decoded);
+}
+
+void test_readings_round_trip_through_the_file() {
+    BinaryLogFile log(logPath, logState);
+    TEST_ASSERT_TRUE(log.begin());
+    for (int n = 0; n < 3; ++n) {
+        TEST_ASSERT_TRUE(appendReading(log, n));
+    }
+    TEST_ASSERT_TRUE(log.getBufferedBytes() > 0);
+    TEST_ASSERT_TRUE(log.flush());
+    TEST_ASSERT_EQUAL(0, log.getBufferedBytes());
+    assertFileHolds({0, 1, 2});
+}
+
+void test_state_survives_deep_sleep_between_flushes() {
+    {
+        BinaryLogFile log(logPath, logState);
+        TEST_ASSERT_TRUE(log.begin());
+        TEST_ASSERT_TRUE(appendReading(log, 0));
+        TEST_ASSERT_TRUE(log.flush());
+    }
+    // A new wake: the writer is constructed again over the state kept in RTC memory
+    BinaryLogFile log(logPath, logState);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_TRUE(appendReading(log, 1));
+    TEST_ASSERT_TRUE(log.flush());
+    assertFileHolds({0, 1});
+}
+
+void test_file_system_manager_writes_binary_logs() {
+    FileSystemManager files([](const LogRecord&) {});
+    files.flushBufferToFile({"first", "second"}, logPath);
+    files.flushBufferToFile({"third"}, logPath); // Starts again from a sync record
+
+    File file = LittleFS.open(logPath, "r");
+    TEST_ASSERT_TRUE(static_cast<bool>(file));
+    std::vector<uint8_t> data(file.size());
+    TEST_ASSERT_EQUAL(data.size(), file.read(data.data(), data.size()));
+    file.close();
+
+    BinaryLogDecoder decoder(data.data(), data.size());
+    TEST_ASSERT_TRUE(decoder.isValid());
+    BinaryLogEntry entry;
+    std::vector<std::string> messages;
+    while (decoder.next(entry)) {
+        TEST_ASSERT_TRUE(entry.type == BinaryLogEntry::Type::Log);
+        messages.push_back(std::string(entry.message, entry.messageLength));
+    }
+    TEST_ASSERT_FALSE(decoder.hasError());
+    TEST_ASSERT_EQUAL(3, messages.size());
+    TEST_ASSERT_EQUAL_STRING("first", messages[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("second", messages[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("third", messages[2].c_str());
+}
+
+#ifndef ARDUINO
+void test_failed_flush_then_reset_keeps_the_file_decodable() {
+    {
+        BinaryLogFile log(logPath, logState);
+        TEST_ASSERT_TRUE(log.begin());
+        TEST_ASSERT_TRUE(appendReading(log, 0));
+        TEST_ASSERT_TRUE(log.flush());
+
+        // The file system fills up, so the next records never reach flash
+        TEST_ASSERT_TRUE(appendReading(log, 1));
+        TEST_ASSERT_TRUE(appendReading(log, 2));
+        LittleFS.setCapacity(LittleFS.usedBytes());
+        TEST_ASSERT_FALSE(log.flush());
+    }
+    // A watchdog reset: RTC memory keeps the state, the RAM buffer is gone
+    LittleFS.setCapacity(1536 * 1024);
+    BinaryLogFile log(logPath, logState);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_TRUE(appendReading(log, 3));
+    TEST_ASSERT_TRUE(appendReading(log, 4));
+    TEST_ASSERT_TRUE(log.flush());
+
+    // Readings 3 and 4 are deltas against reading 0, the last one the file has
+    assertFileHolds({0, 3, 4});
+}
+
+void test_failed_flush_keeps_records_for_the_next_one() {
+    BinaryLogFile log(logPath, logState);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_TRUE(appendReading(log, 0));
+    LittleFS.setCapacity(LittleFS.usedBytes());
+    TEST_ASSERT_FALSE(log.flush());
+    TEST_ASSERT_TRUE(log.getBufferedBytes() > 0);
+
+    LittleFS.setCapacity(1536 * 1024);
+    TEST_ASSERT_TRUE(appendReading(log, 1));
+    TEST_ASSERT_TRUE(log.flush());
+    assertFileHolds({0, 1});
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_readings_round_trip_through_the_file);
+    RUN_TEST(test_state_survives_deep_sleep_between_flushes);
+    RUN_TEST(test_file_system_manager_writes_binary_logs);
+#ifndef ARDUINO
+    RUN_TEST(test_failed_flush_then_reset_keeps_the_file_decodable);
+    RUN_TEST(test_failed_flush_keeps_records_for_the_next_one);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,254 @@
+#include <unity.h>
+#include "BinaryLogFormat.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <cstdlib>
+#endif
+
+BinaryLogEncoder::State encoderState;
+uint8_t buffer[512];
+size_t used;
+
+void setUp() {
+    std::memset(&encoderState, 0, sizeof(encoderState));
+    used = BinaryLogFormat::writeHeader(buffer);
+}
+
+void tearDown() {}
+
+void test_varint_and_zigzag_round_trip() {
+    const uint64_t values[] = {0, 1, 127, 128, 300, 1700000000000ULL, UINT64_MAX};
+    for (uint64_t value : values) {
+        uint8_t encoded[10];
+        size_t written = BinaryLogFormat::writeVarint(encoded, sizeof(encoded), value);
+        uint64_t decoded = 0;
+        TEST_ASSERT_EQUAL(written, BinaryLogFormat::readVarint(encoded, written, decoded));
+        TEST_ASSERT_TRUE(decoded == value);
+    }
+    TEST_ASSERT_EQUAL(0, BinaryLogFormat::writeVarint(buffer, 1, 300)); // Does not fit
+
+    const int64_t signedValues[] = {0, -1, 1, -250, 250, INT32_MIN};
+    for (int64_t value : signedValues) {
+        TEST_ASSERT_TRUE(BinaryLogFormat::zigzagDecode(BinaryLogFormat::zigzagEncode(value)) == value);
+    }
+}
+
+void test_log_and_reading_round_trip() {
+    BinaryLogEncoder encoder(encoderState);
+    const char* message = "Failed to open file for reading: /logs/data.txt";
+    float first[] = {21.5f, 40.25f};
+    float second[] = {21.75f, 39.5f};
+
+    used += encoder.encodeLog(buffer + used, sizeof(buffer) - used, 1700000000000ULL, LogLevel::ERROR, 3, message, std::strlen(message));
+    used += encoder.encodeReading(buffer + used, sizeof(buffer) - used, 1700000000500ULL, 1, first, 2);
+    used += encoder.encodeReading(buffer + used, sizeof(buffer) - used, 1700000300500ULL, 1, second, 2);
+
+    BinaryLogDecoder decoder(buffer, used);
+    BinaryLogEntry entry;
+    TEST_ASSERT_TRUE(decoder.isValid());
+
+    TEST_ASSERT_TRUE(decoder.next(entry));
+    TEST_ASSERT_TRUE(entry.type == BinaryLogEntry::Type::Log);
+    TEST_ASSERT_TRUE(entry.level == LogLevel::ERROR);
+    TEST_ASSERT_EQUAL(3, entry.sourceId);
+    TEST_ASSERT_TRUE(entry.timestampMs == 1700000000000ULL);
+    TEST_ASSERT_EQUAL(std::strlen(message), entry.messageLength);
+    TEST_ASSERT_EQUAL_MEMORY(message, entry.message, entry.messageLength);
+
+    TEST_ASSERT_TRUE(decoder.next(entry));
+    TEST_ASSERT_TRUE(entry.type == BinaryLogEntry::Type::Reading);
+    TEST_ASSERT_EQUAL(1, entry.sensorId);
+    TEST_ASSERT_EQUAL(2, entry.valueCount);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 21.5, entry.values[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 40.25, entry.values[1]);
+
+    TEST_ASSERT_TRUE(decoder.next(entry));
+    TEST_ASSERT_TRUE(entry.timestampMs == 1700000300500ULL);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 21.75, entry.values[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 39.5, entry.values[1]);
+
+    TEST_ASSERT_FALSE(decoder.next(entry));
+    TEST_ASSERT_FALSE(decoder.hasError());
+}
+
+void test_sync_written_after_reset_and_clock_jump() {
+    BinaryLogEncoder encoder(encoderState);
+    float value[] = {20.0f};
+
+    size_t first = encoder.encodeReading(buffer + used, sizeof(buffer) - used, 5000, 0, value, 1);
+    TEST_ASSERT_EQUAL(BinaryLogFormat::tagSync, buffer[used]);
+    used += first;
+
+    size_t second = encoder.encodeReading(buffer + used, sizeof(buffer) - used, 6000, 0, value, 1);
+    TEST_ASSERT_EQUAL(BinaryLogFormat::tagReading | 1, buffer[used]); // Delta only
+    used += second;
+
+    size_t backwards = encoder.encodeReading(buffer + used, sizeof(buffer) - used, 1000, 0, value, 1);
+    TEST_ASSERT_EQUAL(BinaryLogFormat::tagSync, buffer[used]);
+    used += backwards;
+
+    BinaryLogDecoder decoder(buffer, used);
+    BinaryLogEntry entry;
+    uint64_t expected[] = {5000, 6000, 1000};
+    for (uint64_t timestamp : expected) {
+        TEST_ASSERT_TRUE(decoder.next(entry));
+        TEST_ASSERT_TRUE(entry.timestampMs == timestamp);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, 20.0, entry.values[0]);
+    }
+}
+
+void test_encoder_rejects_invalid_readings_and_small_buffers() {
+    BinaryLogEncoder encoder(encoderState);
+    float invalid[] = {NAN};
+    float valid[] = {1.0f};
+
+    TEST_ASSERT_EQUAL(0, encoder.encodeReading(buffer, sizeof(buffer), 0, 0, invalid, 1));
+    TEST_ASSERT_EQUAL(0, encoder.encodeReading(buffer, sizeof(buffer), 0, BINARY_LOG_MAX_SENSORS, valid, 1));
+    TEST_ASSERT_EQUAL(0, encoder.encodeReading(buffer, 2, 1700000000000ULL, 0, valid, 1));
+    TEST_ASSERT_FALSE(encoderState.synced); // A failed encode leaves the state untouched
+}
+
+void test_decoder_stops_on_truncated_record() {
+    BinaryLogEncoder encoder(encoderState);
+    const char* message = "truncated message";
+    used += encoder.encodeLog(buffer + used, sizeof(buffer) - used, 10, LogLevel::INFO, 0, message, std::strlen(message));
+
+    BinaryLogDecoder decoder(buffer, used - 4);
+    BinaryLogEntry entry;
+    TEST_ASSERT_FALSE(decoder.next(entry));
+    TEST_ASSERT_TRUE(decoder.hasError());
+}
+
+#ifndef ARDUINO
+// Compares bytes per record and host append time of the text sample format written by
+// saveToLittleFS against binary readings, both with the encoder state kept across wakes
+// (RTC memory) and reset every wake (cold boot).
+void test_binary_versus_text_size_and_write_time() {
+    const int samples = 2000;
+    std::vector<float> temperatures(samples);
+    std::vector<float> humidities(samples);
+    float temperature = 18.0f;
+    float humidity = 55.0f;
+    srand(42);
+    for (int i = 0; i < samples; ++i) {
+        temperature += (rand() % 21 - 10) / 100.0f;
+        humidity += (rand() % 41 - 20) / 100.0f;
+        temperatures[i] = temperature;
+        humidities[i] = humidity;
+    }
+
+    const char* textPath = "/tmp/test_binary_log_text.txt";
+    const char* binaryPath = "/tmp/test_binary_log_data.bin";
+    std::remove(textPath);
+    std::remove(binaryPath);
+
+    size_t textBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+        int seconds = i * 300;
+        char line[80];
+        int length = snprintf(line, sizeof(line), "[%02d:%02d:%02d] Temp: %.2fC, Humidity: %.2f%%\n",
+                              (seconds / 3600) % 24, (seconds / 60) % 60, seconds % 60, temperatures[i], humidities[i]);
+        FILE* file = fopen(textPath, "a"); // One open/append/close per sample, like saveToLittleFS
+        fwrite(line, 1, length, file);
+        fclose(file);
+        textBytes += length;
+    }
+    auto textTime = std::chrono::steady_clock::now() - start;
+
+    BinaryLogEncoder::State rtcState;
+    std::memset(&rtcState, 0, sizeof(rtcState));
+    size_t binaryBytes = BinaryLogFormat::headerSize;
+    FILE* header = fopen(binaryPath, "w");
+    fwrite(buffer, 1, BinaryLogFormat::headerSize, header);
+    fclose(header);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+        BinaryLogEncoder encoder(rtcState);
+        float values[] = {temperatures[i], humidities[i]};
+        uint8_t record[32];
+        size_t length = encoder.encodeReading(record, sizeof(record), 1700000000000ULL + i * 300000ULL, 0, values, 2);
+        FILE* file = fopen(binaryPath, "a");
+        fwrite(record, 1, length, file);
+        fclose(file);
+        binaryBytes += length;
+    }
+    auto binaryTime = std::chrono::steady_clock::now() - start;
+
+    BinaryLogEncoder::State coldState;
+    size_t coldBytes = 0;
+    for (int i = 0; i < samples; ++i) {
+        std::memset(&coldState, 0, sizeof(coldState));
+        BinaryLogEncoder encoder(coldState);
+        float values[] = {temperatures[i], humidities[i]};
+        uint8_t record[32];
+        coldBytes += encoder.encodeReading(record, sizeof(record), 1700000000000ULL + i * 300000ULL, 0, values, 2);
+    }
+
+    auto microseconds = [](std::chrono::steady_clock::duration elapsed) {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    };
+    char report[200];
+    snprintf(report, sizeof(report),
+             "bytes/record text=%.1f binary=%.1f binary-cold=%.1f | append us/record text=%.2f binary=%.2f",
+             static_cast<double>(textBytes) / samples, static_cast<double>(binaryBytes) / samples,
+             static_cast<double>(coldBytes) / samples,
+             microseconds(textTime) / samples, microseconds(binaryTime) / samples);
+    TEST_MESSAGE(report);
+
+    // The file decodes back to the same samples
+    FILE* file = fopen(binaryPath, "rb");
+    std::vector<uint8_t> data(binaryBytes);
+    TEST_ASSERT_EQUAL(binaryBytes, fread(data.data(), 1, data.size(), file));
+    fclose(file);
+    BinaryLogDecoder decoder(data.data(), data.size());
+    BinaryLogEntry entry;
+    int decoded = 0;
+    while (decoder.next(entry)) {
+        TEST_ASSERT_FLOAT_WITHIN(0.006, temperatures[decoded], entry.values[0]);
+        TEST_ASSERT_FLOAT_WITHIN(0.006, humidities[decoded], entry.values[1]);
+        ++decoded;
+    }
+    TEST_ASSERT_EQUAL(samples, decoded);
+    TEST_ASSERT_LESS_THAN(textBytes / 4, binaryBytes);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_varint_and_zigzag_round_trip);
+    RUN_TEST(test_log_and_reading_round_trip);
+    RUN_TEST(test_sync_written_after_reset_and_clock_jump);
+    RUN_TEST(test_encoder_rejects_invalid_readings_and_small_buffers);
+    RUN_TEST(test_decoder_stops_on_truncated_record);
+#ifndef ARDUINO
+    RUN_TEST(test_binary_versus_text_size_and_write_time);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
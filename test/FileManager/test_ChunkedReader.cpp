@@ -0,0 +1,185 @@
+#include <unity.h>
+#include "ChunkedReader.h"
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+// Hands out at most `step` bytes per read, to cross chunk boundaries at awkward places
+class TrickleSource {
+public:
+    TrickleSource(const std::string& data, size_t step) : source(data.data(), data.size()), step(step) {}
+
+    size_t read(uint8_t* buffer, size_t size) {
+        return source.read(buffer, size < step ? size : step);
+    }
+
+private:
+    ChunkedReader::BufferSource source;
+    size_t step;
+};
+
+std::vector<std::string> collectLines(const std::string& text, size_t step) {
+    TrickleSource source(text, step);
+    LineReader<TrickleSource, 16> lines(source);
+    std::vector<std::string> result;
+    std::string_view line;
+    while (lines.next(line)) {
+        result.emplace_back(line);
+    }
+    return result;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_read_all_appends_every_chunk() {
+    std::string text(FILE_READ_CHUNK_SIZE * 3 + 17, 'a');
+    ChunkedReader::BufferSource source(text.data(), text.size());
+    std::string out = "prefix";
+    TEST_ASSERT_EQUAL(text.size(), ChunkedReader::readAll(source, out, text.size()));
+    TEST_ASSERT_TRUE(out == "prefix" + text);
+}
+
+void test_line_reader_splits_lines_across_reads() {
+    const std::string text = "one\ntwo\r\n\nthree-is-longer\nlast";
+    const size_t steps[] = {1, 3, 7, 64};
+    for (size_t step : steps) {
+        std::vector<std::string> lines = collectLines(text, step);
+        TEST_ASSERT_EQUAL(5, lines.size());
+        TEST_ASSERT_EQUAL_STRING("one", lines[0].c_str());
+        TEST_ASSERT_EQUAL_STRING("two", lines[1].c_str());
+        TEST_ASSERT_EQUAL_STRING("", lines[2].c_str());
+        TEST_ASSERT_EQUAL_STRING("three-is-longer", lines[3].c_str());
+        TEST_ASSERT_EQUAL_STRING("last", lines[4].c_str());
+    }
+    TEST_ASSERT_EQUAL(0, collectLines("", 4).size());
+    TEST_ASSERT_EQUAL(1, collectLines("only\n", 4).size());
+}
+
+void test_line_reader_splits_lines_longer_than_buffer() {
+    std::string text = std::string(40, 'x') + "\nshort\n";
+    TrickleSource source(text, 5);
+    LineReader<TrickleSource, 16> lines(source);
+    std::string_view line;
+    std::string joined;
+    int count = 0;
+    while (lines.next(line)) {
+        if (line.size() == 16 || count >= 2) {
+            joined.append(line.data(), line.size());
+        }
+        ++count;
+    }
+    TEST_ASSERT_EQUAL(2, lines.getSplitLines()); // 40 bytes: two full pieces, then the remaining 8
+    TEST_ASSERT_EQUAL(4, count);
+    TEST_ASSERT_TRUE(joined == std::string(40, 'x') + "short");
+}
+
+#ifndef ARDUINO
+struct StdioSource {
+    FILE* file;
+    size_t read(uint8_t* buffer, size_t size) { return fread(buffer, 1, size, file); }
+};
+
+// Reads a ~400 KB log file per byte (the old FileSystem::read loop), in chunks with a
+// size() reserve, and line by line with LineReader, and reports the throughput of each.
+void test_chunked_versus_per_byte_read_throughput() {
+    const char* path = "/tmp/test_chunked_reader.log";
+    FILE* out = fopen(path, "w");
+    size_t fileSize = 0;
+    size_t expectedLines = 10000;
+    for (size_t i = 0; i < expectedLines; ++i) {
+        fileSize += fprintf(out, "[%02u:%02u:%02u] Temp: %.2fC, Humidity: %.2f%%\n",
+                            static_cast<unsigned>(i / 3600 % 24), static_cast<unsigned>(i / 60 % 60),
+                            static_cast<unsigned>(i % 60), 20.0 + i % 50 / 10.0, 50.0 + i % 30 / 10.0);
+    }
+    fclose(out);
+
+    const int rounds = 5;
+    auto seconds = [](std::chrono::steady_clock::duration elapsed) {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        FILE* file = fopen(path, "rb");
+        std::string content;
+        int c;
+        while ((c = fgetc(file)) != EOF) {
+            content += static_cast<char>(c);
+        }
+        fclose(file);
+        TEST_ASSERT_EQUAL(fileSize, content.size());
+    }
+    double perByte = seconds(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        StdioSource source{fopen(path, "rb")};
+        std::string content;
+        ChunkedReader::readAll(source, content, fileSize);
+        fclose(source.file);
+        TEST_ASSERT_EQUAL(fileSize, content.size());
+    }
+    double chunked = seconds(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        StdioSource source{fopen(path, "rb")};
+        LineReader<StdioSource> lines(source);
+        std::string_view line;
+        size_t count = 0;
+        size_t bytes = 0;
+        while (lines.next(line)) {
+            ++count;
+            bytes += line.size() + 1;
+        }
+        fclose(source.file);
+        TEST_ASSERT_EQUAL(expectedLines, count);
+        TEST_ASSERT_EQUAL(fileSize, bytes);
+    }
+    double lineReader = seconds(std::chrono::steady_clock::now() - start);
+
+    double megabytes = static_cast<double>(fileSize) * rounds / (1024.0 * 1024.0);
+    char report[160];
+    snprintf(report, sizeof(report), "file=%lu bytes | MB/s per-byte=%.1f chunked=%.1f lines=%.1f",
+             static_cast<unsigned long>(fileSize), megabytes / perByte, megabytes / chunked, megabytes / lineReader);
+    TEST_MESSAGE(report);
+    std::remove(path);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_all_appends_every_chunk);
+    RUN_TEST(test_line_reader_splits_lines_across_reads);
+    RUN_TEST(test_line_reader_splits_lines_longer_than_buffer);
+#ifndef ARDUINO
+    RUN_TEST(test_chunked_versus_per_byte_read_throughput);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
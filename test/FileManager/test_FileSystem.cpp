@@ -0,0 +1,140 @@
+#include <unity.h>
+#include "FileSystem.h"
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+const char* textPath = "/logs/test_fs.txt";
+const char* journalPath = "/logs/test_fs_journal.txt";
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::setConsoleEnabled(false); // FileSystem reports every mount step
+#endif
+    LittleFS.remove(textPath);
+    LittleFS.remove(journalPath);
+}
+
+void tearDown() {
+    LittleFS.remove(textPath);
+    LittleFS.remove(journalPath);
+}
+
+void test_first_mount_creates_log_files() {
+    FileSystem fs;
+    TEST_ASSERT_TRUE(fs.exists("/logs/data.txt"));
+    TEST_ASSERT_TRUE(fs.exists("/logs/error.txt"));
+    TEST_ASSERT_TRUE(fs.exists("/logs/info.txt"));
+}
+
+void test_write_append_and_read() {
+    FileSystem fs;
+    TEST_ASSERT_TRUE(fs.write(textPath, "first\n"));
+    TEST_ASSERT_TRUE(fs.write(textPath, "second\n"));
+    TEST_ASSERT_EQUAL_STRING("first\nsecond\n", fs.read(textPath).c_str());
+
+    uint8_t part[6];
+    TEST_ASSERT_EQUAL(6, fs.read(textPath, part, sizeof(part), 6));
+    TEST_ASSERT_EQUAL_MEMORY("second", part, sizeof(part));
+
+    TEST_ASSERT_TRUE(fs.write(true, textPath, "only"));
+    TEST_ASSERT_EQUAL_STRING("only", fs.read(textPath).c_str());
+    TEST_ASSERT_TRUE(fs.remove(textPath));
+    TEST_ASSERT_FALSE(fs.exists(textPath));
+}
+
+void test_journaled_path_reads_back_lines() {
+    FileSystem fs;
+    TEST_ASSERT_TRUE(fs.openJournal(journalPath));
+    fs.write(journalPath, "a,1\n");
+    fs.write(journalPath, "b,2\n");
+    TEST_ASSERT_TRUE(fs.flushJournals());
+
+    std::vector<std::string> lines;
+    size_t count = fs.readLines(journalPath, [&lines](std::string_view line) {
+        lines.emplace_back(line);
+    });
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL_STRING("a,1", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("b,2", lines[1].c_str());
+    fs.closeJournals();
+}
+
+void test_journaled_path_reads_unflushed_appends() {
+    FileSystem fs;
+    TEST_ASSERT_TRUE(fs.openJournal(journalPath));
+    fs.write(journalPath, "a,1\n");
+    TEST_ASSERT_TRUE(fs.flushJournals());
+    fs.write(journalPath, "b,2\n"); // Still in the journal's RAM buffer
+
+    std::vector<std::string> lines;
+    size_t count = fs.readLines(journalPath, [&lines](std::string_view line) {
+        lines.emplace_back(line);
+    });
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL_STRING("b,2", lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("a,1\nb,2\n", fs.read(journalPath).c_str());
+
+    // Offsets count data bytes, so a read can span the flushed frame and the buffer
+    uint8_t part[5];
+    TEST_ASSERT_EQUAL(5, fs.read(journalPath, part, sizeof(part), 2));
+    TEST_ASSERT_EQUAL_MEMORY("1\nb,2", part, sizeof(part));
+    TEST_ASSERT_EQUAL(2, fs.read(journalPath, part, sizeof(part), 6));
+    TEST_ASSERT_EQUAL_MEMORY("2\n", part, 2);
+    TEST_ASSERT_EQUAL(0, fs.read(journalPath, part, sizeof(part), 20));
+    fs.closeJournals();
+}
+
+void test_journaled_lines_span_frames() {
+    FileSystem fs;
+    AppendJournal::Config config = AppendJournal::defaultConfig();
+    config.flushThreshold = 16; // Lines end up split across small frames
+    config.maxDelayMs = 0;
+    TEST_ASSERT_TRUE(fs.openJournal(journalPath, config));
+    std::string expected;
+    for (int i = 0; i < 20; ++i) {
+        std::string line = "reading " + std::to_string(i) + "\n";
+        fs.write(journalPath, line);
+        expected += line;
+    }
+
+    size_t count = 0;
+    fs.readLines(journalPath, [&count](std::string_view line) {
+        TEST_ASSERT_EQUAL_STRING(("reading " + std::to_string(count++)).c_str(), std::string(line).c_str());
+    });
+    TEST_ASSERT_EQUAL(20, count);
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), fs.read(journalPath).c_str());
+    fs.closeJournals();
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_mount_creates_log_files);
+    RUN_TEST(test_write_append_and_read);
+    RUN_TEST(test_journaled_path_reads_back_lines);
+    RUN_TEST(test_journaled_path_reads_unflushed_appends);
+    RUN_TEST(test_journaled_lines_span_frames);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
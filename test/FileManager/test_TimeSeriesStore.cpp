@@ -0,0 +1,386 @@
+#include <unity.h>
+#include "TimeSeriesStore.h"
+#include <Hal.h>
+#include <HalFS.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#include <BinaryLogFile.h>
+#include <chrono>
+const char* imagePath = "/tmp/test_series_fs.img";
+#endif
+
+using Tier = TimeSeriesStore::Tier;
+
+HAL_RTC_DATA TimeSeriesStore::State testState;
+
+const uint32_t dayStart = 1790208000; // 2026-09-24 00:00 UTC
+const char* seriesDirectory = "/test_series";
+
+TimeSeriesStore::Config testConfig() {
+    TimeSeriesStore::Config config = TimeSeriesStore::defaultConfig();
+    config.directory = seriesDirectory;
+    return config;
+}
+
+void removeSegments() {
+    const char prefixes[] = {'r', 'm', 'h', 'd'};
+    for (char prefix : prefixes) {
+        for (int slot = 0; slot < 8; ++slot) {
+            char path[32];
+            snprintf(path, sizeof(path), "%s/%c%d", seriesDirectory, prefix, slot);
+            LittleFS.remove(path);
+        }
+    }
+}
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+    std::memset(&testState, 0, sizeof(testState));
+    LittleFS.begin(true);
+    removeSegments();
+}
+
+void tearDown() {
+    removeSegments();
+}
+
+// The greenhouse over a day: temperature and humidity in opposite phase, the battery draining
+float temperatureAt(uint32_t time) {
+    return 18.0f + 6.0f * std::sin((time % 86400) * 6.2831853f / 86400);
+}
+
+float humidityAt(uint32_t time) {
+    return 60.0f - 15.0f * std::sin((time % 86400) * 6.2831853f / 86400);
+}
+
+float batteryAt(uint32_t time) {
+    return 100.0f - (time - dayStart) / 86400.0f;
+}
+
+// One wake's readings, as the sensor task takes them every 5 minutes
+void appendWake(TimeSeriesStore& series, uint32_t time) {
+    series.append(time, 0, 0, temperatureAt(time));
+    series.append(time, 0, 1, humidityAt(time));
+    series.append(time, 1, 0, batteryAt(time));
+}
+
+void test_rollups_close_with_their_period() {
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    TEST_ASSERT_TRUE(series.append(dayStart + 5, 0, 0, 10.0f));
+    TEST_ASSERT_TRUE(series.append(dayStart + 25, 0, 0, 30.0f));
+    TEST_ASSERT_TRUE(series.append(dayStart + 45, 0, 0, 20.0f));
+    TEST_ASSERT_TRUE(series.append(dayStart + 65, 0, 0, 40.0f)); // Closes the first minute
+    TEST_ASSERT_FALSE(series.append(dayStart + 70, 0, 0, NAN));
+
+    TimeSeriesStore::Rollup minute = {};
+    TEST_ASSERT_EQUAL(1, series.query(Tier::Minute, 0, 0, 0, UINT32_MAX, [&minute](const TimeSeriesStore::Rollup& rollup) {
+        minute = rollup;
+    }));
+    TEST_ASSERT_EQUAL(dayStart, minute.periodStart);
+    TEST_ASSERT_EQUAL(3, minute.count);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, minute.min);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, minute.max);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, minute.mean);
+
+    TimeSeriesStore::Rollup open;
+    TEST_ASSERT_TRUE(series.getOpen(Tier::Minute, 0, 0, open));
+    TEST_ASSERT_EQUAL(dayStart + 60, open.periodStart);
+    TEST_ASSERT_EQUAL(1, open.count);
+    TEST_ASSERT_TRUE(series.getOpen(Tier::Hour, 0, 0, open));
+    TEST_ASSERT_EQUAL(4, open.count);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, open.mean);
+    TEST_ASSERT_EQUAL(0, series.query(Tier::Hour, 0, 0, 0, UINT32_MAX, [](const TimeSeriesStore::Rollup&) {}));
+}
+
+void test_unsynced_wake_does_not_hold_the_clock() {
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    appendWake(series, dayStart);
+
+    // NTPClient before its first update: the -7 h offset plus 20 s of uptime, wrapped
+    uint32_t unsetClock = static_cast<uint32_t>(-7 * 3600) + 20;
+    TEST_ASSERT_FALSE(series.append(unsetClock, 0, 0, 21.0f));
+    TEST_ASSERT_EQUAL(1, series.getStats().rejectedTimes);
+
+    // The hour still closes once the real clock passes it
+    appendWake(series, dayStart + 1800);
+    appendWake(series, dayStart + 3600);
+    TimeSeriesStore::Rollup hour = {};
+    TEST_ASSERT_EQUAL(1, series.query(Tier::Hour, 0, 0, 0, UINT32_MAX, [&hour](const TimeSeriesStore::Rollup& rollup) {
+        hour = rollup;
+    }));
+    TEST_ASSERT_EQUAL(dayStart, hour.periodStart);
+    TEST_ASSERT_EQUAL(2, hour.count);
+}
+
+void test_channels_roll_up_apart() {
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    for (uint32_t time = dayStart; time < dayStart + 2 * 3600; time += 300) {
+        appendWake(series, time);
+    }
+    appendWake(series, dayStart + 2 * 3600);
+
+    int hours = 0;
+    series.query(Tier::Hour, 0, 1, dayStart, dayStart + 3600, [&hours](const TimeSeriesStore::Rollup& rollup) {
+        TEST_ASSERT_EQUAL(12, rollup.count);
+        TEST_ASSERT_TRUE(rollup.min > 40.0f && rollup.max < 61.0f); // Humidity, not temperature
+        hours++;
+    });
+    TEST_ASSERT_EQUAL(2, hours);
+
+    size_t raw = series.queryRaw(1, 0, dayStart, dayStart + 3599, [](const TimeSeriesStore::Sample& sample) {
+        TEST_ASSERT_EQUAL_FLOAT(batteryAt(sample.time), sample.value);
+    });
+    TEST_ASSERT_EQUAL(12, raw);
+}
+
+void test_history_stays_within_its_segments() {
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    const uint32_t wakes = 30 * 288; // 30 days
+    for (uint32_t i = 0; i < wakes; ++i) {
+        appendWake(series, dayStart + i * 300);
+    }
+    TEST_ASSERT_TRUE(series.flush());
+
+    // The raw tier holds its last few segments' worth, the day tier all 29 closed days
+    uint32_t oldest = UINT32_MAX;
+    size_t raw = series.queryRaw(0, 0, 0, UINT32_MAX, [&oldest](const TimeSeriesStore::Sample& sample) {
+        oldest = sample.time < oldest ? sample.time : oldest;
+    });
+    size_t rawCapacity = series.getCapacity(Tier::Raw);
+    TEST_ASSERT_TRUE(raw * 3 <= rawCapacity && raw * 3 > rawCapacity - rawCapacity / 4);
+    TEST_ASSERT_EQUAL(dayStart + (wakes - raw) * 300, oldest);
+    TEST_ASSERT_EQUAL(29, series.query(Tier::Day, 0, 0, 0, UINT32_MAX, [](const TimeSeriesStore::Rollup& day) {
+        TEST_ASSERT_EQUAL(288, day.count);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.0f, day.min);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 24.0f, day.max);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 18.0f, day.mean);
+    }));
+    TEST_ASSERT_TRUE(series.getStats().segmentsReused > 0);
+    TEST_ASSERT_TRUE(LittleFS.usedBytes() <= 24 * TIME_SERIES_SEGMENT_SIZE);
+}
+
+void test_query_returns_the_range_only() {
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    for (uint32_t time = dayStart; time < dayStart + 3 * 86400; time += 300) {
+        appendWake(series, time);
+    }
+
+    uint32_t expected = dayStart + 86400;
+    size_t hours = series.query(Tier::Hour, 0, 0, dayStart + 86400, dayStart + 2 * 86400 - 1, [&expected](const TimeSeriesStore::Rollup& hour) {
+        TEST_ASSERT_EQUAL(expected, hour.periodStart);
+        TEST_ASSERT_EQUAL(12, hour.count);
+        expected += 3600;
+    });
+    TEST_ASSERT_EQUAL(24, hours);
+}
+
+#ifndef ARDUINO
+void test_state_survives_deep_sleep() {
+    {
+        TimeSeriesStore series(testState, testConfig());
+        TEST_ASSERT_TRUE(series.begin());
+        appendWake(series, dayStart);
+    }
+    Hal::Sim::deepSleep(300ULL * 1000 * 1000);
+
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    TEST_ASSERT_FALSE(series.wasRebuilt());
+    appendWake(series, dayStart + 300);
+    TimeSeriesStore::Rollup hour;
+    TEST_ASSERT_TRUE(series.getOpen(Tier::Hour, 0, 0, hour));
+    TEST_ASSERT_EQUAL(2, hour.count);
+    TEST_ASSERT_EQUAL(2, series.queryRaw(0, 0, 0, UINT32_MAX, [](const TimeSeriesStore::Sample&) {}));
+    TEST_ASSERT_EQUAL(0, series.getStats().fileWrites); // Still in RTC memory
+}
+
+void test_rebuilds_after_power_loss() {
+    TimeSeriesStore::Rollup before;
+    {
+        TimeSeriesStore series(testState, testConfig());
+        TEST_ASSERT_TRUE(series.begin());
+        for (uint32_t time = dayStart; time < dayStart + 10 * 3600 + 1800; time += 300) {
+            appendWake(series, time);
+        }
+        TEST_ASSERT_TRUE(series.flush());
+        TEST_ASSERT_TRUE(series.getOpen(Tier::Day, 0, 0, before));
+        TEST_ASSERT_TRUE(LittleFS.saveImage(imagePath));
+    }
+
+    Hal::Sim::powerCycle();
+    LittleFS.format();
+    TEST_ASSERT_TRUE(LittleFS.loadImage(imagePath));
+    std::remove(imagePath);
+
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    TEST_ASSERT_TRUE(series.wasRebuilt());
+    TimeSeriesStore::Rollup after;
+    TEST_ASSERT_TRUE(series.getOpen(Tier::Day, 0, 0, after));
+    TEST_ASSERT_EQUAL(before.count, after.count);
+    TEST_ASSERT_EQUAL_FLOAT(before.mean, after.mean);
+    TEST_ASSERT_TRUE(series.getOpen(Tier::Hour, 0, 0, after));
+    TEST_ASSERT_EQUAL(dayStart + 10 * 3600, after.periodStart);
+    TEST_ASSERT_EQUAL(6, after.count);
+
+    // The hour goes on where it stopped and is stored once
+    for (uint32_t time = dayStart + 10 * 3600 + 1800; time <= dayStart + 11 * 3600; time += 300) {
+        appendWake(series, time);
+    }
+    size_t stored = series.query(Tier::Hour, 0, 0, dayStart + 10 * 3600, dayStart + 10 * 3600, [](const TimeSeriesStore::Rollup& hour) {
+        TEST_ASSERT_EQUAL(12, hour.count);
+    });
+    TEST_ASSERT_EQUAL(1, stored);
+    TEST_ASSERT_EQUAL(11, series.query(Tier::Hour, 0, 0, 0, UINT32_MAX, [](const TimeSeriesStore::Rollup&) {}));
+}
+
+double elapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 30 days of 5-minute wakes with three channels, stored as main.cpp did (each wake's readings
+// appended to the binary data file and flushed) and in the store. Flash pages are estimated
+// as LittleFSAppendFile does: the pages a write touches plus a metadata commit
+void test_write_amplification_and_query_latency() {
+    const uint32_t wakes = 30 * 288;
+    const uint32_t samples = wakes * 3;
+
+    BinaryLogEncoder::State logState = {};
+    BinaryLogFile log("/test_series_log.bin", logState);
+    TEST_ASSERT_TRUE(log.begin());
+    uint64_t logPages = 0;
+    size_t logSize = BinaryLogFormat::headerSize;
+    LittleFS.resetStats();
+    for (uint32_t i = 0; i < wakes; ++i) {
+        uint32_t time = dayStart + i * 300;
+        float climate[] = {temperatureAt(time), humidityAt(time)};
+        float battery[] = {batteryAt(time)};
+        log.appendReading(time * 1000ULL, 0, climate, 2);
+        log.appendReading(time * 1000ULL, 1, battery, 1);
+        size_t written = log.getBufferedBytes();
+        TEST_ASSERT_TRUE(log.flush());
+        logPages += (logSize + written - 1) / 256 - logSize / 256 + 2;
+        logSize += written;
+    }
+    HostLittleFS::Stats logStats = LittleFS.getStats();
+    LittleFS.remove("/test_series_log.bin");
+
+    TimeSeriesStore series(testState, testConfig());
+    TEST_ASSERT_TRUE(series.begin());
+    for (uint32_t i = 0; i < wakes; ++i) {
+        appendWake(series, dayStart + i * 300);
+    }
+    TimeSeriesStore::Stats stats = series.getStats();
+
+    // Without the minute tier, which holds one sample a period at this rate
+    std::memset(&testState, 0, sizeof(testState));
+    removeSegments();
+    TimeSeriesStore::Config hourly = testConfig();
+    hourly.segments[static_cast<size_t>(Tier::Minute)] = 0;
+    TimeSeriesStore hourlySeries(testState, hourly);
+    TEST_ASSERT_TRUE(hourlySeries.begin());
+    for (uint32_t i = 0; i < wakes; ++i) {
+        appendWake(hourlySeries, dayStart + i * 300);
+    }
+    TimeSeriesStore::Stats hourlyStats = hourlySeries.getStats();
+    appendWake(hourlySeries, dayStart + wakes * 300); // Closes the last hour of the last day
+
+    const double payload = samples * sizeof(TimeSeriesStore::Sample);
+    char line[192];
+    snprintf(line, sizeof(line), "binary log:   %.2f file writes/wake, %.2f pages/wake, amplification %.1fx, %u KB after 30 days, growing",
+             static_cast<double>(logStats.flushes) / wakes, static_cast<double>(logPages) / wakes,
+             logPages * 256 / payload, static_cast<unsigned>(logSize / 1024));
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "series store: %.2f file writes/wake, %.2f pages/wake, amplification %.1fx, at most %u KB",
+             static_cast<double>(stats.fileWrites) / wakes, static_cast<double>(stats.pageWrites) / wakes,
+             stats.pageWrites * 256 / payload, 24u * TIME_SERIES_SEGMENT_SIZE / 1024);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "  no minutes: %.2f file writes/wake, %.2f pages/wake, amplification %.1fx",
+             static_cast<double>(hourlyStats.fileWrites) / wakes, static_cast<double>(hourlyStats.pageWrites) / wakes,
+             hourlyStats.pageWrites * 256 / payload);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(stats.pageWrites < logPages);
+    TEST_ASSERT_TRUE(hourlyStats.pageWrites < stats.pageWrites);
+
+    // Hourly min, max and mean of the last full day: from the hour tier, and by scanning the raw samples
+    const uint32_t from = dayStart + 29 * 86400;
+    const uint32_t to = from + 86400 - 1;
+    const int runs = 20;
+    LittleFS.resetStats();
+    auto start = std::chrono::steady_clock::now();
+    size_t hours = 0;
+    for (int run = 0; run < runs; ++run) {
+        hours = hourlySeries.query(Tier::Hour, 0, 0, from, to, [](const TimeSeriesStore::Rollup&) {});
+    }
+    double rollupUs = elapsedUs(start) / runs;
+    uint64_t rollupBytes = LittleFS.getStats().bytesRead / runs;
+
+    LittleFS.resetStats();
+    start = std::chrono::steady_clock::now();
+    TimeSeriesStore::Rollup scanned[24];
+    for (int run = 0; run < runs; ++run) {
+        std::memset(scanned, 0, sizeof(scanned));
+        hourlySeries.queryRaw(0, 0, from, to, [&scanned](const TimeSeriesStore::Sample& sample) {
+            TimeSeriesStore::Rollup& hour = scanned[(sample.time - (dayStart + 29 * 86400)) / 3600];
+            hour.min = hour.count == 0 || sample.value < hour.min ? sample.value : hour.min;
+            hour.max = hour.count == 0 || sample.value > hour.max ? sample.value : hour.max;
+            hour.count++;
+            hour.mean += (sample.value - hour.mean) / hour.count;
+        });
+    }
+    double scanUs = elapsedUs(start) / runs;
+    uint64_t scanBytes = LittleFS.getStats().bytesRead / runs;
+
+    snprintf(line, sizeof(line), "hourly summary of a day: rollups %.1f us, %u bytes read; raw scan %.1f us, %u bytes read",
+             rollupUs, static_cast<unsigned>(rollupBytes), scanUs, static_cast<unsigned>(scanBytes));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(24, hours);
+    TEST_ASSERT_EQUAL(12, scanned[23].count);
+    TEST_ASSERT_TRUE(rollupBytes * 2 < scanBytes);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rollups_close_with_their_period);
+    RUN_TEST(test_unsynced_wake_does_not_hold_the_clock);
+    RUN_TEST(test_channels_roll_up_apart);
+    RUN_TEST(test_history_stays_within_its_segments);
+    RUN_TEST(test_query_returns_the_range_only);
+#ifndef ARDUINO
+    RUN_TEST(test_state_survives_deep_sleep);
+    RUN_TEST(test_rebuilds_after_power_loss);
+    RUN_TEST(test_write_amplification_and_query_latency);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,248 @@
+#include <unity.h>
+#include <Hal.h>
+#include <HalFS.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#include <cstdio>
+const char* imagePath = "/tmp/test_hal_fs.img";
+#endif
+
+const char* filePath = "/test_hal.txt";
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+    LittleFS.format();
+    LittleFS.setCapacity(1536 * 1024);
+    LittleFS.resetStats();
+#endif
+    LittleFS.remove(filePath);
+}
+
+void tearDown() {
+    LittleFS.remove(filePath);
+}
+
+std::string readFile(const char* path) {
+    File file = LittleFS.open(path, FILE_READ);
+    std::string content;
+    uint8_t chunk[32];
+    size_t length;
+    while (file && (length = file.read(chunk, sizeof(chunk))) > 0) {
+        content.append(reinterpret_cast<const char*>(chunk), length);
+    }
+    file.close();
+    return content;
+}
+
+void test_clock_is_monotonic() {
+    uint32_t startMs = Hal::millis();
+    uint32_t startUs = Hal::micros();
+    Hal::delay(20);
+    TEST_ASSERT_TRUE(Hal::millis() - startMs >= 20);
+    TEST_ASSERT_TRUE(Hal::micros() - startUs >= 20000);
+}
+
+std::atomic<int> taskRuns{0};
+std::atomic<bool> taskDone{false};
+
+void countingTask(void* parameters) {
+    taskRuns.fetch_add(*static_cast<int*>(parameters));
+    taskDone.store(true);
+}
+
+void test_task_runs_and_ends() {
+    static int increment = 3;
+    taskRuns.store(0);
+    taskDone.store(false);
+    TEST_ASSERT_TRUE(Hal::startTask("CountingTask", countingTask, &increment, 2048, 1));
+    for (int i = 0; i < 1000 && !taskDone.load(); ++i) {
+        Hal::delay(1);
+    }
+    TEST_ASSERT_TRUE(taskDone.load());
+    TEST_ASSERT_EQUAL(3, taskRuns.load());
+}
+
+void test_fs_write_append_read() {
+    File file = LittleFS.open(filePath, FILE_WRITE);
+    TEST_ASSERT_TRUE(static_cast<bool>(file));
+    TEST_ASSERT_EQUAL(5, file.print("hello"));
+    file.close();
+
+    file = LittleFS.open(filePath, FILE_APPEND);
+    file.println(" world");
+    file.close();
+    TEST_ASSERT_TRUE(LittleFS.exists(filePath));
+    TEST_ASSERT_EQUAL_STRING("hello world\r\n", readFile(filePath).c_str());
+
+    file = LittleFS.open(filePath, FILE_READ);
+    TEST_ASSERT_EQUAL(13, file.size());
+    TEST_ASSERT_TRUE(file.seek(6));
+    TEST_ASSERT_EQUAL('w', file.read());
+    TEST_ASSERT_EQUAL(6, file.available());
+    file.close();
+
+    TEST_ASSERT_TRUE(LittleFS.remove(filePath));
+    TEST_ASSERT_FALSE(LittleFS.exists(filePath));
+    TEST_ASSERT_FALSE(static_cast<bool>(LittleFS.open(filePath, FILE_READ)));
+}
+
+#ifndef ARDUINO
+void test_manual_clock_advances_only_when_told() {
+    Hal::Sim::useManualClock(true);
+    TEST_ASSERT_EQUAL(0, Hal::millis());
+    Hal::delay(1500); // Advances instead of sleeping
+    TEST_ASSERT_EQUAL(1500, Hal::millis());
+    Hal::delayMicroseconds(250);
+    TEST_ASSERT_EQUAL(1500250, Hal::micros());
+    Hal::Sim::advanceMillis(500);
+    TEST_ASSERT_EQUAL(2000, Hal::millis());
+}
+
+HAL_RTC_DATA uint32_t rtcCounter;
+
+void test_rtc_survives_deep_sleep() {
+    Hal::Sim::useManualClock(true);
+    Hal::delay(800);
+    rtcCounter = 7;
+    Hal::Sim::deepSleep(60000000); // One minute
+
+    TEST_ASSERT_EQUAL(0, Hal::millis()); // A wake starts the clock over
+    TEST_ASSERT_EQUAL(60800000, static_cast<uint32_t>(Hal::rtcMicros()));
+    TEST_ASSERT_EQUAL(7, rtcCounter);
+
+    Hal::Sim::powerCycle();
+    TEST_ASSERT_EQUAL(0, static_cast<uint32_t>(Hal::rtcMicros()));
+    TEST_ASSERT_EQUAL(0, rtcCounter);
+}
+
+void test_analog_values_sources_and_read_cost() {
+    Hal::Sim::useManualClock(true);
+    TEST_ASSERT_EQUAL(0, Hal::analogRead(34)); // Unset channels read 0
+
+    Hal::Sim::setAnalogValue(34, 1234);
+    TEST_ASSERT_EQUAL(1234, Hal::analogRead(34));
+
+    // A ramp of one count per simulated microsecond, with each read taking 10 us
+    Hal::Sim::setAnalogReadCost(10);
+    Hal::Sim::setAnalogSource(34, [](uint8_t, uint64_t nowUs) { return static_cast<int>(nowUs); });
+    int first = Hal::analogRead(34);
+    int second = Hal::analogRead(34);
+    TEST_ASSERT_EQUAL(10, second - first);
+    TEST_ASSERT_EQUAL(4, Hal::Sim::getAnalogReadCount(34));
+}
+
+void test_gpio_state() {
+    Hal::pinMode(19, Hal::PinMode::Output);
+    Hal::digitalWrite(19, true);
+    TEST_ASSERT_TRUE(Hal::Sim::getDigitalOutput(19));
+    TEST_ASSERT_TRUE(Hal::digitalRead(19));
+
+    Hal::pinMode(16, Hal::PinMode::InputPullup);
+    TEST_ASSERT_TRUE(Hal::digitalRead(16));
+    Hal::Sim::setDigitalInput(16, false);
+    TEST_ASSERT_FALSE(Hal::digitalRead(16));
+    TEST_ASSERT_TRUE(Hal::Sim::getPinMode(16) == Hal::PinMode::InputPullup);
+}
+
+void test_pulse_capture() {
+    Hal::Sim::useManualClock(true);
+    Hal::Sim::setPulseCaptureChannels(1);
+    TEST_ASSERT_TRUE(Hal::pulseCaptureBegin(4, 200));
+    TEST_ASSERT_FALSE(Hal::pulseCaptureBegin(5, 200)); // The only channel is taken
+    TEST_ASSERT_TRUE(Hal::Sim::getDigitalOutput(4));   // Released
+
+    Hal::pulseCaptureLineLow(4);
+    TEST_ASSERT_FALSE(Hal::Sim::getDigitalOutput(4));
+    Hal::Pulse pulses[4];
+    TEST_ASSERT_TRUE(Hal::pulseCaptureArm(4));
+    TEST_ASSERT_EQUAL(0, Hal::pulseCaptureRead(4, pulses, 4, 10)); // Nothing on the line
+    TEST_ASSERT_EQUAL(10000, Hal::Sim::nowMicros());
+
+    Hal::Sim::setPulseResponse(4, {{80, false}, {80, true}, {50, false}});
+    TEST_ASSERT_TRUE(Hal::pulseCaptureArm(4));
+    TEST_ASSERT_EQUAL(3, Hal::pulseCaptureRead(4, pulses, 4, 10));
+    TEST_ASSERT_EQUAL(10210, Hal::Sim::nowMicros()); // Waited for the capture to end
+    TEST_ASSERT_EQUAL(80, pulses[1].us);
+    TEST_ASSERT_TRUE(pulses[1].high);
+    TEST_ASSERT_EQUAL(2, Hal::Sim::getPulseCaptureCount(4));
+
+    Hal::pulseCaptureEnd(4);
+    TEST_ASSERT_FALSE(Hal::pulseCaptureArm(4));
+    TEST_ASSERT_TRUE(Hal::pulseCaptureBegin(5, 200));
+    Hal::pulseCaptureEnd(5);
+}
+
+void test_fs_image_survives_reboot() {
+    LittleFS.mkdir("/logs");
+    File file = LittleFS.open("/logs/data.txt", FILE_WRITE);
+    uint8_t bytes[] = {0x00, 0xA5, 0xFF, 0x5A};
+    file.write(bytes, sizeof(bytes));
+    file.close();
+    TEST_ASSERT_TRUE(LittleFS.saveImage(imagePath));
+
+    LittleFS.format(); // Power cycle: RAM contents are gone
+    TEST_ASSERT_FALSE(LittleFS.exists("/logs/data.txt"));
+
+    TEST_ASSERT_TRUE(LittleFS.loadImage(imagePath));
+    TEST_ASSERT_TRUE(LittleFS.exists("/logs"));
+    std::string content = readFile("/logs/data.txt");
+    TEST_ASSERT_EQUAL(sizeof(bytes), content.size());
+    TEST_ASSERT_EQUAL_MEMORY(bytes, content.data(), sizeof(bytes));
+    std::remove(imagePath);
+}
+
+void test_fs_capacity_limit() {
+    LittleFS.setCapacity(8);
+    File file = LittleFS.open(filePath, FILE_WRITE);
+    TEST_ASSERT_EQUAL(8, file.print("12345678"));
+    TEST_ASSERT_EQUAL(0, file.print("9")); // Partition full
+    file.close();
+    TEST_ASSERT_EQUAL(8, LittleFS.usedBytes());
+
+    HostLittleFS::Stats stats = LittleFS.getStats();
+    TEST_ASSERT_EQUAL(1, stats.opens);
+    TEST_ASSERT_EQUAL(8, stats.bytesWritten);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clock_is_monotonic);
+    RUN_TEST(test_task_runs_and_ends);
+    RUN_TEST(test_fs_write_append_read);
+#ifndef ARDUINO
+    RUN_TEST(test_manual_clock_advances_only_when_told);
+    RUN_TEST(test_rtc_survives_deep_sleep);
+    RUN_TEST(test_analog_values_sources_and_read_cost);
+    RUN_TEST(test_gpio_state);
+    RUN_TEST(test_pulse_capture);
+    RUN_TEST(test_fs_image_survives_reboot);
+    RUN_TEST(test_fs_capacity_limit);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    LittleFS.begin(true);
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,522 @@
+#include <unity.h>
+#include "Logger.h"
+#include "LogHandler.h"
+#include "LogRecord.h"
+#include "LogRing.h"
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+// Counts heap allocations so the tests can report allocations per log call
+std::atomic<uint32_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
+std::vector<std::string> captured;
+
+void captureHandler(LogLevel level, const std::string& message) {
+    captured.push_back("[" + logLevelToString(level) + "] " + message);
+}
+
+void setUp() {
+    Logger::stopAsync();
+    Logger::clearHandlers();
+    Logger::setGlobalLogLevel(LogLevel::INFO);
+    Logger::resetAsyncStats();
+    captured.clear();
+}
+
+void tearDown() {
+    Logger::stopAsync();
+    Logger::clearHandlers();
+}
+
+void test_sync_log_dispatches_inline() {
+    Logger::addHandler(captureHandler);
+    Logger::log(LogLevel::WARNING, "inline");
+
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[WARNING] inline", captured[0].c_str());
+}
+
+void test_global_level_filters_messages() {
+    Logger::addHandler(captureHandler);
+    Logger::setGlobalLogLevel(LogLevel::ERROR);
+    Logger::log(LogLevel::INFO, "dropped");
+    Logger::log(LogLevel::ERROR, "kept");
+
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[ERROR] kept", captured[0].c_str());
+}
+
+void test_ring_rejects_pushes_when_full() {
+    static LogRing<int, 4> ring;
+    for (int i = 0; i < 4; ++i) {
+        TEST_ASSERT_TRUE(ring.tryPush(i));
+    }
+    TEST_ASSERT_FALSE(ring.tryPush(99));
+    TEST_ASSERT_EQUAL(1, ring.getOverrunCount());
+    TEST_ASSERT_EQUAL(4, ring.getHighWater());
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        TEST_ASSERT_TRUE(ring.tryPop(value));
+        TEST_ASSERT_EQUAL(i, value);
+    }
+    TEST_ASSERT_FALSE(ring.tryPop(value));
+}
+
+void test_async_log_is_delivered_on_flush() {
+    Logger::addHandler(captureHandler);
+    TEST_ASSERT_TRUE(Logger::startAsync(1000)); // Long interval so the test drains explicitly
+    Logger::log(LogLevel::INFO, "first");
+    Logger::log(LogLevel::ERROR, "second");
+    Logger::flush();
+
+    TEST_ASSERT_EQUAL(2, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[INFO] first", captured[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("[ERROR] second", captured[1].c_str());
+
+    Logger::AsyncStats stats = Logger::getAsyncStats();
+    TEST_ASSERT_EQUAL(2, stats.enqueued);
+    TEST_ASSERT_EQUAL(2, stats.dispatched);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+}
+
+void test_async_overrun_is_counted() {
+    Logger::addHandler(captureHandler);
+    TEST_ASSERT_TRUE(Logger::startAsync(1000));
+    for (int i = 0; i < LOGGER_RING_CAPACITY + 5; ++i) {
+        Logger::log(LogLevel::INFO, "burst");
+    }
+    Logger::stopAsync();
+
+    Logger::AsyncStats stats = Logger::getAsyncStats();
+    TEST_ASSERT_EQUAL(5, stats.overruns);
+    TEST_ASSERT_EQUAL(LOGGER_RING_CAPACITY, stats.dispatched);
+    TEST_ASSERT_EQUAL(LOGGER_RING_CAPACITY, captured.size());
+}
+
+void test_async_truncates_long_messages() {
+    Logger::addHandler(captureHandler);
+    TEST_ASSERT_TRUE(Logger::startAsync(1000));
+    Logger::log(LogLevel::INFO, std::string(LOGGER_RECORD_ARG_BYTES * 2, 'x'));
+    Logger::flush();
+
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL(LOGGER_RECORD_ARG_BYTES - 2 + 7, captured[0].size()); // "[INFO] " prefix
+    TEST_ASSERT_EQUAL(1, Logger::getAsyncStats().truncated);
+}
+
+void test_record_renders_typed_arguments() {
+    std::string path = "/logs/data.txt";
+    LogRecord record = LogRecord::make(LogLevel::INFO, "check {} result: {} size: {} temp: {}C id: {}",
+                                       path, true, 512u, 21.5f, -3);
+    char text[128];
+    record.render(text, sizeof(text));
+
+    TEST_ASSERT_EQUAL(5, record.getArgCount());
+    TEST_ASSERT_FALSE(record.isTruncated());
+    TEST_ASSERT_EQUAL_STRING("check /logs/data.txt result: true size: 512 temp: 21.50C id: -3", text);
+}
+
+void test_record_render_respects_buffer_size() {
+    LogRecord record = LogRecord::make(LogLevel::INFO, "value {}", 123456);
+    char text[8];
+    size_t length = record.render(text, sizeof(text));
+
+    TEST_ASSERT_EQUAL(7, length);
+    TEST_ASSERT_EQUAL_STRING("value 1", text);
+}
+
+void test_record_handler_receives_unrendered_record() {
+    const char* format = "File read successfully: {}";
+    const char* seenFormat = nullptr;
+    Logger::addRecordHandler([&seenFormat](const LogRecord& record) { seenFormat = record.getFormat(); });
+    Logger::addHandler(captureHandler);
+    Logger::logf(LogLevel::INFO, format, "/logs/info.txt");
+
+    TEST_ASSERT_TRUE(seenFormat == format); // The format pointer is the message id
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[INFO] File read successfully: /logs/info.txt", captured[0].c_str());
+}
+
+void test_log_handler_formats_records() {
+    std::string written;
+    LogHandler<std::function<void(const char*)>> handler(
+        [&written](const char* message) { written = message; }, LogLevel::WARNING);
+
+    handler.handleRecord(LogRecord::make(LogLevel::INFO, "filtered {}", 1));
+    TEST_ASSERT_TRUE(written.empty());
+
+    handler.handleRecord(LogRecord::make(LogLevel::ERROR, "Failed to remove file: {}", "/a.txt"));
+    TEST_ASSERT_EQUAL_STRING("[ERROR] Failed to remove file: /a.txt", written.c_str());
+}
+
+void test_log_handler_marks_truncated_messages() {
+    std::string written;
+    LogHandler<std::function<void(const char*)>> handler([&written](const char* message) { written = message; });
+    std::string path(300, 'a');
+    // The record keeps a shortened copy of the path, so the format has to make up the length
+    std::string format = "Failed to open {} " + std::string(LOGGER_RENDER_BUFFER_SIZE, 'x');
+
+    handler.handleRecord(LogRecord::make(LogLevel::ERROR, format.c_str(), path));
+    TEST_ASSERT_EQUAL(LOGGER_RENDER_BUFFER_SIZE - 1, written.size());
+    TEST_ASSERT_EQUAL_STRING("...", written.c_str() + written.size() - 3);
+    TEST_ASSERT_EQUAL(0, written.compare(0, 25, "[ERROR] Failed to open aa"));
+
+    handler.handleLog(LogLevel::INFO, path);
+    TEST_ASSERT_EQUAL(LOGGER_RENDER_BUFFER_SIZE - 1, written.size());
+    TEST_ASSERT_EQUAL_STRING("...", written.c_str() + written.size() - 3);
+
+    // A message that just fits is left alone
+    std::string fits(LOGGER_RENDER_BUFFER_SIZE - 1 - 7, 'b');
+    handler.handleLog(LogLevel::INFO, fits);
+    TEST_ASSERT_EQUAL_STRING(("[INFO] " + fits).c_str(), written.c_str());
+    handler.handleRecord(LogRecord::make(LogLevel::INFO, fits.c_str()));
+    TEST_ASSERT_EQUAL_STRING(("[INFO] " + fits).c_str(), written.c_str());
+}
+
+void test_handler_ids_allow_removal() {
+    TEST_ASSERT_TRUE(Logger::addHandler("serial", captureHandler));
+    TEST_ASSERT_FALSE(Logger::addHandler("serial", captureHandler)); // Duplicate IDs are rejected
+    TEST_ASSERT_EQUAL(1, Logger::getHandlerCount());
+
+    Logger::log(LogLevel::INFO, "before");
+    Logger::removeHandler("serial");
+    Logger::log(LogLevel::INFO, "after");
+
+    TEST_ASSERT_EQUAL(0, Logger::getHandlerCount());
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[INFO] before", captured[0].c_str());
+}
+
+void test_handlers_only_receive_their_levels() {
+    int flashCount = 0;
+    Logger::addHandler("serial", captureHandler, LogLevel::INFO);
+    Logger::addRecordHandler("flash", [&flashCount](const LogRecord&) { ++flashCount; }, LogLevel::ERROR);
+
+    Logger::log(LogLevel::INFO, "info");
+    Logger::logf(LogLevel::CRITICAL, "critical {}", 1);
+    TEST_ASSERT_EQUAL(2, captured.size());
+    TEST_ASSERT_EQUAL(1, flashCount);
+
+    TEST_ASSERT_TRUE(Logger::setHandlerLevel("serial", LogLevel::WARNING));
+    TEST_ASSERT_FALSE(Logger::setHandlerLevel("missing", LogLevel::WARNING));
+    Logger::log(LogLevel::INFO, "info");
+    TEST_ASSERT_EQUAL(2, captured.size());
+}
+
+void test_level_without_handlers_skips_arguments() {
+    int evaluated = 0;
+    auto expensive = [&evaluated]() {
+        ++evaluated;
+        return 1;
+    };
+    Logger::addHandler("flash", captureHandler, LogLevel::ERROR);
+
+    LOG_WARNING("value {}", expensive());
+    TEST_ASSERT_FALSE(Logger::isEnabled(LogLevel::WARNING));
+    TEST_ASSERT_EQUAL(0, evaluated);
+    TEST_ASSERT_EQUAL(0, captured.size());
+}
+
+static_assert(isLogLevelCompiledIn(LogLevel::CRITICAL), "CRITICAL must always be compiled in");
+
+void test_macro_skips_argument_evaluation_when_filtered() {
+    int evaluated = 0;
+    auto expensive = [&evaluated]() {
+        ++evaluated;
+        return 42;
+    };
+    Logger::addHandler(captureHandler);
+    Logger::setGlobalLogLevel(LogLevel::ERROR);
+
+    LOG_INFO("value {}", expensive());
+    TEST_ASSERT_EQUAL(0, evaluated);
+    TEST_ASSERT_EQUAL(0, captured.size());
+
+    LOG_ERROR("value {}", expensive());
+    TEST_ASSERT_EQUAL(1, evaluated);
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[ERROR] value 42", captured[0].c_str());
+}
+
+#ifndef ARDUINO
+// Measures what a filtered-out INFO message costs the caller: the old string-building call
+// and the LOG_INFO macro rejected at runtime. test/LoggerCompiledOut times it compiled out.
+void test_filtered_log_cost() {
+    const int calls = 200000;
+    const std::string path = "/logs/data.txt";
+    Logger::addHandler(captureHandler);
+    Logger::setGlobalLogLevel(LogLevel::ERROR);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        Logger::log(LogLevel::INFO, "File exists check for path: " + path + ", result: " + (i & 1 ? "true" : "false"));
+    }
+    auto concatenated = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        LOG_INFO("File exists check for path: {}, result: {}", path, (i & 1) != 0);
+    }
+    auto runtimeFiltered = std::chrono::steady_clock::now() - start;
+
+    auto perCall = [calls](std::chrono::steady_clock::duration elapsed) {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / calls;
+    };
+    char report[160];
+    snprintf(report, sizeof(report), "filtered INFO ns/call: concatenated=%.2f runtime-filtered=%.2f",
+             perCall(concatenated), perCall(runtimeFiltered));
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(0, captured.size());
+    TEST_ASSERT_TRUE(runtimeFiltered < concatenated);
+}
+
+// Registers dozens of handlers spread over every minimum level and checks each receives
+// exactly its levels, then times dispatch against handlers that each filter themselves.
+void test_dispatch_with_many_handlers() {
+    const int handlerCount = 48;
+    const int messages = 20000;
+    std::vector<uint32_t> received(handlerCount, 0);
+
+    for (int i = 0; i < handlerCount; ++i) {
+        LogLevel minLevel = static_cast<LogLevel>(i % logLevelCount);
+        Logger::addHandler("masked-" + std::to_string(i),
+                           [&received, i](LogLevel, const std::string&) { ++received[i]; }, minLevel);
+    }
+    Logger::setGlobalLogLevel(LogLevel::SETUP);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; ++i) {
+        Logger::logf(static_cast<LogLevel>(i % logLevelCount), "message {}", i);
+    }
+    auto masked = std::chrono::steady_clock::now() - start;
+
+    for (int i = 0; i < handlerCount; ++i) {
+        int minLevel = i % logLevelCount;
+        uint32_t expected = messages / logLevelCount * (logLevelCount - minLevel);
+        TEST_ASSERT_EQUAL(expected, received[i]);
+    }
+
+    Logger::clearHandlers();
+    std::vector<uint32_t> selfFiltered(handlerCount, 0);
+    for (int i = 0; i < handlerCount; ++i) {
+        LogLevel minLevel = static_cast<LogLevel>(i % logLevelCount);
+        Logger::addHandler([&selfFiltered, i, minLevel](LogLevel level, const std::string&) {
+            if (level >= minLevel) {
+                ++selfFiltered[i];
+            }
+        });
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; ++i) {
+        Logger::logf(static_cast<LogLevel>(i % logLevelCount), "message {}", i);
+    }
+    auto unmasked = std::chrono::steady_clock::now() - start;
+
+    auto perCall = [messages](std::chrono::steady_clock::duration elapsed) {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / messages;
+    };
+    char report[128];
+    snprintf(report, sizeof(report), "%d handlers ns/log: per-level dispatch=%.1f self-filtering=%.1f",
+             handlerCount, perCall(masked), perCall(unmasked));
+    TEST_MESSAGE(report);
+    TEST_ASSERT_EQUAL(received[handlerCount - 1], selfFiltered[handlerCount - 1]);
+}
+
+// Compares heap allocations per call for the old string-concatenation style against logf.
+// A record handler and a text handler are both registered, as in a serial + flash setup.
+void test_allocations_per_log_call() {
+    const int calls = 1000;
+    const std::string path = "/logs/sensor_data_archive.txt";
+    size_t renderedBytes = 0;
+
+    Logger::addRecordHandler([](const LogRecord&) {});
+    Logger::addHandler([&renderedBytes](LogLevel, const std::string& message) { renderedBytes += message.size(); });
+    Logger::logf(LogLevel::INFO, "warm up {}", path); // Lets the per-thread render buffer grow once
+
+    allocationCount.store(0);
+    for (int i = 0; i < calls; ++i) {
+        bool result = (i & 1) != 0;
+        Logger::log(LogLevel::INFO, "File exists check for path: " + path + ", result: " + (result ? "true" : "false"));
+    }
+    uint32_t concatenated = allocationCount.load();
+
+    allocationCount.store(0);
+    for (int i = 0; i < calls; ++i) {
+        bool result = (i & 1) != 0;
+        Logger::logf(LogLevel::INFO, "File exists check for path: {}, result: {}", path, result);
+    }
+    uint32_t structured = allocationCount.load();
+
+    char report[128];
+    snprintf(report, sizeof(report), "allocations per log call: concatenated=%.2f structured=%.2f",
+             static_cast<double>(concatenated) / calls, static_cast<double>(structured) / calls);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_GREATER_THAN(0, renderedBytes);
+    TEST_ASSERT_GREATER_OR_EQUAL(calls, concatenated);
+    TEST_ASSERT_EQUAL(0, structured);
+}
+
+// Several producers log against a deliberately slow handler while the drain thread runs.
+// Reports producer-side latency and drops; every record must be either delivered or counted.
+void test_async_producer_latency_under_load() {
+    const int producers = 4;
+    const int messagesPerProducer = 20000;
+    std::atomic<uint32_t> delivered{0};
+
+    Logger::addHandler([&delivered](LogLevel, const std::string&) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(2);
+        while (std::chrono::steady_clock::now() < until) {
+            // Busy wait standing in for a serial print or flash append
+        }
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    });
+    TEST_ASSERT_TRUE(Logger::startAsync(1));
+
+    std::vector<std::vector<uint32_t>> latencies(producers);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([p, &latencies]() {
+            latencies[p].reserve(messagesPerProducer);
+            const std::string message = "sensor sample from producer " + std::to_string(p);
+            for (int i = 0; i < messagesPerProducer; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                Logger::log(LogLevel::INFO, message);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                latencies[p].push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Logger::stopAsync();
+
+    std::vector<uint32_t> all;
+    for (const auto& perProducer : latencies) {
+        all.insert(all.end(), perProducer.begin(), perProducer.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    Logger::AsyncStats stats = Logger::getAsyncStats();
+    char report[200];
+    snprintf(report, sizeof(report),
+             "producer latency ns p50=%u p99=%u max=%u | enqueued=%u dispatched=%u overruns=%u highWater=%u",
+             all[all.size() / 2], all[all.size() * 99 / 100], all.back(),
+             stats.enqueued, stats.dispatched, stats.overruns, stats.highWater);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(producers * messagesPerProducer, stats.enqueued + stats.overruns);
+    TEST_ASSERT_EQUAL(stats.enqueued, stats.dispatched);
+    TEST_ASSERT_EQUAL(stats.dispatched, delivered.load());
+}
+
+// Switches back to inline dispatch while producers keep logging: every record is either
+// delivered once or counted as an overrun, and none is left in the ring
+void test_stop_async_while_producers_log() {
+    const int producers = 4;
+    const int messagesPerProducer = 5000;
+    std::atomic<uint32_t> delivered{0};
+
+    Logger::addHandler([&delivered](LogLevel, const std::string&) {
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    });
+    TEST_ASSERT_TRUE(Logger::startAsync(1));
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < messagesPerProducer; ++i) {
+                Logger::log(LogLevel::INFO, "sample");
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    Logger::stopAsync();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Logger::AsyncStats stats = Logger::getAsyncStats();
+    TEST_ASSERT_FALSE(Logger::isAsync());
+    TEST_ASSERT_EQUAL(stats.enqueued, stats.dispatched);
+    TEST_ASSERT_EQUAL(producers * messagesPerProducer - stats.overruns, delivered.load());
+    TEST_ASSERT_TRUE(stats.highWater <= LOGGER_RING_CAPACITY);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sync_log_dispatches_inline);
+    RUN_TEST(test_global_level_filters_messages);
+    RUN_TEST(test_ring_rejects_pushes_when_full);
+    RUN_TEST(test_async_log_is_delivered_on_flush);
+    RUN_TEST(test_async_overrun_is_counted);
+    RUN_TEST(test_async_truncates_long_messages);
+    RUN_TEST(test_record_renders_typed_arguments);
+    RUN_TEST(test_record_render_respects_buffer_size);
+    RUN_TEST(test_record_handler_receives_unrendered_record);
+    RUN_TEST(test_log_handler_formats_records);
+    RUN_TEST(test_log_handler_marks_truncated_messages);
+    RUN_TEST(test_handler_ids_allow_removal);
+    RUN_TEST(test_handlers_only_receive_their_levels);
+    RUN_TEST(test_level_without_handlers_skips_arguments);
+    RUN_TEST(test_macro_skips_argument_evaluation_when_filtered);
+#ifndef ARDUINO
+    RUN_TEST(test_filtered_log_cost);
+    RUN_TEST(test_dispatch_with_many_handlers);
+    RUN_TEST(test_allocations_per_log_call);
+    RUN_TEST(test_async_producer_latency_under_load);
+    RUN_TEST(test_stop_async_while_producers_log);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,105 @@
+// A test target of its own, so LOGGER_MIN_LEVEL can sit above INFO here while the other
+// targets keep every level. It has to be set before Logger.h, as a -D build flag would.
+#undef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 2
+
+#include <unity.h>
+#include "Logger.h"
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <cstdio>
+#endif
+
+std::vector<std::string> captured;
+int evaluated = 0;
+
+void captureHandler(LogLevel level, const std::string& message) {
+    captured.push_back("[" + logLevelToString(level) + "] " + message);
+}
+
+// An argument whose evaluation the test can see
+int expensive() {
+    ++evaluated;
+    return evaluated;
+}
+
+void setUp() {
+    Logger::clearHandlers();
+    Logger::addHandler(captureHandler);
+    Logger::setGlobalLogLevel(LogLevel::SETUP); // Only LOGGER_MIN_LEVEL filters
+    captured.clear();
+    evaluated = 0;
+}
+
+void tearDown() {
+    Logger::clearHandlers();
+}
+
+void test_compiled_out_levels_skip_arguments() {
+    LOG_SETUP("setup {}", expensive());
+    LOG_INFO("info {}", expensive());
+    Logger::logf<LogLevel::INFO>("info {}", 1);
+    TEST_ASSERT_EQUAL(0, evaluated);
+    TEST_ASSERT_EQUAL(0, captured.size());
+}
+
+void test_levels_from_the_minimum_still_log() {
+    LOG_WARNING("warning {}", expensive());
+    TEST_ASSERT_EQUAL(1, evaluated);
+    TEST_ASSERT_EQUAL(1, captured.size());
+    TEST_ASSERT_EQUAL_STRING("[WARNING] warning 1", captured[0].c_str());
+}
+
+#ifndef ARDUINO
+// What a compiled-out LOG_INFO costs the caller; test_Logger times the other ways to filter it
+void test_compiled_out_log_cost() {
+    const int calls = 200000;
+    const std::string path = "/logs/data.txt";
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        LOG_INFO("File exists check for path: {}, result: {}", path, expensive() > 0);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    char report[96];
+    snprintf(report, sizeof(report), "compiled-out INFO ns/call: %.2f",
+             static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / calls);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(0, evaluated);
+    TEST_ASSERT_EQUAL(0, captured.size());
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_compiled_out_levels_skip_arguments);
+    RUN_TEST(test_levels_from_the_minimum_still_log);
+#ifndef ARDUINO
+    RUN_TEST(test_compiled_out_log_cost);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
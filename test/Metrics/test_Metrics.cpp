@@ -0,0 +1,183 @@
+#include <unity.h>
+#include <Metrics.h>
+#include <BatchPublisher.h>
+#include <FileSystemManager.h>
+#include <HalFS.h>
+#include <Logger.h>
+#include <cstring>
+#include <string>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+const char* filePath = "/test_metrics.txt";
+
+// Accepts or rejects every publish
+class FakeClient {
+public:
+    bool publish(const char*, const uint8_t*, unsigned int) {
+        return accept;
+    }
+
+    bool accept = true;
+};
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+    Metrics::reset();
+}
+
+void tearDown() {
+    Logger::clearHandlers();
+    LittleFS.remove(filePath);
+}
+
+void test_counters_add_up() {
+    METRICS_COUNT(SensorReads);
+    METRICS_COUNT(SensorReads);
+    METRICS_ADD(PublishedBytes, 120);
+
+    Metrics::Snapshot snapshot = Metrics::snapshot();
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.counters[static_cast<size_t>(Metrics::Counter::SensorReads)]);
+    TEST_ASSERT_EQUAL_UINT32(120, snapshot.counters[static_cast<size_t>(Metrics::Counter::PublishedBytes)]);
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.counters[static_cast<size_t>(Metrics::Counter::SensorErrors)]);
+
+    Metrics::reset();
+    TEST_ASSERT_EQUAL_UINT32(0, Metrics::snapshot().counters[static_cast<size_t>(Metrics::Counter::SensorReads)]);
+}
+
+void test_histogram_buckets() {
+    TEST_ASSERT_EQUAL(0, Metrics::bucketOf(0));
+    TEST_ASSERT_EQUAL(0, Metrics::bucketOf(1));
+    TEST_ASSERT_EQUAL(1, Metrics::bucketOf(2));
+    TEST_ASSERT_EQUAL(1, Metrics::bucketOf(3));
+    TEST_ASSERT_EQUAL(10, Metrics::bucketOf(1024));
+    TEST_ASSERT_EQUAL(METRICS_HISTOGRAM_BUCKETS - 1, Metrics::bucketOf(UINT32_MAX));
+
+    for (int i = 0; i < 98; ++i) {
+        Metrics::record(Metrics::Timer::FileWrite, 100);
+    }
+    Metrics::record(Metrics::Timer::FileWrite, 5000);
+    Metrics::record(Metrics::Timer::FileWrite, 200000);
+
+    Metrics::TimerStats stats = Metrics::snapshot().timers[static_cast<size_t>(Metrics::Timer::FileWrite)];
+    TEST_ASSERT_EQUAL_UINT32(100, stats.count);
+    TEST_ASSERT_EQUAL_UINT32(98 * 100 + 5000 + 200000, stats.totalUs);
+    TEST_ASSERT_EQUAL_UINT32(200000, stats.maxUs);
+    TEST_ASSERT_EQUAL_UINT32(98, stats.buckets[6]); // 64..127 us
+    TEST_ASSERT_EQUAL_UINT32(127, Metrics::percentileUs(stats, 50));
+    TEST_ASSERT_EQUAL_UINT32(8191, Metrics::percentileUs(stats, 99));
+    TEST_ASSERT_EQUAL_UINT32(200000, Metrics::percentileUs(stats, 100)); // Open-ended last bucket
+}
+
+#ifndef ARDUINO
+void test_scoped_timer_records_scope() {
+    Hal::Sim::useManualClock(true);
+    {
+        METRICS_TIME(SensorRead);
+        Hal::Sim::advanceMicros(750);
+    }
+    Metrics::TimerStats stats = Metrics::snapshot().timers[static_cast<size_t>(Metrics::Timer::SensorRead)];
+    TEST_ASSERT_EQUAL_UINT32(1, stats.count);
+    TEST_ASSERT_EQUAL_UINT32(750, stats.totalUs);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.buckets[9]); // 512..1023 us
+}
+#endif
+
+void test_format_json() {
+    char payload[400];
+    size_t length = Metrics::formatJson(Metrics::snapshot(), payload, sizeof(payload));
+    TEST_ASSERT_EQUAL_STRING("{\"c\":{},\"t\":{}}", payload);
+    TEST_ASSERT_EQUAL(std::strlen(payload), length);
+
+    METRICS_ADD(LogRecords, 3);
+    Metrics::record(Metrics::Timer::Publish, 40);
+    length = Metrics::formatJson(Metrics::snapshot(), payload, sizeof(payload));
+    TEST_ASSERT_EQUAL_STRING("{\"c\":{\"log\":3},\"t\":{\"pub\":[1,40,40,40,40]}}", payload);
+
+    TEST_ASSERT_EQUAL(0, Metrics::formatJson(Metrics::snapshot(), payload, 20)); // Does not fit
+    TEST_ASSERT_EQUAL_STRING("", payload);
+}
+
+// A wake with every metric in use still fits in one MQTT message
+void test_busy_wake_fits_message() {
+    for (size_t i = 0; i < Metrics::counterCount; ++i) {
+        Metrics::add(static_cast<Metrics::Counter>(i), 999);
+    }
+    for (size_t i = 0; i < Metrics::timerCount; ++i) {
+        for (int sample = 0; sample < 99; ++sample) {
+            Metrics::record(static_cast<Metrics::Timer>(i), 10000); // 99 calls of 10 ms, ~1 s in total
+        }
+    }
+    char payload[BATCH_PUBLISHER_PAYLOAD_SIZE];
+    TEST_ASSERT_TRUE(Metrics::formatJson(Metrics::snapshot(), payload, sizeof(payload)) > 0);
+}
+
+void test_instrumented_paths() {
+    Logger::setGlobalLogLevel(LogLevel::INFO);
+    Logger::addRecordHandler("test", [](const LogRecord&) {});
+    LOG_INFO("Reading {}", 1);
+    LOG_INFO("Reading {}", 2);
+
+    FileSystemManager files([](const LogRecord&) {});
+    TEST_ASSERT_TRUE(files.write(filePath, "21.5,48.0\n"));
+    TEST_ASSERT_EQUAL_STRING("21.5,48.0\n", files.read(filePath).c_str());
+    files.read("/missing.txt");
+
+    FakeClient client;
+    BatchPublisher batch("esp32-temperature");
+    batch.add("greenhouse/reading", "dht", "temp", 21.5f, 1700000000000ULL);
+    TEST_ASSERT_EQUAL(1, batch.publish(client));
+    client.accept = false;
+    batch.add("greenhouse/reading", "dht", "temp", 21.5f, 1700000000000ULL);
+    TEST_ASSERT_EQUAL(0, batch.publish(client));
+
+    Metrics::Snapshot snapshot = Metrics::snapshot();
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.counters[static_cast<size_t>(Metrics::Counter::LogRecords)]);
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.timers[static_cast<size_t>(Metrics::Timer::LogDispatch)].count);
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.timers[static_cast<size_t>(Metrics::Timer::FileWrite)].count);
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.timers[static_cast<size_t>(Metrics::Timer::FileRead)].count);
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.counters[static_cast<size_t>(Metrics::Counter::FileErrors)]);
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.counters[static_cast<size_t>(Metrics::Counter::Published)]);
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.counters[static_cast<size_t>(Metrics::Counter::PublishFailures)]);
+    TEST_ASSERT_TRUE(snapshot.counters[static_cast<size_t>(Metrics::Counter::PublishedBytes)] > 0);
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.timers[static_cast<size_t>(Metrics::Timer::Publish)].count);
+
+    Metrics::dump(snapshot);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_counters_add_up);
+    RUN_TEST(test_histogram_buckets);
+#ifndef ARDUINO
+    RUN_TEST(test_scoped_timer_records_scope);
+#endif
+    RUN_TEST(test_format_json);
+    RUN_TEST(test_busy_wake_fits_message);
+    RUN_TEST(test_instrumented_paths);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    LittleFS.begin(true);
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,177 @@
+#include <unity.h>
+#include "AdcSampler.h"
+#include <cmath>
+#include <cstdint>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+const uint8_t batteryPin = 36;
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+    Hal::Sim::useManualClock(true);
+#endif
+}
+
+void tearDown() {}
+
+void test_stats_match_direct_computation() {
+    const uint16_t values[] = {1000, 1010, 990, 1005, 995, 1020, 980, 1000};
+    SampleStats single;
+    SampleStats batched;
+    double sum = 0;
+    for (uint16_t value : values) {
+        single.add(value);
+        sum += value;
+    }
+    batched.addBatch(values, 3);
+    batched.addBatch(values + 3, 5);
+
+    double mean = sum / 8;
+    double squares = 0;
+    for (uint16_t value : values) {
+        squares += (value - mean) * (value - mean);
+    }
+    TEST_ASSERT_EQUAL(8, batched.getCount());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, mean, single.getMean());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, mean, batched.getMean());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, squares / 7, single.getVariance());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, squares / 7, batched.getVariance());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, std::sqrt(squares / 7 / 8), batched.getStandardError());
+}
+
+void test_stats_of_too_few_samples() {
+    SampleStats stats;
+    TEST_ASSERT_EQUAL_FLOAT(0, stats.getVariance());
+    stats.add(2048);
+    TEST_ASSERT_EQUAL_FLOAT(2048, stats.getMean());
+    TEST_ASSERT_EQUAL_FLOAT(0, stats.getStandardError());
+}
+
+#ifndef ARDUINO
+// Alternates around 2000 by ±amplitude, so the variance is amplitude squared
+void useSquareWave(int amplitude) {
+    Hal::Sim::setAnalogSource(batteryPin, [amplitude](uint8_t, uint64_t nowUs) {
+        return 2000 + ((nowUs / 50) % 2 ? amplitude : -amplitude); // One sample per 50 us at 20 kHz
+    });
+}
+
+void test_streams_frames_without_analog_reads() {
+    useSquareWave(10);
+    AdcSampler sampler(batteryPin, AdcSampler::Config{20000, 0, 1000, 0.0f, 100});
+    TEST_ASSERT_TRUE(sampler.start());
+    TEST_ASSERT_TRUE(sampler.run());
+
+    TEST_ASSERT_EQUAL(1000, sampler.getStats().getCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 2000, sampler.getStats().getMean());
+    TEST_ASSERT_FLOAT_WITHIN(2, 100, sampler.getStats().getVariance());
+    TEST_ASSERT_EQUAL(0, Hal::Sim::getAnalogReadCount(batteryPin));
+    TEST_ASSERT_EQUAL(51, Hal::millis()); // Four 256 sample frames at 20 kHz
+    TEST_ASSERT_FALSE(Hal::Sim::isAdcStreamRunning());
+}
+
+void test_poll_never_waits() {
+    Hal::Sim::setAnalogValue(batteryPin, 1234);
+    AdcSampler sampler(batteryPin, AdcSampler::Config{20000, 0, 512, 0.0f, 100});
+    sampler.start();
+    TEST_ASSERT_FALSE(sampler.poll());
+    TEST_ASSERT_EQUAL(0, Hal::Sim::nowMicros());
+    TEST_ASSERT_EQUAL(0, sampler.getStats().getCount());
+
+    Hal::Sim::advanceMillis(13); // One 256 sample frame takes 12.8 ms
+    TEST_ASSERT_FALSE(sampler.poll());
+    TEST_ASSERT_EQUAL(256, sampler.getStats().getCount());
+    Hal::Sim::advanceMillis(13);
+    TEST_ASSERT_TRUE(sampler.poll());
+    TEST_ASSERT_EQUAL(512, sampler.getStats().getCount());
+    TEST_ASSERT_EQUAL_FLOAT(1234, sampler.getStats().getMean());
+}
+
+void test_stops_early_once_the_error_is_small() {
+    AdcSampler::Config config{20000, 500, 10000, 0.5f, 100};
+    useSquareWave(4);
+    AdcSampler quiet(batteryPin, config);
+    quiet.start();
+    TEST_ASSERT_TRUE(quiet.run());
+    TEST_ASSERT_TRUE(quiet.getStats().getCount() < 1000); // 0.5 counts needs 64 samples, minSamples rules
+    TEST_ASSERT_FALSE(Hal::Sim::isAdcStreamRunning());    // The ADC is off until the next reading
+
+    useSquareWave(200);
+    AdcSampler noisy(batteryPin, config);
+    noisy.start();
+    TEST_ASSERT_TRUE(noisy.run());
+    TEST_ASSERT_EQUAL(10000, noisy.getStats().getCount()); // 0.5 counts needs 160k samples, capped
+}
+
+void test_one_stream_at_a_time() {
+    Hal::Sim::setAnalogValue(batteryPin, 2000);
+    Hal::Sim::setAnalogValue(39, 1000);
+    AdcSampler first(batteryPin, AdcSampler::Config{20000, 0, 256, 0.0f, 100});
+    AdcSampler second(39, AdcSampler::Config{20000, 0, 256, 0.0f, 100});
+    TEST_ASSERT_TRUE(first.start());
+    TEST_ASSERT_FALSE(second.start()); // Falls back to analogRead()
+
+    TEST_ASSERT_TRUE(second.run());
+    TEST_ASSERT_TRUE(first.run());
+    TEST_ASSERT_EQUAL_FLOAT(1000, second.getStats().getMean());
+    TEST_ASSERT_EQUAL_FLOAT(2000, first.getStats().getMean());
+    TEST_ASSERT_EQUAL(256, Hal::Sim::getAnalogReadCount(39));
+    TEST_ASSERT_TRUE(second.start()); // Free again once the first reading is done
+}
+
+void test_stalled_stream_times_out() {
+    Hal::Sim::setAnalogValue(batteryPin, 2000);
+    AdcSampler sampler(batteryPin, AdcSampler::Config{20000, 0, 256, 0.0f, 5}); // A frame takes 12.8 ms
+    sampler.start();
+    TEST_ASSERT_FALSE(sampler.run());
+    TEST_ASSERT_TRUE(sampler.hasTimedOut());
+    TEST_ASSERT_FALSE(Hal::Sim::isAdcStreamRunning());
+}
+
+void test_slow_reader_loses_old_frames() {
+    Hal::Sim::setAnalogValue(batteryPin, 2000);
+    AdcSampler sampler(batteryPin, AdcSampler::Config{20000, 0, 1024, 0.0f, 100});
+    sampler.start();
+    Hal::Sim::advanceMillis(100); // Seven frames converted, the last two kept
+    sampler.poll();
+    TEST_ASSERT_EQUAL(256, sampler.getStats().getCount());
+    TEST_ASSERT_EQUAL(5 * 256, Hal::Sim::getAdcStreamDropCount());
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_stats_match_direct_computation);
+    RUN_TEST(test_stats_of_too_few_samples);
+#ifndef ARDUINO
+    RUN_TEST(test_streams_frames_without_analog_reads);
+    RUN_TEST(test_poll_never_waits);
+    RUN_TEST(test_stops_early_once_the_error_is_small);
+    RUN_TEST(test_one_stream_at_a_time);
+    RUN_TEST(test_stalled_stream_times_out);
+    RUN_TEST(test_slow_reader_loses_old_frames);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
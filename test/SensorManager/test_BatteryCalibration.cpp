@@ -0,0 +1,138 @@
+#include <unity.h>
+#include "BatteryCalibration.h"
+#include <cmath>
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+using BatteryCalibration::batteryMillivolts;
+using BatteryCalibration::centiPercentAt;
+using BatteryCalibration::centiPercentFromCounts;
+using BatteryCalibration::countsScale;
+using BatteryCalibration::maxCounts;
+
+// Generated by the compiler, not at startup
+static_assert(batteryMillivolts(0) == 653, "the ADC's 142 mV floor behind the divider");
+static_assert(batteryMillivolts(maxCounts * countsScale) == 15829, "ADC1 reads up to about 3.44 V at 11 dB");
+static_assert(BatteryCalibration::table<BatteryChemistry::LiIon>.centiPercent[0] == 0, "empty below the curve");
+static_assert(BatteryCalibration::table<BatteryChemistry::LiIon>.centiPercent[maxCounts] == 10000, "full at full scale");
+static_assert(centiPercentAt<BatteryChemistry::LiIon>(4300) == 10000, "full above the curve");
+
+void setUp() {}
+
+void tearDown() {}
+
+// The 18650 resting voltages of the Li-ion curve, kept apart from the header as the reference
+const float referenceVolts[] = {3.27f, 3.61f, 3.69f, 3.71f, 3.73f, 3.75f, 3.77f, 3.79f, 3.80f, 3.82f, 3.84f,
+                                3.85f, 3.87f, 3.91f, 3.95f, 3.98f, 4.02f, 4.08f, 4.11f, 4.15f, 4.20f};
+
+// esp_adc_cal_raw_to_voltage() for ADC1 at 11 dB in floating point, then the 36k/10k divider
+float referenceBatteryVolts(float counts, float vrefMv = 1100) {
+    float pinMv = counts * vrefMv * 196602.0f / 4096.0f / 65536.0f + 142.0f;
+    return pinMv * (36.0f + 10.0f) / 10.0f / 1000.0f;
+}
+
+// Percentage along the reference curve, 5 percentage points per step
+float referencePercentage(float volts) {
+    const int count = sizeof(referenceVolts) / sizeof(referenceVolts[0]);
+    if (volts <= referenceVolts[0]) {
+        return 0;
+    }
+    for (int i = 1; i < count; ++i) {
+        if (volts <= referenceVolts[i]) {
+            float fraction = (volts - referenceVolts[i - 1]) / (referenceVolts[i] - referenceVolts[i - 1]);
+            return (i - 1 + fraction) * 5.0f;
+        }
+    }
+    return 100;
+}
+
+void test_millivolts_match_esp_adc_cal() {
+    for (uint32_t countsQ4 = 0; countsQ4 <= maxCounts * countsScale; countsQ4 += 3) {
+        float expectedMv = referenceBatteryVolts(countsQ4 / static_cast<float>(countsScale)) * 1000;
+        TEST_ASSERT_FLOAT_WITHIN(1.0, expectedMv, batteryMillivolts(countsQ4));
+    }
+    // A module whose eFuse reads 1150 mV
+    TEST_ASSERT_FLOAT_WITHIN(1.0, referenceBatteryVolts(2000, 1150) * 1000, batteryMillivolts(2000 * countsScale, 1150));
+}
+
+void test_curve_points_map_exactly() {
+    for (const BatteryCalibration::CurvePoint& point : BatteryCalibration::Curve<BatteryChemistry::LiIon>::points) {
+        TEST_ASSERT_EQUAL(point.centiPercent, centiPercentAt<BatteryChemistry::LiIon>(point.millivolts));
+    }
+    TEST_ASSERT_EQUAL(0, centiPercentAt<BatteryChemistry::LiIon>(3000));
+    TEST_ASSERT_EQUAL(6250, centiPercentAt<BatteryChemistry::LiIon>(3890)); // Halfway between two points
+}
+
+void test_table_matches_reference_curve() {
+    float maxError = 0;
+    for (uint32_t counts = 0; counts <= maxCounts; ++counts) {
+        float expected = referencePercentage(referenceBatteryVolts(counts));
+        float error = std::fabs(BatteryCalibration::table<BatteryChemistry::LiIon>.centiPercent[counts] / 100.0f - expected);
+        maxError = error > maxError ? error : maxError;
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "largest table error against the float reference: %.3f percentage points", maxError);
+    TEST_MESSAGE(line);
+    // Rounding to whole millivolts costs at most 0.25 points where the curve is steepest
+    TEST_ASSERT_TRUE(maxError <= 0.3f);
+}
+
+void test_fractional_counts_interpolate() {
+    for (uint32_t countsQ4 = 800 * countsScale; countsQ4 < 920 * countsScale; ++countsQ4) {
+        float expected = referencePercentage(referenceBatteryVolts(countsQ4 / static_cast<float>(countsScale)));
+        TEST_ASSERT_FLOAT_WITHIN(0.3, expected, centiPercentFromCounts(countsQ4) / 100.0f);
+    }
+    TEST_ASSERT_EQUAL(10000, centiPercentFromCounts(maxCounts * countsScale + 15)); // Clamped to the last entry
+}
+
+void test_table_is_monotonic() {
+    const uint16_t* entries = BatteryCalibration::table<BatteryChemistry::LiIon>.centiPercent;
+    for (uint32_t counts = 1; counts <= maxCounts; ++counts) {
+        TEST_ASSERT_TRUE(entries[counts] >= entries[counts - 1]);
+    }
+}
+
+void test_curve_reads_lower_than_linear_mid_discharge() {
+    // 3.7 V is two thirds of the way from 2.7 to 4.2 V, but little of a Li-ion cell's charge is left
+    TEST_ASSERT_EQUAL(1250, centiPercentAt<BatteryChemistry::LiIon>(3700));
+}
+
+void test_lifepo4_curve() {
+    TEST_ASSERT_EQUAL(7000, centiPercentAt<BatteryChemistry::LiFePO4>(3300));
+    TEST_ASSERT_EQUAL(10000, centiPercentAt<BatteryChemistry::LiFePO4>(3600));
+    uint32_t countsQ4 = 700 * countsScale; // About 3.25 V at the battery
+    TEST_ASSERT_TRUE(centiPercentFromCounts<BatteryChemistry::LiFePO4>(countsQ4) > 1500);
+    TEST_ASSERT_EQUAL(0, centiPercentFromCounts<BatteryChemistry::LiIon>(countsQ4));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_millivolts_match_esp_adc_cal);
+    RUN_TEST(test_curve_points_map_exactly);
+    RUN_TEST(test_table_matches_reference_curve);
+    RUN_TEST(test_fractional_counts_interpolate);
+    RUN_TEST(test_table_is_monotonic);
+    RUN_TEST(test_curve_reads_lower_than_linear_mid_discharge);
+    RUN_TEST(test_lifepo4_curve);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -1,59 +1,214 @@
-#include <Arduino.h>
 #include <unity.h>
 #include "BatteryZenerSensor.h"
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+const int batteryPin = 36;
+const int controlPin = 2;
+
+BatteryZenerSensor ZenerSensor(4.2, 3.0, batteryPin, controlPin, 100);
 
-// Mock analogRead for testing
-int mockAnalogReadValue = 0;
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+}
+
+void tearDown() {}
 
-int analogRead(int pin) {
-    return mockAnalogReadValue; // Return the mock value
+#ifndef ARDUINO
+// The simulated ADC stands in for the old analogRead() mock
+void setMockAnalogRead(int value) {
+    Hal::Sim::setAnalogValue(batteryPin, value);
 }
 
-BatteryZenerSensor ZenerSensor(4.2, 3.0, A0, 2);
+// Percentage of a steady pin along the Li-ion curve; test_BatteryCalibration checks the curve itself
+float expectedPercentage(uint32_t counts) {
+    uint32_t millivolts = BatteryCalibration::batteryMillivolts(counts * BatteryCalibration::countsScale);
+    return BatteryCalibration::centiPercentAt<BatteryChemistry::LiIon>(millivolts) / 100.0f;
+}
 
 void test_sensor_initialization_success() {
-    Serial.println("Running test_sensor_initialization_success");
-    mockAnalogReadValue = 2048; // Simulate valid ADC value
+    setMockAnalogRead(2048); // Simulate valid ADC value
     TEST_ASSERT_TRUE(ZenerSensor.begin());
     TEST_ASSERT_EQUAL_STRING("", ZenerSensor.getErrorMessage());
-    Serial.println("test_sensor_initialization_success complete");
+    TEST_ASSERT_TRUE(Hal::Sim::getPinMode(controlPin) == Hal::PinMode::Output);
+    TEST_ASSERT_TRUE(Hal::Sim::getDigitalOutput(controlPin)); // Sensor enabled
 }
 
 void test_sensor_initialization_failure() {
-    Serial.println("Running test_sensor_initialization_failure");
-    mockAnalogReadValue = -1; // Simulate ADC failure
+    setMockAnalogRead(-1); // Simulate ADC failure
     TEST_ASSERT_FALSE(ZenerSensor.begin());
     TEST_ASSERT_EQUAL_STRING("Failed to initialize battery sensor!", ZenerSensor.getErrorMessage());
-    Serial.println("test_sensor_initialization_failure complete");
 }
 
 void test_get_reading_valid() {
-    Serial.println("Running test_get_reading_valid");
-    mockAnalogReadValue = 2048; // Simulate ADC value
+    setMockAnalogRead(917); // About 4.05 V at the battery behind the 36k/10k divider
     ZenerSensor.begin();
-    float expectedVoltage = (2048 / 4095.0) * 3.3;
-    float expectedPercentage = ((expectedVoltage - 3.0) / (4.2 - 3.0)) * 100;
 
-    TEST_ASSERT_FLOAT_WITHIN(0.1, expectedPercentage, ZenerSensor.getReading());
-    Serial.println("test_get_reading_valid complete");
+    TEST_ASSERT_FLOAT_WITHIN(0.01, expectedPercentage(917), ZenerSensor.getReading());
+    TEST_ASSERT_EQUAL(1, Hal::Sim::getAnalogReadCount(batteryPin)); // Only begin(); the average is streamed
+    TEST_ASSERT_EQUAL(100, Hal::Sim::getAdcStreamSampleCount());
+    TEST_ASSERT_FALSE(Hal::Sim::isAdcStreamRunning());
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 82.7, ZenerSensor.getReading()); // A straight line from 3.0 V would read 87.6
 }
 
-void setup() {
-    Serial.begin(115200); // Start Serial for debug
-    delay(2000); // Give time to open serial monitor
+void test_get_reading_falls_back_to_analog_read() {
+    Hal::Sim::setAdcStreamSupported(false);
+    setMockAnalogRead(917);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, expectedPercentage(917), ZenerSensor.getReading());
+    TEST_ASSERT_EQUAL(64, Hal::Sim::getAnalogReadCount(batteryPin)); // A noiseless pin stops at the minimum
+    TEST_ASSERT_EQUAL(64, ZenerSensor.getSamplesUsed());
+}
 
-    UNITY_BEGIN();
+void test_async_readings_are_per_sensor() {
+    const int otherPin = 39;
+    BatteryZenerSensor other(4.2, 3.0, otherPin, -1, 100);
+    Hal::Sim::useManualClock(true);
+    setMockAnalogRead(4095);
+    Hal::Sim::setAnalogValue(otherPin, 0);
+    bool ready = false;
+
+    // Interleaved like SensorManager polls them; only one can hold the stream
+    for (int i = 0; i < 10; ++i) {
+        TEST_ASSERT_EQUAL_FLOAT(-1, ZenerSensor.getReading(&ready));
+        TEST_ASSERT_EQUAL_FLOAT(-1, other.getReading(&ready));
+        Hal::delay(5);
+    }
+    ready = true;
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, ZenerSensor.getReading(&ready));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, other.getReading(&ready));
+    TEST_ASSERT_EQUAL_FLOAT(-1, ZenerSensor.getReading(&ready)); // Nothing sampled since
+    TEST_ASSERT_FALSE(Hal::Sim::isAdcStreamRunning());
+}
 
+void test_get_reading_clamps_to_range() {
+    setMockAnalogRead(4095); // Above battVoltHigh after the divider
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, ZenerSensor.getReading());
+    setMockAnalogRead(0);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, ZenerSensor.getReading());
+    setMockAnalogRead(700); // About 3.25 V: above battVoltLow, below the curve's empty point
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, ZenerSensor.getReading());
+}
+
+void test_reads_one_battery_channel() {
+    setMockAnalogRead(917);
+    TEST_ASSERT_EQUAL(1, ZenerSensor.getChannelCount());
+    TEST_ASSERT_EQUAL_STRING("battery", ZenerSensor.getChannelInfo(0).name);
+    TEST_ASSERT_TRUE(ZenerSensor.getChannelInfo(0).unit == Reading::Unit::Percent);
+
+    float values[1];
+    TEST_ASSERT_TRUE(ZenerSensor.readChannels(values));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, expectedPercentage(917), values[0]);
+}
+
+struct AdaptiveRun {
+    uint32_t samples; // Average per reading
+    float ms;         // Simulated time per reading
+};
+
+// Gaussian noise (sum of 12 uniforms) derived from the sample time, so every run sees the same samples
+float noiseAt(uint64_t us) {
+    uint64_t state = us * 0x9E3779B97F4A7C15ULL + 1;
+    float sum = 0;
+    for (int i = 0; i < 12; ++i) {
+        state ^= state >> 33;
+        state *= 0xff51afd7ed558ccdULL;
+        state ^= state >> 33;
+        sum += (state & 0xffff) / 65536.0f;
+    }
+    return sum - 6.0f;
+}
+
+// Readings of a 4.05 V battery under ADC noise from quiet to very noisy, streamed and through the
+// analogRead() fallback (about 10 us a call on the ESP32). Reports the samples a reading averaged
+// and its time against a fixed 10k samples: 512 ms streamed, 100 ms of busy CPU in the old loop
+AdaptiveRun runReadings(BatteryZenerSensor& sensor, int readings, float expected) {
+    uint32_t samples = 0;
+    uint64_t startUs = Hal::Sim::nowMicros();
+    for (int i = 0; i < readings; ++i) {
+        // 2 mV at the battery is 0.17 percentage points on this part of the curve; allow for a few standard errors
+        TEST_ASSERT_FLOAT_WITHIN(1.0, expected, sensor.getReading());
+        samples += sensor.getSamplesUsed();
+    }
+    return AdaptiveRun{samples / readings, (Hal::Sim::nowMicros() - startUs) / 1000.0f / readings};
+}
+
+void test_adaptive_samples_follow_noise() {
+    struct Profile {
+        const char* name;
+        float sigmaCounts;
+    };
+    const Profile profiles[] = {{"quiet", 1}, {"typical", 8}, {"noisy", 30}, {"very noisy", 120}};
+    const float trueCounts = 917;
+    const float expected = expectedPercentage(917);
+    BatteryZenerSensor sensor(4.2, 3.0, batteryPin, -1, 10000, 2.0f);
+    Hal::Sim::useManualClock(true);
+    Hal::Sim::setAnalogReadCost(10);
+    uint32_t previousSamples = 0;
+
+    for (const Profile& profile : profiles) {
+        float sigma = profile.sigmaCounts;
+        Hal::Sim::setAnalogSource(batteryPin, [sigma, trueCounts](uint8_t, uint64_t nowUs) {
+            return static_cast<int>(trueCounts + sigma * noiseAt(nowUs) + 0.5f);
+        });
+        Hal::Sim::setAdcStreamSupported(true);
+        AdaptiveRun streamed = runReadings(sensor, 10, expected);
+        Hal::Sim::setAdcStreamSupported(false);
+        AdaptiveRun looped = runReadings(sensor, 10, expected);
+
+        char line[160];
+        snprintf(line, sizeof(line), "%-10s (sigma %3d): streamed %5u samples %5.1f ms (10k: 512 ms), analogRead %5u samples %5.1f ms (10k: 100 ms)",
+                 profile.name, static_cast<int>(sigma), static_cast<unsigned>(streamed.samples), streamed.ms,
+                 static_cast<unsigned>(looped.samples), looped.ms);
+        TEST_MESSAGE(line);
+        TEST_ASSERT_TRUE(streamed.samples >= previousSamples); // Noisier takes more samples
+        previousSamples = streamed.samples;
+    }
+    TEST_ASSERT_EQUAL(10000, previousSamples); // The noisiest profile hits the cap
+}
+#else
+void test_sensor_initialization_on_device() {
+    TEST_ASSERT_TRUE(ZenerSensor.begin()); // The ADC returns a count even on a floating pin
+    TEST_ASSERT_EQUAL_STRING("", ZenerSensor.getErrorMessage());
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+#ifndef ARDUINO
     RUN_TEST(test_sensor_initialization_success);
     RUN_TEST(test_sensor_initialization_failure);
     RUN_TEST(test_get_reading_valid);
+    RUN_TEST(test_get_reading_clamps_to_range);
+    RUN_TEST(test_get_reading_falls_back_to_analog_read);
+    RUN_TEST(test_async_readings_are_per_sensor);
+    RUN_TEST(test_reads_one_battery_channel);
+    RUN_TEST(test_adaptive_samples_follow_noise);
+#else
+    RUN_TEST(test_sensor_initialization_on_device);
+#endif
+    return UNITY_END();
+}
 
-    UNITY_END();
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
 
-    delay(1000); // Allow time for Unity to finish
-    ESP.restart(); // Restart the ESP32
+    runUnityTests();
 }
 
 void loop() {
     // Unity runs tests in setup()
 }
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,115 @@
+#include <unity.h>
+#include "DHTFrame.h"
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+void setUp() {}
+
+void tearDown() {}
+
+// The line as a capture sees it: the rest of the start signal, the pull-up, the sensor's
+// 80/80 us response, 40 bits and the final low
+std::vector<Hal::Pulse> framePulses(const uint8_t bytes[5], uint16_t zeroUs = 27, uint16_t oneUs = 70, uint16_t lowUs = 50) {
+    std::vector<Hal::Pulse> pulses = {{10, false}, {30, true}, {80, false}, {80, true}};
+    for (size_t bit = 0; bit < 40; ++bit) {
+        bool one = (bytes[bit / 8] & (0x80 >> (bit % 8))) != 0;
+        pulses.push_back({lowUs, false});
+        pulses.push_back({one ? oneUs : zeroUs, true});
+    }
+    pulses.push_back({lowUs, false});
+    return pulses;
+}
+
+// 65.2 %RH and 23.4 C from a DHT22, with the timing spread of a real sensor
+const Hal::Pulse jitteredCapture[] = {
+    {12, false}, {31, true}, {81, false}, {79, true}, {53, false}, {24, true}, {54, false}, {28, true},
+    {48, false}, {23, true}, {49, false}, {25, true}, {48, false}, {27, true}, {51, false}, {23, true},
+    {49, false}, {71, true}, {54, false}, {23, true}, {51, false}, {68, true}, {54, false}, {23, true},
+    {49, false}, {24, true}, {48, false}, {27, true}, {54, false}, {68, true}, {51, false}, {68, true},
+    {50, false}, {25, true}, {54, false}, {24, true}, {49, false}, {27, true}, {52, false}, {27, true},
+    {50, false}, {23, true}, {51, false}, {25, true}, {49, false}, {27, true}, {49, false}, {27, true},
+    {48, false}, {27, true}, {51, false}, {26, true}, {54, false}, {74, true}, {53, false}, {71, true},
+    {55, false}, {70, true}, {52, false}, {24, true}, {50, false}, {73, true}, {51, false}, {23, true},
+    {52, false}, {72, true}, {55, false}, {25, true}, {55, false}, {25, true}, {49, false}, {68, true},
+    {54, false}, {69, true}, {53, false}, {69, true}, {55, false}, {71, true}, {48, false}, {28, true},
+    {49, false}, {29, true}, {53, false}, {25, true}, {52, false},
+};
+
+void test_decodes_jittered_capture() {
+    DHTFrame::Reading reading;
+    size_t count = sizeof(jitteredCapture) / sizeof(jitteredCapture[0]);
+    TEST_ASSERT_TRUE(DHTFrame::decode(jitteredCapture, count, DHTFrame::Model::Dht22, reading) == DHTFrame::Status::Ok);
+    TEST_ASSERT_EQUAL_FLOAT(65.2f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(23.4f, reading.temperature);
+}
+
+void test_decodes_dht22_below_zero() {
+    const uint8_t bytes[5] = {0x01, 0xF4, 0x80, 0x65, 0xDA}; // 50.0 %RH, -10.1 C
+    std::vector<Hal::Pulse> pulses = framePulses(bytes);
+    DHTFrame::Reading reading;
+    TEST_ASSERT_TRUE(DHTFrame::decode(pulses.data(), pulses.size(), DHTFrame::Model::Dht22, reading) == DHTFrame::Status::Ok);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(-10.1f, reading.temperature);
+}
+
+void test_decodes_dht11() {
+    const uint8_t bytes[5] = {45, 0, 22, 3, 70}; // 45 %RH, 22.3 C
+    std::vector<Hal::Pulse> pulses = framePulses(bytes);
+    DHTFrame::Reading reading;
+    TEST_ASSERT_TRUE(DHTFrame::decode(pulses.data(), pulses.size(), DHTFrame::Model::Dht11, reading) == DHTFrame::Status::Ok);
+    TEST_ASSERT_EQUAL_FLOAT(45.0f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(22.3f, reading.temperature);
+}
+
+void test_bits_follow_the_low_before_them() {
+    // A sensor whose clock runs 30 % slow: its 0s are 35 us, beyond the datasheet's 26-28 us
+    const uint8_t bytes[5] = {0x02, 0x8C, 0x00, 0xEA, 0x78};
+    std::vector<Hal::Pulse> pulses = framePulses(bytes, 35, 91, 65);
+    uint8_t decoded[5];
+    TEST_ASSERT_TRUE(DHTFrame::bitsFromPulses(pulses.data(), pulses.size(), decoded) == DHTFrame::Status::Ok);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, decoded, 5);
+}
+
+void test_rejects_bad_captures() {
+    const uint8_t bytes[5] = {0x02, 0x8C, 0x00, 0xEA, 0x78};
+    std::vector<Hal::Pulse> pulses = framePulses(bytes);
+    DHTFrame::Reading reading;
+    TEST_ASSERT_TRUE(DHTFrame::decode(pulses.data(), 0, DHTFrame::Model::Dht22, reading) == DHTFrame::Status::NoResponse);
+
+    // Cut short after 30 bits
+    TEST_ASSERT_TRUE(DHTFrame::decode(pulses.data(), 4 + 60, DHTFrame::Model::Dht22, reading) == DHTFrame::Status::TooShort);
+
+    // One bit flipped on the wire
+    pulses[4 + 2 * 8 + 1].us = 27;
+    TEST_ASSERT_TRUE(DHTFrame::decode(pulses.data(), pulses.size(), DHTFrame::Model::Dht22, reading) == DHTFrame::Status::Checksum);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_decodes_jittered_capture);
+    RUN_TEST(test_decodes_dht22_below_zero);
+    RUN_TEST(test_decodes_dht11);
+    RUN_TEST(test_bits_follow_the_low_before_them);
+    RUN_TEST(test_rejects_bad_captures);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,236 @@
+#include <unity.h>
+#include "DHTReader.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#include <ctime>
+#endif
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+}
+
+void tearDown() {}
+
+#ifndef ARDUINO
+// What the line does after the start signal: the sensor's 80/80 us response, 40 bits and the
+// final low
+std::vector<Hal::Pulse> framePulses(float humidity, float temperature) {
+    uint16_t h = static_cast<uint16_t>(humidity * 10 + 0.5f);
+    uint16_t t = static_cast<uint16_t>((temperature < 0 ? -temperature : temperature) * 10 + 0.5f) | (temperature < 0 ? 0x8000 : 0);
+    uint8_t bytes[5] = {static_cast<uint8_t>(h >> 8), static_cast<uint8_t>(h), static_cast<uint8_t>(t >> 8), static_cast<uint8_t>(t), 0};
+    bytes[4] = static_cast<uint8_t>(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+
+    std::vector<Hal::Pulse> pulses = {{30, true}, {80, false}, {80, true}};
+    for (size_t bit = 0; bit < 40; ++bit) {
+        bool one = (bytes[bit / 8] & (0x80 >> (bit % 8))) != 0;
+        pulses.push_back({50, false});
+        pulses.push_back({static_cast<uint16_t>(one ? 70 : 27), true});
+    }
+    pulses.push_back({50, false});
+    return pulses;
+}
+
+uint64_t durationUs(const std::vector<Hal::Pulse>& pulses) {
+    uint64_t total = 0;
+    for (const Hal::Pulse& pulse : pulses) {
+        total += pulse.us;
+    }
+    return total;
+}
+
+void test_reads_both_values_in_one_transaction() {
+    Hal::Sim::useManualClock(true);
+    std::vector<Hal::Pulse> frame = framePulses(48.5f, 21.3f);
+    Hal::Sim::setPulseResponse(26, frame);
+    DHTReader reader(26);
+    TEST_ASSERT_TRUE(reader.begin());
+
+    DHTFrame::Reading reading;
+    TEST_ASSERT_TRUE(reader.read(reading));
+    TEST_ASSERT_EQUAL_FLOAT(48.5f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(21.3f, reading.temperature);
+    TEST_ASSERT_EQUAL(1, Hal::Sim::getPulseCaptureCount(26));
+    TEST_ASSERT_EQUAL(2000 + durationUs(frame), Hal::Sim::nowMicros()); // Start signal, then the frame
+}
+
+void test_reads_within_interval_return_last_frame() {
+    Hal::Sim::useManualClock(true);
+    Hal::Sim::setPulseResponse(26, framePulses(48.5f, -4.2f));
+    DHTReader reader(26);
+    TEST_ASSERT_TRUE(reader.begin());
+    DHTFrame::Reading reading;
+    TEST_ASSERT_TRUE(reader.read(reading));
+    TEST_ASSERT_EQUAL_FLOAT(-4.2f, reading.temperature);
+
+    Hal::Sim::setPulseResponse(26, framePulses(50.0f, -4.0f));
+    Hal::Sim::advanceMillis(1000);
+    TEST_ASSERT_TRUE(reader.read(reading));
+    TEST_ASSERT_EQUAL_FLOAT(-4.2f, reading.temperature); // A DHT22 needs 2 s between transactions
+    TEST_ASSERT_EQUAL(1, Hal::Sim::getPulseCaptureCount(26));
+
+    Hal::Sim::advanceMillis(1000);
+    TEST_ASSERT_TRUE(reader.read(reading));
+    TEST_ASSERT_EQUAL_FLOAT(-4.0f, reading.temperature);
+    TEST_ASSERT_EQUAL(2, Hal::Sim::getPulseCaptureCount(26));
+}
+
+void test_missing_sensor_times_out() {
+    Hal::Sim::useManualClock(true);
+    DHTReader reader(27);
+    TEST_ASSERT_TRUE(reader.begin());
+    DHTFrame::Reading reading;
+    TEST_ASSERT_FALSE(reader.read(reading));
+    TEST_ASSERT_TRUE(reader.getLastStatus() == DHTFrame::Status::NoResponse);
+    TEST_ASSERT_EQUAL((2 + DHT_READ_TIMEOUT_MS) * 1000, Hal::Sim::nowMicros());
+}
+
+void test_begin_fails_without_free_channel() {
+    Hal::Sim::setPulseCaptureChannels(1);
+    DHTReader second(27);
+    {
+        DHTReader first(26);
+        TEST_ASSERT_TRUE(first.begin());
+        TEST_ASSERT_FALSE(second.begin());
+        DHTFrame::Reading reading;
+        TEST_ASSERT_FALSE(second.read(reading));
+        TEST_ASSERT_EQUAL(0, Hal::Sim::getPulseCaptureCount(27));
+    }
+    TEST_ASSERT_TRUE(second.begin()); // The first reader gave its channel back
+}
+
+void test_read_all_runs_transactions_together() {
+    Hal::Sim::useManualClock(true);
+    const uint8_t pins[] = {25, 26, 27, 32};
+    std::vector<std::unique_ptr<DHTReader>> owned;
+    std::vector<DHTReader*> readers;
+    uint64_t longestUs = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        std::vector<Hal::Pulse> frame = framePulses(40.0f + i, 20.0f + i);
+        longestUs = durationUs(frame) > longestUs ? durationUs(frame) : longestUs;
+        Hal::Sim::setPulseResponse(pins[i], frame);
+        owned.emplace_back(new DHTReader(pins[i]));
+        TEST_ASSERT_TRUE(owned.back()->begin());
+        readers.push_back(owned.back().get());
+    }
+
+    TEST_ASSERT_EQUAL(4, DHTReader::readAll(readers.data(), readers.size()));
+    for (uint8_t i = 0; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_FLOAT(20.0f + i, readers[i]->getLastReading().temperature);
+        TEST_ASSERT_EQUAL_FLOAT(40.0f + i, readers[i]->getLastReading().humidity);
+    }
+    TEST_ASSERT_EQUAL(2000 + longestUs, Hal::Sim::nowMicros()); // As long as one read
+}
+
+// CPU time the calling thread used, which sleeping does not count
+uint64_t threadCpuMicros() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// The Adafruit driver's read: the start signal held with delayMicroseconds(1100), then the frame
+// polled with interrupts off; both spin the CPU for their whole length
+void bitBangRead(uint64_t frameUs) {
+    uint64_t startUs = Hal::Sim::nowMicros();
+    while (Hal::Sim::nowMicros() - startUs < 1100 + frameUs) {
+    }
+}
+
+void report(const char* name, uint64_t cpuUs, uint64_t wallUs, int reads) {
+    char line[128];
+    snprintf(line, sizeof(line), "%-28s cpu %5u us/read, wall %5u us/read", name,
+             static_cast<unsigned>(cpuUs / reads), static_cast<unsigned>(wallUs / reads));
+    TEST_MESSAGE(line);
+}
+
+void test_cpu_blocked_time_per_read() {
+    const int reads = 20;
+    const uint8_t pins[] = {25, 26, 27, 32};
+    std::vector<Hal::Pulse> frame = framePulses(48.5f, 21.3f);
+    for (uint8_t pin : pins) {
+        Hal::Sim::setPulseResponse(pin, frame);
+    }
+
+    uint64_t cpuStart = threadCpuMicros();
+    uint64_t wallStart = Hal::Sim::nowMicros();
+    for (int i = 0; i < reads; ++i) {
+        bitBangRead(durationUs(frame));
+    }
+    uint64_t bitBangCpu = threadCpuMicros() - cpuStart;
+    uint64_t bitBangWall = Hal::Sim::nowMicros() - wallStart;
+
+    // A fresh reader for each read, since one reader would serve reads within 2 s from its last frame
+    cpuStart = threadCpuMicros();
+    wallStart = Hal::Sim::nowMicros();
+    int valid = 0;
+    for (int i = 0; i < reads; ++i) {
+        DHTReader reader(pins[0]);
+        DHTFrame::Reading reading;
+        valid += reader.begin() && reader.read(reading) ? 1 : 0;
+    }
+    uint64_t captureCpu = threadCpuMicros() - cpuStart;
+    uint64_t captureWall = Hal::Sim::nowMicros() - wallStart;
+    TEST_ASSERT_EQUAL(reads, valid);
+
+    // Four sensors a round
+    cpuStart = threadCpuMicros();
+    wallStart = Hal::Sim::nowMicros();
+    valid = 0;
+    for (int i = 0; i < reads / 4; ++i) {
+        DHTReader a(pins[0]), b(pins[1]), c(pins[2]), d(pins[3]);
+        DHTReader* readers[] = {&a, &b, &c, &d};
+        for (DHTReader* reader : readers) {
+            reader->begin();
+        }
+        valid += static_cast<int>(DHTReader::readAll(readers, 4));
+    }
+    uint64_t parallelCpu = threadCpuMicros() - cpuStart;
+    uint64_t parallelWall = Hal::Sim::nowMicros() - wallStart;
+    TEST_ASSERT_EQUAL(reads, valid);
+
+    report("bit-banged (Adafruit model)", bitBangCpu, bitBangWall, reads);
+    report("capture, one at a time", captureCpu, captureWall, reads);
+    report("capture, 4 at a time", parallelCpu, parallelWall, reads);
+
+    TEST_ASSERT_TRUE(captureCpu * 10 < bitBangCpu);
+    TEST_ASSERT_TRUE(parallelWall * 2 < captureWall);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+#ifndef ARDUINO
+    RUN_TEST(test_reads_both_values_in_one_transaction);
+    RUN_TEST(test_reads_within_interval_return_last_frame);
+    RUN_TEST(test_missing_sensor_times_out);
+    RUN_TEST(test_begin_fails_without_free_channel);
+    RUN_TEST(test_read_all_runs_transactions_together);
+    RUN_TEST(test_cpu_blocked_time_per_read);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,170 @@
+#include <unity.h>
+#include "LatestValue.h"
+#include <atomic>
+#include <cstdint>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+// The stress test is meant to run under ThreadSanitizer as well, which reports any unsynchronized
+// access between the writer and reader threads:
+//   build_flags = -std=gnu++17 -pthread -fsanitize=thread -g
+// in a native environment (the flag is needed when linking too).
+
+// Same layout as SensorManager's SensorData, which needs the DHT driver to include
+struct Reading {
+    float temperature;
+    float humidity;
+    bool isValid;
+    unsigned long lastReadTime;
+};
+
+struct Odd {
+    uint8_t bytes[7];
+};
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+}
+
+void tearDown() {}
+
+void test_load_before_first_store_is_zero() {
+    LatestValue<Reading> latest;
+    Reading reading = latest.load();
+    TEST_ASSERT_EQUAL_FLOAT(0, reading.temperature);
+    TEST_ASSERT_FALSE(reading.isValid);
+    TEST_ASSERT_EQUAL(0, latest.getStoreCount());
+}
+
+void test_load_returns_last_store() {
+    LatestValue<Reading> latest(Reading{1.0f, 2.0f, false, 3});
+    latest.store(Reading{21.5f, 48.0f, true, 1234});
+    Reading reading = latest.load();
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, reading.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(48.0f, reading.humidity);
+    TEST_ASSERT_TRUE(reading.isValid);
+    TEST_ASSERT_EQUAL(1234, reading.lastReadTime);
+    TEST_ASSERT_EQUAL(2, latest.getStoreCount());
+}
+
+void test_sizes_that_are_not_whole_words() {
+    LatestValue<Odd> latest;
+    Odd odd = {{1, 2, 3, 4, 5, 6, 7}};
+    latest.store(odd);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(odd.bytes, latest.load().bytes, sizeof(odd.bytes));
+}
+
+#ifndef ARDUINO
+const int valueCount = 4;
+const int readerCount = 4;
+const uint32_t storesPerWriter = 200000;
+
+LatestValue<Reading> values[valueCount];
+std::atomic<int> tasksReady{0};
+std::atomic<bool> started{false}; // Set once every task is up, so none can run ahead of the others
+std::atomic<int> writersDone{0};
+std::atomic<int> readersDone{0};
+std::atomic<uint32_t> tornReads{0};
+std::atomic<uint32_t> staleReads{0};
+std::atomic<uint64_t> totalReads{0};
+
+void waitForStart() {
+    tasksReady.fetch_add(1);
+    while (!started.load()) {
+        Hal::delay(1);
+    }
+}
+
+// Every field follows from one counter, so a reading made of two stores is easy to spot
+void writerTask(void* parameters) {
+    LatestValue<Reading>& latest = values[reinterpret_cast<intptr_t>(parameters)];
+    waitForStart();
+    for (uint32_t n = 1; n <= storesPerWriter; ++n) {
+        latest.store(Reading{static_cast<float>(n), static_cast<float>(n) * 2, (n & 1) == 1, n});
+    }
+    writersDone.fetch_add(1);
+}
+
+void readerTask(void*) {
+    unsigned long seen[valueCount] = {};
+    uint64_t reads = 0;
+    waitForStart();
+    // At least one pass, even if the writers are done before this task gets the CPU again
+    do {
+        for (int i = 0; i < valueCount; ++i) {
+            Reading reading = values[i].load();
+            unsigned long n = reading.lastReadTime;
+            if (reading.temperature != static_cast<float>(n) || reading.humidity != static_cast<float>(n) * 2 ||
+                reading.isValid != ((n & 1) == 1)) {
+                tornReads.fetch_add(1);
+            }
+            if (n < seen[i]) {
+                staleReads.fetch_add(1); // Went back to an older store
+            }
+            seen[i] = n;
+            reads++;
+        }
+    } while (writersDone.load() < valueCount);
+    totalReads.fetch_add(reads);
+    readersDone.fetch_add(1);
+}
+
+void test_concurrent_readers_never_see_torn_values() {
+    for (int i = 0; i < readerCount; ++i) {
+        TEST_ASSERT_TRUE(Hal::startTask("Reader", readerTask));
+    }
+    for (intptr_t i = 0; i < valueCount; ++i) {
+        TEST_ASSERT_TRUE(Hal::startTask("Writer", writerTask, reinterpret_cast<void*>(i)));
+    }
+    // Threads need not start in launch order; release them together once all are waiting
+    while (tasksReady.load() < readerCount + valueCount) {
+        Hal::delay(1);
+    }
+    started.store(true);
+    while (readersDone.load() < readerCount) {
+        Hal::delay(1);
+    }
+
+    TEST_ASSERT_EQUAL(0, tornReads.load());
+    TEST_ASSERT_EQUAL(0, staleReads.load());
+    TEST_ASSERT_TRUE(totalReads.load() > 0);
+    for (int i = 0; i < valueCount; ++i) {
+        TEST_ASSERT_EQUAL(storesPerWriter, values[i].load().lastReadTime);
+        TEST_ASSERT_EQUAL(storesPerWriter, values[i].getStoreCount());
+    }
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_load_before_first_store_is_zero);
+    RUN_TEST(test_load_returns_last_store);
+    RUN_TEST(test_sizes_that_are_not_whole_words);
+#ifndef ARDUINO
+    RUN_TEST(test_concurrent_readers_never_see_torn_values);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
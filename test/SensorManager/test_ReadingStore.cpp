@@ -0,0 +1,141 @@
+#include <unity.h>
+#include "ReadingStore.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+void setUp() {}
+
+void tearDown() {}
+
+// Readings of a span, collected in the order forEachSpan() hands them out
+struct Collected {
+    uint32_t timestamps[16];
+    float values[16];
+    size_t count = 0;
+    size_t spans = 0;
+};
+
+template <size_t MaxChannels, size_t Capacity>
+Collected collect(const ReadingStore<MaxChannels, Capacity>& store, size_t index) {
+    Collected out;
+    store.forEachSpan(index, [&out](const uint32_t* timestamps, const float* values, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            out.timestamps[out.count] = timestamps[i];
+            out.values[out.count++] = values[i];
+        }
+        out.spans++;
+    });
+    return out;
+}
+
+void test_appends_in_order() {
+    ReadingStore<2, 4> store;
+    int temperature = store.addChannel(0, 0, Reading::Unit::Celsius, "temp");
+    TEST_ASSERT_EQUAL(0, temperature);
+    store.append(temperature, 1000, 21.5f);
+    store.append(temperature, 3000, 21.7f);
+
+    TEST_ASSERT_EQUAL(2, store.size(temperature));
+    Collected readings = collect(store, temperature);
+    TEST_ASSERT_EQUAL(1, readings.spans);
+    TEST_ASSERT_EQUAL(1000, readings.timestamps[0]);
+    TEST_ASSERT_EQUAL_FLOAT(21.7f, readings.values[1]);
+
+    Reading last;
+    TEST_ASSERT_TRUE(store.latest(temperature, last));
+    TEST_ASSERT_EQUAL(3000, last.timestampMs);
+    TEST_ASSERT_TRUE(last.unit == Reading::Unit::Celsius);
+    TEST_ASSERT_EQUAL_STRING("temp", store.getChannel(temperature).name);
+}
+
+void test_full_channel_overwrites_oldest() {
+    ReadingStore<1, 4> store;
+    int level = store.addChannel(1, 0, Reading::Unit::Percent);
+    for (uint32_t i = 0; i < 6; ++i) {
+        store.append(level, i * 1000, 80.0f + i);
+    }
+
+    TEST_ASSERT_EQUAL(4, store.size(level));
+    TEST_ASSERT_EQUAL(2, store.getOverwritten(level));
+    TEST_ASSERT_EQUAL(2000, store.at(level, 0).timestampMs);
+    TEST_ASSERT_EQUAL_FLOAT(85.0f, store.at(level, 3).value);
+
+    // The ring wrapped, so the readings come as two runs, still oldest first
+    Collected readings = collect(store, level);
+    TEST_ASSERT_EQUAL(2, readings.spans);
+    TEST_ASSERT_EQUAL(4, readings.count);
+    for (size_t i = 0; i < readings.count; ++i) {
+        TEST_ASSERT_EQUAL((i + 2) * 1000, readings.timestamps[i]);
+        TEST_ASSERT_EQUAL_FLOAT(82.0f + i, readings.values[i]);
+    }
+}
+
+void test_channels_are_kept_apart() {
+    ReadingStore<2, 8> store;
+    TEST_ASSERT_TRUE(store.append(Reading{0, 0, Reading::Unit::Celsius, 1000, 21.5f}));
+    TEST_ASSERT_TRUE(store.append(Reading{0, 1, Reading::Unit::Percent, 1000, 48.0f}));
+    TEST_ASSERT_TRUE(store.append(Reading{0, 0, Reading::Unit::Celsius, 3000, 21.6f}));
+    TEST_ASSERT_FALSE(store.append(Reading{1, 0, Reading::Unit::Percent, 3000, 87.0f})); // Both channels taken
+
+    TEST_ASSERT_EQUAL(2, store.getChannelCount());
+    TEST_ASSERT_EQUAL(1, store.findChannel(0, 1));
+    TEST_ASSERT_EQUAL(-1, store.findChannel(1, 0));
+    TEST_ASSERT_EQUAL(1, store.addChannel(0, 1, Reading::Unit::Percent)); // Already there
+    TEST_ASSERT_EQUAL(2, store.size(0));
+    TEST_ASSERT_EQUAL(1, store.size(1));
+    TEST_ASSERT_EQUAL_FLOAT(48.0f, store.at(1, 0).value);
+    TEST_ASSERT_TRUE(store.at(1, 0).unit == Reading::Unit::Percent);
+}
+
+void test_clear_keeps_channels() {
+    ReadingStore<2, 4> store;
+    int temperature = store.addChannel(0, 0, Reading::Unit::Celsius);
+    for (uint32_t i = 0; i < 5; ++i) {
+        store.append(temperature, i, 20.0f);
+    }
+    store.clear();
+
+    Reading last;
+    TEST_ASSERT_FALSE(store.latest(temperature, last));
+    TEST_ASSERT_EQUAL(0, collect(store, temperature).spans);
+    TEST_ASSERT_EQUAL(1, store.getChannelCount());
+
+    store.append(temperature, 10, 22.0f);
+    TEST_ASSERT_EQUAL(10, store.at(temperature, 0).timestampMs);
+    TEST_ASSERT_EQUAL(1, store.size(temperature));
+}
+
+void test_footprint_is_eight_bytes_a_reading() {
+    TEST_ASSERT_EQUAL(8, (ReadingStore<1, 1>::bytesPerReading));
+    // The readings plus a few words of bookkeeping per channel
+    TEST_ASSERT_TRUE(sizeof(ReadingStore<4, 256>) < 4 * 256 * 8 + 4 * 64);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_appends_in_order);
+    RUN_TEST(test_full_channel_overwrites_oldest);
+    RUN_TEST(test_channels_are_kept_apart);
+    RUN_TEST(test_clear_keeps_channels);
+    RUN_TEST(test_footprint_is_eight_bytes_a_reading);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,260 @@
+#include <unity.h>
+#include "SensorDiscovery.h"
+#include <HalFS.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+using SensorType = BaseSensor::SensorType;
+
+HAL_RTC_DATA SensorDiscovery::State testState;
+
+const char* manifestPath = "/test_sensors.bin";
+const std::vector<int> boardPins = {26, 27, 34, 35};
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+    std::memset(&testState, 0, sizeof(testState));
+    LittleFS.begin(true);
+    LittleFS.remove(manifestPath);
+}
+
+void tearDown() {
+    LittleFS.remove(manifestPath);
+}
+
+void test_fingerprint_depends_on_pins_and_order() {
+    uint32_t fingerprint = SensorDiscovery::fingerprintOf({26, 27});
+    TEST_ASSERT_EQUAL(fingerprint, SensorDiscovery::fingerprintOf({26, 27}));
+    TEST_ASSERT_NOT_EQUAL(fingerprint, SensorDiscovery::fingerprintOf({27, 26}));
+    TEST_ASSERT_NOT_EQUAL(fingerprint, SensorDiscovery::fingerprintOf({26}));
+}
+
+#ifndef ARDUINO
+// The simulated board: DHTs on 26 and 27, a battery divider on 34, nothing on 35. Costs are
+// those of the old scanForSensors(): a DHT test read, which times out on a pin without one, then
+// a battery reading of 10,000 ADC samples
+const uint32_t dhtReadMs = 25;
+const uint32_t dhtTimeoutMs = 100;
+const uint32_t batteryReadMs = 100;
+
+std::atomic<int> probeCount{0};
+
+SensorType boardProbe(int pin) {
+    probeCount.fetch_add(1);
+    if (pin == 26 || pin == 27) {
+        Hal::delay(dhtReadMs);
+        return SensorType::DHT;
+    }
+    Hal::delay(dhtTimeoutMs);
+    if (pin == 34) {
+        Hal::delay(batteryReadMs);
+        return SensorType::BatteryZener;
+    }
+    return SensorType::Undefined;
+}
+
+void expectBoard(const std::vector<SensorDiscovery::Found>& found) {
+    TEST_ASSERT_EQUAL(3, found.size());
+    TEST_ASSERT_EQUAL(26, found[0].pin);
+    TEST_ASSERT_TRUE(found[0].type == SensorType::DHT);
+    TEST_ASSERT_EQUAL(27, found[1].pin);
+    TEST_ASSERT_TRUE(found[1].type == SensorType::DHT);
+    TEST_ASSERT_EQUAL(34, found[2].pin);
+    TEST_ASSERT_TRUE(found[2].type == SensorType::BatteryZener);
+}
+
+void test_first_boot_probes_and_caches() {
+    probeCount.store(0);
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    expectBoard(discovery.discover(boardPins));
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Probe);
+    TEST_ASSERT_TRUE(discovery.isComplete());
+    TEST_ASSERT_EQUAL(4, probeCount.load());
+    TEST_ASSERT_TRUE(LittleFS.exists(manifestPath));
+}
+
+void test_warm_wake_uses_rtc_cache() {
+    SensorDiscovery(testState, boardProbe, manifestPath).discover(boardPins);
+    LittleFS.remove(manifestPath); // Not needed while the RTC memory holds
+    Hal::Sim::deepSleep(60ULL * 1000 * 1000);
+
+    probeCount.store(0);
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    expectBoard(discovery.discover(boardPins));
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Rtc);
+    TEST_ASSERT_EQUAL(0, probeCount.load());
+}
+
+void test_cold_boot_uses_manifest() {
+    SensorDiscovery(testState, boardProbe, manifestPath).discover(boardPins);
+    Hal::Sim::powerCycle();
+
+    probeCount.store(0);
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    expectBoard(discovery.discover(boardPins));
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Manifest);
+    TEST_ASSERT_EQUAL(0, probeCount.load());
+
+    // The manifest was copied to RTC memory for the wakes that follow
+    discovery.discover(boardPins);
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Rtc);
+}
+
+void test_changed_pins_probe_again() {
+    SensorDiscovery(testState, boardProbe, manifestPath).discover(boardPins);
+
+    probeCount.store(0);
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    std::vector<SensorDiscovery::Found> found = discovery.discover({26, 35});
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Probe);
+    TEST_ASSERT_EQUAL(2, probeCount.load());
+    TEST_ASSERT_EQUAL(1, found.size());
+    TEST_ASSERT_EQUAL(26, found[0].pin);
+}
+
+void test_corrupt_caches_are_ignored() {
+    SensorDiscovery(testState, boardProbe, manifestPath).discover(boardPins);
+    testState.types[2] = static_cast<uint8_t>(SensorType::DHT); // Bit rot in RTC memory
+
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    expectBoard(discovery.discover(boardPins));
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Manifest);
+
+    // A manifest cut short by a reset while it was written
+    File file = LittleFS.open(manifestPath, FILE_WRITE);
+    file.write(reinterpret_cast<const uint8_t*>(&testState), sizeof(testState) / 2);
+    file.close();
+    Hal::Sim::powerCycle();
+    probeCount.store(0);
+    expectBoard(discovery.discover(boardPins));
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Probe);
+    TEST_ASSERT_EQUAL(4, probeCount.load());
+}
+
+void test_forget_drops_both_caches() {
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    discovery.discover(boardPins);
+    discovery.forget();
+    TEST_ASSERT_FALSE(LittleFS.exists(manifestPath));
+
+    discovery.discover(boardPins);
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Probe);
+}
+
+// A probe that hangs, like a DHT read on a pin that holds the line low
+SensorType hangingProbe(int pin) {
+    Hal::delay(pin == 35 ? 400 : 5);
+    return pin == 35 ? SensorType::DHT : SensorType::BatteryZener;
+}
+
+void test_probe_timeout_bounds_discovery() {
+    SensorDiscovery discovery(testState, hangingProbe, manifestPath);
+    uint32_t startMs = Hal::millis();
+    std::vector<SensorDiscovery::Found> found = discovery.discover({34, 35}, 50);
+    uint32_t elapsedMs = Hal::millis() - startMs;
+
+    TEST_ASSERT_TRUE(elapsedMs >= 50 && elapsedMs < 300);
+    TEST_ASSERT_FALSE(discovery.isComplete());
+    TEST_ASSERT_EQUAL(1, found.size());
+    TEST_ASSERT_EQUAL(34, found[0].pin);
+
+    // Nothing was cached, so the next boot probes the silent pin again
+    TEST_ASSERT_FALSE(LittleFS.exists(manifestPath));
+    discovery.discover({34, 35}, 50);
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Probe);
+}
+
+// Boot until the first sensor has a reading: discovery, then one read of the first sensor
+uint32_t bootToFirstReadingMs(SensorDiscovery& discovery) {
+    uint32_t startMs = Hal::millis();
+    std::vector<SensorDiscovery::Found> found = discovery.discover(boardPins);
+    TEST_ASSERT_FALSE(found.empty());
+    Hal::delay(found[0].type == SensorType::DHT ? dhtReadMs : batteryReadMs);
+    return Hal::millis() - startMs;
+}
+
+// The old scanForSensors(): one pin after the other, then the first reading
+uint32_t serialBootToFirstReadingMs() {
+    uint32_t startMs = Hal::millis();
+    for (int pin : boardPins) {
+        boardProbe(pin);
+    }
+    Hal::delay(dhtReadMs);
+    return Hal::millis() - startMs;
+}
+
+void report(const char* name, uint32_t ms) {
+    char line[96];
+    snprintf(line, sizeof(line), "boot to first reading, %-26s %4u ms", name, static_cast<unsigned>(ms));
+    TEST_MESSAGE(line);
+}
+
+void test_boot_to_first_reading_warm_versus_cold() {
+    uint32_t serialMs = serialBootToFirstReadingMs();
+
+    SensorDiscovery discovery(testState, boardProbe, manifestPath);
+    uint32_t probeMs = bootToFirstReadingMs(discovery);
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Probe);
+
+    Hal::Sim::powerCycle();
+    uint32_t manifestMs = bootToFirstReadingMs(discovery);
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Manifest);
+
+    Hal::Sim::deepSleep(60ULL * 1000 * 1000);
+    uint32_t rtcMs = bootToFirstReadingMs(discovery);
+    TEST_ASSERT_TRUE(discovery.getLastSource() == SensorDiscovery::Source::Rtc);
+
+    report("serial scan (old):", serialMs);
+    report("cold, parallel probe:", probeMs);
+    report("cold, manifest:", manifestMs);
+    report("warm wake, RTC cache:", rtcMs);
+
+    // The parallel probe waits for the slowest pin instead of the sum of all of them
+    TEST_ASSERT_TRUE(probeMs < serialMs);
+    TEST_ASSERT_TRUE(manifestMs < probeMs);
+    TEST_ASSERT_TRUE(rtcMs < probeMs);
+    TEST_ASSERT_TRUE(rtcMs < dhtReadMs + 20);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fingerprint_depends_on_pins_and_order);
+#ifndef ARDUINO
+    RUN_TEST(test_first_boot_probes_and_caches);
+    RUN_TEST(test_warm_wake_uses_rtc_cache);
+    RUN_TEST(test_cold_boot_uses_manifest);
+    RUN_TEST(test_changed_pins_probe_again);
+    RUN_TEST(test_corrupt_caches_are_ignored);
+    RUN_TEST(test_forget_drops_both_caches);
+    RUN_TEST(test_probe_timeout_bounds_discovery);
+    RUN_TEST(test_boot_to_first_reading_warm_versus_cold);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
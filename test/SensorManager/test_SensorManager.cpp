@@ -0,0 +1,75 @@
+#include <unity.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "SensorManager.h" // Needs the DHT driver, so its tests run on the device only
+#include <set>
+#else
+#include <HalSim.h>
+#endif
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+}
+
+void tearDown() {}
+
+#ifdef ARDUINO
+const int batteryPin = 34;
+
+// Distinct reading times of a sensor seen over windowMs
+size_t countReadings(SensorManager& manager, int index, uint32_t windowMs) {
+    std::set<uint32_t> times;
+    uint32_t startMs = Hal::millis();
+    while (Hal::millis() - startMs < windowMs) {
+        Reading reading;
+        if (manager.getReading(index, 0, reading)) {
+            times.insert(reading.timestampMs);
+        }
+        Hal::delay(5);
+    }
+    return times.size();
+}
+
+// On the host, test_SensorScheduler covers setInterval() while run() executes
+void test_refresh_interval_changes_after_start() {
+    // The reading tasks cannot be stopped, so the manager outlives the test
+    SensorManager* manager = new SensorManager();
+    TEST_ASSERT_TRUE(manager->registerSensor(batteryPin));
+    manager->setRefreshInterval(0, 1000);
+    manager->startConcurrentReading();
+    Hal::delay(200);
+    TEST_ASSERT_EQUAL(1, countReadings(*manager, 0, 500)); // The first reading, at start
+
+    manager->setRefreshInterval(0, 100);
+    Hal::delay(400); // The reading scheduled at 1000 ms runs on the old interval
+    TEST_ASSERT_TRUE(countReadings(*manager, 0, 1000) >= 5);
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+#ifdef ARDUINO
+    RUN_TEST(test_refresh_interval_changes_after_start);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
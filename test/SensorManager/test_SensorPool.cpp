@@ -0,0 +1,110 @@
+#include <unity.h>
+#include "SensorPool.h"
+#include "BaseSensor.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+int liveSensors = 0;
+
+class SmallSensor : public BaseSensor {
+public:
+    explicit SmallSensor(int pin) : BaseSensor(pin, "Small") { liveSensors++; }
+    ~SmallSensor() override { liveSensors--; }
+    bool begin() override { return true; }
+    float getReading() const override { return static_cast<float>(sensorPin); }
+};
+
+class LargeSensor : public SmallSensor {
+public:
+    LargeSensor(int pin, double scale) : SmallSensor(pin), scale(scale) {}
+    float getReading() const override { return static_cast<float>(sensorPin * scale); }
+
+    double scale;
+    uint16_t buffer[64] = {};
+};
+
+using Pool = SensorPool<BaseSensor, 3, SmallSensor, LargeSensor>;
+
+static_assert(Pool::slotSize == sizeof(LargeSensor), "slots fit the largest type");
+
+void setUp() {
+    liveSensors = 0;
+}
+
+void tearDown() {}
+
+void test_creates_until_full() {
+    Pool pool;
+    BaseSensor* small = pool.create<SmallSensor>(26);
+    BaseSensor* large = pool.create<LargeSensor>(27, 0.5);
+    TEST_ASSERT_NOT_NULL(small);
+    TEST_ASSERT_NOT_NULL(pool.create<SmallSensor>(28));
+    TEST_ASSERT_NULL(pool.create<SmallSensor>(29));
+    TEST_ASSERT_EQUAL(3, pool.size());
+    TEST_ASSERT_EQUAL(3, liveSensors);
+
+    TEST_ASSERT_EQUAL_FLOAT(26, small->getReading());
+    TEST_ASSERT_EQUAL_FLOAT(13.5f, large->getReading());
+}
+
+void test_destroy_frees_the_slot() {
+    Pool pool;
+    BaseSensor* first = pool.create<LargeSensor>(26, 1.0);
+    pool.create<SmallSensor>(27);
+    pool.create<SmallSensor>(28);
+    pool.destroy(first);
+    TEST_ASSERT_EQUAL(2, liveSensors);
+    TEST_ASSERT_EQUAL(2, pool.size());
+
+    BaseSensor* reused = pool.create<SmallSensor>(29);
+    TEST_ASSERT_EQUAL_PTR(first, reused); // The freed slot
+    TEST_ASSERT_EQUAL_FLOAT(29, reused->getReading());
+}
+
+void test_destroy_ignores_foreign_pointers() {
+    Pool pool;
+    SmallSensor outside(30);
+    pool.create<SmallSensor>(26);
+    pool.destroy(&outside);
+    pool.destroy(nullptr);
+    TEST_ASSERT_EQUAL(1, pool.size());
+    TEST_ASSERT_EQUAL(2, liveSensors);
+}
+
+void test_pool_destroys_what_is_left() {
+    {
+        Pool pool;
+        pool.create<SmallSensor>(26);
+        pool.create<LargeSensor>(27, 2.0);
+        TEST_ASSERT_EQUAL(2, liveSensors);
+    }
+    TEST_ASSERT_EQUAL(0, liveSensors);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_creates_until_full);
+    RUN_TEST(test_destroy_frees_the_slot);
+    RUN_TEST(test_destroy_ignores_foreign_pointers);
+    RUN_TEST(test_pool_destroys_what_is_left);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,338 @@
+#include <unity.h>
+#include "SensorScheduler.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+#endif
+}
+
+void tearDown() {}
+
+#ifndef ARDUINO
+void test_runs_jobs_in_deadline_order() {
+    Hal::Sim::useManualClock(true);
+    std::string order;
+    SensorScheduler scheduler;
+    scheduler.add(300, [&order] { order += 'a'; }, 300);
+    scheduler.add(100, [&order] { order += 'b'; }, 100);
+    scheduler.add(200, [&order] { order += 'c'; }, 200);
+
+    TEST_ASSERT_EQUAL(100, scheduler.runDue(0));
+    for (uint32_t nowMs = 100; nowMs <= 600; nowMs += 100) {
+        scheduler.runDue(nowMs);
+    }
+    TEST_ASSERT_EQUAL_STRING("bcbabcbbcab", order.c_str());
+    TEST_ASSERT_EQUAL(11, scheduler.getStats().runs);
+    TEST_ASSERT_EQUAL(7, scheduler.getStats().wakeups);
+}
+
+void test_returns_time_until_next_deadline() {
+    Hal::Sim::useManualClock(true);
+    SensorScheduler scheduler;
+    TEST_ASSERT_EQUAL(UINT32_MAX, scheduler.runDue(0));
+    scheduler.add(2000, [] {});
+    scheduler.add(30000, [] {}, 500);
+    TEST_ASSERT_EQUAL(500, scheduler.runDue(0));
+    TEST_ASSERT_EQUAL(1500, scheduler.runDue(500));
+    TEST_ASSERT_EQUAL(1, scheduler.runDue(1999)); // Nothing due yet
+}
+
+void test_late_run_keeps_cadence() {
+    Hal::Sim::useManualClock(true);
+    SensorScheduler scheduler;
+    scheduler.add(100, [] {});
+    scheduler.runDue(0);
+    TEST_ASSERT_EQUAL(70, scheduler.runDue(130)); // Due again at 200, not 230
+    TEST_ASSERT_EQUAL(30, scheduler.getStats().maxLateMs);
+    TEST_ASSERT_EQUAL(30, scheduler.getStats().totalLateMs);
+}
+
+void test_falling_behind_skips_missed_runs() {
+    Hal::Sim::useManualClock(true);
+    uint32_t runs = 0;
+    SensorScheduler scheduler;
+    scheduler.add(100, [&runs] { runs++; });
+    scheduler.runDue(0);
+    TEST_ASSERT_EQUAL(50, scheduler.runDue(350)); // One run for 100, 200 and 300, then 400
+    TEST_ASSERT_EQUAL(2, runs);
+    TEST_ASSERT_EQUAL(2, scheduler.getStats().skipped);
+}
+
+void test_short_interval_runs_once_per_call() {
+    Hal::Sim::useManualClock(true);
+    uint32_t runs = 0;
+    SensorScheduler scheduler;
+    scheduler.add(0, [&runs] { runs++; }); // Treated as 1 ms
+    TEST_ASSERT_EQUAL(1, scheduler.runDue(0));
+    TEST_ASSERT_EQUAL(1, runs);
+    scheduler.setInterval(0, 50);
+    scheduler.runDue(1);
+    TEST_ASSERT_EQUAL(50, scheduler.runDue(1));
+}
+
+void test_deadlines_across_millis_wrap() {
+    Hal::Sim::useManualClock(true);
+    Hal::Sim::advanceMicros((static_cast<uint64_t>(UINT32_MAX) - 99) * 1000); // 100 ms before millis() wraps
+    std::string order;
+    SensorScheduler scheduler;
+    scheduler.add(1000, [&order] { order += 'a'; }, 150); // Due after the wrap
+    scheduler.add(1000, [&order] { order += 'b'; }, 50);
+    TEST_ASSERT_EQUAL(50, scheduler.runDue(Hal::millis()));
+    Hal::Sim::advanceMillis(200);
+    scheduler.runDue(Hal::millis());
+    TEST_ASSERT_EQUAL_STRING("ba", order.c_str());
+}
+
+struct CountingRun {
+    SensorScheduler scheduler;
+    std::atomic<uint32_t> runs{0};
+    std::atomic<bool> done{false};
+};
+
+void countingTask(void* parameters) {
+    CountingRun* run = static_cast<CountingRun*>(parameters);
+    run->scheduler.run();
+    run->done.store(true);
+}
+
+void test_interval_changes_while_running() {
+    CountingRun run;
+    run.scheduler.add(100, [&run] { run.runs++; });
+    TEST_ASSERT_TRUE(Hal::startTask("Sensors", countingTask, &run));
+    Hal::delay(50);
+    TEST_ASSERT_EQUAL(1, run.runs.load());
+
+    run.scheduler.setInterval(0, 10); // From another task, while run() sleeps
+    Hal::delay(300);
+    run.scheduler.stop();
+    while (!run.done.load()) {
+        Hal::delay(1);
+    }
+    // One more run at 100 ms, then every 10 ms rather than at 200 and 300 only
+    TEST_ASSERT_TRUE(run.runs.load() > 10);
+}
+
+void test_interval_set_while_jobs_run() {
+    CountingRun run;
+    run.scheduler.add(1, [&run] { run.runs++; });
+    run.scheduler.add(2, [] {});
+    TEST_ASSERT_TRUE(Hal::startTask("Sensors", countingTask, &run));
+
+    // Change the intervals while runDue() reads them on the scheduler's task
+    uint32_t startMs = Hal::millis();
+    while (Hal::millis() - startMs < 100) {
+        run.scheduler.setInterval(0, 1 + Hal::millis() % 3);
+        run.scheduler.setInterval(1, 2 + Hal::millis() % 5);
+    }
+    run.scheduler.setInterval(0, 10000);
+    Hal::delay(20); // The deadline already set is kept, at most 3 ms away
+    uint32_t runsAfterSlowing = run.runs.load();
+    Hal::delay(200);
+    run.scheduler.stop();
+    while (!run.done.load()) {
+        Hal::delay(1);
+    }
+    TEST_ASSERT_TRUE(runsAfterSlowing > 10);
+    TEST_ASSERT_EQUAL(runsAfterSlowing, run.runs.load()); // The next run is 10 s away
+}
+
+// A sensor read that records how far each gap between its reads strays from the interval
+struct SimSensor {
+    uint32_t intervalMs;
+    uint32_t lastUs = 0;
+    uint32_t reads = 0;
+    uint64_t totalJitterUs = 0;
+    uint32_t maxJitterUs = 0;
+    uint32_t lastPollMs = 0; // Old polling loop only
+
+    void read() {
+        uint32_t nowUs = Hal::micros();
+        if (reads > 0) {
+            int64_t deviation = static_cast<int64_t>(nowUs - lastUs) - static_cast<int64_t>(intervalMs) * 1000;
+            uint32_t jitterUs = static_cast<uint32_t>(deviation < 0 ? -deviation : deviation);
+            totalJitterUs += jitterUs;
+            maxJitterUs = jitterUs > maxJitterUs ? jitterUs : maxJitterUs;
+        }
+        lastUs = nowUs;
+        reads++;
+        Hal::delayMicroseconds(200); // The bus transaction
+    }
+};
+
+// The old sensorTask: wake on a fixed tick and check every sensor's interval
+struct PollingRun {
+    std::vector<SimSensor>* sensors;
+    uint32_t tickMs;
+    uint32_t wakeups = 0;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> done{false};
+};
+
+void pollingTask(void* parameters) {
+    PollingRun* run = static_cast<PollingRun*>(parameters);
+    while (!run->stopping.load()) {
+        run->wakeups++;
+        for (SimSensor& sensor : *run->sensors) {
+            if (Hal::millis() - sensor.lastPollMs >= sensor.intervalMs) {
+                sensor.read();
+                sensor.lastPollMs = Hal::millis();
+            }
+        }
+        Hal::delay(run->tickMs);
+    }
+    run->done.store(true);
+}
+
+struct SchedulerRun {
+    SensorScheduler scheduler;
+    std::atomic<bool> done{false};
+};
+
+void schedulerTask(void* parameters) {
+    SchedulerRun* run = static_cast<SchedulerRun*>(parameters);
+    run->scheduler.run();
+    run->done.store(true);
+}
+
+struct Measurement {
+    uint32_t wakeups;
+    uint32_t reads;
+    uint32_t meanJitterUs;
+    uint32_t maxJitterUs;
+};
+
+// SensorManager's kind of intervals at 1/20 the time: DHTs every 2-4 s, the battery every 30 s,
+// polled every 500 ms
+std::vector<SimSensor> makeSensors(size_t count) {
+    const uint32_t intervals[] = {100, 150, 200, 1500};
+    std::vector<SimSensor> sensors;
+    for (size_t i = 0; i < count; ++i) {
+        sensors.push_back(SimSensor{intervals[i % 4]});
+    }
+    return sensors;
+}
+
+Measurement summarize(const std::vector<SimSensor>& sensors, uint32_t wakeups) {
+    Measurement result{wakeups, 0, 0, 0};
+    uint64_t totalJitterUs = 0;
+    uint32_t gaps = 0;
+    for (const SimSensor& sensor : sensors) {
+        result.reads += sensor.reads;
+        totalJitterUs += sensor.totalJitterUs;
+        gaps += sensor.reads > 0 ? sensor.reads - 1 : 0;
+        result.maxJitterUs = sensor.maxJitterUs > result.maxJitterUs ? sensor.maxJitterUs : result.maxJitterUs;
+    }
+    result.meanJitterUs = gaps > 0 ? static_cast<uint32_t>(totalJitterUs / gaps) : 0;
+    return result;
+}
+
+const uint32_t runMs = 1000;
+
+Measurement measurePolling(size_t count) {
+    std::vector<SimSensor> sensors = makeSensors(count);
+    PollingRun run;
+    run.sensors = &sensors;
+    run.tickMs = 25;
+    TEST_ASSERT_TRUE(Hal::startTask("Polling", pollingTask, &run));
+    Hal::delay(runMs);
+    run.stopping.store(true);
+    while (!run.done.load()) {
+        Hal::delay(1);
+    }
+    return summarize(sensors, run.wakeups);
+}
+
+// Sensors spread over tasks schedulers, each on its own std::thread
+Measurement measureScheduler(size_t count, size_t tasks) {
+    std::vector<SimSensor> sensors = makeSensors(count);
+    std::vector<SchedulerRun> runs(tasks);
+    for (size_t i = 0; i < count; ++i) {
+        SimSensor* sensor = &sensors[i];
+        runs[i % tasks].scheduler.add(sensor->intervalMs, [sensor] { sensor->read(); });
+    }
+    for (SchedulerRun& run : runs) {
+        TEST_ASSERT_TRUE(Hal::startTask("Sensors", schedulerTask, &run));
+    }
+    Hal::delay(runMs);
+    uint32_t wakeups = 0;
+    for (SchedulerRun& run : runs) {
+        run.scheduler.stop();
+        while (!run.done.load()) {
+            Hal::delay(1);
+        }
+        wakeups += run.scheduler.getStats().wakeups;
+    }
+    return summarize(sensors, wakeups);
+}
+
+void report(const char* name, size_t count, const Measurement& result) {
+    char line[160];
+    snprintf(line, sizeof(line), "%2u sensors, %-12s %4u wakeups %5u reads, jitter mean %6u us max %6u us",
+             static_cast<unsigned>(count), name, static_cast<unsigned>(result.wakeups), static_cast<unsigned>(result.reads),
+             static_cast<unsigned>(result.meanJitterUs), static_cast<unsigned>(result.maxJitterUs));
+    TEST_MESSAGE(line);
+}
+
+void test_wakeups_and_jitter_versus_polling() {
+    const size_t counts[] = {1, 4, 16, 64};
+    for (size_t count : counts) {
+        Measurement polling = measurePolling(count);
+        Measurement scheduled = measureScheduler(count, 1);
+        report("polling", count, polling);
+        report("scheduler", count, scheduled);
+        if (count >= 4) {
+            report("4 schedulers", count, measureScheduler(count, 4));
+        }
+
+        TEST_ASSERT_TRUE(scheduled.wakeups < polling.wakeups);
+        if (count >= 16) {
+            // With few sensors both are within a millisecond or so and the host's scheduling decides
+            TEST_ASSERT_TRUE(scheduled.meanJitterUs < polling.meanJitterUs);
+        }
+    }
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+#ifndef ARDUINO
+    RUN_TEST(test_runs_jobs_in_deadline_order);
+    RUN_TEST(test_returns_time_until_next_deadline);
+    RUN_TEST(test_late_run_keeps_cadence);
+    RUN_TEST(test_falling_behind_skips_missed_runs);
+    RUN_TEST(test_short_interval_runs_once_per_call);
+    RUN_TEST(test_deadlines_across_millis_wrap);
+    RUN_TEST(test_interval_changes_while_running);
+    RUN_TEST(test_interval_set_while_jobs_run);
+    RUN_TEST(test_wakeups_and_jitter_versus_polling);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
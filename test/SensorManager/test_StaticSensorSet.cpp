@@ -0,0 +1,124 @@
+#include <unity.h>
+#include "StaticSensorSet.h"
+#include "BaseSensor.h"
+#include <string>
+#include <type_traits>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// A sensor that reads a fixed value and counts its calls
+class FixedSensor : public BaseSensor {
+public:
+    FixedSensor(int pin, float value, bool starts = true)
+        : BaseSensor(pin, "Fixed", SensorType::Undefined), value(value), starts(starts) {}
+
+    bool begin() override {
+        begun = true;
+        return starts;
+    }
+
+    float getReading() const override {
+        reads++;
+        return value;
+    }
+
+    float value;
+    bool starts;
+    bool begun = false;
+    mutable int reads = 0;
+};
+
+// Overrides the reading, to show which one a set of FixedSensor calls
+class OverridingSensor : public FixedSensor {
+public:
+    using FixedSensor::FixedSensor;
+    float getReading() const override { return -99; }
+};
+
+// Not a BaseSensor at all; the set only needs begin() and getReading()
+struct CounterSensor {
+    bool begin() { return true; }
+    float getReading() const { return static_cast<float>(++count); }
+    mutable int count = 0;
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_reads_every_sensor_in_order() {
+    FixedSensor first(26, 21.5f);
+    FixedSensor second(27, 48.0f);
+    CounterSensor counter;
+    StaticSensorSet sensors(first, second, counter);
+    TEST_ASSERT_EQUAL(3, sensors.size);
+
+    float readings[sensors.size];
+    sensors.readAll(readings);
+    sensors.readAll(readings);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, readings[0]);
+    TEST_ASSERT_EQUAL_FLOAT(48.0f, readings[1]);
+    TEST_ASSERT_EQUAL_FLOAT(2, readings[2]);
+    TEST_ASSERT_EQUAL(2, first.reads);
+}
+
+void test_begin_all_reports_a_failure_but_starts_the_rest() {
+    FixedSensor broken(26, 0, false);
+    FixedSensor working(27, 0);
+    StaticSensorSet sensors(broken, working);
+    TEST_ASSERT_FALSE(sensors.beginAll());
+    TEST_ASSERT_TRUE(broken.begun);
+    TEST_ASSERT_TRUE(working.begun);
+
+    StaticSensorSet good(working);
+    TEST_ASSERT_TRUE(good.beginAll());
+}
+
+void test_for_each_sees_concrete_types() {
+    FixedSensor fixed(26, 1);
+    CounterSensor counter;
+    StaticSensorSet sensors(fixed, counter);
+    std::string kinds;
+    sensors.forEach([&kinds](auto& sensor) {
+        kinds += std::is_base_of<BaseSensor, std::decay_t<decltype(sensor)>>::value ? 'B' : 'C';
+    });
+    TEST_ASSERT_EQUAL_STRING("BC", kinds.c_str());
+    TEST_ASSERT_EQUAL_PTR(&counter, &sensors.get<1>());
+}
+
+void test_calls_are_not_virtual() {
+    OverridingSensor sensor(26, 5);
+    StaticSensorSet<FixedSensor> sensors(sensor);
+    float reading;
+    sensors.readAll(&reading);
+    TEST_ASSERT_EQUAL_FLOAT(5, reading); // The declared type's reading, not the override
+    TEST_ASSERT_EQUAL_FLOAT(-99, static_cast<BaseSensor&>(sensor).getReading());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reads_every_sensor_in_order);
+    RUN_TEST(test_begin_all_reports_a_failure_but_starts_the_rest);
+    RUN_TEST(test_for_each_sees_concrete_types);
+    RUN_TEST(test_calls_are_not_virtual);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
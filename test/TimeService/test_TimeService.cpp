@@ -0,0 +1,242 @@
+#include <unity.h>
+#include "TimeService.h"
+#include <Hal.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <HalSim.h>
+#endif
+
+HAL_RTC_DATA TimeService::State testState;
+
+const uint64_t syncedEpochMs = 1700000000000ULL;
+const uint32_t awakeMs = 2000;                 // Time a wake spends before sleeping
+const uint64_t sleepUs = 298ULL * 1000 * 1000; // A 5 minute wake cycle with the awake time
+
+void setUp() {
+#ifndef ARDUINO
+    Hal::Sim::reset();
+    Hal::Sim::useManualClock(true);
+#endif
+    std::memset(&testState, 0, sizeof(testState));
+}
+
+void tearDown() {}
+
+void test_unsynced_clock_reads_zero() {
+    TimeService clock(testState);
+    clock.wake();
+    TEST_ASSERT_FALSE(clock.isSynced());
+    TEST_ASSERT_TRUE(clock.needsSync());
+    TEST_ASSERT_EQUAL_UINT64(0, clock.nowMs());
+    TEST_ASSERT_EQUAL(0, clock.getSyncCount());
+}
+
+void test_corruption_reads_as_unsynced() {
+    TimeService clock(testState);
+    clock.sync(syncedEpochMs);
+    TEST_ASSERT_TRUE(clock.isSynced());
+    testState.syncEpochMs ^= 1; // A bit flipped in RTC memory
+    TEST_ASSERT_FALSE(clock.isSynced());
+    TEST_ASSERT_TRUE(clock.needsSync());
+
+    clock.sync(syncedEpochMs); // Syncing starts over
+    TEST_ASSERT_TRUE(clock.isSynced());
+    TEST_ASSERT_EQUAL(1, clock.getSyncCount());
+}
+
+void test_format_time_of_day() {
+    char text[9];
+    TEST_ASSERT_EQUAL(8, TimeService::formatTimeOfDay(syncedEpochMs, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("22:13:20", text);
+    TEST_ASSERT_EQUAL(8, TimeService::formatTimeOfDay(86399999, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("23:59:59", text);
+    TEST_ASSERT_EQUAL(0, TimeService::formatTimeOfDay(0, text, 8));
+}
+
+#ifndef ARDUINO
+// One wake: awake time, then deep sleep; trueMs follows the reference clock
+void sleepCycle(uint64_t& trueMs) {
+    Hal::Sim::advanceMillis(awakeMs);
+    Hal::Sim::deepSleep(sleepUs);
+    trueMs += awakeMs + sleepUs / 1000;
+}
+
+// Local stand-in for NTPClient: whole seconds, centred as main.cpp does
+uint64_t ntpMs(uint64_t trueMs) {
+    return trueMs / 1000 * 1000 + 500;
+}
+
+void test_time_carries_across_deep_sleep() {
+    TimeService clock(testState);
+    uint64_t trueMs = syncedEpochMs;
+    clock.sync(trueMs);
+    for (int wake = 1; wake < 12; ++wake) {
+        sleepCycle(trueMs);
+        clock.wake();
+        TEST_ASSERT_EQUAL_UINT64(trueMs, clock.nowMs());
+        TEST_ASSERT_FALSE(clock.needsSync());
+    }
+    sleepCycle(trueMs);
+    clock.wake(); // The 12th wake since the sync
+    TEST_ASSERT_TRUE(clock.needsSync());
+
+    clock.sync(trueMs);
+    TEST_ASSERT_FALSE(clock.needsSync());
+    TEST_ASSERT_EQUAL(0, clock.getLastErrorMs());
+    TEST_ASSERT_EQUAL(2, clock.getSyncCount());
+}
+
+void test_sync_is_due_by_age() {
+    TimeService clock(testState, TimeService::Config{1000, 3600, 10800, true});
+    clock.sync(syncedEpochMs);
+    Hal::Sim::deepSleep(3599ULL * 1000 * 1000);
+    clock.wake();
+    TEST_ASSERT_FALSE(clock.needsSync());
+    Hal::Sim::deepSleep(1000ULL * 1000);
+    TEST_ASSERT_TRUE(clock.needsSync());
+}
+
+void test_state_survives_deep_sleep_not_power_loss() {
+    {
+        TimeService clock(testState);
+        clock.sync(syncedEpochMs);
+    }
+    Hal::Sim::deepSleep(sleepUs);
+    {
+        TimeService clock(testState); // The next wake constructs a new clock over the same state
+        TEST_ASSERT_TRUE(clock.isSynced());
+        TEST_ASSERT_EQUAL_UINT64(syncedEpochMs + sleepUs / 1000, clock.nowMs());
+    }
+    Hal::Sim::powerCycle();
+    TimeService clock(testState);
+    TEST_ASSERT_FALSE(clock.isSynced());
+}
+
+void test_drift_is_learned() {
+    Hal::Sim::setRtcDriftPpm(2000); // 7.2 s an hour
+    TimeService clock(testState, TimeService::Config{12, 86400, 3600, true});
+    uint64_t trueMs = syncedEpochMs;
+    clock.sync(trueMs);
+
+    for (int wake = 1; wake <= 12; ++wake) {
+        sleepCycle(trueMs);
+        clock.wake();
+    }
+    TEST_ASSERT_TRUE(clock.needsSync());
+    clock.sync(trueMs);
+    TEST_ASSERT_INT_WITHIN(200, 7128, clock.getLastErrorMs()); // Uncorrected over the first hour
+    TEST_ASSERT_INT_WITHIN(50, 2000, clock.getDriftPpm());
+
+    for (int wake = 1; wake <= 12; ++wake) {
+        sleepCycle(trueMs);
+        clock.wake();
+    }
+    TEST_ASSERT_INT_WITHIN(200, 0, static_cast<int64_t>(clock.nowMs() - trueMs));
+    clock.sync(trueMs);
+    TEST_ASSERT_INT_WITHIN(200, 0, clock.getLastErrorMs());
+}
+
+void test_implausible_drift_is_ignored() {
+    TimeService clock(testState, TimeService::Config{12, 86400, 60, true});
+    clock.sync(syncedEpochMs);
+    Hal::Sim::deepSleep(sleepUs);
+    clock.sync(syncedEpochMs + 3600 * 1000); // The reference jumped an hour
+    TEST_ASSERT_EQUAL(0, clock.getDriftPpm());
+    TEST_ASSERT_EQUAL(2, clock.getSyncCount());
+}
+
+struct ErrorStats {
+    uint32_t meanMs;
+    uint32_t maxMs;
+    uint32_t syncs;
+};
+
+// Two days of 5 minute wakes with a 500 ppm RTC, syncing against the NTP stand-in every
+// syncEveryWakes wakes; measures the timestamp error of each wake of the second day, once the
+// first has had time to learn the drift
+ErrorStats simulateDays(uint32_t syncEveryWakes, bool learnDrift) {
+    const int wakesPerDay = 288;
+    Hal::Sim::powerCycle();
+    Hal::Sim::setRtcDriftPpm(500);
+    TimeService clock(testState, TimeService::Config{syncEveryWakes, 86400, 3 * 3600, learnDrift});
+    uint64_t trueMs = syncedEpochMs;
+    uint64_t totalErrorMs = 0;
+    uint32_t maxErrorMs = 0;
+
+    for (int wake = 0; wake < 2 * wakesPerDay; ++wake) {
+        uint32_t connectMs = 500 + wake * 397 % 1000; // Varies where in the second the sync lands
+        Hal::Sim::advanceMillis(connectMs);
+        trueMs += connectMs;
+        clock.wake();
+        if (clock.needsSync()) {
+            clock.sync(ntpMs(trueMs));
+        }
+        if (wake >= wakesPerDay) {
+            uint32_t errorMs = static_cast<uint32_t>(std::llabs(static_cast<int64_t>(clock.nowMs() - trueMs)));
+            totalErrorMs += errorMs;
+            maxErrorMs = errorMs > maxErrorMs ? errorMs : maxErrorMs;
+        }
+
+        Hal::Sim::advanceMillis(awakeMs - connectMs);
+        Hal::Sim::deepSleep(sleepUs);
+        trueMs += awakeMs - connectMs + sleepUs / 1000;
+    }
+    return ErrorStats{static_cast<uint32_t>(totalErrorMs / wakesPerDay), maxErrorMs, clock.getSyncCount()};
+}
+
+void test_error_versus_sync_frequency() {
+    const uint32_t intervals[] = {1, 12, 48, 288};
+    for (uint32_t every : intervals) {
+        ErrorStats raw = simulateDays(every, false);
+        ErrorStats corrected = simulateDays(every, true);
+        char line[160];
+        snprintf(line, sizeof(line), "sync every %3u wakes (%3u syncs): uncorrected mean %5u max %6u ms, corrected mean %4u max %5u ms",
+                 static_cast<unsigned>(every), static_cast<unsigned>(corrected.syncs), static_cast<unsigned>(raw.meanMs),
+                 static_cast<unsigned>(raw.maxMs), static_cast<unsigned>(corrected.meanMs), static_cast<unsigned>(corrected.maxMs));
+        TEST_MESSAGE(line);
+
+        TEST_ASSERT_TRUE(corrected.maxMs <= 1000); // Within NTP's resolution however rarely it syncs
+        if (every >= 48) {
+            TEST_ASSERT_TRUE(corrected.meanMs * 4 < raw.meanMs);
+        }
+    }
+}
+#endif
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unsynced_clock_reads_zero);
+    RUN_TEST(test_corruption_reads_as_unsynced);
+    RUN_TEST(test_format_time_of_day);
+#ifndef ARDUINO
+    RUN_TEST(test_time_carries_across_deep_sleep);
+    RUN_TEST(test_sync_is_due_by_age);
+    RUN_TEST(test_state_survives_deep_sleep_not_power_loss);
+    RUN_TEST(test_drift_is_learned);
+    RUN_TEST(test_implausible_drift_is_ignored);
+    RUN_TEST(test_error_versus_sync_frequency);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200); // Start Serial for debug
+    delay(2000); // Give time to open serial monitor
+
+    runUnityTests();
+}
+
+void loop() {
+    // Unity runs tests in setup()
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,135 @@
+/**
+ * @brief Host-side decoder for the binary log and sensor data files.
+ *
+ * Prints each record as text (the default) or as CSV. Build on Linux from the repository root with:
+ *
+ *   g++ -std=c++17 -O2 -Ilib/FileManager/include -Ilib/Logger/include \
+ *       tools/binlog_decode/binlog_decode.cpp lib/FileManager/src/BinaryLogFormat.cpp -o binlog_decode
+ *
+ * Usage: binlog_decode [--csv] <file>...
+ */
+#include "BinaryLogFormat.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Timestamps from NTP are epoch milliseconds; anything earlier is time since boot
+void formatTimestamp(uint64_t timestampMs, char* out, size_t size) {
+    const uint64_t epochThresholdMs = 1000000000000ULL; // September 2001
+    if (timestampMs < epochThresholdMs) {
+        snprintf(out, size, "+%llums", static_cast<unsigned long long>(timestampMs));
+        return;
+    }
+    time_t seconds = static_cast<time_t>(timestampMs / 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    size_t length = strftime(out, size, "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(out + length, size - length, ".%03uZ", static_cast<unsigned>(timestampMs % 1000));
+}
+
+void printCsvMessage(const char* message, size_t length) {
+    putchar('"');
+    for (size_t i = 0; i < length; ++i) {
+        if (message[i] == '"') {
+            putchar('"'); // Escape quotes by doubling them
+        }
+        putchar(message[i]);
+    }
+    putchar('"');
+}
+
+int decodeFile(const char* path, bool csv) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        fprintf(stderr, "%s: cannot open file\n", path);
+        return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    BinaryLogDecoder decoder(data.data(), data.size());
+    if (!decoder.isValid()) {
+        fprintf(stderr, "%s: not a binary log file\n", path);
+        return 1;
+    }
+
+    BinaryLogEntry entry;
+    char timestamp[40];
+    while (decoder.next(entry)) {
+        if (csv) {
+            printf("%llu,", static_cast<unsigned long long>(entry.timestampMs));
+            if (entry.type == BinaryLogEntry::Type::Log) {
+                printf("log,%s,%u,,,,,,", logLevelName(entry.level), static_cast<unsigned>(entry.sourceId));
+                printCsvMessage(entry.message, entry.messageLength);
+            } else {
+                printf("reading,,,%u", static_cast<unsigned>(entry.sensorId));
+                for (uint8_t i = 0; i < BINARY_LOG_MAX_CHANNELS; ++i) {
+                    if (i < entry.valueCount) {
+                        printf(",%.2f", entry.values[i]);
+                    } else {
+                        printf(",");
+                    }
+                }
+                printf(",");
+            }
+            printf("\n");
+            continue;
+        }
+
+        formatTimestamp(entry.timestampMs, timestamp, sizeof(timestamp));
+        if (entry.type == BinaryLogEntry::Type::Log) {
+            printf("[%s] [%s] (source %u) %.*s\n", timestamp, logLevelName(entry.level),
+                   static_cast<unsigned>(entry.sourceId), static_cast<int>(entry.messageLength), entry.message);
+        } else {
+            printf("[%s] sensor %u:", timestamp, static_cast<unsigned>(entry.sensorId));
+            for (uint8_t i = 0; i < entry.valueCount; ++i) {
+                printf("%s %.2f", i == 0 ? "" : ",", entry.values[i]);
+            }
+            printf("\n");
+        }
+    }
+
+    if (decoder.hasError()) {
+        fprintf(stderr, "%s: stopped at malformed or truncated record at offset %zu\n", path, decoder.getOffset());
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool csv = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        fprintf(stderr, "Usage: %s [--csv] <file>...\n", argv[0]);
+        return 2;
+    }
+
+    if (csv) {
+        printf("timestamp_ms,kind,level,source,sensor");
+        for (int i = 0; i < BINARY_LOG_MAX_CHANNELS; ++i) {
+            printf(",value%d", i);
+        }
+        printf(",message\n");
+    }
+
+    int status = 0;
+    for (const char* path : paths) {
+        status |= decodeFile(path, csv);
+    }
+    return status;
+}